@@ -211,6 +211,10 @@ def addNoISAOptions(parser, configure_xiangshan=False):
     parser.add_argument("--arch-db-file",
                         action="store",
                         help="Where to save database")
+    parser.add_argument("--arch-db-format",
+                        default="sqlite",
+                        choices=["sqlite", "columnar"],
+                        help="On-disk format of the arch database")
     parser.add_argument("--arch-db-fromstart",
                         default=True,
                         help="start arch database from "
@@ -331,6 +335,12 @@ def addCommonOptions(parser, configure_xiangshan=False):
         default=20*10**6,
         help="Warmup period in total instructions, reset stats without switch")
 
+    parser.add_argument("--functional-warmup-insts", action="store", type=int,
+        default=None,
+        help="Warm caches, TLBs, branch predictor and prefetchers with an "
+        "atomic CPU for this many instructions per core before switching to "
+        "the detailed CPU")
+
     parser.add_argument(
         "--stats-root", action="append", default=[],
         help="If given, dump only stats of objects under the given SimObject. "
@@ -640,6 +650,10 @@ def addXiangshanFSOptions(parser):
     parser.add_argument("--raw-cpt", action= "store_true",
                         help = "The checkpoint file is not gz but binary")
 
+    parser.add_argument("--gcpt-lazy-restore", action="store_true",
+                        help="Decompress a multi-frame zstd checkpoint "
+                        "region by region on first access")
+
     parser.add_argument("--mmc-img", action="store", type=str,
                         default=None, help="The path of mmc img")
     parser.add_argument("--mmc-cptbin", action="store",
@@ -655,3 +669,28 @@ def addXiangshanFSOptions(parser):
                         default=None,
                         help="The shared lib file used to do difftest")
 
+    parser.add_argument("--difftest-batch-size",
+                        type=int,
+                        default=1,
+                        help="Step the difftest ref over this many "
+                        "committed instructions at once")
+
+    parser.add_argument("--difftest-async",
+                        action="store_true",
+                        help="Step the difftest ref on a separate host "
+                        "thread, needs --difftest-batch-size > 1")
+
+    # Parallel simulation option
+    parser.add_argument("--parallel-cores",
+                        action="store_true",
+                        help="Run each core with its private caches and "
+                        "TLBs on its own event queue and host thread "
+                        "(Ruby only)")
+
+    parser.add_argument("--sim-quantum",
+                        type=str,
+                        default=None,
+                        help="Synchronisation quantum of the event queues "
+                        "with --parallel-cores (default: the smallest "
+                        "latency between a core and the network, a longer "
+                        "one delays every message across it)")
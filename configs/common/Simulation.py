@@ -290,6 +290,22 @@ def benchCheckpoints(testsys, options, maxtick, cptdir):
 
     return exit_event
 
+def functionalWarmup(testsys, maxtick):
+    """Run the warmup CPUs of XSConfig.config_functional_warmup until one
+    of them retires its instructions, then switch to the detailed CPUs.
+    Returns the exit event if the simulation ended during the warmup."""
+    print("**** FUNCTIONAL WARMUP ****")
+    exit_event = m5.simulate(maxtick - m5.curTick())
+    exit_cause = exit_event.getCause()
+    if exit_cause != "a thread reached the max instruction count":
+        return exit_event
+
+    print("Functional warmup done @ tick %i, switching to detailed CPUs" %
+          m5.curTick())
+    m5.switchCpus(testsys, list(zip(testsys.warmup_cpus, testsys.cpu)))
+    m5.stats.reset()
+    return None
+
 # Set up environment for taking SimPoint checkpoints
 # Expecting SimPoint files generated by SimPoint 3.2
 def parseSimpointAnalysisFile(options, testsys):
@@ -843,11 +859,16 @@ def run_vanilla(options, root, testsys, cpu_class):
              " Using least")
     maxtick = min([maxtick_from_abs, maxtick_from_rel, maxtick_from_maxtime])
 
-    print("**** REAL SIMULATION ****")
+    exit_event = None
+    if hasattr(testsys, 'warmup_cpus'):
+        exit_event = functionalWarmup(testsys, maxtick)
 
-    # If checkpoints are being taken, then the checkpoint instruction
-    # will occur in the benchmark code it self.
-    exit_event = benchCheckpoints(testsys, options, maxtick, cptdir=None)
+    if exit_event is None:
+        print("**** REAL SIMULATION ****")
+
+        # If checkpoints are being taken, then the checkpoint instruction
+        # will occur in the benchmark code it self.
+        exit_event = benchCheckpoints(testsys, options, maxtick, cptdir=None)
 
     print('Exiting @ tick %i because %s' %
           (m5.curTick(), exit_event.getCause()))
@@ -93,6 +93,7 @@ def config_xiangshan_inputs(args: argparse.Namespace, sys):
         assert(buildEnv['TARGET_ISA'] == "riscv")
         sys.restore_from_gcpt = True
         sys.gcpt_file = args.generic_rv_cpt
+        sys.gcpt_lazy_restore = args.gcpt_lazy_restore
 
         sys.workload.bootloader = ''
         sys.workload.xiangshan_cpt = True
@@ -123,8 +124,142 @@ def config_difftest(cpu_list, args, sys):
                 cpu.enable_mem_dedup = True
                 cpu.enable_difftest = True
                 cpu.difftest_ref_so = args.difftest_ref_so
+                cpu.difftest_batch_size = args.difftest_batch_size
+                cpu.difftest_async = args.difftest_async
         else:
             # sys.enable_mem_dedup = True
             # cpu_list[0].enable_mem_dedup = True
             cpu_list[0].enable_difftest = True
             cpu_list[0].difftest_ref_so = args.difftest_ref_so
+            cpu_list[0].difftest_batch_size = args.difftest_batch_size
+            cpu_list[0].difftest_async = args.difftest_async
+
+
+def config_functional_warmup(args, sys):
+    """Put an atomic CPU in front of each detailed CPU of sys. It runs the
+    first args.functional_warmup_insts instructions of the core in atomic
+    mode, training the caches and their prefetchers, the TLBs of the shared
+    MMU and the branch predictor of the detailed CPU, which then takes over
+    (see Simulation.functionalWarmup)."""
+    if not args.functional_warmup_insts:
+        return
+
+    warmup_cpus = []
+    for cpu in sys.cpu:
+        warm = AtomicSimpleCPU(cpu_id=cpu.cpu_id, clk_domain=cpu.clk_domain)
+        warm.system = sys
+        warm.workload = cpu.workload
+        warm.progress_interval = cpu.progress_interval
+        warm.isa = cpu.isa
+        warm.mmu = cpu.mmu
+        warm.interrupts = cpu.interrupts
+        warm.max_insts_any_thread = args.functional_warmup_insts
+        warm.warmup_branch_pred = cpu.branchPred
+        warm.createThreads()
+
+        # the warmup CPU runs first, so it takes the caches and difftest
+        for port in ['icache_port', 'dcache_port']:
+            ref = getattr(cpu, port)
+            peer = ref.peer
+            ref.peer = None
+            peer.peer = None
+            setattr(warm, port, peer)
+        for param in ['enable_difftest', 'difftest_ref_so',
+                      'difftest_batch_size', 'difftest_async',
+                      'enable_mem_dedup', 'nemuSDimg', 'nemuSDCptBin',
+                      'enable_riscv_vector']:
+            setattr(warm, param, getattr(cpu, param))
+        cpu.enable_difftest = False
+
+        cpu.switched_out = True
+        warmup_cpus.append(warm)
+
+    sys.warmup_cpus = warmup_cpus
+    sys.mem_mode = 'atomic'
+    for obj in sys.descendants():
+        if isinstance(obj, BaseCache):
+            obj.prefetch_train_atomic = True
+
+
+def cross_queue_latency(args, sys):
+    """A lower bound, in ticks, of the latency of the messages between the
+    private controllers of a core and the network: the smallest latency of
+    their links and of their outgoing requests, responses, snoops and data,
+    in cycles of the faster of the CPU and Ruby clocks."""
+    cntrls = {id(obj) for cpu in sys.cpu for obj in cpu.descendants()
+              if isinstance(obj, RubyController)}
+    cycles = []
+    for link in sys.ruby.network.ext_links:
+        if id(link.ext_node) not in cntrls:
+            continue
+        cycles.append(int(link.latency))
+        for name in ("request_latency", "response_latency",
+                     "snoop_latency", "data_latency"):
+            if hasattr(link.ext_node, name):
+                cycles.append(int(getattr(link.ext_node, name)))
+    if not cycles:
+        fatal("--parallel-cores found no private controller of a core "
+              "on the network")
+    if min(cycles) == 0:
+        warn("A private controller of a core has a zero latency to the "
+             "network, its messages are held for a cycle")
+    period = min(m5.util.convert.anyToLatency(args.cpu_clock),
+                 m5.util.convert.anyToLatency(args.ruby_clock))
+    return max(min(cycles), 1) * m5.ticks.fromSeconds(period)
+
+def config_parallel_cores(args, root, sys):
+    """Give each core of a Ruby system its own event queue, so the cores
+    run on their own host threads and meet every quantum.
+
+    Everything below a CPU object moves with it: its TLBs, its branch
+    predictor and, with CHI, its sequencers and private L1 and L2
+    controllers (see CHI_RNF). The interconnect, the home and memory
+    nodes and the devices stay on queue 0. A message to another queue is
+    handed over under that queue's lock and takes at least a quantum; the
+    m_held_msgs and m_held_ticks stats of the MessageBuffers count the
+    messages that would have been faster.
+
+    The quantum is args.sim_quantum, by default the smallest latency of
+    such a message, so that none is held. Every private L2 miss crosses
+    twice, a longer quantum adds to each of them."""
+    if not args.parallel_cores:
+        return
+
+    if not args.ruby or buildEnv['PROTOCOL'] != 'CHI':
+        fatal("--parallel-cores needs --ruby with CHI, which keeps the "
+              "private controllers of a core below its CPU object")
+    if args.functional_warmup_insts:
+        fatal("--parallel-cores does not support functional warmup")
+    if args.enable_arch_db:
+        fatal("--parallel-cores does not support the arch db, which is "
+              "shared by all cores")
+    if args.l2_to_l3_pf_hint:
+        fatal("--parallel-cores does not support L2 to L3 prefetch hints")
+
+    if args.enable_difftest:
+        # The reference model and its golden memory see all cores.
+        warn("Difftest is disabled with --parallel-cores")
+        # System::initState wants deduplicated memory for multi-core
+        # difftest, so both go
+        sys.enable_difftest = False
+        sys.enable_mem_dedup = False
+        for cpu in sys.cpu:
+            cpu.enable_difftest = False
+            cpu.enable_mem_dedup = False
+            cpu.l1d.enable_difftest = False
+
+    for i, cpu in enumerate(sys.cpu):
+        for obj in cpu.descendants():
+            obj.eventq_index = i + 1
+
+    m5.ticks.fixGlobalFrequency()
+    latency = cross_queue_latency(args, sys)
+    quantum = latency
+    if args.sim_quantum is not None:
+        quantum = m5.ticks.fromSeconds(
+            m5.util.convert.anyToLatency(args.sim_quantum))
+        if quantum > latency:
+            warn("--sim-quantum is longer than the %d ticks between a "
+                 "core and the network, which delays its messages",
+                 latency)
+    root.sim_quantum = quantum
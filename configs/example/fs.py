@@ -156,6 +156,7 @@ def build_test_system(np):
                 uncacheable=[AddrRange(0, size=0x80000000)])
     if args.enable_arch_db:
         test_sys.arch_db = ArchDBer(arch_db_file=args.arch_db_file)
+        test_sys.arch_db.format = args.arch_db_format
         test_sys.arch_db.dump_from_start = args.arch_db_fromstart
         test_sys.arch_db.enable_rolling = args.enable_rolling
         test_sys.arch_db.dump_l1_pf_trace = False
@@ -228,6 +228,7 @@ def build_test_system(np, args):
         perfCCT_cmd += ");"
 
         test_sys.arch_db = ArchDBer(arch_db_file=args.arch_db_file)
+        test_sys.arch_db.format = args.arch_db_format
         test_sys.arch_db.dump_from_start = args.arch_db_fromstart
         test_sys.arch_db.enable_rolling = args.enable_rolling
         test_sys.arch_db.dump_l1_pf_trace = False
@@ -313,6 +314,9 @@ def build_test_system(np, args):
             test_sys.cpu[i].dump_commit = False
             test_sys.cpu[i].dump_start = 0
 
+    # must come last, the warmup CPUs copy the settings of the others
+    XSConfig.config_functional_warmup(args, test_sys)
+
     return test_sys
 
 def setKmhV3IdealParams(args, system):
@@ -418,4 +422,6 @@ if __name__ == '__m5_main__':
 
     root = Root(full_system=True, system=test_sys)
 
+    XSConfig.config_parallel_cores(args, root, test_sys)
+
     Simulation.run_vanilla(args, root, test_sys, FutureClass)
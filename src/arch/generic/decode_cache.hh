@@ -29,6 +29,8 @@
 #ifndef __ARCH_GENERIC_DECODE_CACHE_HH__
 #define __ARCH_GENERIC_DECODE_CACHE_HH__
 
+#include <unordered_map>
+
 #include "base/types.hh"
 #include "cpu/decode_cache.hh"
 #include "cpu/static_inst_fwd.hh"
@@ -76,6 +78,62 @@ class BasicDecodeCache
     }
 };
 
+/**
+ * A decode cache for one decoder, organized in fetch blocks. Each slot
+ * keeps the bits it was decoded from, so an instruction is only reused
+ * while the bytes at its address are unchanged, and stores to code or a
+ * fence.i need no explicit invalidation.
+ *
+ * Slots are keyed by the address the CPU fetched from, which is the
+ * virtual PC, and the map from bits to instructions belongs to the
+ * decoder too. Every core thus decodes its own copy of each
+ * instruction, but decoders of cores simulated on different host
+ * threads share nothing they write.
+ *
+ * No decoder uses it yet. It should replace BasicDecodeCache only once
+ * a simulation shows it is faster despite the duplicated instructions.
+ *
+ * @tparam InstPtr The decoded instruction handed out, only replaced by
+ *         tests that can't build a StaticInst.
+ */
+template <typename Decoder, typename EMI, Addr BlockShift = 6,
+          Addr SlotShift = 1, typename InstPtr = StaticInstPtr>
+class BlockDecodeCache
+{
+  private:
+    std::unordered_map<EMI, InstPtr> instMap;
+    struct Slot
+    {
+        InstPtr inst;
+        EMI machInst;
+    };
+    decode_cache::BlockMap<Slot, BlockShift, SlotShift> decodeBlocks;
+
+  public:
+    /// Decode a machine instruction.
+    /// @param mach_inst The binary instruction to decode.
+    /// @retval A pointer to the corresponding StaticInst object.
+    InstPtr
+    decode(Decoder *const decoder, EMI mach_inst, Addr addr)
+    {
+        auto &slot = decodeBlocks.lookup(addr);
+        if (slot.inst && (slot.machInst == mach_inst))
+            return slot.inst;
+
+        slot.machInst = mach_inst;
+
+        auto iter = instMap.find(mach_inst);
+        if (iter != instMap.end()) {
+            slot.inst = iter->second;
+            return slot.inst;
+        }
+
+        slot.inst = decoder->decodeInst(mach_inst);
+        instMap[mach_inst] = slot.inst;
+        return slot.inst;
+    }
+};
+
 } // namespace GenericISA
 } // namespace gem5
 
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "arch/generic/decode_cache.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** The instruction a TestDecoder decodes bits to */
+struct TestInst
+{
+    uint32_t bits;
+};
+
+using TestInstPtr = std::shared_ptr<const TestInst>;
+
+/** Decodes bits to a new instruction every time, and counts them */
+class TestDecoder
+{
+  public:
+    TestInstPtr
+    decodeInst(uint32_t mach_inst)
+    {
+        decoded.push_back(mach_inst);
+        return std::make_shared<const TestInst>(TestInst{mach_inst});
+    }
+
+    std::vector<uint32_t> decoded;
+};
+
+using TestCache =
+    GenericISA::BlockDecodeCache<TestDecoder, uint32_t, 6, 1, TestInstPtr>;
+
+} // anonymous namespace
+
+/** Every halfword of a block has a slot, bytes within it share it */
+TEST(BlockMapTest, SlotPerHalfword)
+{
+    decode_cache::BlockMap<int> map;
+    for (Addr addr = 0x80000000; addr < 0x80000040; addr += 2) {
+        map.lookup(addr) = int(addr - 0x80000000);
+    }
+    for (Addr addr = 0x80000000; addr < 0x80000040; addr++) {
+        ASSERT_EQ(map.lookup(addr), int((addr - 0x80000000) & ~Addr(1)));
+    }
+    // the next block starts out empty
+    ASSERT_EQ(map.lookup(0x80000040), 0);
+    ASSERT_EQ(&map.lookup(0x80000001), &map.lookup(0x80000000));
+    ASSERT_NE(&map.lookup(0x80000002), &map.lookup(0x80000000));
+}
+
+/**
+ * Blocks mapped to the same way push each other out of the table, but
+ * keep their slots in the hash map behind it.
+ */
+TEST(BlockMapTest, DirectMappedConflict)
+{
+    // four ways of 64 bytes, so blocks 256 bytes apart conflict
+    decode_cache::BlockMap<int, 6, 1, 4> map;
+    const Addr a = 0x80000010;
+    const Addr b = a + 0x100;
+    const Addr c = a + 0x100000000ULL;
+    int *slot_a = &map.lookup(a);
+    *slot_a = 1;
+    map.lookup(b) = 2;
+    map.lookup(c) = 3;
+    // a neighbour in another way is not disturbed
+    map.lookup(a + 0x40) = 4;
+
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(map.lookup(a), 1);
+        ASSERT_EQ(map.lookup(c), 3);
+        ASSERT_EQ(map.lookup(b), 2);
+        ASSERT_EQ(map.lookup(a + 0x40), 4);
+    }
+    ASSERT_EQ(&map.lookup(a), slot_a);
+}
+
+/** Bits seen again are not decoded again, at any address */
+TEST(BlockDecodeCacheTest, ReuseDecoded)
+{
+    TestDecoder decoder;
+    TestCache cache;
+
+    TestInstPtr add = cache.decode(&decoder, 0x00b50533, 0x80000000);
+    ASSERT_EQ(add->bits, 0x00b50533u);
+    ASSERT_EQ(cache.decode(&decoder, 0x00b50533, 0x80000000), add);
+    // the same bits elsewhere share the instruction
+    ASSERT_EQ(cache.decode(&decoder, 0x00b50533, 0x80001234), add);
+    ASSERT_EQ(decoder.decoded, std::vector<uint32_t>{0x00b50533});
+
+    // a compressed instruction in the next halfword has its own slot
+    TestInstPtr c_addi = cache.decode(&decoder, 0x0505, 0x80000002);
+    ASSERT_EQ(c_addi->bits, 0x0505u);
+    ASSERT_EQ(cache.decode(&decoder, 0x00b50533, 0x80000000), add);
+    ASSERT_EQ(decoder.decoded.size(), 2u);
+}
+
+/**
+ * Code written over is decoded from its new bits, without the cache
+ * being told, and the old bits come back from the map of instructions.
+ */
+TEST(BlockDecodeCacheTest, SelfModifyingCode)
+{
+    TestDecoder decoder;
+    TestCache cache;
+    const Addr pc = 0x80000100;
+
+    TestInstPtr old_inst = cache.decode(&decoder, 0x00100093, pc);
+    TestInstPtr new_inst = cache.decode(&decoder, 0x00200093, pc);
+    ASSERT_NE(new_inst, old_inst);
+    ASSERT_EQ(new_inst->bits, 0x00200093u);
+    ASSERT_EQ(cache.decode(&decoder, 0x00200093, pc), new_inst);
+
+    ASSERT_EQ(cache.decode(&decoder, 0x00100093, pc), old_inst);
+    ASSERT_EQ(decoder.decoded,
+              (std::vector<uint32_t>{0x00100093, 0x00200093}));
+}
+
+/** Code 64KiB apart conflicts in the table but decodes only once */
+TEST(BlockDecodeCacheTest, DirectMappedConflict)
+{
+    TestDecoder decoder;
+    TestCache cache;
+    // 1024 ways of 64 bytes
+    const Addr a = 0x80000000;
+    const Addr b = a + 0x10000;
+
+    TestInstPtr inst_a = cache.decode(&decoder, 0x00000013, a);
+    TestInstPtr inst_b = cache.decode(&decoder, 0x00000073, b);
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(cache.decode(&decoder, 0x00000013, a), inst_a);
+        ASSERT_EQ(cache.decode(&decoder, 0x00000073, b), inst_b);
+    }
+    ASSERT_EQ(decoder.decoded.size(), 2u);
+}
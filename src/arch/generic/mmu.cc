@@ -156,6 +156,10 @@ BaseMMU::MMUTranslationGen::translate(Range &range) const
 void
 BaseMMU::takeOverFrom(BaseMMU *old_mmu)
 {
+    // a functional warmup CPU shares its MMU with the CPU it hands over to
+    if (old_mmu == this)
+        return;
+
     Port *old_itb_port = old_mmu->itb->getTableWalkerPort();
     Port *old_dtb_port = old_mmu->dtb->getTableWalkerPort();
     Port *new_itb_port = itb->getTableWalkerPort();
@@ -52,6 +52,8 @@ class RiscvPagetableWalker(ClockedObject):
     pmp = Param.PMP(Parent.any, "PMP")
     open_nextline = Param.Bool(True, "open nextline pre")
 
+class RiscvL2TLBRepl(Enum): vals = ['lru', 'tree_plru']
+
 class RiscvTLB(BaseTLB):
     type = 'RiscvTLB'
     cxx_class = 'gem5::RiscvISA::TLB'
@@ -79,6 +81,10 @@ class RiscvTLB(BaseTLB):
     l2tlb_l3_size = Param.Int(128, "l2TLB_l3 size")
     l2tlb_sp_size = Param.Int(16, "l2TLB_sp size")
     l2tlb_line_size = Param.Int(8, "l2TLB_line size")
+    l2tlb_l2_assoc = Param.Unsigned(2, "l2TLB_l2 ways per set, in lines")
+    l2tlb_l3_assoc = Param.Unsigned(4, "l2TLB_l3 ways per set, in lines")
+    l2tlb_repl = Param.RiscvL2TLBRepl('lru',
+        "replacement within a l2TLB_l2/l2TLB_l3 set")
     regulation_num = Param.Int(70000, "train nextline num")
     walker = Param.RiscvPagetableWalker(\
             RiscvPagetableWalker(), "page table walker")
@@ -38,7 +38,8 @@ namespace gem5
 namespace RiscvISA
 {
 
-GenericISA::BasicDecodeCache<Decoder, ExtMachInst> Decoder::defaultCache;
+thread_local GenericISA::BasicDecodeCache<Decoder, ExtMachInst>
+    Decoder::defaultCache;
 
 void Decoder::reset()
 {
@@ -60,8 +60,10 @@ class Decoder : public InstDecoder
     bool vtypeReady = true;
     VTYPE machVtype;
 
-    /// A cache of decoded instruction objects.
-    static GenericISA::BasicDecodeCache<Decoder, ExtMachInst> defaultCache;
+    /// A cache of decoded instruction objects, shared by the decoders
+    /// simulated on a host thread.
+    static thread_local GenericISA::BasicDecodeCache<Decoder, ExtMachInst>
+        defaultCache;
     friend class GenericISA::BasicDecodeCache<Decoder, ExtMachInst>;
 
     StaticInstPtr decodeInst(ExtMachInst mach_inst);
@@ -0,0 +1,269 @@
+#ifndef __ARCH_RISCV_HOST_FP_HH__
+#define __ARCH_RISCV_HOST_FP_HH__
+
+#include <softfloat.h>
+
+#include <cfenv>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+namespace gem5
+{
+
+namespace RiscvISA
+{
+
+/*
+ * Scalar F and D operations that run on the host FPU when that gives the
+ * same result and flags as softfloat, and fall back to softfloat
+ * otherwise.
+ *
+ * The host result is taken only with round to nearest even, for finite
+ * operands and a finite result far enough from the subnormal range that
+ * underflow cannot happen. IEEE 754 then fixes the value, and the only
+ * flag that can be raised is inexact, which is found with an error-free
+ * transformation rather than by reading the host flags: clearing and
+ * testing those costs more than softfloat itself. Everything else,
+ * including NaN boxing, canonical NaNs and tininess, is left to
+ * softfloat, as are fused multiply-adds, which have no cheap exactness
+ * test.
+ */
+namespace host_fp
+{
+
+/** Whether the host evaluates float and double as IEEE 754 binary32 and
+ *  binary64, without excess precision. */
+constexpr bool usable = FLT_EVAL_METHOD == 0 &&
+                        std::numeric_limits<float>::is_iec559 &&
+                        std::numeric_limits<double>::is_iec559;
+
+/** Whether the host rounds to nearest even without flushing subnormals. */
+inline bool
+hostRoundsToNearest()
+{
+#if defined(__SSE2__)
+    // All exceptions masked, round to nearest, no FTZ or DAZ.
+    return (_mm_getcsr() & ~0x3fu) == 0x1f80;
+#else
+    return std::fegetround() == FE_TONEAREST;
+#endif
+}
+
+inline bool
+enabled()
+{
+    return usable &&
+        softfloat_roundingMode == softfloat_round_near_even &&
+        softfloat_detectTininess == softfloat_tininess_afterRounding &&
+        hostRoundsToNearest();
+}
+
+inline float
+toHost(float32_t v)
+{
+    float h;
+    std::memcpy(&h, &v.v, sizeof(h));
+    return h;
+}
+
+inline double
+toHost(float64_t v)
+{
+    double h;
+    std::memcpy(&h, &v.v, sizeof(h));
+    return h;
+}
+
+template <typename Soft, typename Host>
+inline Soft
+toSoft(Host h, bool inexact)
+{
+    Soft v;
+    static_assert(sizeof(v.v) == sizeof(h));
+    std::memcpy(&v.v, &h, sizeof(h));
+    if (inexact) {
+        softfloat_exceptionFlags |= softfloat_flag_inexact;
+    }
+    return v;
+}
+
+/** Whether a + b == s exactly, for a rounded sum s that did not
+ *  overflow (Knuth's TwoSum). */
+template <typename T>
+inline bool
+sumExact(T a, T b, T s)
+{
+    T bb = s - a;
+    return (a - (s - bb)) + (b - bb) == 0;
+}
+
+/**
+ * Whether a * b == p exactly. With an FMA unit this is one instruction,
+ * otherwise Dekker's product with Veltkamp splitting, which needs both
+ * operands below 2^995.
+ */
+inline bool
+productIs(double a, double b, double p)
+{
+#ifdef FP_FAST_FMA
+    return std::fma(a, b, -p) == 0;
+#else
+    constexpr double split = 134217729.0; // 2^27 + 1
+    double ca = split * a, cb = split * b;
+    double ah = ca - (ca - a), al = a - ah;
+    double bh = cb - (cb - b), bl = b - bh;
+    return ((ah * bh - p) + ah * bl + al * bh) + al * bl == 0;
+#endif
+}
+
+/** Products of doubles whose error term is neither subnormal nor lost,
+ *  and whose splitting cannot overflow. */
+constexpr double productMin = 0x1p-960;
+constexpr double productMax = 0x1p994;
+
+inline bool
+inRange(double v)
+{
+    double m = std::fabs(v);
+    return m >= productMin && m <= productMax;
+}
+
+} // namespace host_fp
+
+/*
+ * Single precision checks exactness in double, where the product of two
+ * floats is always exact.
+ */
+
+inline float32_t
+fastF32Add(float32_t a, float32_t b)
+{
+    float x = host_fp::toHost(a), y = host_fp::toHost(b);
+    float s = x + y;
+    if (host_fp::enabled() && std::isfinite(s)) {
+        // NaN and infinite operands give a NaN or infinite sum.
+        return host_fp::toSoft<float32_t>(s, !host_fp::sumExact(x, y, s));
+    }
+    return f32_add(a, b);
+}
+
+inline float32_t
+fastF32Sub(float32_t a, float32_t b)
+{
+    float x = host_fp::toHost(a), y = host_fp::toHost(b);
+    float s = x - y;
+    if (host_fp::enabled() && std::isfinite(s)) {
+        return host_fp::toSoft<float32_t>(s, !host_fp::sumExact(x, -y, s));
+    }
+    return f32_sub(a, b);
+}
+
+inline float32_t
+fastF32Mul(float32_t a, float32_t b)
+{
+    float x = host_fp::toHost(a), y = host_fp::toHost(b);
+    double p = double(x) * y;
+    if (host_fp::enabled() && std::fabs(p) >= FLT_MIN &&
+            std::fabs(p) <= FLT_MAX) {
+        float r = p;
+        if (std::isfinite(r)) {
+            return host_fp::toSoft<float32_t>(r, r != p);
+        }
+    }
+    return f32_mul(a, b);
+}
+
+inline float32_t
+fastF32Div(float32_t a, float32_t b)
+{
+    float x = host_fp::toHost(a), y = host_fp::toHost(b);
+    float q = x / y;
+    if (host_fp::enabled() && std::isfinite(x) && std::fabs(q) > FLT_MIN &&
+            std::fabs(q) <= FLT_MAX) {
+        // y is finite and non-zero for a finite, non-zero quotient, and
+        // a quotient rounded up to FLT_MIN may still be tiny.
+        return host_fp::toSoft<float32_t>(q, double(q) * y != x);
+    }
+    return f32_div(a, b);
+}
+
+inline float32_t
+fastF32Sqrt(float32_t a)
+{
+    float x = host_fp::toHost(a);
+    if (host_fp::enabled() && x >= FLT_MIN && x <= FLT_MAX) {
+        float r = std::sqrt(x);
+        return host_fp::toSoft<float32_t>(r, double(r) * r != x);
+    }
+    return f32_sqrt(a);
+}
+
+inline float64_t
+fastF64Add(float64_t a, float64_t b)
+{
+    double x = host_fp::toHost(a), y = host_fp::toHost(b);
+    double s = x + y;
+    if (host_fp::enabled() && std::isfinite(s)) {
+        return host_fp::toSoft<float64_t>(s, !host_fp::sumExact(x, y, s));
+    }
+    return f64_add(a, b);
+}
+
+inline float64_t
+fastF64Sub(float64_t a, float64_t b)
+{
+    double x = host_fp::toHost(a), y = host_fp::toHost(b);
+    double s = x - y;
+    if (host_fp::enabled() && std::isfinite(s)) {
+        return host_fp::toSoft<float64_t>(s, !host_fp::sumExact(x, -y, s));
+    }
+    return f64_sub(a, b);
+}
+
+inline float64_t
+fastF64Mul(float64_t a, float64_t b)
+{
+    double x = host_fp::toHost(a), y = host_fp::toHost(b);
+    double p = x * y;
+    if (host_fp::enabled() && host_fp::inRange(p) && host_fp::inRange(x) &&
+            host_fp::inRange(y)) {
+        return host_fp::toSoft<float64_t>(p, !host_fp::productIs(x, y, p));
+    }
+    return f64_mul(a, b);
+}
+
+inline float64_t
+fastF64Div(float64_t a, float64_t b)
+{
+    double x = host_fp::toHost(a), y = host_fp::toHost(b);
+    double q = x / y;
+    if (host_fp::enabled() && host_fp::inRange(x) && host_fp::inRange(y) &&
+            host_fp::inRange(q)) {
+        return host_fp::toSoft<float64_t>(q, !host_fp::productIs(q, y, x));
+    }
+    return f64_div(a, b);
+}
+
+inline float64_t
+fastF64Sqrt(float64_t a)
+{
+    double x = host_fp::toHost(a);
+    if (host_fp::enabled() && x >= host_fp::productMin &&
+            x <= host_fp::productMax) {
+        double r = std::sqrt(x);
+        return host_fp::toSoft<float64_t>(r, !host_fp::productIs(r, r, x));
+    }
+    return f64_sqrt(a);
+}
+
+} // namespace RiscvISA
+} // namespace gem5
+
+#endif // __ARCH_RISCV_HOST_FP_HH__
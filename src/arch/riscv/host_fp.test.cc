@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <softfloat.h>
+#include <specialize.h>
+
+#include <cstdint>
+#include <functional>
+#include <random>
+
+#include "arch/riscv/host_fp.hh"
+
+using namespace gem5;
+using namespace gem5::RiscvISA;
+
+namespace
+{
+
+/** Operands biased towards the cases the host path must hand over */
+template <typename Bits, int ExpBits, int FracBits>
+Bits
+randomOperand(std::mt19937_64 &rng)
+{
+    const Bits sign = Bits(rng() & 1) << (ExpBits + FracBits);
+    const Bits max_exp = (Bits(1) << ExpBits) - 1;
+    const Bits frac_mask = (Bits(1) << FracBits) - 1;
+    auto make = [&](Bits exp, Bits frac) {
+        return sign | (exp << FracBits) | (frac & frac_mask);
+    };
+    // a few significand bits set, so results are often exact
+    Bits short_frac = Bits(rng()) << (FracBits - 8);
+
+    switch (rng() % 12) {
+      case 0: return make(0, 0);
+      case 1: return make(0, rng());
+      case 2: return make(rng() % 4, rng());
+      case 3: return make(max_exp - 1 - rng() % 4, rng());
+      case 4: return make(max_exp, 0);
+      case 5: return make(max_exp, rng() | 1);
+      case 6: return make(max_exp, (Bits(1) << (FracBits - 1)) | rng());
+      case 7: return make(max_exp / 2 + rng() % 8, short_frac);
+      case 8: return make(max_exp / 2 - rng() % 8, short_frac);
+      case 9: return make(max_exp / 2 + rng() % 64 - 32, rng());
+      default: return Bits(rng());
+    }
+}
+
+/**
+ * Run an operation with both implementations, mostly with round to
+ * nearest even and sometimes with another rounding mode, and check that
+ * results and flags are bit-exact.
+ */
+template <typename Soft, typename Bits, int ExpBits, int FracBits,
+          int NumOps>
+void
+compare(const char *name,
+        std::function<Soft(const Soft *)> fast,
+        std::function<Soft(const Soft *)> soft)
+{
+    std::mt19937_64 rng(0x5eed);
+    Soft ops[NumOps];
+    for (int i = 0; i < 200000; i++) {
+        for (auto &op : ops) {
+            op.v = randomOperand<Bits, ExpBits, FracBits>(rng);
+        }
+        uint_fast8_t rm = softfloat_round_near_even;
+        if (i % 8 == 0) {
+            rm = rng() % 5;
+        }
+        softfloat_roundingMode = rm;
+
+        softfloat_exceptionFlags = 0;
+        const Soft expected = soft(ops);
+        const uint_fast8_t expected_flags = softfloat_exceptionFlags;
+
+        softfloat_exceptionFlags = 0;
+        const Soft actual = fast(ops);
+        const uint_fast8_t actual_flags = softfloat_exceptionFlags;
+
+        ASSERT_EQ(actual.v, expected.v)
+            << name << " #" << i << " rm " << int(rm) << " " << std::hex
+            << ops[0].v << " " << ops[NumOps - 1].v;
+        ASSERT_EQ(actual_flags, expected_flags)
+            << name << " #" << i << " rm " << int(rm) << " " << std::hex
+            << ops[0].v << " " << ops[NumOps - 1].v;
+    }
+    softfloat_roundingMode = softfloat_round_near_even;
+    softfloat_exceptionFlags = 0;
+}
+
+template <typename Soft, int NumOps>
+using Op = std::function<Soft(const Soft *)>;
+
+} // anonymous namespace
+
+TEST(HostFpTest, F32AgainstSoftfloat)
+{
+    using F = Op<float32_t, 2>;
+    auto cmp = compare<float32_t, uint32_t, 8, 23, 2>;
+    cmp("add", F([](auto o) { return fastF32Add(o[0], o[1]); }),
+        F([](auto o) { return f32_add(o[0], o[1]); }));
+    cmp("sub", F([](auto o) { return fastF32Sub(o[0], o[1]); }),
+        F([](auto o) { return f32_sub(o[0], o[1]); }));
+    cmp("mul", F([](auto o) { return fastF32Mul(o[0], o[1]); }),
+        F([](auto o) { return f32_mul(o[0], o[1]); }));
+    cmp("div", F([](auto o) { return fastF32Div(o[0], o[1]); }),
+        F([](auto o) { return f32_div(o[0], o[1]); }));
+    compare<float32_t, uint32_t, 8, 23, 1>("sqrt",
+        [](auto o) { return fastF32Sqrt(o[0]); },
+        [](auto o) { return f32_sqrt(o[0]); });
+}
+
+TEST(HostFpTest, F64AgainstSoftfloat)
+{
+    using F = Op<float64_t, 2>;
+    auto cmp = compare<float64_t, uint64_t, 11, 52, 2>;
+    cmp("add", F([](auto o) { return fastF64Add(o[0], o[1]); }),
+        F([](auto o) { return f64_add(o[0], o[1]); }));
+    cmp("sub", F([](auto o) { return fastF64Sub(o[0], o[1]); }),
+        F([](auto o) { return f64_sub(o[0], o[1]); }));
+    cmp("mul", F([](auto o) { return fastF64Mul(o[0], o[1]); }),
+        F([](auto o) { return f64_mul(o[0], o[1]); }));
+    cmp("div", F([](auto o) { return fastF64Div(o[0], o[1]); }),
+        F([](auto o) { return f64_div(o[0], o[1]); }));
+    compare<float64_t, uint64_t, 11, 52, 1>("sqrt",
+        [](auto o) { return fastF64Sqrt(o[0]); },
+        [](auto o) { return f64_sqrt(o[0]); });
+}
+
+/** NaN results are the canonical NaN whatever NaNs went in */
+TEST(HostFpTest, CanonicalNaN)
+{
+    softfloat_roundingMode = softfloat_round_near_even;
+    softfloat_exceptionFlags = 0;
+
+    const float64_t qnan{0xfff8000000001234};
+    const float64_t one{0x3ff0000000000000};
+    ASSERT_EQ(fastF64Add(qnan, one).v, defaultNaNF64UI);
+    ASSERT_EQ(softfloat_exceptionFlags, 0);
+
+    const float64_t inf{0x7ff0000000000000};
+    ASSERT_EQ(fastF64Sub(inf, inf).v, defaultNaNF64UI);
+    ASSERT_EQ(softfloat_exceptionFlags, softfloat_flag_invalid);
+
+    softfloat_exceptionFlags = 0;
+    const float32_t snan{0xff800001};
+    const float32_t two{0x40000000};
+    ASSERT_EQ(fastF32Mul(snan, two).v, defaultNaNF32UI);
+    ASSERT_EQ(softfloat_exceptionFlags, softfloat_flag_invalid);
+    softfloat_exceptionFlags = 0;
+}
@@ -83,6 +83,8 @@ class MMU : public BaseMMU
     void
     takeOverFrom(BaseMMU *old_mmu) override
     {
+      if (old_mmu == this)
+          return;
       MMU *ommu = dynamic_cast<MMU*>(old_mmu);
       BaseMMU::takeOverFrom(ommu);
       pma->takeOverFrom(ommu->pma);
@@ -31,6 +31,7 @@
 
 #include "arch/riscv/tlb.hh"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,7 @@
 #include "arch/riscv/pra_constants.hh"
 #include "arch/riscv/utility.hh"
 #include "base/inifile.hh"
+#include "base/intmath.hh"
 #include "base/str.hh"
 #include "base/trace.hh"
 #include "cpu/thread_context.hh"
@@ -100,10 +102,21 @@ TLB::TLB(const Params &p) :
     pmp(p.pmp),
     tlbL2L1(l2TlbL1Size *l2tlbLineSize),tlbL2L2(l2TlbL2Size *l2tlbLineSize),
     tlbL2L3(l2TlbL3Size *l2tlbLineSize),tlbL2Sp(l2TlbSpSize *l2tlbLineSize),
-    forwardPre(forwardPreSize),backPre(32)
+    forwardPre(forwardPreSize),backPre(32),
+    l2TreePLRU(p.l2tlb_repl == enums::RiscvL2TLBRepl::tree_plru)
 {
-    L2TLB_L2_MASK = (((uint64_t)1) << static_cast<int>(std::log2(l2TlbL2Size / 2))) - 1;
-    L2TLB_L3_MASK = (((uint64_t)1) << static_cast<int>(std::log2(l2TlbL3Size / 4))) - 1;
+    fatal_if(p.l2tlb_l2_assoc == 0 || l2TlbL2Size % p.l2tlb_l2_assoc ||
+             !isPowerOf2(l2TlbL2Size / p.l2tlb_l2_assoc),
+             "%s: l2tlb_l2_size %d is not a power of two number of sets of %d lines\n",
+             name(), l2TlbL2Size, p.l2tlb_l2_assoc);
+    fatal_if(p.l2tlb_l3_assoc == 0 || l2TlbL3Size % p.l2tlb_l3_assoc ||
+             !isPowerOf2(l2TlbL3Size / p.l2tlb_l3_assoc),
+             "%s: l2tlb_l3_size %d is not a power of two number of sets of %d lines\n",
+             name(), l2TlbL3Size, p.l2tlb_l3_assoc);
+    fatal_if(l2TreePLRU && !(isPowerOf2(p.l2tlb_l2_assoc) && isPowerOf2(p.l2tlb_l3_assoc)),
+             "%s: tree-PLRU needs a power of two l2tlb_l2_assoc and l2tlb_l3_assoc\n", name());
+    L2TLB_L2_MASK = l2TlbL2Size / p.l2tlb_l2_assoc - 1;
+    L2TLB_L3_MASK = l2TlbL3Size / p.l2tlb_l3_assoc - 1;
 
     if (is_L1tlb) {
         DPRINTF(TLBVerbose, "tlb11\n");
@@ -130,6 +143,9 @@ TLB::TLB(const Params &p) :
         configL2Tlb(&freeListL2L2,&trieL2L2,tlbL2L2,l2TlbL2Size,false);
         configL2Tlb(&freeListL2L3,&trieL2L3,tlbL2L3,l2TlbL3Size,false);
         configL2Tlb(&freeListL2sp,&trieL2sp,tlbL2Sp,l2TlbSpSize,true);
+        l2Sets.resize(l2Tlb.size());
+        configL2TlbSets(L_L2L2, l2TlbL2Size, p.l2tlb_l2_assoc, PageShift + LEVEL_BITS + L2TLB_BLK_OFFSET);
+        configL2TlbSets(L_L2L3, l2TlbL3Size, p.l2tlb_l3_assoc, PageShift + L2TLB_BLK_OFFSET);
 
         for (size_t x_g = 0; x_g < forwardPreSize; x_g++) {
             forwardPre[x_g].trieHandle = nullptr;
@@ -175,6 +191,92 @@ TLB::configL2Tlb(EntryList *List_choose, TlbEntryTrie *Trie_l2_choose, std::vect
         l2Freelist.push_back(List_choose);
     }
 }
+
+void
+TLB::configL2TlbSets(int choose, size_t lines, unsigned assoc, unsigned index_shift)
+{
+    L2TLBSets &sets = l2Sets[choose - 1];
+    sets.assoc = assoc;
+    sets.setMask = lines / assoc - 1;
+    sets.indexShift = index_shift;
+    sets.plru.assign(lines, 0);
+    // lines are found through their set instead
+    l2Freelist[choose - 1]->clear();
+}
+
+size_t
+TLB::l2TLBSetVictim(int choose, Addr vpn)
+{
+    const L2TLBSets &sets = l2Sets[choose - 1];
+    const TlbEntry *lines = l2Tlb[choose - 1];
+    size_t first = ((vpn >> sets.indexShift) & sets.setMask) * sets.assoc;
+
+    // some entries of a line may have hit when it was filled, so a line
+    // is only free when all of them are
+    for (unsigned way = 0; way < sets.assoc; way++) {
+        size_t idx = (first + way) * l2tlbLineSize;
+        if (std::none_of(lines + idx, lines + idx + l2tlbLineSize,
+                         [](const TlbEntry &e) { return e.trieHandle; }))
+            return idx;
+    }
+
+    size_t victim = first;
+    if (l2TreePLRU) {
+        const uint8_t *tree = &sets.plru[first];
+        unsigned node = 1;
+        while (node < sets.assoc)
+            node = 2 * node + tree[node];
+        victim = first + node - sets.assoc;
+    } else {
+        for (unsigned way = 1; way < sets.assoc; way++) {
+            if (lines[(first + way) * l2tlbLineSize].lruSeq < lines[victim * l2tlbLineSize].lruSeq)
+                victim = first + way;
+        }
+    }
+    DPRINTF(TLB, "l2tlb level %d set %d evict way %d\n", choose, first / sets.assoc, victim - first);
+    l2TLBRemove(victim * l2tlbLineSize, choose);
+    return victim * l2tlbLineSize;
+}
+
+size_t
+TLB::l2TLBFillLine(int choose, Addr line_vpn, Addr step, uint16_t id, uint8_t translateMode)
+{
+    const L2TLBSets &sets = l2Sets[choose - 1];
+    const TlbEntry *lines = l2Tlb[choose - 1];
+    size_t first = ((line_vpn >> sets.indexShift) & sets.setMask) * sets.assoc;
+
+    // the walker inserts the entries of a line in order, but those that
+    // hit are skipped, so look for the line holding the others first
+    for (unsigned way = 0; way < sets.assoc; way++) {
+        size_t idx = (first + way) * l2tlbLineSize;
+        for (int i = 0; i < l2tlbLineSize; i++) {
+            const TlbEntry &e = lines[idx + i];
+            if (!e.trieHandle || e.vaddr != line_vpn + step * i)
+                continue;
+            if ((translateMode == gstage ? e.vmid : e.asid) == id)
+                return idx;
+        }
+    }
+    return l2TLBSetVictim(choose, line_vpn);
+}
+
+void
+TLB::l2TLBTouch(int choose, const TlbEntry *entry)
+{
+    L2TLBSets &sets = l2Sets[choose - 1];
+    if (!l2TreePLRU || !sets.assoc)
+        return;
+    size_t line = (entry - l2Tlb[choose - 1]) / l2tlbLineSize;
+    unsigned way = line % sets.assoc;
+    uint8_t *tree = &sets.plru[line - way];
+    unsigned node = 1;
+    for (unsigned bit = sets.assoc >> 1; bit; bit >>= 1) {
+        bool right = way & bit;
+        // point away from the way just used
+        tree[node] = !right;
+        node = 2 * node + right;
+    }
+}
 void
 TLB::evictLRU()
 {
@@ -218,12 +320,6 @@ TLB::l2TLBEvictLRU(int l2TLBlevel, Addr vaddr)
 {
     size_t lru;
     size_t i;
-    Addr l2_index;
-    Addr l3_index;
-    l2_index = (vaddr >> (PageShift + LEVEL_BITS + L2TLB_BLK_OFFSET)) & (L2TLB_L2_MASK);
-    l3_index = (vaddr >> (PageShift + L2TLB_BLK_OFFSET)) & (L2TLB_L3_MASK);
-    int l2_index_num = 0;
-    int l3_index_num = 0;
     DPRINTF(TLB, "l2tlb_evictLRU tlb_l2l1_size %d\n", tlbL2L1.size());
 
     if (l2TLBlevel == L_L2L1) {
@@ -236,50 +332,6 @@ TLB::l2TLBEvictLRU(int l2TLBlevel, Addr vaddr)
         l2TLBRemove(lru, L_L2L1);
     }
 
-    else if (l2TLBlevel == L_L2L2) {
-        lru = 0;
-        for (i = 0; i < l2TlbL2Size * l2tlbLineSize; i = i + l2tlbLineSize) {
-            if ((tlbL2L2[i].index == l2_index) && (tlbL2L2[i].trieHandle != nullptr)) {
-                DPRINTF(TLBVerbose, "vaddr %#x index %#x\n", tlbL2L2[i].vaddr, l2_index);
-                if (l2_index_num == 0) {
-                    lru = i;
-                } else if (tlbL2L2[i].lruSeq < tlbL2L2[lru].lruSeq) {
-                    lru = i;
-                }
-                l2_index_num++;
-            }
-        }
-        if (l2_index_num == 2) {
-            l2TLBRemove(lru, L_L2L2);
-        }
-
-        else if (l2_index_num > 2) {
-            panic("wrong in l2l2 tlb l2_index_num %d\n",l2_index_num);
-        }
-
-    }
-
-    else if (l2TLBlevel == L_L2L3) {
-        lru = 0;
-        for (i = 0; i < l2TlbL3Size * l2tlbLineSize; i = i + l2tlbLineSize) {
-            if ((tlbL2L3[i].index == l3_index) && (tlbL2L3[i].trieHandle != nullptr)) {
-                if (l3_index_num == 0) {
-                    lru = i;
-                } else if (tlbL2L3[i].lruSeq < tlbL2L3[lru].lruSeq) {
-                    lru = i;
-                }
-                l3_index_num++;
-            }
-        }
-
-        if (l3_index_num == 4){
-            l2TLBRemove(lru, L_L2L3);
-        }
-
-        else if (l3_index_num > 4)
-            panic("wrong in l2l3 tlb l3_index_num %d\n",l3_index_num);
-    }
-
     else if ((l2TLBlevel == L_L2sp1) || (l2TLBlevel == L_L2sp2)) {
         lru =0;
         for (i = l2tlbLineSize; i < l2TlbSpSize * l2tlbLineSize; i = i + l2tlbLineSize) {
@@ -443,8 +495,10 @@ TLB::lookupL2TLB(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden, int f
         TlbEntry *entry_l2l2 = trieL2L2.lookup(buildKey(f_vpnl2l2, asid, translateMode));
         entry_l2 = entry_l2l2;
         step = 0x1 << (PageShift + LEVEL_BITS);
-        if ((!hidden) && (entry_l2l2))
+        if ((!hidden) && (entry_l2l2)) {
             updateL2TLBSeq(&trieL2L2, vpnl2l2, step, asid, translateMode);
+            l2TLBTouch(L_L2L2, entry_l2l2);
+        }
     }
     if (f_level == L_L2L3) {
         DPRINTF(TLB, "look up l2tlb in l2l3\n");
@@ -476,6 +530,7 @@ TLB::lookupL2TLB(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden, int f
                     m_entry_l2l3->preSign = true;
             }
             if (!hidden) {
+                l2TLBTouch(L_L2L3, entry_l2l3);
                 if (mode == BaseMMU::Write) {
                     stats.writeL2Tlbl3Hits++;
                 } else {
@@ -706,17 +761,22 @@ TLB::L2TLBInsertIn(Addr vpn, const TlbEntry &entry, int choose, EntryList *List,
         return newEntry;
     }
     DPRINTF(TLB, "not hit in l2 tlb\n");
-    if ((choose == L_L2L2 || choose == L_L2L3) && (sign == 0)) {
+    L2TLBSets &sets = l2Sets[choose - 1];
+    if (sets.assoc) {
         DPRINTF(TLB, "choose %d sign %d\n", choose, sign);
-        l2TLBEvictLRU(choose, vpn);
+        newEntry = l2Tlb[choose - 1] +
+                   l2TLBFillLine(choose, vpn - step * sign, step,
+                                 translateMode == gstage ? entry.vmid : entry.asid, translateMode) +
+                   sign;
+        assert(!newEntry->trieHandle);
+        l2TLBTouch(choose, newEntry);
     } else {
         if ((*List).empty())
             l2TLBEvictLRU(choose, vpn);
+        newEntry = (*List).front();
+        (*List).pop_front();
     }
 
-    newEntry = (*List).front();
-    (*List).pop_front();
-
 
     key = buildKey(vpn, entry.asid, translateMode);
     if (translateMode == gstage)
@@ -1017,10 +1077,13 @@ TLB::l2TLBRemove(size_t idx, int choose)
                 (l2Tlb[choose - 1] + idx + i)->vaddr, (l2Tlb[choose - 1] + idx + i)->asid,
                 (l2Tlb[choose - 1] + idx + i)->paddr, (l2Tlb[choose - 1] + idx + i)->pte,
                 (l2Tlb[choose - 1] + idx + i)->size());
+        if (l2Sets[choose - 1].assoc && !(l2Tlb[choose - 1] + idx + i)->trieHandle)
+            continue;
         assert((l2Tlb[choose - 1] + idx + i)->trieHandle);
         (*l2Trie[choose - 1]).remove((l2Tlb[choose - 1] + idx + i)->trieHandle);
         (l2Tlb[choose - 1] + idx + i)->trieHandle = nullptr;
-        (*l2Freelist[choose - 1]).push_back((l2Tlb[choose - 1] + idx + i));
+        if (!l2Sets[choose - 1].assoc)
+            (*l2Freelist[choose - 1]).push_back((l2Tlb[choose - 1] + idx + i));
     }
 
 }
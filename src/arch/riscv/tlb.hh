@@ -291,6 +291,25 @@ class TLB : public BaseTLB
     std::vector<TlbEntryTrie *> l2Trie;
     std::vector<EntryList *> l2Freelist;
 
+    /**
+     * L2L2 and L2L3 are set associative: the way-th line of a set is
+     * line set * assoc + way of the level, and a fill only ever looks at
+     * the assoc lines of its set. The other levels are small and stay
+     * fully associative, allocating from their free list.
+     */
+    struct L2TLBSets
+    {
+        // 0 for a fully associative level
+        unsigned assoc = 0;
+        Addr setMask = 0;
+        unsigned indexShift = 0;
+        // tree-PLRU nodes 1..assoc-1 of each set, at set * assoc
+        std::vector<uint8_t> plru;
+    };
+    // indexed by choose - 1, like l2Tlb
+    std::vector<L2TLBSets> l2Sets;
+    bool l2TreePLRU;
+
   private:
     uint64_t nextSeq() { return ++lruSeq; }
     void updateL2TLBSeq(TlbEntryTrie *Trie_l2,Addr vpn,Addr step, uint16_t asid,uint8_t translateMode);
@@ -301,6 +320,15 @@ class TLB : public BaseTLB
     void evictBackPre();
 
     void l2TLBEvictLRU(int l2TLBlevel, Addr vaddr);
+    void configL2TlbSets(int choose, size_t lines, unsigned assoc, unsigned index_shift);
+    size_t l2TLBSetVictim(int choose, Addr vpn);
+    /**
+     * Entry index of the line an insert goes to: the one already holding
+     * other entries of the line starting at line_vpn, or a victim.
+     */
+    size_t l2TLBFillLine(int choose, Addr line_vpn, Addr step, uint16_t id,
+                         uint8_t translateMode);
+    void l2TLBTouch(int choose, const TlbEntry *entry);
 
     void remove(size_t idx);
     void removeForwardPre(size_t idx);
@@ -49,6 +49,7 @@
 #include <sstream>
 #include <string>
 
+#include "arch/riscv/host_fp.hh"
 #include "arch/riscv/regs/float.hh"
 #include "arch/riscv/regs/int.hh"
 #include "arch/riscv/regs/vector.hh"
@@ -358,9 +359,9 @@ template<typename FloatType> FloatType
 fadd(FloatType a, FloatType b)
 {
     if constexpr(std::is_same_v<float32_t, FloatType>)
-        return f32_add(a, b);
+        return fastF32Add(a, b);
     else if constexpr(std::is_same_v<float64_t, FloatType>)
-        return f64_add(a, b);
+        return fastF64Add(a, b);
     GEM5_UNREACHABLE;
 }
 
@@ -368,9 +369,9 @@ template<typename FloatType> FloatType
 fsub(FloatType a, FloatType b)
 {
     if constexpr(std::is_same_v<float32_t, FloatType>)
-        return f32_sub(a, b);
+        return fastF32Sub(a, b);
     else if constexpr(std::is_same_v<float64_t, FloatType>)
-        return f64_sub(a, b);
+        return fastF64Sub(a, b);
     GEM5_UNREACHABLE;
 }
 
@@ -398,9 +399,9 @@ template<typename FloatType> FloatType
 fdiv(FloatType a, FloatType b)
 {
     if constexpr(std::is_same_v<float32_t, FloatType>)
-        return f32_div(a, b);
+        return fastF32Div(a, b);
     else if constexpr(std::is_same_v<float64_t, FloatType>)
-        return f64_div(a, b);
+        return fastF64Div(a, b);
     GEM5_UNREACHABLE;
 }
 
@@ -408,9 +409,9 @@ template<typename FloatType> FloatType
 fmul(FloatType a, FloatType b)
 {
     if constexpr(std::is_same_v<float32_t, FloatType>)
-        return f32_mul(a, b);
+        return fastF32Mul(a, b);
     else if constexpr(std::is_same_v<float64_t, FloatType>)
-        return f64_mul(a, b);
+        return fastF64Mul(a, b);
     GEM5_UNREACHABLE;
 }
 
@@ -418,9 +419,9 @@ template<typename FloatType> FloatType
 fsqrt(FloatType a)
 {
     if constexpr(std::is_same_v<float32_t, FloatType>)
-        return f32_sqrt(a);
+        return fastF32Sqrt(a);
     else if constexpr(std::is_same_v<float64_t, FloatType>)
-        return f64_sqrt(a);
+        return fastF64Sqrt(a);
     GEM5_UNREACHABLE;
 }
 
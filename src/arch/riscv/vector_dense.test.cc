@@ -0,0 +1,400 @@
+#include <gtest/gtest.h>
+
+#include <softfloat.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
+
+#include "arch/riscv/host_fp.hh"
+#include "arch/riscv/types.hh"
+
+using namespace gem5;
+using namespace gem5::RiscvISA;
+
+/*
+ * The vector arithmetic formats run a micro-op that is unmasked and
+ * wholly below vl in a dense loop without per-element checks, and every
+ * other one in the checked loop. These tests run the element code of a
+ * few instructions, as written in decoder.isa, in copies of both loop
+ * shapes the formats generate, and check that they leave the registers
+ * and the softfloat flags bit-identical. They don't run the generated
+ * micro-ops; those assert that their dense loop has the length of the
+ * checked one.
+ */
+
+namespace
+{
+
+/*
+ * What fadd<et>() and the others of arch/riscv/utility.hh dispatch to,
+ * that header can't be used without the rest of the CPU.
+ */
+float32_t fadd(float32_t a, float32_t b) { return fastF32Add(a, b); }
+float64_t fadd(float64_t a, float64_t b) { return fastF64Add(a, b); }
+float32_t fmul(float32_t a, float32_t b) { return fastF32Mul(a, b); }
+float64_t fmul(float64_t a, float64_t b) { return fastF64Mul(a, b); }
+float32_t fdiv(float32_t a, float32_t b) { return fastF32Div(a, b); }
+float64_t fdiv(float64_t a, float64_t b) { return fastF64Div(a, b); }
+float32_t fsqrt(float32_t a) { return fastF32Sqrt(a); }
+float64_t fsqrt(float64_t a) { return fastF64Sqrt(a); }
+bool feq(float32_t a, float32_t b) { return f32_eq(a, b); }
+bool feq(float64_t a, float64_t b) { return f64_eq(a, b); }
+
+template <typename et>
+et
+ftype(decltype(et::v) bits)
+{
+    return et{bits};
+}
+
+bool
+elem_mask(const uint8_t *vs, int index)
+{
+    return (vs[index / 8] >> (index % 8)) & 1;
+}
+
+/** The registers of a micro-op */
+struct Regs
+{
+    alignas(64) uint8_t vd[VLENB];
+    alignas(64) uint8_t vs2[VLENB];
+    alignas(64) uint8_t vs1[VLENB];
+    alignas(64) uint8_t v0[VLENB];
+};
+
+/** The checked loop, as loopWrapper(maskCondWrapper(code)) */
+template <typename vu, typename Elem>
+void
+checkedLoop(const Regs &regs, uint32_t vl, uint32_t micro_idx, bool vm,
+            const Elem &elem)
+{
+    const uint32_t elem_num_per_vreg = VLEN / (sizeof(vu) * 8);
+    for (uint32_t i = 0; i < elem_num_per_vreg; i++) {
+        uint32_t ei = i + elem_num_per_vreg * micro_idx;
+        if ((ei < vl) && (vm || elem_mask(regs.v0, ei))) {
+            elem(i);
+        }
+    }
+}
+
+/** The loops as denseLoopWrapper() picks them */
+template <typename vu, typename Elem>
+void
+denseLoop(const Regs &regs, uint32_t vl, uint32_t micro_idx, bool vm,
+          const Elem &elem)
+{
+    const uint32_t elem_num_per_vreg = VLEN / (sizeof(vu) * 8);
+    if (vm && vl >= elem_num_per_vreg * (micro_idx + 1)) {
+        for (uint32_t i = 0; i < VLENB / sizeof(vu); i++) {
+            elem(i);
+        }
+    } else {
+        checkedLoop<vu>(regs, vl, micro_idx, vm, elem);
+    }
+}
+
+/** Operands biased towards the cases the host FP path hands over */
+template <typename vu>
+vu
+randomElem(std::mt19937_64 &rng, bool is_fp)
+{
+    if constexpr (sizeof(vu) < 4) {
+        return rng();
+    } else {
+        if (!is_fp || rng() % 2) {
+            return rng();
+        }
+        constexpr int frac_bits = sizeof(vu) == 4 ? 23 : 52;
+        constexpr vu max_exp = sizeof(vu) == 4 ? 0xff : 0x7ff;
+        const vu sign = vu(rng() & 1) << (sizeof(vu) * 8 - 1);
+        const vu frac = vu(rng()) & ((vu(1) << frac_bits) - 1);
+        const vu exps[] = {0, 1, max_exp / 2, max_exp - 1, max_exp};
+        return sign | (exps[rng() % 5] << frac_bits) |
+            (rng() % 2 ? frac : frac & ~vu(0xffff));
+    }
+}
+
+template <typename vu>
+void
+randomRegs(Regs &regs, std::mt19937_64 &rng, bool is_fp)
+{
+    for (auto *reg : {regs.vd, regs.vs2, regs.vs1}) {
+        for (uint32_t i = 0; i < VLENB / sizeof(vu); i++) {
+            const vu elem = randomElem<vu>(rng, is_fp);
+            std::memcpy(reg + i * sizeof(vu), &elem, sizeof(vu));
+        }
+    }
+    // vs1 often repeats vs2, for the compares
+    if (rng() % 2) {
+        std::memcpy(regs.vs1, regs.vs2, VLENB / 2);
+    }
+    for (auto &byte : regs.v0) {
+        byte = rng();
+    }
+}
+
+/**
+ * The element code of some instructions. Each one is a function of
+ * the registers, the micro-op index and the sew, which gives the
+ * element code run at index i.
+ */
+struct VaddVv
+{
+    static constexpr bool isFp = false;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        return [=](uint32_t i) { Vd_vu[i] = Vs2_vu[i] + Vs1_vu[i]; };
+    }
+};
+
+struct VmaxVv
+{
+    static constexpr bool isFp = false;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        using vi = std::make_signed_t<vu>;
+        auto Vd_vi = reinterpret_cast<vi *>(regs.vd);
+        auto Vs2_vi = reinterpret_cast<const vi *>(regs.vs2);
+        auto Vs1_vi = reinterpret_cast<const vi *>(regs.vs1);
+        return [=](uint32_t i) {
+            Vd_vi[i] = Vs2_vi[i] > Vs1_vi[i] ?
+                    Vs2_vi[i] : Vs1_vi[i];
+        };
+    }
+};
+
+struct VsllVv
+{
+    static constexpr bool isFp = false;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t sew)
+    {
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        return [=](uint32_t i) {
+            Vd_vu[i] = Vs2_vu[i] << (Vs1_vu[i] & (sew - 1));
+        };
+    }
+};
+
+#define ASSIGN_VD_BIT(idx, bit) \
+    ((Vd[(idx)/8] & ~(1 << (idx)%8)) | ((bit) << (idx)%8))
+
+struct VmseqVv
+{
+    static constexpr bool isFp = false;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t micro_idx, uint32_t sew)
+    {
+        auto Vd = regs.vd;
+        auto Vd_ub = regs.vd;
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        const uint16_t offset = VLEN / sew * micro_idx;
+        return [=](uint32_t i) {
+            Vd_ub[(i + offset)/8] = ASSIGN_VD_BIT(i + offset,
+                (Vs2_vu[i] == Vs1_vu[i]));
+        };
+    }
+};
+
+template <typename vu>
+using FloatOf = std::conditional_t<sizeof(vu) == 4, float32_t, float64_t>;
+
+struct VfaddVv
+{
+    static constexpr bool isFp = true;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        using et = FloatOf<vu>;
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        return [=](uint32_t i) {
+            auto fd = fadd(ftype<et>(Vs2_vu[i]),
+                           ftype<et>(Vs1_vu[i]));
+            Vd_vu[i] = fd.v;
+        };
+    }
+};
+
+struct VfmulVv
+{
+    static constexpr bool isFp = true;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        using et = FloatOf<vu>;
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        return [=](uint32_t i) {
+            auto fd = fmul(ftype<et>(Vs2_vu[i]),
+                           ftype<et>(Vs1_vu[i]));
+            Vd_vu[i] = fd.v;
+        };
+    }
+};
+
+struct VfdivVv
+{
+    static constexpr bool isFp = true;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        using et = FloatOf<vu>;
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        return [=](uint32_t i) {
+            auto fd = fdiv(ftype<et>(Vs2_vu[i]),
+                           ftype<et>(Vs1_vu[i]));
+            Vd_vu[i] = fd.v;
+        };
+    }
+};
+
+struct VfsqrtV
+{
+    static constexpr bool isFp = true;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t, uint32_t)
+    {
+        using et = FloatOf<vu>;
+        auto Vd_vu = reinterpret_cast<vu *>(regs.vd);
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        return [=](uint32_t i) {
+            auto fd = fsqrt(ftype<et>(Vs2_vu[i]));
+            Vd_vu[i] = fd.v;
+        };
+    }
+};
+
+struct VmfeqVv
+{
+    static constexpr bool isFp = true;
+
+    template <typename vu>
+    static auto
+    code(Regs &regs, uint32_t micro_idx, uint32_t sew)
+    {
+        using et = FloatOf<vu>;
+        auto Vd = regs.vd;
+        auto Vd_ub = regs.vd;
+        auto Vs2_vu = reinterpret_cast<const vu *>(regs.vs2);
+        auto Vs1_vu = reinterpret_cast<const vu *>(regs.vs1);
+        const uint16_t offset = VLEN / sew * micro_idx;
+        return [=](uint32_t i) {
+            Vd_ub[(i + offset)/8] = ASSIGN_VD_BIT(i + offset,
+                feq(ftype<et>(Vs2_vu[i]), ftype<et>(Vs1_vu[i])));
+        };
+    }
+};
+
+/**
+ * Run random micro-ops in both loop shapes, most of them unmasked and
+ * below vl so that the dense loop runs, and compare the results.
+ */
+template <typename Op, typename vu>
+void
+compare(const char *name)
+{
+    std::mt19937_64 rng(0xde75e);
+    const uint32_t sew = sizeof(vu) * 8;
+    const uint32_t elem_num_per_vreg = VLEN / sew;
+    Regs checked;
+    Regs dense;
+
+    for (int step = 0; step < 20000; step++) {
+        randomRegs<vu>(checked, rng, Op::isFp);
+        dense = checked;
+        const uint32_t micro_idx = rng() % 8;
+        const bool vm = rng() % 4;
+        // mostly vl covering the micro-op, sometimes ending within it
+        uint32_t vl = elem_num_per_vreg * (micro_idx + 1 + rng() % 2);
+        if (rng() % 4 == 0) {
+            vl -= rng() % elem_num_per_vreg;
+        }
+        softfloat_roundingMode = rng() % 8 ? softfloat_round_near_even
+                                           : rng() % 5;
+
+        softfloat_exceptionFlags = 0;
+        checkedLoop<vu>(checked, vl, micro_idx, vm,
+            Op::template code<vu>(checked, micro_idx, sew));
+        const uint_fast8_t checked_flags = softfloat_exceptionFlags;
+
+        softfloat_exceptionFlags = 0;
+        denseLoop<vu>(dense, vl, micro_idx, vm,
+            Op::template code<vu>(dense, micro_idx, sew));
+        const uint_fast8_t dense_flags = softfloat_exceptionFlags;
+
+        ASSERT_EQ(std::memcmp(checked.vd, dense.vd, VLENB), 0)
+            << name << " sew " << sew << " step " << step;
+        ASSERT_EQ(checked_flags, dense_flags)
+            << name << " sew " << sew << " step " << step;
+    }
+    softfloat_roundingMode = softfloat_round_near_even;
+    softfloat_exceptionFlags = 0;
+}
+
+template <typename Op>
+void
+compareInt(const char *name)
+{
+    compare<Op, uint8_t>(name);
+    compare<Op, uint16_t>(name);
+    compare<Op, uint32_t>(name);
+    compare<Op, uint64_t>(name);
+}
+
+template <typename Op>
+void
+compareFp(const char *name)
+{
+    compare<Op, uint32_t>(name);
+    compare<Op, uint64_t>(name);
+}
+
+} // anonymous namespace
+
+TEST(VectorDenseLoopTest, IntegerBitIdentical)
+{
+    compareInt<VaddVv>("vadd.vv");
+    compareInt<VmaxVv>("vmax.vv");
+    compareInt<VsllVv>("vsll.vv");
+    compareInt<VmseqVv>("vmseq.vv");
+}
+
+TEST(VectorDenseLoopTest, FloatBitIdentical)
+{
+    compareFp<VfaddVv>("vfadd.vv");
+    compareFp<VfmulVv>("vfmul.vv");
+    compareFp<VfdivVv>("vfdiv.vv");
+    compareFp<VfsqrtV>("vfsqrt.v");
+    compareFp<VmfeqVv>("vmfeq.vv");
+}
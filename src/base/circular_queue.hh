@@ -73,7 +73,7 @@ class CircularQueue
 
     using reference = typename std::vector<T>::reference;
     using const_reference = typename std::vector<T>::const_reference;
-    const size_t _capacity;
+    size_t _capacity;
     size_t _size = 0;
     size_t _head = 1;
 
@@ -426,6 +426,26 @@ class CircularQueue
         _size = 0;
     }
 
+    /**
+     * Grow the backing store to hold at least the given number of
+     * elements. The queued elements keep their indices, so iterators to
+     * them stay valid.
+     *
+     * @ingroup api_base_utils
+     */
+    void
+    reserve(size_t capacity)
+    {
+        if (capacity <= _capacity)
+            return;
+
+        std::vector<T> grown(capacity);
+        for (size_t idx = _head; idx < _head + _size; idx++)
+            grown[idx % capacity] = std::move(data[idx % _capacity]);
+        data = std::move(grown);
+        _capacity = capacity;
+    }
+
     /**
      * Test if the index is in the range of valid elements.
      */
@@ -484,13 +504,15 @@ class CircularQueue
     /**
      * Circularly decrease the tail pointer.
      *
+     * @params num_elem number of elements to remove
+     *
      * @ingroup api_base_utils
      */
     void
-    pop_back()
+    pop_back(size_t num_elem=1)
     {
-        assert(!empty());
-        --_size;
+        assert(num_elem <= size());
+        _size -= num_elem;
     }
 
     /**
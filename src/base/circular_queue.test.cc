@@ -265,3 +265,40 @@ TEST(CircularQueueTest, MultipleRound)
 
     ASSERT_EQ(ending_it - starting_it, cq_size);
 }
+
+/**
+ * Testing that growing the queue keeps the elements and their indices:
+ * - Iterators taken before growing still point to the same elements
+ * - The grown queue only wraps around at the new capacity
+ */
+TEST(CircularQueueTest, Reserve)
+{
+    const auto cq_size = 4;
+    CircularQueue<uint32_t> cq(cq_size);
+
+    // Wrap around once so that the elements straddle the backing store
+    for (auto idx = 0; idx < cq_size + 2; idx++) {
+        cq.push_back(idx);
+    }
+    auto it = cq.begin() + 1;
+    ASSERT_EQ(*it, 3);
+
+    cq.reserve(cq_size * 2);
+    ASSERT_EQ(cq.capacity(), cq_size * 2);
+    ASSERT_EQ(cq.size(), cq_size);
+    ASSERT_EQ(*it, 3);
+    ASSERT_EQ(cq.front(), 2);
+    ASSERT_EQ(cq.back(), 5);
+
+    for (auto idx = cq_size + 2; idx < cq_size * 2 + 2; idx++) {
+        cq.push_back(idx);
+    }
+    ASSERT_TRUE(cq.full());
+    ASSERT_EQ(*it, 3);
+    ASSERT_EQ(cq.front(), 2);
+    ASSERT_EQ(cq.back(), cq_size * 2 + 1);
+
+    // Shrinking is not supported
+    cq.reserve(cq_size);
+    ASSERT_EQ(cq.capacity(), cq_size * 2);
+}
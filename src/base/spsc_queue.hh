@@ -0,0 +1,111 @@
+#ifndef __BASE_SPSC_QUEUE_HH__
+#define __BASE_SPSC_QUEUE_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+/**
+ * A bounded, lock-free queue connecting exactly one producer thread to
+ * exactly one consumer thread, e.g. the simulation thread handing work
+ * to a host helper thread.
+ *
+ * The capacity is rounded up to a power of two. Each side caches the
+ * index owned by the other side, so in the common case a push or a pop
+ * only touches its own cache line.
+ *
+ * @tparam T Element type, must be default constructible and movable.
+ */
+template <typename T>
+class SPSCQueue
+{
+  private:
+    static constexpr size_t CacheLine = 64;
+
+    std::vector<T> buffer;
+    const size_t mask;
+
+    /** Next slot to pop, written by the consumer only. */
+    alignas(CacheLine) std::atomic<size_t> head{0};
+    /** Producer's last view of head. */
+    size_t cachedHead = 0;
+
+    /** Next slot to push, written by the producer only. */
+    alignas(CacheLine) std::atomic<size_t> tail{0};
+    /** Consumer's last view of tail. */
+    size_t cachedTail = 0;
+
+  public:
+    explicit SPSCQueue(size_t capacity)
+        : buffer(size_t(1) << ceilLog2(capacity < 2 ? size_t(2) : capacity)),
+          mask(buffer.size() - 1)
+    {}
+
+    SPSCQueue(const SPSCQueue &) = delete;
+    SPSCQueue &operator=(const SPSCQueue &) = delete;
+
+    size_t capacity() const { return buffer.size(); }
+
+    /**
+     * Push an element, producer side only.
+     *
+     * @return false if the queue is full, in which case the element is
+     *         left untouched
+     */
+    template <typename U>
+    bool
+    tryPush(U &&value)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == buffer.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == buffer.size())
+                return false;
+        }
+        buffer[t & mask] = std::forward<U>(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pop the oldest element, consumer side only.
+     *
+     * @return false if the queue is empty
+     */
+    bool
+    tryPop(T &value)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail)
+                return false;
+        }
+        value = std::move(buffer[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Approximate number of queued elements. Exact when called from
+     * either side while the other one is idle.
+     */
+    size_t
+    size() const
+    {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+};
+
+} // namespace gem5
+
+#endif // __BASE_SPSC_QUEUE_HH__
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+
+#include "base/spsc_queue.hh"
+
+using namespace gem5;
+
+/** The capacity is rounded up to the next power of two. */
+TEST(SPSCQueueTest, Capacity)
+{
+    SPSCQueue<int> q(5);
+    ASSERT_EQ(q.capacity(), 8);
+    ASSERT_TRUE(q.empty());
+}
+
+/** Elements come out in order, and a full queue rejects pushes. */
+TEST(SPSCQueueTest, FullAndEmpty)
+{
+    SPSCQueue<int> q(4);
+    for (int i = 0; i < 4; i++)
+        ASSERT_TRUE(q.tryPush(i));
+    ASSERT_FALSE(q.tryPush(4));
+    ASSERT_EQ(q.size(), 4);
+
+    int v;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(q.tryPop(v));
+        ASSERT_EQ(v, i);
+    }
+    ASSERT_FALSE(q.tryPop(v));
+    ASSERT_TRUE(q.empty());
+}
+
+/** Indices keep working after wrapping around the buffer many times. */
+TEST(SPSCQueueTest, WrapAround)
+{
+    SPSCQueue<std::string> q(4);
+    std::string v;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(q.tryPush(std::to_string(i)));
+        ASSERT_TRUE(q.tryPush(std::to_string(i + 1000)));
+        ASSERT_TRUE(q.tryPop(v));
+        ASSERT_EQ(v, std::to_string(i));
+        ASSERT_TRUE(q.tryPop(v));
+        ASSERT_EQ(v, std::to_string(i + 1000));
+    }
+}
+
+/** A consumer thread sees every element exactly once and in order. */
+TEST(SPSCQueueTest, TwoThreads)
+{
+    const uint64_t count = 100000;
+    SPSCQueue<uint64_t> q(64);
+
+    std::thread consumer([&]() {
+        uint64_t expected = 0;
+        uint64_t v;
+        while (expected < count) {
+            if (q.tryPop(v)) {
+                ASSERT_EQ(v, expected);
+                expected++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    for (uint64_t i = 0; i < count; i++) {
+        while (!q.tryPush(i))
+            std::this_thread::yield();
+    }
+    consumer.join();
+    ASSERT_TRUE(q.empty());
+}
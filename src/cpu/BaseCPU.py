@@ -162,6 +162,12 @@ class BaseCPU(ClockedObject):
     enable_riscv_h = Param.Bool(True, "Enable riscv vector extension")
     enable_difftest_inst_trace = Param.Bool(True, "Enable difftest inst trace")
     enable_mem_dedup = Param.Bool(False, "Enable memory deduplication for difftest and golden memory")
+    difftest_batch_size = Param.Unsigned(1, "Instructions stepped on the "
+        "difftest ref at once, 1 compares after every instruction")
+    difftest_async = Param.Bool(False, "Step the difftest ref over batches "
+        "on a separate host thread")
+    difftest_async_csr_interval = Param.Unsigned(16, "With difftest_async, "
+        "wait for the ref and compare CSRs after every this many batches")
 
     def createInterruptController(self):
         self.interrupts = [
@@ -43,6 +43,8 @@
 
 #include "cpu/base.hh"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -164,6 +166,9 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       enableRVV(p.enable_riscv_vector),
       enableRVHDIFF(p.enable_riscv_h),
       enabledifftesInstTrace(p.enable_difftest_inst_trace),
+      diffBatchSize(std::max(1u, p.difftest_batch_size)),
+      diffAsync(p.difftest_async),
+      diffAsyncCsrInterval(std::max(1u, p.difftest_async_csr_interval)),
       noHypeMode(false),
       enableMemDedup(p.enable_mem_dedup)
 {
@@ -236,6 +241,14 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
                                params().nemuSDCptBin.c_str());
         }
         diffAllStates->diff.will_handle_intr = false;
+        diffAllStates->batch.records.reserve(diffBatchSize);
+        fatal_if(diffAsync && diffBatchSize < 2, "Asynchronous difftest needs difftest_batch_size > 1\n");
+        if (diffAsync && system->multiCore()) {
+            // the refs share the golden memory with the simulation thread
+            warn("Asynchronous difftest is not supported with multiple cores, checking batches in line\n");
+        } else if (diffAsync) {
+            diffAllStates->worker = std::make_unique<DiffWorker>(*diffAllStates, 64);
+        }
     } else {
         warn("Difftest is disabled\n");
         diffAllStates->hasCommit = true;
@@ -402,7 +415,8 @@ BaseCPU::startup()
         goldenMemPtr = system->getGoldenMemPtr();
         _goldenMemManager = system->getGoldenMemManager();
 
-        diffAllStates->proxy->initState(params().cpu_id, goldenMemPtr);
+        if (enableDifftest)
+            diffAllStates->proxy->initState(params().cpu_id, goldenMemPtr);
     } else {
         goldenMemPtr = nullptr;
         _goldenMemManager = nullptr;
@@ -694,6 +708,7 @@ BaseCPU::takeOverFrom(BaseCPU *oldCPU)
     auto [enable_diff, diff_all] = oldCPU->getDiffAllStates();
     if (enable_diff) {
         warn("Take over difftest state to new CPU\n");
+        oldCPU->flushDiffBatch(0, false);
         enableDifftest = enable_diff;
         takeOverDiffAllStates(diff_all);
     }
@@ -1039,6 +1054,127 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
         }
     }
 
+    diffCSRs(tid, seq, diff_at);
+
+    if (diff_at != NoneDiff) {
+        DPRINTF(Diff, "Inst [sn:%llu] @ \033[31m%#lx\033[0m in GEM5 is "
+                "\033[31m%s\033[0m\n", seq, diffInfo.pc->instAddr(),
+                diffInfo.inst->disassemble(diffInfo.pc->instAddr()));
+        if (diffInfo.inst->isLoad()) {
+            DPRINTF(Diff, "Load addr: %#lx\n", diffInfo.physEffAddr);
+        }
+    }
+
+    for (int dest_idx = 0; dest_idx < diffInfo.inst->numDestRegs(); dest_idx++) {
+
+        const auto &dest = diffInfo.inst->destRegIdx(dest_idx);
+        auto dest_tag = dest.index() + dest.isFloatReg() * 32;
+
+        if ((dest.isFloatReg() || dest.isIntReg()) && !dest.isZeroReg()) {
+            auto gem5_val = diffInfo.scalarResults[dest_idx];
+            auto nemu_val = diffAllStates->referenceRegFile[dest_tag];
+            DPRINTF(Diff, "At %s Ref value: %#lx, GEM5 value: %#lx\n",
+                    reg_name[dest_tag], nemu_val, gem5_val);
+
+            if (diffInfo.inst->isMemRef()) {
+                diffMsg += csprintf("%s addr: %#lx, size: %u\n",
+                        diffInfo.inst->isAtomic() ? "AMO"
+                        : diffInfo.inst->isLoad() ? "Load"
+                                                  : "Store",
+                        diffInfo.physEffAddr, diffInfo.effSize);
+            }
+
+            if (gem5_val != nemu_val) {
+                if (system->multiCore() && (diffInfo.inst->isLoad() || diffInfo.inst->isAtomic()) &&
+                    _goldenMemManager->inPmem(diffInfo.physEffAddr)) {
+                    DPRINTF(Diff, "Difference on %s instr found in multicore mode, check in golden memory\n",
+                         diffInfo.inst->isLoad() ? "load" : "amo");
+                    uint8_t *golden_ptr = diffInfo.goldenValue;
+
+                    // a lambda function to sync memory and register from golden results to ref
+                    auto sync_mem_reg = [&]() {
+                        diffAllStates->proxy->memcpy(diffInfo.physEffAddr, golden_ptr, diffInfo.effSize,
+                                                     DIFFTEST_TO_REF);
+                        diffAllStates->referenceRegFile[dest_tag] = gem5_val;
+                        diffAllStates->proxy->regcpy(&(diffAllStates->referenceRegFile), DUT_TO_REF);
+                    };
+
+                    if (diffInfo.inst->isLoad() && memcmp(golden_ptr, &gem5_val, diffInfo.effSize) == 0) {
+                        DPRINTF(Diff, "Load content matched in golden memory. Sync from golden to ref\n");
+                        sync_mem_reg();
+                        continue;
+                    } else if (diffInfo.inst->isAtomic()) {
+                        DPRINTF(Diff, "Golden mem old value: %#lx, GEM5 old value: %#lx\n",
+                                diffInfo.amoOldGoldenValue, gem5_val);
+                        DPRINTF(Diff, "New golden value: %#lx\n", *(uint64_t *)golden_ptr);
+                        if (memcmp(&diffInfo.amoOldGoldenValue, &gem5_val, diffInfo.effSize) == 0) {
+                            DPRINTF(Diff,
+                                "Atomic encountered, old value matched. Sync from golden to ref\n");
+                            sync_mem_reg();
+                            continue;
+                        } else {
+                            warn("Atomic old value not matched!\n");
+                        }
+                    }
+                }
+
+                if (dest.isFloatReg() &&
+                    (gem5_val ^ nemu_val) == ((0xffffffffULL) << 32)) {
+                    DPRINTF(Diff,
+                            "Difference might be caused by box,"
+                            " ignore it\n");
+                } else {
+                    for (int i = 0; i < diffInfo.inst->numSrcRegs(); i++) {
+                        const auto &src = diffInfo.inst->srcRegIdx(i);
+                        DPRINTF(Diff, "Src%d %s = %lx\n", i,
+                                reg_name[src.index()],
+                                diffInfo.getSrcReg(src));
+                        // threadContexts[curThread]->getReg(src));
+                    }
+                    bool skipCSR = false;
+                    for (auto iter : skipCSRs) {
+                        if ((machInst & 0xfff00073) == iter) {
+                            skipCSR = true;
+                            DPRINTF(Diff, "This is an csr instruction, skip!\n");
+                            diffAllStates->referenceRegFile[dest_tag] = gem5_val;
+                            diffAllStates->proxy->regcpy(&(diffAllStates->referenceRegFile), DUT_TO_REF);
+                            break;
+                        }
+                    }
+                    DPRINTF(Diff, "Inst src count: %u, dest count: %u\n",
+                            diffInfo.inst->numSrcRegs(),
+                            diffInfo.inst->numDestRegs());
+                    diffMsg += csprintf("Inst [sn:%lli] pc: %#lx\n", seq, diffInfo.pc->instAddr());
+                    diffMsg +=
+                        csprintf("Diff at \033[31m%s\033[0m Ref value: \033[31m%#lx\033[0m, "
+                                "GEM5 value: \033[31m%#lx\033[0m\n",
+                                reg_name[dest_tag], nemu_val, gem5_val);
+                    diffInfo.errorRegsValue[dest_tag] = 1;
+                    if (dest_tag<32)
+                        diffAllStates->gem5RegFile.gpr[dest_tag]._64 = gem5_val;
+                    else if (dest_tag>=32 && dest_tag<64)
+                        diffAllStates->gem5RegFile.fpr[dest_tag-32]._64 = gem5_val;
+
+                    diffAllStates->gem5RegFile.pc = gem5_pc;
+                    if (!diff_at && !skipCSR) {
+                        diff_at = ValueDiff;
+                    }
+
+                }
+            }
+        }
+    }
+    if (diff_at && (enabledifftesInstTrace)) {
+        diffMsg += csprintf("In CPU%d: NEMU PC: %#10lx, GEM5 PC: %#10lx, inst: %s\n", cpuId(),
+        nemu_pc, gem5_pc,
+        diffInfo.inst->disassemble(diffInfo.pc->instAddr()).c_str());
+    }
+    return std::make_pair(diff_at, npc_match);
+}
+
+void
+BaseCPU::diffCSRs(ThreadID tid, InstSeqNum seq, int &diff_at)
+{
     // always check some CSR regs
     {
         // mstatus
@@ -1294,124 +1430,116 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
             csrDiffMessage(gem5_val, ref_val, CsrRegIndex::v, diffAllStates->gem5RegFile.v, seq, "v", diff_at);
         }
     }
+}
 
+bool
+BaseCPU::diffNeedsSync() const
+{
+    const auto &inst = diffInfo.inst;
+    auto mach_inst = static_cast<RiscvISA::RiscvStaticInst &>(*inst).machInst;
+    // CSR accesses, ecall, xret, wfi and sfence.vma
+    bool is_system = (mach_inst & 0x7f) == 0x73;
+
+    return diffInfo.curInstStrictOrdered || diffAllStates->diff.will_handle_intr || is_system ||
+           inst->isNonSpeculative() || inst->isSerializing() || inst->isVector() || inst->isMicroop() ||
+           inst->isAtomic() || inst->isLoadReserved() || inst->isStoreConditional() ||
+           // loads may have to be fixed up from the golden memory
+           (system->multiCore() && inst->isLoad()) || inst->numDestRegs() > MaxDestRegisters;
+}
 
-
-        if (diff_at != NoneDiff) {
-            DPRINTF(Diff, "Inst [sn:%llu] @ \033[31m%#lx\033[0m in GEM5 is \033[31m%s\033[0m\n", seq,
-                    diffInfo.pc->instAddr(),
-                    diffInfo.inst->disassemble(diffInfo.pc->instAddr()));
-            if (diffInfo.inst->isLoad()) {
-                DPRINTF(Diff, "Load addr: %#lx\n", diffInfo.physEffAddr);
-            }
-        }
-
-
+void
+BaseCPU::bufferDiffCommit(InstSeqNum seq)
+{
+    DiffCommitRecord rec;
+    rec.seq = seq;
+    rec.tick = curTick();
+    rec.pc = diffInfo.pc->instAddr();
+    rec.npc = diffInfo.pc->as<RiscvISA::PCState>().npc();
+    rec.numDests = 0;
     for (int dest_idx = 0; dest_idx < diffInfo.inst->numDestRegs(); dest_idx++) {
-
         const auto &dest = diffInfo.inst->destRegIdx(dest_idx);
-        auto dest_tag = dest.index() + dest.isFloatReg() * 32;
-
         if ((dest.isFloatReg() || dest.isIntReg()) && !dest.isZeroReg()) {
-            auto gem5_val = diffInfo.scalarResults[dest_idx];
-            auto nemu_val = diffAllStates->referenceRegFile[dest_tag];
-            DPRINTF(Diff, "At %s Ref value: %#lx, GEM5 value: %#lx\n",
-                    reg_name[dest_tag], nemu_val, gem5_val);
+            unsigned tag = dest.index() + dest.isFloatReg() * 32;
+            rec.destTags[rec.numDests] = tag;
+            rec.destValues[rec.numDests] = diffInfo.scalarResults[dest_idx];
+            rec.numDests++;
+            diffAllStates->batch.gem5Regs[tag] = diffInfo.scalarResults[dest_idx];
+        }
+    }
+    diffAllStates->batch.records.push_back(rec);
+}
 
-            if (diffInfo.inst->isMemRef()) {
-                diffMsg += csprintf("%s addr: %#lx, size: %u\n",
-                        diffInfo.inst->isAtomic() ? "AMO"
-                        : diffInfo.inst->isLoad() ? "Load"
-                                                  : "Store",
-                        diffInfo.physEffAddr, diffInfo.effSize);
+void
+BaseCPU::flushDiffBatch(ThreadID tid, bool at_batch_end)
+{
+    auto &batch = diffAllStates->batch;
+    auto &worker = diffAllStates->worker;
+
+    if (!batch.records.empty() && worker) {
+        const InstSeqNum last_seq = batch.records.back().seq;
+        DiffBatch out;
+        out.records.swap(batch.records);
+        out.gem5Regs = batch.gem5Regs;
+        worker->push(std::move(out));
+        batch.records.reserve(diffBatchSize);
+        // gem5 stopped right after this batch, once the worker caught up
+        // the ref did as well and the CSRs can be compared
+        if (at_batch_end && ++diffAsyncBatches >= diffAsyncCsrInterval) {
+            diffAsyncBatches = 0;
+            worker->drain();
+            if (worker->failed()) {
+                reportDiffBatchFailure(tid, worker->failure(), "batch checked by the difftest worker");
             }
-
-            if (gem5_val != nemu_val) {
-                if (system->multiCore() && (diffInfo.inst->isLoad() || diffInfo.inst->isAtomic()) &&
-                    _goldenMemManager->inPmem(diffInfo.physEffAddr)) {
-                    DPRINTF(Diff, "Difference on %s instr found in multicore mode, check in golden memory\n",
-                         diffInfo.inst->isLoad() ? "load" : "amo");
-                    uint8_t *golden_ptr = diffInfo.goldenValue;
-
-                    // a lambda function to sync memory and register from golden results to ref
-                    auto sync_mem_reg = [&]() {
-                        diffAllStates->proxy->memcpy(diffInfo.physEffAddr, golden_ptr, diffInfo.effSize,
-                                                     DIFFTEST_TO_REF);
-                        diffAllStates->referenceRegFile[dest_tag] = gem5_val;
-                        diffAllStates->proxy->regcpy(&(diffAllStates->referenceRegFile), DUT_TO_REF);
-                    };
-
-                    if (diffInfo.inst->isLoad() && memcmp(golden_ptr, &gem5_val, diffInfo.effSize) == 0) {
-                        DPRINTF(Diff, "Load content matched in golden memory. Sync from golden to ref\n");
-                        sync_mem_reg();
-                        continue;
-                    } else if (diffInfo.inst->isAtomic()) {
-                        DPRINTF(Diff, "Golden mem old value: %#lx, GEM5 old value: %#lx\n",
-                                diffInfo.amoOldGoldenValue, gem5_val);
-                        DPRINTF(Diff, "New golden value: %#lx\n", *(uint64_t *)golden_ptr);
-                        if (memcmp(&diffInfo.amoOldGoldenValue, &gem5_val, diffInfo.effSize) == 0) {
-                            DPRINTF(Diff,
-                                "Atomic encountered, old value matched. Sync from golden to ref\n");
-                            sync_mem_reg();
-                            continue;
-                        } else {
-                            warn("Atomic old value not matched!\n");
-                        }
-                    }
-                }
-
-                if (dest.isFloatReg() &&
-                    (gem5_val ^ nemu_val) == ((0xffffffffULL) << 32)) {
-                    DPRINTF(Diff,
-                            "Difference might be caused by box,"
-                            " ignore it\n");
-                } else {
-                    for (int i = 0; i < diffInfo.inst->numSrcRegs(); i++) {
-                        const auto &src = diffInfo.inst->srcRegIdx(i);
-                        DPRINTF(Diff, "Src%d %s = %lx\n", i,
-                                reg_name[src.index()],
-                                diffInfo.getSrcReg(src));
-                        // threadContexts[curThread]->getReg(src));
-                    }
-                    bool skipCSR = false;
-                    for (auto iter : skipCSRs) {
-                        if ((machInst & 0xfff00073) == iter) {
-                            skipCSR = true;
-                            DPRINTF(Diff, "This is an csr instruction, skip!\n");
-                            diffAllStates->referenceRegFile[dest_tag] = gem5_val;
-                            diffAllStates->proxy->regcpy(&(diffAllStates->referenceRegFile), DUT_TO_REF);
-                            break;
-                        }
-                    }
-                    DPRINTF(Diff, "Inst src count: %u, dest count: %u\n",
-                            diffInfo.inst->numSrcRegs(),
-                            diffInfo.inst->numDestRegs());
-                    diffMsg += csprintf("Inst [sn:%lli] pc: %#lx\n", seq, diffInfo.pc->instAddr());
-                    diffMsg +=
-                        csprintf("Diff at \033[31m%s\033[0m Ref value: \033[31m%#lx\033[0m, "
-                                "GEM5 value: \033[31m%#lx\033[0m\n",
-                                reg_name[dest_tag], nemu_val, gem5_val);
-                    diffInfo.errorRegsValue[dest_tag] = 1;
-                    if (dest_tag<32)
-                        diffAllStates->gem5RegFile.gpr[dest_tag]._64 = gem5_val;
-                    else if (dest_tag>=32 && dest_tag<64)
-                        diffAllStates->gem5RegFile.fpr[dest_tag-32]._64 = gem5_val;
-
-                    diffAllStates->gem5RegFile.pc = gem5_pc;
-                    if (!diff_at && !skipCSR) {
-                        diff_at = ValueDiff;
-                    }
-
-                }
+            DiffBatchResult result;
+            diffCSRs(tid, last_seq, result.diffAt);
+            if (result.diffAt != NoneDiff) {
+                reportDiffBatchFailure(tid, result, csprintf("CSRs after the batch ending at [sn:%lli]", last_seq));
             }
+            clearDiffMismatch(tid, last_seq);
+        }
+    } else if (!batch.records.empty()) {
+        DPRINTF(Diff, "Step NEMU over %lu batched insts\n", batch.records.size());
+        auto result = checkDiffBatch(*diffAllStates, batch);
+        const auto &first = batch.records.front();
+        const auto &last = batch.records.back();
+        // CSRs are only compared when gem5 stopped right after the batch
+        if (at_batch_end) {
+            diffCSRs(tid, last.seq, result.diffAt);
+        }
+        if (result.diffAt != NoneDiff) {
+            reportDiffBatchFailure(tid, result,
+                csprintf("batch of %lu insts from [sn:%lli] pc %#lx to [sn:%lli] pc %#lx", batch.records.size(),
+                         first.seq, first.pc, last.seq, last.pc));
         }
+        clearDiffMismatch(tid, last.seq);
+        batch.records.clear();
     }
-    if (diff_at && (enabledifftesInstTrace)) {
-        diffMsg += csprintf("In CPU%d: NEMU PC: %#10lx, GEM5 PC: %#10lx, inst: %s\n", cpuId(),
-        nemu_pc, gem5_pc,
-        diffInfo.inst->disassemble(diffInfo.pc->instAddr()).c_str());
+
+    if (worker && !at_batch_end) {
+        worker->drain();
+        if (worker->failed()) {
+            reportDiffBatchFailure(tid, worker->failure(), "batch checked by the difftest worker");
+        }
     }
-    return std::make_pair(diff_at, npc_match);
+}
+
+void
+BaseCPU::reportDiffBatchFailure(ThreadID tid, const DiffBatchResult &result, const std::string &where)
+{
+    std::copy(result.errorRegs.begin(), result.errorRegs.end(), diffInfo.errorRegsValue);
+    diffInfo.errorPcValue = result.diffAt == PCDiff;
+    diffMsg += result.msg;
+    diffMsg += csprintf("In CPU%d: %s\n", cpuId(), where);
+    reportDiffMismatch(tid, 0);
+    panic("Difftest failed!\n");
+}
+
+void
+BaseCPU::syncDiffShadow()
+{
+    memcpy(diffAllStates->batch.gem5Regs.data(), &diffAllStates->referenceRegFile.gpr[0]._64,
+           sizeof(diffAllStates->batch.gem5Regs));
+    diffAllStates->dutScalarRegsValid = true;
 }
 
 void
@@ -1427,6 +1555,10 @@ void
 BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
 {
     bool should_diff = false;
+    // a batch checked in the background diverged, stop at this commit
+    if (enableDifftest && diffAllStates->worker && diffAllStates->worker->failed()) {
+        reportDiffBatchFailure(tid, diffAllStates->worker->failure(), "batch checked by the difftest worker");
+    }
     DPRINTF(DumpCommit, "[sn:%llu] %#lx, %s\n",
             seq, diffInfo.pc->instAddr(), diffInfo.inst->disassemble(diffInfo.pc->instAddr()));
     DPRINTF(Diff, "DiffTest step on inst pc: %#lx: %s\n",
@@ -1447,6 +1579,8 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
             diffAllStates->hasCommit = true;
             readGem5Regs();
             diffAllStates->gem5RegFile.pc = diffInfo.pc->instAddr();
+            // the reference model copies the whole backing store
+            system->getPhysMem().materializeAll();
             if (noHypeMode) {
                 auto start = pmemStart + pmemSize * diffAllStates->diff.cpu_id;
                 warn("Start memcpy to NEMU from %#lx, size=%lu \n", (uint64_t)start, pmemSize);
@@ -1464,7 +1598,15 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
         }
     }
 
-    if (enableDifftest && should_diff) {
+    if (enableDifftest && should_diff && diffBatchSize > 1 && diffAllStates->dutScalarRegsValid &&
+        !diffNeedsSync()) {
+        bufferDiffCommit(seq);
+        if (diffAllStates->batch.records.size() >= diffBatchSize) {
+            flushDiffBatch(tid, true);
+        }
+    } else if (enableDifftest && should_diff) {
+        // the ref catches up before this inst is checked on its own
+        flushDiffBatch(tid, false);
         auto [diff_at, npc_match] = diffWithNEMU(tid, seq);
         if (diff_at != NoneDiff) {
             if (npc_match && diff_at == PCDiff) {
@@ -1490,6 +1632,9 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
         } else {
             clearDiffMismatch(tid, seq);
         }
+        if (diffBatchSize > 1) {
+            syncDiffShadow();
+        }
     }
     committedInstNum++;
     if (dumpCommitFlag && committedInstNum >= dumpStartNum) {
@@ -1614,6 +1759,7 @@ BaseCPU::displayGem5Regs()
 void
 BaseCPU::difftestRaiseIntr(uint64_t no)
 {
+    flushDiffBatch(0, false);
     diffAllStates->diff.will_handle_intr = true;
     diffAllStates->proxy->raise_intr(no);
 }
@@ -1628,6 +1774,7 @@ BaseCPU::clearGuideExecInfo()
 void
 BaseCPU::enableDiffPrint()
 {
+    flushDiffBatch(0, false);
     diffAllStates->diff.dynamic_config.debug_difftest = true;
     diffAllStates->proxy->update_config(&diffAllStates->diff.dynamic_config);
 }
@@ -1642,6 +1789,7 @@ void
 BaseCPU::setExceptionGuideExecInfo(uint64_t exception_num, uint64_t mtval, uint64_t stval, bool force_set_jump_target,
                                    uint64_t jump_target, ThreadID tid)
 {
+    flushDiffBatch(tid, false);
     auto &gd = diffAllStates->diff.guide;
     gd.force_raise_exception = true;
     gd.exception_num = exception_num;
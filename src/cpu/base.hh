@@ -42,6 +42,7 @@
 #ifndef __CPU_BASE_HH__
 #define __CPU_BASE_HH__
 
+#include <memory>
 #include <queue>
 #include <vector>
 
@@ -55,6 +56,7 @@
 #else
 #include "arch/generic/interrupts.hh"
 #include "base/statistics.hh"
+#include "cpu/diff_worker.hh"
 #include "cpu/difftest.hh"
 #include "debug/Mwait.hh"
 #include "mem/htm.hh"
@@ -130,6 +132,13 @@ struct DiffAllStates
     RefProxy *proxy;
 
     bool hasCommit{false};
+
+    // Batched difftest. gem5's registers in the batch are only valid
+    // after the ref and gem5 have been seen to agree.
+    DiffBatch batch;
+    bool dutScalarRegsValid{false};
+    // checks batches off the simulation thread, if enabled
+    std::unique_ptr<DiffWorker> worker;
 };
 
 class BaseCPU : public ClockedObject
@@ -706,6 +715,46 @@ class BaseCPU : public ClockedObject
     void csrDiffMessage(uint64_t gem5_val, uint64_t ref_val, int error_num, uint64_t &error_reg, InstSeqNum seq,
                         std::string error_csr_name,int &diff_at);
     std::pair<int, bool> diffWithNEMU(ThreadID tid, InstSeqNum seq);
+    void diffCSRs(ThreadID tid, InstSeqNum seq, int &diff_at);
+
+    /** Instructions stepped on the ref at once, see difftest_batch_size. */
+    const unsigned diffBatchSize;
+    /** Check batches on a DiffWorker thread. */
+    const bool diffAsync;
+    /**
+     * Batches handed to the worker between two CSR checks. The worker
+     * cannot read gem5's CSRs, so the simulation thread drains it at
+     * the end of every such batch and compares them itself.
+     */
+    const unsigned diffAsyncCsrInterval;
+    /** Batches handed to the worker since the last CSR check. */
+    unsigned diffAsyncBatches = 0;
+
+    /**
+     * Whether the instruction in diffInfo has to be checked on its own,
+     * because the ref needs to be synchronized or fixed up around it.
+     */
+    bool diffNeedsSync() const;
+
+    /** Append the instruction in diffInfo to the batch. */
+    void bufferDiffCommit(InstSeqNum seq);
+
+    /**
+     * Step the ref over the whole batch and compare the result, or hand
+     * the batch to the worker.
+     *
+     * @param at_batch_end gem5 has not committed anything past the batch,
+     *        so its CSRs can be compared as well. Otherwise the caller
+     *        goes on to use the ref, and the worker is drained.
+     */
+    void flushDiffBatch(ThreadID tid, bool at_batch_end);
+
+    /** Report a mismatch found in a batch and stop. */
+    [[noreturn]] void reportDiffBatchFailure(ThreadID tid, const DiffBatchResult &result,
+                                             const std::string &where);
+
+    /** Take the ref's GPRs and FPRs as gem5's after a matching step. */
+    void syncDiffShadow();
 
     std::string diffMsg;
     void reportDiffMismatch(ThreadID tid, InstSeqNum seq) {
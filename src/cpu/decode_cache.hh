@@ -29,10 +29,13 @@
 #ifndef __CPU_DECODE_CACHE_HH__
 #define __CPU_DECODE_CACHE_HH__
 
+#include <array>
+#include <memory>
 #include <unordered_map>
 
 #include "base/bitfield.hh"
 #include "base/compiler.hh"
+#include "base/types.hh"
 #include "cpu/static_inst_fwd.hh"
 
 namespace gem5
@@ -136,6 +139,57 @@ class AddrMap
     }
 };
 
+/**
+ * A sparse map from addresses to values, grouped into small blocks of
+ * slots, one per possible instruction start. Blocks are found through a
+ * direct mapped table of recently used blocks, and through a hash map
+ * only when that misses, so code that fits in the table never hashes.
+ */
+template<class Value, Addr BlockShift = 6, Addr SlotShift = 1,
+         unsigned NumWays = 1024>
+class BlockMap
+{
+  protected:
+    static constexpr Addr BlockBytes = 1ULL << BlockShift;
+    static constexpr unsigned NumSlots = BlockBytes >> SlotShift;
+
+    struct Block
+    {
+        std::array<Value, NumSlots> slots;
+    };
+
+    struct Way
+    {
+        Addr tag = MaxAddr;
+        Block *block = nullptr;
+    };
+
+    std::array<Way, NumWays> ways;
+    std::unordered_map<Addr, std::unique_ptr<Block>> blocks;
+
+    Block *
+    getBlock(Addr block_num)
+    {
+        Way &way = ways[block_num % NumWays];
+        if (way.tag != block_num) {
+            auto &block = blocks[block_num];
+            if (!block)
+                block = std::make_unique<Block>();
+            way.tag = block_num;
+            way.block = block.get();
+        }
+        return way.block;
+    }
+
+  public:
+    Value &
+    lookup(Addr addr)
+    {
+        Block *block = getBlock(addr >> BlockShift);
+        return block->slots[(addr & (BlockBytes - 1)) >> SlotShift];
+    }
+};
+
 } // namespace decode_cache
 } // namespace gem5
 
@@ -0,0 +1,140 @@
+#include "cpu/diff_worker.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/cprintf.hh"
+#include "cpu/base.hh"
+#include "cpu/difftest.hh"
+
+namespace gem5
+{
+
+DiffBatchResult
+checkDiffBatch(DiffAllStates &states, DiffBatch &batch)
+{
+    DiffBatchResult result;
+    const auto &records = batch.records;
+    const auto &last = records.back();
+
+    states.proxy->exec(records.size());
+    states.proxy->regcpy(states.diff.nemu_reg, REF_TO_DIFFTEST);
+
+    auto &ref = states.referenceRegFile;
+    states.diff.nemu_commit_inst_pc = last.pc;
+    states.diff.nemu_this_pc = ref.pc;
+    states.diff.npc = ref.pc;
+
+    if (ref.pc != last.npc) {
+        result.msg += csprintf("Diff at %s after [sn:%lli] @ tick %lu, NEMU: %#lx, GEM5: %#lx\n", "PC", last.seq,
+                               last.tick, ref.pc, last.npc);
+        result.diffAt = PCDiff;
+    }
+
+    // GPRs and FPRs are adjacent, so a single memcmp checks all of them
+    const uint64_t *ref_regs = &ref.gpr[0]._64;
+    uint64_t *gem5_regs = batch.gem5Regs.data();
+    if (memcmp(ref_regs, gem5_regs, sizeof(batch.gem5Regs)) == 0)
+        return result;
+
+    for (unsigned tag = 0; tag < 64; tag++) {
+        uint64_t ref_val = ref_regs[tag];
+        uint64_t gem5_val = gem5_regs[tag];
+        if (ref_val == gem5_val)
+            continue;
+        if (tag >= 32 && (gem5_val ^ ref_val) == ((0xffffffffULL) << 32)) {
+            // might be caused by box, ignore it
+            gem5_regs[tag] = ref_val;
+            continue;
+        }
+        // walk the writeback log back to the last inst writing the register
+        auto writer = std::find_if(records.rbegin(), records.rend(), [tag](const DiffCommitRecord &rec) {
+            return std::find(rec.destTags, rec.destTags + rec.numDests, tag) != rec.destTags + rec.numDests;
+        });
+        if (writer != records.rend()) {
+            result.msg += csprintf("Inst [sn:%lli] pc: %#lx @ tick %lu\n", writer->seq, writer->pc, writer->tick);
+        } else {
+            result.msg += csprintf("Not written by GEM5 in [sn:%lli, sn:%lli]\n", records.front().seq, last.seq);
+        }
+        result.msg += csprintf("Diff at \033[31m%s\033[0m Ref value: \033[31m%#lx\033[0m, "
+                               "GEM5 value: \033[31m%#lx\033[0m\n",
+                               reg_name[tag], ref_val, gem5_val);
+        result.errorRegs[tag] = true;
+        if (!result.diffAt)
+            result.diffAt = ValueDiff;
+    }
+    return result;
+}
+
+DiffWorker::DiffWorker(DiffAllStates &states, size_t queue_size)
+    : states(states), queue(queue_size)
+{
+    thread = std::thread([this]() { run(); });
+}
+
+DiffWorker::~DiffWorker()
+{
+    stop.store(true, std::memory_order_release);
+    notify(workCv);
+    thread.join();
+}
+
+void
+DiffWorker::notify(std::condition_variable &cv)
+{
+    // taking the mutex orders the change before the waiter's check of
+    // its predicate, so the wake-up cannot be lost
+    { std::lock_guard<std::mutex> lock(mutex); }
+    cv.notify_one();
+}
+
+void
+DiffWorker::push(DiffBatch &&batch)
+{
+    if (!queue.tryPush(std::move(batch))) {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCv.wait(lock, [&]() { return queue.tryPush(std::move(batch)); });
+    }
+    pushed.fetch_add(1, std::memory_order_release);
+    notify(workCv);
+}
+
+void
+DiffWorker::drain()
+{
+    const uint64_t target = pushed.load(std::memory_order_relaxed);
+    if (checked.load(std::memory_order_acquire) == target)
+        return;
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCv.wait(lock, [&]() { return checked.load(std::memory_order_acquire) == target; });
+}
+
+void
+DiffWorker::run()
+{
+    DiffBatch batch;
+    while (true) {
+        if (!queue.tryPop(batch)) {
+            std::unique_lock<std::mutex> lock(mutex);
+            workCv.wait(lock, [&]() {
+                return !queue.empty() || stop.load(std::memory_order_acquire);
+            });
+            if (queue.empty())
+                break;
+            continue;
+        }
+        // after a mismatch the ref is left where it diverged, for the
+        // report on the simulation thread
+        if (!failed()) {
+            auto result = checkDiffBatch(states, batch);
+            if (result.diffAt) {
+                _failure = std::move(result);
+                _failed.store(true, std::memory_order_release);
+            }
+        }
+        checked.fetch_add(1, std::memory_order_release);
+        notify(doneCv);
+    }
+}
+
+} // namespace gem5
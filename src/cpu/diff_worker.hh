@@ -0,0 +1,115 @@
+#ifndef __CPU_DIFF_WORKER_HH__
+#define __CPU_DIFF_WORKER_HH__
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/spsc_queue.hh"
+#include "base/types.hh"
+#include "cpu/inst_seq.hh"
+
+namespace gem5
+{
+
+struct DiffAllStates;
+
+/**
+ * A committed instruction whose difftest check is deferred to the end of
+ * its batch.
+ */
+struct DiffCommitRecord
+{
+    InstSeqNum seq;
+    Tick tick;
+    Addr pc;
+    Addr npc;
+    int numDests;
+    // 0~31 GPRs, 32~63 FPRs, as in riscv64_CPU_regfile
+    unsigned destTags[2];
+    uint64_t destValues[2];
+};
+
+/**
+ * Instructions not stepped on the ref yet, and gem5's GPRs and FPRs as
+ * of the last of them.
+ */
+struct DiffBatch
+{
+    std::vector<DiffCommitRecord> records;
+    std::array<uint64_t, 64> gem5Regs;
+};
+
+struct DiffBatchResult
+{
+    // a DiffAt value
+    int diffAt = 0;
+    std::string msg;
+    std::array<bool, 64> errorRegs{};
+};
+
+/**
+ * Step the ref over a batch and compare its PC, GPRs and FPRs with
+ * gem5's. Only the ref and the reference side of the states are
+ * touched, so this may run off the simulation thread.
+ */
+DiffBatchResult checkDiffBatch(DiffAllStates &states, DiffBatch &batch);
+
+/**
+ * Runs checkDiffBatch() on a host thread, so that the ref steps in
+ * parallel with the simulated CPU. The simulation thread must drain()
+ * the worker before it touches the ref itself.
+ */
+class DiffWorker
+{
+  public:
+    DiffWorker(DiffAllStates &states, size_t queue_size);
+    ~DiffWorker();
+
+    /** Hand a batch over, waiting if the worker is too far behind. */
+    void push(DiffBatch &&batch);
+
+    /** Wait until every batch pushed so far has been checked. */
+    void drain();
+
+    /** Set once a batch did not match, the worker stops checking then. */
+    bool failed() const { return _failed.load(std::memory_order_acquire); }
+
+    /** The first mismatch, only valid once failed() */
+    const DiffBatchResult &failure() const { return _failure; }
+
+  private:
+    DiffAllStates &states;
+    SPSCQueue<DiffBatch> queue;
+    std::thread thread;
+
+    std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> checked{0};
+    std::atomic<bool> stop{false};
+    std::atomic<bool> _failed{false};
+    DiffBatchResult _failure;
+
+    /**
+     * Both sides sleep instead of spinning: the worker on workCv until a
+     * batch or stop arrives, the simulation thread on doneCv until a
+     * batch has been checked. The batches themselves still go through
+     * the lock-free queue, the mutex only guards the sleeping.
+     */
+    std::mutex mutex;
+    std::condition_variable workCv;
+    std::condition_variable doneCv;
+
+    /** Wake up the other side after changing what it waits for. */
+    void notify(std::condition_variable &cv);
+
+    void run();
+};
+
+} // namespace gem5
+
+#endif // __CPU_DIFF_WORKER_HH__
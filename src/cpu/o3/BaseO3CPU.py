@@ -138,6 +138,11 @@ class BaseO3CPU(BaseCPU):
     commitToRenameDelay = Param.Cycles(1, "Commit to rename delay")
     decodeToRenameDelay = Param.Cycles(1, "Decode to rename delay")
     renameWidth = Param.Unsigned(6, "Rename width")
+    numRenameCheckpoints = Param.Unsigned(4, "Number of rename map "
+        "checkpoints taken at branches to recover from squashes, "
+        "0 to always undo the renames one by one")
+    renameCheckpointGap = Param.Unsigned(16, "Minimum number of renames "
+        "between two rename map checkpoints")
 
     commitToIEWDelay = Param.Cycles(1, "Commit to "
                "Issue/Execute/Writeback delay")
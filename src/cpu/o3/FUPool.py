@@ -63,6 +63,8 @@ class IssuePort(SimObject):
     fu = VectorParam.FUDesc("Combined FU")
     rp = VectorParam.Int([], "Integer register read port id and priority ()")
 
+class IQSelectPolicy(Enum): vals = ['heap', 'age_matrix']
+
 class IssueQue(SimObject):
     type = 'IssueQue'
     cxx_class = 'gem5::o3::IssueQue'
@@ -72,6 +74,9 @@ class IssueQue(SimObject):
     size = Param.Int(16, "")
     inports = Param.Int(2, "")
     scheduleToExecDelay = Param.Cycles(2, "")
+    selectPolicy = Param.IQSelectPolicy('heap',
+        "keep ready insts in heaps, or in fixed slots selected "
+        "oldest first by an age matrix")
 
     oports = VectorParam.IssuePort("")
 
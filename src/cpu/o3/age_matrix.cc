@@ -0,0 +1,57 @@
+#include "cpu/o3/age_matrix.hh"
+
+#include <cassert>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+AgeMatrix::AgeMatrix(size_t size)
+    : older(size, Bitmap(size)), _valid(size)
+{
+}
+
+size_t
+AgeMatrix::allocate()
+{
+    size_t slot = (~_valid).find_first();
+    assert(slot != npos);
+    // rows of the other slots may still point at the last occupant
+    for (auto &row : older) {
+        row.reset(slot);
+    }
+    older[slot] = _valid;
+    _valid.set(slot);
+    return slot;
+}
+
+void
+AgeMatrix::free(size_t slot)
+{
+    assert(_valid.test(slot));
+    _valid.reset(slot);
+}
+
+void
+AgeMatrix::free(const Bitmap &mask)
+{
+    assert(mask.is_subset_of(_valid));
+    _valid -= mask;
+}
+
+size_t
+AgeMatrix::oldest(const Bitmap &candidates) const
+{
+    for (size_t i = candidates.find_first(); i != npos; i = candidates.find_next(i)) {
+        if (!older[i].intersects(candidates)) {
+            return i;
+        }
+    }
+    assert(candidates.none());
+    return npos;
+}
+
+} // namespace o3
+} // namespace gem5
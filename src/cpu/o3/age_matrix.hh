@@ -0,0 +1,51 @@
+#ifndef __CPU_O3_AGE_MATRIX_HH__
+#define __CPU_O3_AGE_MATRIX_HH__
+
+#include <vector>
+
+#include <boost/dynamic_bitset/dynamic_bitset.hpp>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Slot allocator of a fixed-size issue queue, which also tracks the
+ * relative age of the occupied slots.
+ *
+ * Row i holds the slots older than slot i. Slots are allocated in
+ * program order, so a new slot is younger than every valid one; the
+ * oldest of a set of slots is the one whose row has none of them.
+ */
+class AgeMatrix
+{
+  public:
+    using Bitmap = boost::dynamic_bitset<>;
+    static constexpr size_t npos = Bitmap::npos;
+
+    explicit AgeMatrix(size_t size);
+
+    size_t size() const { return _valid.size(); }
+    bool full() const { return _valid.all(); }
+    const Bitmap &valid() const { return _valid; }
+
+    /** Take a free slot as the youngest one */
+    size_t allocate();
+    void free(size_t slot);
+    /** Free all slots in mask */
+    void free(const Bitmap &mask);
+
+    /** The oldest slot of candidates, npos if there is none */
+    size_t oldest(const Bitmap &candidates) const;
+
+  private:
+    std::vector<Bitmap> older;
+    Bitmap _valid;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_AGE_MATRIX_HH__
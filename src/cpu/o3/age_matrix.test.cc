@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+
+#include "cpu/o3/age_matrix.hh"
+
+using namespace gem5::o3;
+
+/** Slots are handed out lowest first, the oldest wins among candidates */
+TEST(AgeMatrixTest, SelectOldest)
+{
+    AgeMatrix ages(4);
+
+    ASSERT_EQ(ages.oldest(AgeMatrix::Bitmap(4)), AgeMatrix::npos);
+    ASSERT_EQ(ages.allocate(), 0);
+    ASSERT_EQ(ages.allocate(), 1);
+    ASSERT_EQ(ages.allocate(), 2);
+    ASSERT_EQ(ages.oldest(ages.valid()), 0);
+
+    // slot 0 is reused by an inst younger than 1 and 2
+    ages.free(0);
+    ASSERT_EQ(ages.allocate(), 0);
+    ASSERT_EQ(ages.oldest(ages.valid()), 1);
+    ASSERT_EQ(ages.allocate(), 3);
+    ASSERT_TRUE(ages.full());
+
+    AgeMatrix::Bitmap candidates(4);
+    candidates.set(0).set(3);
+    ASSERT_EQ(ages.oldest(candidates), 0);
+    candidates.set(2);
+    ASSERT_EQ(ages.oldest(candidates), 2);
+
+    // a squash frees several slots at once
+    AgeMatrix::Bitmap squashed(4);
+    squashed.set(1).set(2);
+    ages.free(squashed);
+    ASSERT_EQ(ages.oldest(ages.valid()), 0);
+    ASSERT_EQ(ages.allocate(), 1);
+    ASSERT_EQ(ages.oldest(ages.valid() - AgeMatrix::Bitmap(4, 1)), 3);
+}
+
+/**
+ * Run random allocations, issues, squashes and selections, and check
+ * that the selected slot always holds the oldest candidate inst.
+ */
+TEST(AgeMatrixTest, RandomAgainstSequenceNumbers)
+{
+    const size_t size = 24;
+    std::mt19937_64 rng(0xa9e);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    AgeMatrix ages(size);
+    // slot -> seqNum of the inst in it
+    std::map<size_t, uint64_t> insts;
+    uint64_t seq = 0;
+
+    for (int step = 0; step < 200000; step++) {
+        switch (rand(4)) {
+          case 0:
+          case 1:
+            if (!ages.full()) {
+                size_t slot = ages.allocate();
+                ASSERT_FALSE(insts.count(slot));
+                insts[slot] = ++seq;
+            }
+            break;
+          case 2:
+            if (!insts.empty()) {
+                auto it = std::next(insts.begin(), rand(insts.size()));
+                ages.free(it->first);
+                insts.erase(it);
+            }
+            break;
+          default:
+            {
+                // a squash frees every inst younger than some seqNum
+                if (rand(16) == 0 && !insts.empty()) {
+                    uint64_t youngest = seq - rand(insts.size());
+                    AgeMatrix::Bitmap squashed(size);
+                    for (auto it = insts.begin(); it != insts.end();) {
+                        if (it->second > youngest) {
+                            squashed.set(it->first);
+                            it = insts.erase(it);
+                        } else {
+                            it++;
+                        }
+                    }
+                    ages.free(squashed);
+                    break;
+                }
+
+                AgeMatrix::Bitmap candidates(size);
+                size_t expected = AgeMatrix::npos;
+                for (const auto &[slot, inst_seq] : insts) {
+                    if (rand(2)) {
+                        continue;
+                    }
+                    candidates.set(slot);
+                    if (expected == AgeMatrix::npos ||
+                        inst_seq < insts[expected]) {
+                        expected = slot;
+                    }
+                }
+                ASSERT_EQ(ages.oldest(candidates), expected)
+                    << "step " << step;
+            }
+        }
+        ASSERT_EQ(ages.valid().count(), insts.size());
+    }
+}
@@ -1214,7 +1214,7 @@ Commit::commitInsts()
                     if (head_inst->isReturn()) {
                         DPRINTF(FTBRAS, "commit inst PC %x miss %d real target %x pred target %x\n",
                                 head_inst->pcState().instAddr(), miss,
-                                head_rv_pc.npc(), *(head_inst->predPC));
+                                head_rv_pc.npc(), head_inst->predPC);
                     }
 
                     // FIXME: ignore mret/sret/uret in correspond with RTL
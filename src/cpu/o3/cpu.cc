@@ -192,6 +192,11 @@ CPU::CPU(const BaseO3CPUParams &params)
     rename.setIEWStage(&iew);
     rename.setCommitStage(&commit);
 
+    // Room for the instructions in the ROB and the fetch queues, the
+    // list grows if the other buffers of the front end hold more.
+    instList.reserve(params.numROBEntries +
+                     params.numThreads * params.fetchQueueSize);
+
     ThreadID active_threads;
     if (FullSystem) {
         active_threads = 1;
@@ -1319,6 +1324,10 @@ CPU::squashFromTC(ThreadID tid)
 CPU::ListIt
 CPU::addInst(const DynInstPtr &inst)
 {
+    // Never wrap over the oldest instructions in flight
+    if (instList.full()) {
+        instList.reserve(instList.capacity() * 2);
+    }
     instList.push_back(inst);
 
     return --(instList.end());
@@ -1435,23 +1444,21 @@ CPU::removeInstsUntil(const InstSeqNum &seq_num, ThreadID tid)
             "list that are from [tid:%i] and above [sn:%lli] (end=%lli).\n",
             tid, seq_num, (*inst_iter)->seqNum);
 
-    while ((*inst_iter)->seqNum > seq_num) {
-
-        bool break_loop = (inst_iter == instList.begin());
+    while (!*inst_iter || (*inst_iter)->seqNum > seq_num) {
 
         squashInstIt(inst_iter, tid);
 
-        inst_iter--;
-
-        if (break_loop)
+        if (inst_iter == instList.begin())
             break;
+
+        inst_iter--;
     }
 }
 
 void
 CPU::squashInstIt(const ListIt &instIt, ThreadID tid)
 {
-    if ((*instIt)->threadNumber == tid) {
+    if (*instIt && (*instIt)->threadNumber == tid) {
         DPRINTF(O3CPU, "Squashing instruction, "
                 "[tid:%i] [sn:%lli] PC %s\n",
                 (*instIt)->threadNumber,
@@ -1485,11 +1492,20 @@ CPU::cleanUpRemovedInsts()
                 (*removeList.front())->seqNum,
                 (*removeList.front())->pcState());
 
-        instList.erase(removeList.front());
+        *removeList.front() = nullptr;
 
         removeList.pop();
     }
 
+    // Retired instructions are the oldest of a thread and squashed ones the
+    // youngest, so only SMT can leave empty slots between two instructions.
+    while (!instList.empty() && !instList.front()) {
+        instList.pop_front();
+    }
+    while (!instList.empty() && !instList.back()) {
+        instList.pop_back();
+    }
+
     removeInstsThisCycle = false;
 }
 /*
@@ -1509,6 +1525,10 @@ CPU::dumpInsts()
     cprintf("Dumping Instruction List\n");
 
     while (inst_list_it != instList.end()) {
+        if (!*inst_list_it) {
+            inst_list_it++;
+            continue;
+        }
         cprintf("Instruction:%i\nPC:%#x\n[tid:%i]\n[sn:%lli]\nIssued:%i\n"
                 "Squashed:%i\n\n",
                 num, (*inst_list_it)->pcState().instAddr(),
@@ -50,6 +50,7 @@
 #include <vector>
 
 #include "arch/generic/pcstate.hh"
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "config/the_isa.hh"
 #include "cpu/activity.hh"
@@ -59,6 +60,7 @@
 #include "cpu/o3/commit.hh"
 #include "cpu/o3/cpu_def.hh"
 #include "cpu/o3/decode.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/fetch.hh"
 #include "cpu/o3/free_list.hh"
@@ -99,7 +101,7 @@ class ThreadContext;
 class CPU : public BaseCPU
 {
   public:
-    typedef std::list<DynInstPtr>::iterator ListIt;
+    typedef CircularQueue<DynInstPtr>::iterator ListIt;
 
     friend class ThreadContext;
 
@@ -129,6 +131,11 @@ class CPU : public BaseCPU
     Status _status;
 
     PhysRegIdPtr vecOnesPhysRegId;
+
+    /** Buffers of the DynInsts of this CPU. Declared before everything
+     *  that may hold a DynInst, so that it is destroyed after them. */
+    DynInstPool dynInstPool;
+
   private:
 
     /** The tick event used for scheduling CPU ticks. */
@@ -407,8 +414,10 @@ class CPU : public BaseCPU
     int instcount;
 #endif
 
-    /** List of all the instructions in flight. */
-    std::list<DynInstPtr> instList;
+    /** List of all the instructions in flight, oldest first. A removed
+     *  instruction leaves an empty slot until it is at either end.
+     */
+    CircularQueue<DynInstPtr> instList;
 
     /** List of all the instructions that will be removed at the end of this
      *  cycle.
@@ -101,8 +101,8 @@ DynInst::DynInst(const Arrays &arrays, const StaticInstPtr &static_inst,
         const PCStateBase &pred_pc, InstSeqNum seq_num, CPU *_cpu)
     : DynInst(arrays, static_inst, _macroop, seq_num, _cpu)
 {
-    set(pc, _pc);
-    set(predPC, pred_pc);
+    pc.update(_pc);
+    predPC.update(pred_pc);
 }
 
 DynInst::DynInst(const Arrays &arrays, const StaticInstPtr &_staticInst,
@@ -111,17 +111,19 @@ DynInst::DynInst(const Arrays &arrays, const StaticInstPtr &_staticInst,
 {}
 
 /*
- * This custom "new" operator uses the default "new" operator to allocate space
- * for a DynInst, but also pads out the number of bytes to make room for some
+ * This custom "new" operator takes space for a DynInst from the CPU's
+ * DynInstPool, but also pads out the number of bytes to make room for some
  * extra structures the DynInst needs. We save time and improve performance by
- * only going to the heap once to get space for all these structures.
+ * only going to the pool once to get space for all these structures, and the
+ * pool only goes to the heap until it has enough buffers for the instructions
+ * in flight.
  *
  * When a DynInst is allocated with new, the compiler will call this "new"
  * operator with "count" set to the number of bytes it needs to store the
- * DynInst. We ultimately call into the default new operator to get those
- * bytes, but before we do, we pad out "count" so that there will be extra
- * space for some structures the DynInst needs. We take into account both the
- * absolute size of these structures, and also what alignment they need.
+ * DynInst. We ultimately call into the pool to get those bytes, but before
+ * we do, we pad out "count" so that there will be extra space for some
+ * structures the DynInst needs. We take into account both the absolute size
+ * of these structures, and also what alignment they need.
  *
  * Once we've gotten a buffer large enough to hold the DynInst itself and these
  * extra structures, we construct the extra bits using placement new. This
@@ -171,8 +173,8 @@ DynInst::operator new(size_t count, Arrays &arrays)
     // Figure out how much space we need in total.
     size_t total_size = ready_src_idx + ready_src_idx_size;
 
-    // Actually allocate it.
-    uint8_t *buf = (uint8_t *)::operator new(total_size);
+    // Actually allocate it, recycling a buffer of the CPU if possible.
+    uint8_t *buf = (uint8_t *)DynInstPool::allocate(arrays.pool, total_size);
 
     // Fill in "arrays" with pointers to all the arrays.
     arrays.flatDestIdx = (RegId *)(buf + flat_dest_idx);
@@ -191,13 +193,13 @@ DynInst::operator new(size_t count, Arrays &arrays)
     return buf;
 }
 
-// Because of the custom "new" operator that allocates more bytes than the
-// size of the DynInst object, AddressSanitizer throw new-delete-type-mismatch.
-// Adding a custom delete function is enough to shut down this false positive
+// The buffer came from DynInstPool::allocate(), so it goes back there
+// rather than to the global delete. This also keeps AddressSanitizer from
+// reporting a new-delete-type-mismatch for the padded allocation.
 void
 DynInst::operator delete(void *ptr)
 {
-    ::operator delete(ptr);
+    DynInstPool::release(ptr);
 }
 
 DynInst::~DynInst()
@@ -290,8 +292,8 @@ DynInst::dumpSNList()
 void
 DynInst::dump()
 {
-    cprintf("T%d : %#08d `", threadNumber, pc->instAddr());
-    std::cout << staticInst->disassemble(pc->instAddr());
+    cprintf("T%d : %#08d `", threadNumber, pc.instAddr());
+    std::cout << staticInst->disassemble(pc.instAddr());
     cprintf("'\n");
 }
 
@@ -299,8 +301,8 @@ void
 DynInst::dump(std::string &outstring)
 {
     std::ostringstream s;
-    s << "T" << threadNumber << " : 0x" << pc->instAddr() << " "
-      << staticInst->disassemble(pc->instAddr());
+    s << "T" << threadNumber << " : 0x" << pc.instAddr() << " "
+      << staticInst->disassemble(pc.instAddr());
 
     outstring = s.str();
 }
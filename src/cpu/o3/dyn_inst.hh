@@ -49,6 +49,8 @@
 #include <string>
 
 #include "arch/riscv/insts/vector.hh"
+#include "arch/riscv/pcstate.hh"
+#include "base/circular_queue.hh"
 #include "base/refcnt.hh"
 #include "base/trace.hh"
 #include "config/the_isa.hh"
@@ -58,6 +60,7 @@
 #include "cpu/inst_res.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/cpu.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/dyn_inst_xsmeta.hh"
 #include "cpu/o3/lsq_unit.hh"
@@ -89,7 +92,7 @@ class DynInst : public ExecContext, public RefCounted
 
   public:
     // The list of instructions iterator type.
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef typename CircularQueue<DynInstPtr>::iterator ListIt;
 
     struct Arrays
     {
@@ -101,6 +104,9 @@ class DynInst : public ExecContext, public RefCounted
         PhysRegIdPtr *prevDestIdx;
         PhysRegIdPtr *srcIdx;
         uint8_t *readySrcIdx;
+
+        /** Pool to take the buffer from, the heap if null */
+        DynInstPool *pool = nullptr;
     };
 
     static void *operator new(size_t count, Arrays &arrays);
@@ -224,8 +230,9 @@ class DynInst : public ExecContext, public RefCounted
      */
     std::queue<InstResult> instResult;
 
-    /** PC state for this instruction. */
-    std::unique_ptr<PCStateBase> pc;
+    /** PC state for this instruction. It is kept inline, like predPC,
+     *  so that setting it is an update rather than a heap clone. */
+    RiscvISA::PCState pc;
 
     /** Values to be written to the destination misc. registers. */
     std::vector<RegVal> _destMiscRegVal;
@@ -257,8 +264,6 @@ class DynInst : public ExecContext, public RefCounted
     // Whether or not the source register is ready, one bit per register.
     uint8_t *_readySrcIdx;
 
-    std::vector<bool> srcRegCanceled;
-
     uint64_t amoOldGoldenValue;
 
   public:
@@ -347,7 +352,7 @@ class DynInst : public ExecContext, public RefCounted
 
     ////////////////////// Branch Data ///////////////
     /** Predicted PC state after this instruction. */
-    std::unique_ptr<PCStateBase> predPC;
+    RiscvISA::PCState predPC;
 
     Addr fallThruPC;
 
@@ -412,6 +417,8 @@ class DynInst : public ExecContext, public RefCounted
 
     IssueQue* issueQue = nullptr;
     int issueportid = -1;
+    // slot held in an age matrix IssueQue until issued
+    int iqSlot = -1;
 
   public:
     /** Records changes to result? */
@@ -578,9 +585,9 @@ class DynInst : public ExecContext, public RefCounted
     bool doneTargCalc() { return false; }
 
     /** Set the predicted target of this current instruction. */
-    void setPredTarg(const PCStateBase &pred_pc) { set(predPC, pred_pc); }
+    void setPredTarg(const PCStateBase &pred_pc) { predPC.update(pred_pc); }
 
-    const PCStateBase &readPredTarg() { return *predPC; }
+    const PCStateBase &readPredTarg() { return predPC; }
 
     /** Returns whether the instruction was predicted taken or not. */
     bool readPredTaken() { return instFlags[PredTaken]; }
@@ -595,11 +602,11 @@ class DynInst : public ExecContext, public RefCounted
     bool
     mispredicted()
     {
-        std::unique_ptr<PCStateBase> next_pc(pc->clone());
-        staticInst->advancePC(*next_pc);
+        RiscvISA::PCState next_pc = pc;
+        staticInst->advancePC(next_pc);
         DPRINTF(DecoupleBP, "check misprediction next pc=%s and pred pc=%s\n",
-                *next_pc, *predPC);
-        return *next_pc != *predPC;
+                next_pc, predPC);
+        return next_pc != predPC;
     }
 
     //
@@ -744,7 +751,7 @@ class DynInst : public ExecContext, public RefCounted
     std::unique_ptr<PCStateBase>
     branchTarget() const
     {
-        return staticInst->branchTarget(*pc);
+        return staticInst->branchTarget(pc);
     }
 
     /** Returns the number of source registers. */
@@ -1000,11 +1007,11 @@ class DynInst : public ExecContext, public RefCounted
     const PCStateBase &
     pcState() const override
     {
-        return *pc;
+        return pc;
     }
 
     /** Set the PC state of this instruction. */
-    void pcState(const PCStateBase &val) override { set(pc, val); }
+    void pcState(const PCStateBase &val) override { pc.update(val); }
 
     bool readPredicate() const override { return instFlags[Predicate]; }
 
@@ -1401,7 +1408,7 @@ class DynInst : public ExecContext, public RefCounted
 
     unsigned getInstBytes()
     {
-        RiscvISA::PCState rpc = pc->as<RiscvISA::PCState>();
+        RiscvISA::PCState rpc = pc;
         return rpc.compressed() ? 2 : 4;
     }
 
@@ -1425,17 +1432,17 @@ class DynInst : public ExecContext, public RefCounted
 
     Addr getPC()
     {
-        return pc->instAddr();
+        return pc.instAddr();
     }
 
     Addr getNPC()
     {
-        return pc->as<RiscvISA::PCState>().npc();
+        return pc.npc();
     }
 
     bool branching()
     {
-        return pc->as<RiscvISA::PCState>().branching();
+        return pc.branching();
     }
 
     /** set golden */
@@ -0,0 +1,61 @@
+#include "cpu/o3/dyn_inst_pool.hh"
+
+#include <new>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+DynInstPool::~DynInstPool()
+{
+    for (auto &free_list : freeLists) {
+        for (Header *header : free_list) {
+            ::operator delete(header);
+        }
+    }
+}
+
+void *
+DynInstPool::allocate(DynInstPool *pool, size_t size)
+{
+    uint32_t size_class = (size + ClassBytes - 1) / ClassBytes;
+    Header *header = nullptr;
+
+    if (pool) {
+        if (size_class >= pool->freeLists.size()) {
+            pool->freeLists.resize(size_class + 1);
+        }
+        auto &free_list = pool->freeLists[size_class];
+        if (!free_list.empty()) {
+            header = free_list.back();
+            free_list.pop_back();
+        }
+        pool->_inUse++;
+    }
+
+    if (!header) {
+        header = static_cast<Header *>(
+            ::operator new(sizeof(Header) + size_class * ClassBytes));
+    }
+    header->pool = pool;
+    header->sizeClass = size_class;
+    return header + 1;
+}
+
+void
+DynInstPool::release(void *ptr)
+{
+    Header *header = static_cast<Header *>(ptr) - 1;
+    DynInstPool *pool = header->pool;
+    if (!pool) {
+        ::operator delete(header);
+        return;
+    }
+    pool->freeLists[header->sizeClass].push_back(header);
+    pool->_inUse--;
+}
+
+} // namespace o3
+} // namespace gem5
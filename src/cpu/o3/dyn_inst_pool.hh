@@ -0,0 +1,61 @@
+#ifndef __CPU_O3_DYN_INST_POOL_HH__
+#define __CPU_O3_DYN_INST_POOL_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Recycles the buffers DynInsts and their register index arrays are
+ * built in. A freed buffer goes onto the free list of its size class
+ * instead of back to the heap, so once the pool has grown to the
+ * in-flight window of its CPU, fetching an instruction no longer
+ * allocates.
+ *
+ * Each buffer starts with a header naming its pool, so that a buffer
+ * can be released without knowing which CPU it belongs to. Every buffer
+ * must be released before the pool is destroyed, which is why the CPU
+ * declares its pool before anything holding a DynInst: members are
+ * destroyed in reverse order, so the holders go first.
+ */
+class DynInstPool
+{
+  public:
+    DynInstPool() = default;
+    DynInstPool(const DynInstPool &) = delete;
+    DynInstPool &operator=(const DynInstPool &) = delete;
+    ~DynInstPool();
+
+    /** A buffer of at least size bytes, pool may be null to use the heap */
+    static void *allocate(DynInstPool *pool, size_t size);
+
+    /** Give back a buffer from allocate() */
+    static void release(void *ptr);
+
+    /** Number of buffers handed out and not released yet */
+    size_t inUse() const { return _inUse; }
+
+  private:
+    static constexpr size_t ClassBytes = 64;
+
+    struct alignas(alignof(std::max_align_t)) Header
+    {
+        DynInstPool *pool;
+        uint32_t sizeClass;
+    };
+
+    /** Free buffers, headers included, by size class */
+    std::vector<std::vector<Header *>> freeLists;
+    size_t _inUse = 0;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_DYN_INST_POOL_HH__
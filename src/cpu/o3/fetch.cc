@@ -987,7 +987,7 @@ Fetch::finishTranslation(const Fault &fault, const RequestPtr &mem_req)
         instruction->fault = fault;
         std::unique_ptr<PCStateBase> next_pc(fetch_pc.clone());
         instruction->staticInst->advancePC(*next_pc);
-        set(instruction->predPC, next_pc);
+        instruction->predPC.update(*next_pc);
 
         wroteToTimeBuffer = true;
 
@@ -1014,7 +1014,7 @@ Fetch::doSquash(const PCStateBase &new_pc, const DynInstPtr squashInst, const In
     // restore vtype
     uint8_t restored_vtype = cpu->readMiscReg(RiscvISA::MISCREG_VTYPE, tid);
     for (auto& it : cpu->instList) {
-        if (!it->isSquashed() &&
+        if (it && !it->isSquashed() &&
             it->seqNum <= seqNum &&
             it->staticInst->isVectorConfig()) {
             auto vset = static_cast<RiscvISA::VConfOp*>(it->staticInst.get());
@@ -1586,6 +1586,7 @@ Fetch::buildInst(ThreadID tid, StaticInstPtr staticInst,
     DynInst::Arrays arrays;
     arrays.numSrcs = staticInst->numSrcRegs();
     arrays.numDests = staticInst->numDestRegs();
+    arrays.pool = &cpu->dynInstPool;
 
     // Create a new DynInst from the instruction fetched.
     DynInstPtr instruction = new (arrays) DynInst(
@@ -44,8 +44,9 @@
 
 #include <algorithm>
 #include <array>
+#include <cstdint>
 #include <iostream>
-#include <queue>
+#include <vector>
 
 #include "base/logging.hh"
 #include "base/trace.hh"
@@ -72,44 +73,104 @@ class SimpleFreeList
 {
   private:
 
-    /** The actual free list */
-    std::queue<PhysRegIdPtr> freeRegs;
+    /**
+     * The actual free list, a FIFO ring indexed by the number of
+     * registers taken from and added to it so far. A register taken
+     * stays in its slot until the ring wraps around, so rename can give
+     * back everything allocated since a checkpoint by rewinding the head.
+     */
+    std::vector<PhysRegIdPtr> freeRegs;
+
+    /** Number of registers ever taken from the list. */
+    uint64_t head = 0;
+
+    /** Number of registers ever added to the list. */
+    uint64_t tail = 0;
+
+    PhysRegIdPtr slot(uint64_t pos) const
+    {
+        return freeRegs[pos % freeRegs.size()];
+    }
+
+    /** Makes room for more registers, only while the list is filled. */
+    void
+    grow()
+    {
+        std::vector<PhysRegIdPtr> grown(std::max<size_t>(
+                    2 * freeRegs.size(), 32));
+        uint64_t first = tail - std::min<uint64_t>(tail, freeRegs.size());
+        for (uint64_t pos = first; pos < tail; pos++) {
+            grown[pos % grown.size()] = slot(pos);
+        }
+        freeRegs.swap(grown);
+    }
 
   public:
 
     SimpleFreeList() {};
 
     /** Add a physical register to the free list */
-    void addReg(PhysRegIdPtr reg) { freeRegs.push(reg); }
+    void
+    addReg(PhysRegIdPtr reg)
+    {
+        if (tail - head == freeRegs.size()) {
+            grow();
+        }
+        freeRegs[tail++ % freeRegs.size()] = reg;
+    }
 
     /** Add physical registers to the free list */
     template<class InputIt>
     void
     addRegs(InputIt first, InputIt last) {
         std::for_each(first, last, [this](typename InputIt::value_type& reg) {
-            freeRegs.push(&reg);
+            addReg(&reg);
         });
     }
 
     /** Get the next available register from the free list */
     PhysRegIdPtr getReg()
     {
-        assert(!freeRegs.empty());
-        PhysRegIdPtr free_reg = freeRegs.front();
-        freeRegs.pop();
+        assert(hasFreeRegs());
+        PhysRegIdPtr free_reg = slot(head++);
         DPRINTF(FreeList, "Allocate p%i (%#lx), next free: p%i (%#lx)\n",
                 free_reg->flatIndex(), free_reg,
-                freeRegs.empty() ? -1 : freeRegs.front()->flatIndex(),
-                freeRegs.empty() ? nullptr : freeRegs.front());
+                hasFreeRegs() ? slot(head)->flatIndex() : -1,
+                hasFreeRegs() ? slot(head) : nullptr);
         free_reg->incRef();
         return free_reg;
     }
 
+    /** Position of the next register to allocate. */
+    uint64_t position() const { return head; }
+
+    /** The register allocated at a position not rewound past yet. */
+    PhysRegIdPtr
+    regAt(uint64_t pos) const
+    {
+        assert(pos < head && tail - pos <= freeRegs.size());
+        return slot(pos);
+    }
+
+    /**
+     * Give back all registers allocated from a position on, they are
+     * allocated again in the same order. Only the instructions that
+     * allocated them may hold references to them.
+     */
+    void
+    rewind(uint64_t pos)
+    {
+        assert(pos <= head && tail - pos <= freeRegs.size());
+        for (; head > pos; head--) {
+            slot(head - 1)->clearRef();
+        }
+    }
+
     /** Return the number of free registers on the list. */
-    unsigned numFreeRegs() const { return freeRegs.size(); }
+    unsigned numFreeRegs() const { return tail - head; }
 
     /** True iff there are free registers on the list. */
-    bool hasFreeRegs() const { return !freeRegs.empty(); }
+    bool hasFreeRegs() const { return tail != head; }
 };
 
 
@@ -183,6 +244,32 @@ class UnifiedFreeList
         freeLists[freed_reg->classValue()].addReg(freed_reg);
     }
 
+    /** Positions of the free lists of all register classes. */
+    using Position = std::array<uint64_t, RMiscRegClass + 1>;
+
+    /** Gets the positions of the next registers to allocate. */
+    void
+    position(Position &pos) const
+    {
+        for (size_t i = 0; i < freeLists.size(); i++)
+            pos[i] = freeLists[i].position();
+    }
+
+    /** The register allocated at a position of a register class. */
+    PhysRegIdPtr
+    regAt(RegClassType type, uint64_t pos) const
+    {
+        return freeLists[type].regAt(pos);
+    }
+
+    /** Gives back the registers allocated from the positions on. */
+    void
+    rewind(const Position &pos)
+    {
+        for (size_t i = 0; i < freeLists.size(); i++)
+            freeLists[i].rewind(pos[i]);
+    }
+
     /** Checks if there are any free registers of type type. */
     bool
     hasFreeRegs(RegClassType type) const
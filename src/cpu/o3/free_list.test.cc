@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "cpu/o3/free_list.hh"
+
+using namespace gem5;
+using namespace gem5::o3;
+
+namespace
+{
+
+/** Registers that stay in place as more are made */
+class RegPool
+{
+  public:
+    PhysRegIdPtr
+    make()
+    {
+        RegIndex idx = regs.size();
+        regs.emplace_back(IntRegClass, idx, idx);
+        return &regs.back();
+    }
+
+  private:
+    std::deque<PhysRegId> regs;
+};
+
+/** A register allocated from the list and the position it came from */
+struct Allocation
+{
+    uint64_t pos;
+    PhysRegIdPtr reg;
+};
+
+/**
+ * The free list as rename uses it: registers are allocated in order,
+ * the oldest ones are freed as they commit and the youngest ones are
+ * given back by a squash. The free registers are kept in a queue the
+ * list has to match.
+ */
+class FreeListModel
+{
+  public:
+    void
+    add(PhysRegIdPtr reg)
+    {
+        list.addReg(reg);
+        free.push_back(reg);
+    }
+
+    PhysRegIdPtr
+    allocate()
+    {
+        uint64_t pos = list.position();
+        PhysRegIdPtr reg = list.getReg();
+        EXPECT_EQ(reg, free.front());
+        free.pop_front();
+        inFlight.push_back({pos, reg});
+        return reg;
+    }
+
+    void
+    commit()
+    {
+        PhysRegIdPtr reg = inFlight.front().reg;
+        inFlight.pop_front();
+        reg->decRef();
+        add(reg);
+    }
+
+    /** Squash the youngest count allocations */
+    void
+    squash(size_t count)
+    {
+        ASSERT_LE(count, inFlight.size());
+        uint64_t pos = list.position() - count;
+        list.rewind(pos);
+        for (; count > 0; count--) {
+            EXPECT_EQ(inFlight.back().reg->getRef(), 0);
+            free.push_front(inFlight.back().reg);
+            inFlight.pop_back();
+        }
+        EXPECT_EQ(list.position(), pos);
+    }
+
+    /** The list has the free registers and the ones in flight */
+    void
+    check() const
+    {
+        ASSERT_EQ(list.numFreeRegs(), free.size());
+        ASSERT_EQ(list.hasFreeRegs(), !free.empty());
+        for (const auto &alloc : inFlight) {
+            ASSERT_EQ(list.regAt(alloc.pos), alloc.reg);
+        }
+    }
+
+    SimpleFreeList list;
+    std::deque<PhysRegIdPtr> free;
+    std::deque<Allocation> inFlight;
+};
+
+} // anonymous namespace
+
+/**
+ * Registers squashed after the ring wrapped around come back first and
+ * in the order they were allocated in.
+ */
+TEST(SimpleFreeListTest, RewindAcrossWrapAround)
+{
+    RegPool pool;
+    FreeListModel model;
+    for (int i = 0; i < 32; i++) {
+        model.add(pool.make());
+    }
+
+    for (int i = 0; i < 20; i++) {
+        model.allocate();
+    }
+    for (int i = 0; i < 20; i++) {
+        model.commit();
+    }
+    // positions 20 to 39 are in slots 20 to 31 and 0 to 7
+    std::vector<PhysRegIdPtr> allocated;
+    for (int i = 0; i < 20; i++) {
+        allocated.push_back(model.allocate());
+    }
+    model.check();
+
+    model.squash(15);
+    model.check();
+    ASSERT_EQ(model.list.position(), 25);
+    ASSERT_EQ(model.list.regAt(24), allocated[4]);
+    for (int i = 5; i < 20; i++) {
+        ASSERT_EQ(model.allocate(), allocated[i]);
+        ASSERT_EQ(allocated[i]->getRef(), 1);
+    }
+    model.check();
+}
+
+/**
+ * Growing the list while the ring has wrapped keeps the free registers
+ * in order, and rewinding works across the grown ring.
+ */
+TEST(SimpleFreeListTest, RewindAfterGrow)
+{
+    RegPool pool;
+    FreeListModel model;
+    for (int i = 0; i < 32; i++) {
+        model.add(pool.make());
+    }
+    for (int i = 0; i < 45; i++) {
+        model.allocate();
+        model.commit();
+    }
+
+    // the ring is full and wrapped, so adding grows it
+    for (int i = 0; i < 20; i++) {
+        model.add(pool.make());
+    }
+    model.check();
+
+    std::vector<PhysRegIdPtr> allocated;
+    for (int i = 0; i < 50; i++) {
+        allocated.push_back(model.allocate());
+    }
+    model.squash(40);
+    model.check();
+    for (int i = 10; i < 30; i++) {
+        ASSERT_EQ(model.allocate(), allocated[i]);
+    }
+    model.check();
+
+    // wrap the grown ring around and squash across its end
+    for (int i = 0; i < 30; i++) {
+        model.commit();
+    }
+    for (int i = 0; i < 50; i++) {
+        model.allocate();
+    }
+    model.check();
+    model.squash(45);
+    model.check();
+    for (int i = 0; i < 45; i++) {
+        model.allocate();
+    }
+    model.check();
+}
+
+/**
+ * Allocate, commit and squash at random, adding registers while none
+ * are in flight as the CPU does, and check the list against the model
+ * after every step.
+ */
+TEST(SimpleFreeListTest, RandomAgainstModel)
+{
+    std::mt19937_64 rng(0xf1ee);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    RegPool pool;
+    FreeListModel model;
+    for (int i = 0; i < 8; i++) {
+        model.add(pool.make());
+    }
+    int num_regs = 8;
+
+    for (int step = 0; step < 100000; step++) {
+        switch (rand(8)) {
+          case 0:
+          case 1:
+          case 2:
+            if (model.list.hasFreeRegs()) {
+                model.allocate();
+            }
+            break;
+          case 3:
+          case 4:
+            if (!model.inFlight.empty()) {
+                model.commit();
+            }
+            break;
+          case 5:
+            if (!model.inFlight.empty()) {
+                model.squash(1 + rand(model.inFlight.size()));
+            }
+            break;
+          default:
+            if (model.inFlight.empty() && num_regs < 200) {
+                for (int n = rand(40); n > 0; n--, num_regs++) {
+                    model.add(pool.make());
+                }
+            }
+        }
+        model.check();
+        if (HasFatalFailure() || HasNonfatalFailure()) {
+            FAIL() << "step " << step;
+        }
+    }
+}
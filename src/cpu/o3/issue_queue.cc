@@ -1,5 +1,6 @@
 #include "cpu/o3/issue_queue.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -115,7 +116,10 @@ IssueQue::IssueQue(const IssueQueParams& params)
       iqsize(params.size),
       scheduleToExecDelay(params.scheduleToExecDelay),
       iqname(params.name),
-      inflightIssues(scheduleToExecDelay, 0)
+      inflightIssues(scheduleToExecDelay, 0),
+      useAgeMatrix(params.selectPolicy == enums::IQSelectPolicy::age_matrix),
+      // FMAMulOp halves are not counted in iqsize, but still take a slot
+      ages(useAgeMatrix ? 2 * params.size : 0)
 {
     toIssue = inflightIssues.getWire(0);
     toFu = inflightIssues.getWire(-scheduleToExecDelay);
@@ -169,8 +173,19 @@ IssueQue::IssueQue(const IssueQueParams& params)
         }
     }
 
+    if (useAgeMatrix) {
+        slots.resize(ages.size());
+        for (int pi = 0; pi < (same_fu ? 1 : outports); pi++) {
+            allReadyMasks.push_back(new AgeMatrix::Bitmap(ages.size()));
+        }
+        for (int pi = 0; pi < outports; pi++) {
+            readyMasks.push_back(allReadyMasks[same_fu ? 0 : pi]);
+        }
+    }
+
     opNum.resize(Num_OpClasses, 0);
     readyQclassify.resize(Num_OpClasses, nullptr);
+    readyMaskClassify.resize(Num_OpClasses, nullptr);
     opPipelined.resize(Num_OpClasses, false);
     for (int pi = 0; pi < (same_fu ? 1 : outports); pi++) {
         auto& port = params.oports[pi];
@@ -181,6 +196,9 @@ IssueQue::IssueQue(const IssueQueParams& params)
                           enums::OpClassStrings[op->opClass]);
                 }
                 readyQclassify[op->opClass] = readyQs.at(pi);
+                if (useAgeMatrix) {
+                    readyMaskClassify[op->opClass] = readyMasks.at(pi);
+                }
                 opPipelined[op->opClass] = op->pipelined;
             }
         }
@@ -235,6 +253,9 @@ IssueQue::addToFu(const DynInstPtr& inst)
     }
     inst->setIssued();
     POPINST(inst);
+    if (useAgeMatrix) {
+        releaseSlot(inst);
+    }
     scheduler->addToFU(inst);
 }
 
@@ -279,9 +300,17 @@ bool
 IssueQue::idle()
 {
     bool idle = false;
-    for (auto it : readyQs) {
-        if (it->size()) {
-            idle = true;
+    if (useAgeMatrix) {
+        for (auto it : allReadyMasks) {
+            if (it->any()) {
+                idle = true;
+            }
+        }
+    } else {
+        for (auto it : readyQs) {
+            if (it->size()) {
+                idle = true;
+            }
         }
     }
     idle |= replayQ.size() > 0;
@@ -355,10 +384,73 @@ IssueQue::addIfReady(const DynInstPtr& inst)
         DPRINTF(Schedule, "[sn:%llu] add to readyInstsQue\n", inst->seqNum);
         inst->clearCancel();
         if (!inst->inReadyQ()) {
-            inst->setInReadyQ();
-            readyQclassify[inst->opClass()]->push(inst);
+            pushReady(inst);
+        }
+    }
+}
+
+void
+IssueQue::pushReady(const DynInstPtr& inst)
+{
+    inst->setInReadyQ();
+    if (useAgeMatrix) {
+        panic_if(inst->iqSlot < 0, "%s: [sn:%llu] is ready but holds no slot\n", iqname, inst->seqNum);
+        readyMaskClassify[inst->opClass()]->set(inst->iqSlot);
+    } else {
+        readyQclassify[inst->opClass()]->push(inst);
+    }
+}
+
+const DynInstPtr&
+IssueQue::topReady(int pi)
+{
+    if (useAgeMatrix) {
+        auto& mask = *readyMasks[pi];
+        for (size_t slot = ages.oldest(mask); slot != AgeMatrix::npos; slot = ages.oldest(mask)) {
+            auto& inst = slots[slot];
+            if (!inst->canceled()) {
+                return inst;
+            }
+            inst->clearInReadyQ();
+            mask.reset(slot);
+        }
+        return nullInst;
+    }
+
+    auto readyQ = readyQs[pi];
+    while (!readyQ->empty()) {
+        auto& top = readyQ->top();
+        if (!top->canceled()) {
+            return top;
         }
+        top->clearInReadyQ();
+        readyQ->pop();
     }
+    return nullInst;
+}
+
+void
+IssueQue::popReady(int pi, const DynInstPtr& inst)
+{
+    if (useAgeMatrix) {
+        readyMasks[pi]->reset(inst->iqSlot);
+    } else {
+        readyQs[pi]->pop();
+    }
+}
+
+void
+IssueQue::releaseSlot(const DynInstPtr& inst)
+{
+    int slot = inst->iqSlot;
+    assert(slot >= 0);
+    for (auto mask : allReadyMasks) {
+        mask->reset(slot);
+    }
+    inst->clearInReadyQ();
+    inst->iqSlot = -1;
+    ages.free(slot);
+    slots[slot] = nullptr;
 }
 
 void
@@ -381,17 +473,8 @@ IssueQue::selectInst()
 {
     selectQ.clear();
     for (int pi = 0; pi < outports; pi++) {
-        auto readyQ = readyQs[pi];
-        while (!readyQ->empty()) {
-            auto top = readyQ->top();
-            if (!top->canceled()) {
-                break;
-            }
-            top->clearInReadyQ();
-            readyQ->pop();
-        }
-        if (!readyQ->empty()) {
-            auto inst = readyQ->top();
+        auto& inst = topReady(pi);
+        if (inst) {
             if (portBusy[pi] & (1llu << scheduler->getCorrectedOpLat(inst))) {
                 continue;
             }
@@ -416,7 +499,8 @@ IssueQue::selectInst()
 
             selectQ.push_back(std::make_pair(pi, inst));
             inst->clearInReadyQ();
-            readyQ->pop();
+            // the reference may be to the heap top, so pop last
+            popReady(pi, inst);
         }
     }
 }
@@ -434,8 +518,7 @@ IssueQue::scheduleInst()
             DPRINTF(Schedule, "[sn:%llu] arbitration failed, retry\n", inst->seqNum);
             iqstats->arbFailed++;
             assert(inst->readyToIssue());
-            inst->setInReadyQ();
-            readyQclassify[inst->opClass()]->push(inst);  // retry
+            pushReady(inst);  // retry
         } else [[likely]] {
             DPRINTF(Schedule, "[sn:%llu] no conflict, scheduled\n", inst->seqNum);
             iqstats->portissued[pi]++;
@@ -489,6 +572,7 @@ IssueQue::full()
 {
     bool full = instNum >= iqsize;
     full |= replayQ.size() > replayQsize;
+    full |= useAgeMatrix && ages.full();
     if (full) {
         DPRINTF(Schedule, "has full!\n");
     }
@@ -509,6 +593,12 @@ IssueQue::insert(const DynInstPtr& inst)
 
     DPRINTF(Schedule, "[sn:%llu] %s insert into %s\n", inst->seqNum, enums::OpClassStrings[inst->opClass()], iqname);
     inst->issueQue = this;
+    if (useAgeMatrix) {
+        // squashSlots relies on instList being in program order
+        assert(instList.empty() || instList.back()->seqNum < inst->seqNum);
+        inst->iqSlot = ages.allocate();
+        slots[inst->iqSlot] = inst;
+    }
     instList.emplace_back(inst);
     bool addToDepGraph = false;
     for (int i = 0; i < inst->numSrcRegs(); i++) {
@@ -561,26 +651,78 @@ IssueQue::doCommit(const InstSeqNum seqNum)
 }
 
 void
-IssueQue::doSquash(const InstSeqNum seqNum)
+IssueQue::squashSlots(const InstSeqNum seqNum)
 {
-    for (auto it = instList.begin(); it != instList.end();) {
-        if ((*it)->seqNum > seqNum) {
-            if (!(*it)->isIssued()) {
-                POPINST((*it));
-                (*it)->setIssued();
-            }
-            if ((*it)->isScheduled() && !opPipelined[(*it)->opClass()]) {
-                portBusy[(*it)->issueportid] = 0;
+    // the squashed insts are the youngest, at the back of instList
+    AgeMatrix::Bitmap squashed(ages.size());
+    while (!instList.empty() && instList.back()->seqNum > seqNum) {
+        auto& inst = instList.back();
+        if (!inst->isIssued()) {
+            POPINST(inst);
+            inst->setIssued();
+        }
+        if (inst->isScheduled() && !opPipelined[inst->opClass()]) {
+            portBusy[inst->issueportid] = 0;
+        }
+
+        inst->setSquashedInIQ();
+        inst->setCanCommit();
+        inst->clearScheduled();
+        inst->setCancel();
+        if (inst->iqSlot >= 0) {
+            squashed.set(inst->iqSlot);
+            slots[inst->iqSlot] = nullptr;
+            inst->clearInReadyQ();
+            inst->iqSlot = -1;
+        }
+
+        // a consumer only waits in the depGraph of its own sources
+        for (int i = 0; i < inst->numSrcRegs(); i++) {
+            auto src = inst->renamedSrcIdx(i);
+            if (src->isFixedMapping()) {
+                continue;
             }
+            auto& entrys = subDepGraph[src->flatIndex()];
+            entrys.erase(std::remove_if(entrys.begin(), entrys.end(),
+                                        [](const std::pair<int, DynInstPtr>& e) { return e.second->isSquashed(); }),
+                         entrys.end());
+        }
 
-            (*it)->setSquashedInIQ();
-            (*it)->setCanCommit();
-            (*it)->clearScheduled();
-            (*it)->setCancel();
-            it = instList.erase(it);
-            assert(instList.size() >= instNum);
-        } else {
-            it++;
+        instList.pop_back();
+        assert(instList.size() >= instNum);
+    }
+
+    for (auto mask : allReadyMasks) {
+        *mask -= squashed;
+    }
+    ages.free(squashed);
+}
+
+void
+IssueQue::doSquash(const InstSeqNum seqNum)
+{
+    if (useAgeMatrix) {
+        squashSlots(seqNum);
+    } else {
+        for (auto it = instList.begin(); it != instList.end();) {
+            if ((*it)->seqNum > seqNum) {
+                if (!(*it)->isIssued()) {
+                    POPINST((*it));
+                    (*it)->setIssued();
+                }
+                if ((*it)->isScheduled() && !opPipelined[(*it)->opClass()]) {
+                    portBusy[(*it)->issueportid] = 0;
+                }
+
+                (*it)->setSquashedInIQ();
+                (*it)->setCanCommit();
+                (*it)->clearScheduled();
+                (*it)->setCancel();
+                it = instList.erase(it);
+                assert(instList.size() >= instNum);
+            } else {
+                it++;
+            }
         }
     }
 
@@ -594,6 +736,11 @@ IssueQue::doSquash(const InstSeqNum seqNum)
         }
     }
 
+    if (useAgeMatrix) {
+        // squashSlots has cleared the depGraph
+        return;
+    }
+
     // clear in depGraph
     for (auto& entrys : subDepGraph) {
         for (auto it = entrys.begin(); it != entrys.end();) {
@@ -14,6 +14,7 @@
 #include "base/statistics.hh"
 #include "base/stats/group.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/o3/age_matrix.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/reg_class.hh"
@@ -114,6 +115,17 @@ class IssueQue : public SimObject
     std::vector<ReadyQue*> readyQclassify;
     // s0: wakeup inst, add ready inst to readyInstsQue
     std::vector<ReadyQue*> readyQs;
+
+    // selectPolicy = age_matrix: insts waiting to issue sit in fixed
+    // slots, and the ready queues above are replaced by bitmaps of slots
+    const bool useAgeMatrix;
+    AgeMatrix ages;
+    std::vector<DynInstPtr> slots;
+    std::vector<AgeMatrix::Bitmap*> readyMaskClassify;
+    std::vector<AgeMatrix::Bitmap*> readyMasks;
+    // unique ready bitmaps, as readyMasks may share one between ports
+    std::vector<AgeMatrix::Bitmap*> allReadyMasks;
+    const DynInstPtr nullInst;
     // s1: schedule readyInsts
     SelectQue selectQ;
 
@@ -149,6 +161,13 @@ class IssueQue : public SimObject
     void addIfReady(const DynInstPtr& inst);
     void cancel(const DynInstPtr& inst);
 
+    void pushReady(const DynInstPtr& inst);
+    // oldest ready inst of the port after dropping canceled ones, or null
+    const DynInstPtr& topReady(int pi);
+    void popReady(int pi, const DynInstPtr& inst);
+    void releaseSlot(const DynInstPtr& inst);
+    void squashSlots(const InstSeqNum seqNum);
+
   public:
     inline void clearBusy(uint32_t pi) { portBusy.at(pi) = 0; }
 
@@ -49,6 +49,7 @@
 #include <string>
 
 #include "base/compiler.hh"
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/trace.hh"
 #include "base/types.hh"
@@ -1379,12 +1380,37 @@ LSQ::LSQRequest::addReq(Addr addr, unsigned size,
 void
 LSQ::LSQRequest::forward()
 {
-    if (!isLoad() || !needWBToRegister() || forwardPackets.empty()) return;
+    if (!isLoad() || !needWBToRegister() ||
+        std::none_of(forwardMask.begin(), forwardMask.end(),
+                     [](uint64_t bits) { return bits; })) {
+        return;
+    }
     DPRINTF(StoreBuffer, "sbuffer forward data\n");
     _sbufferBypass = true;
-    for (auto& p : forwardPackets)
-    {
-        _inst->memData[p.idx] = p.byte;
+    for (size_t word = 0; word < forwardMask.size(); word++) {
+        const unsigned offset = word * 64;
+        maskedCopy(_inst->memData + offset, forwardData.data() + offset,
+                   forwardMask[word], std::min(_size - offset, 64U));
+    }
+}
+
+void
+LSQ::LSQRequest::recordForward(int offset, const uint8_t *data,
+                               uint64_t byte_mask, unsigned size)
+{
+    assert(size <= 64 && offset + size <= _size);
+    assert(size == 64 || (byte_mask >> size) == 0);
+    if (forwardData.empty()) {
+        forwardData.resize(_size);
+        forwardMask.resize(divCeil(_size, 64));
+    }
+    maskedCopy(forwardData.data() + offset, data, byte_mask, size);
+
+    const unsigned word = offset / 64;
+    const unsigned shift = offset % 64;
+    forwardMask[word] |= byte_mask << shift;
+    if (shift && word + 1 < forwardMask.size()) {
+        forwardMask[word + 1] |= byte_mask >> (64 - shift);
     }
 }
 
@@ -42,6 +42,7 @@
 #ifndef __CPU_O3_LSQ_HH__
 #define __CPU_O3_LSQ_HH__
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <list>
@@ -304,12 +305,30 @@ class LSQ
         bool _hasStaleTranslation;
         bool _sbufferBypass;
 
-        struct FWDPacket
+        /**
+         * Bytes forwarded from the store buffer, by offset in the
+         * request, and one bit per byte telling which are forwarded.
+         */
+        std::vector<uint8_t> forwardData;
+        std::vector<uint64_t> forwardMask;
+
+        /**
+         * Record store buffer bytes to forward, later records of a byte
+         * override earlier ones.
+         * @param offset Offset in the request of the first byte.
+         * @param data The bytes.
+         * @param byte_mask Bit i set means byte i is forwarded.
+         * @param size Number of bytes, at most 64.
+         */
+        void recordForward(int offset, const uint8_t *data,
+                           uint64_t byte_mask, unsigned size);
+
+        /** Forget the bytes recorded to forward */
+        void
+        clearForward()
         {
-            int idx;
-            uint8_t byte;
-        };
-        std::vector<FWDPacket> forwardPackets;
+            std::fill(forwardMask.begin(), forwardMask.end(), 0);
+        }
 
       protected:
         LSQUnit* lsqUnit() { return &_port; }
@@ -45,6 +45,8 @@
 
 #include "arch/generic/debugfaults.hh"
 #include "arch/riscv/faults.hh"
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/str.hh"
 #include "base/trace.hh"
@@ -81,9 +83,8 @@ namespace o3
 void
 StoreBufferEntry::reset(uint64_t block_vaddr, uint64_t block_paddr, uint64_t offset, uint8_t *datas, uint64_t size)
 {
-    std::fill(validMask.begin(), validMask.begin() + offset, false);
-    std::fill(validMask.begin() + offset, validMask.begin() + offset + size, true);
-    std::fill(validMask.begin() + offset + size, validMask.end(), false);
+    assert(offset + size <= lineSize);
+    validMask = mask(size) << offset;
     memcpy(blockDatas.data() + offset, datas, size);
 
     this->blockVaddr = block_vaddr;
@@ -96,39 +97,47 @@ StoreBufferEntry::reset(uint64_t block_vaddr, uint64_t block_paddr, uint64_t off
 void
 StoreBufferEntry::merge(uint64_t offset, uint8_t *datas, uint64_t size)
 {
-    assert(offset + size <= validMask.size());
-    for (uint64_t i = 0; i < size; ++i) {
-        blockDatas[offset + i] = datas[i];
-        validMask[offset + i] = true;
-    }
+    assert(offset + size <= lineSize);
+    memcpy(blockDatas.data() + offset, datas, size);
+    validMask |= mask(size) << offset;
 }
 
 bool
 StoreBufferEntry::recordForward(RequestPtr req, LSQ::LSQRequest *lsqreq)
 {
-    int offset = req->getPaddr() & (validMask.size() - 1);
+    int offset = req->getPaddr() & (lineSize - 1);
     // the offset in the split request
     int goffset = req->getVaddr() - lsqreq->mainReq()->getVaddr();
     if (goffset > 0) {
         assert(offset == 0);
     }
-    bool full_forward = true;
-    for (int i = 0; i < req->getSize(); i++) {
-        assert(goffset + i < lsqreq->_size);
-        if (vice && vice->validMask[offset + i]) {
-            // vice is newer
-            assert(vice->blockVaddr == blockVaddr);
-            lsqreq->forwardPackets.push_back(
-                LSQ::LSQRequest::FWDPacket{.idx = goffset + i, .byte = vice->blockDatas[offset + i]});
-        } else if (validMask[offset + i]) {
-            lsqreq->forwardPackets.push_back(
-                LSQ::LSQRequest::FWDPacket{.idx = goffset + i, .byte = blockDatas[offset + i]});
-        } else {
-            full_forward = false;
-        }
+    const unsigned size = req->getSize();
+    assert(goffset + size <= lsqreq->_size);
+    const uint64_t wanted = mask(size);
+
+    uint64_t forwarded = (validMask >> offset) & wanted;
+    lsqreq->recordForward(goffset, blockDatas.data() + offset, forwarded,
+                          size);
+    if (vice) {
+        // vice is newer
+        assert(vice->blockVaddr == blockVaddr);
+        uint64_t vice_forwarded = (vice->validMask >> offset) & wanted;
+        lsqreq->recordForward(goffset, vice->blockDatas.data() + offset,
+                              vice_forwarded, size);
+        forwarded |= vice_forwarded;
     }
 
-    return full_forward;
+    return forwarded == wanted;
+}
+
+std::vector<bool>
+StoreBufferEntry::byteEnable() const
+{
+    std::vector<bool> byte_enable(lineSize);
+    for (unsigned i = 0; i < lineSize; i++) {
+        byte_enable[i] = bits(validMask, i);
+    }
+    return byte_enable;
 }
 
 void
@@ -137,10 +146,8 @@ StoreBuffer::setData(std::vector<StoreBufferEntry *> &data_vec)
     this->data_vec = data_vec;
     int way = data_vec.size();
     _size = 0;
-    lru_index.set_capacity(way);
-    free_list.set_capacity(way);
-    crossRef.resize(way);
-    data_vec.resize(way);
+    lines.init(way);
+    free_list.reserve(way);
     data_vld.resize(way, false);
     for (uint64_t i = 0; i < way; i++) {
         free_list.push_back(i);
@@ -162,7 +169,7 @@ StoreBuffer::size()
 uint64_t
 StoreBuffer::unsentSize()
 {
-    return lru_index.size();
+    return lines.lruSize();
 }
 
 StoreBufferEntry *
@@ -179,39 +186,38 @@ StoreBuffer::insert(int index, uint64_t addr)
 {
     assert(_size < data_vec.size());
     assert(!data_vld[index]);
-    assert(!lru_index.full());
+    assert(lines.lruSize() < data_vec.size());
+    assert(data_vec[index]->blockPaddr == addr);
     _size++;
-    auto [it, _] = data_map.insert({addr, data_vec[index]});
-    crossRef[index] = it;
+    lines.insertLine(index, addr);
     data_vld[index] = true;
-    lru_index.push_front(index);
+    lines.lruPushFront(index);
 }
 
 StoreBufferEntry *
 StoreBuffer::get(uint64_t addr)
 {
-    auto iter = data_map.find(addr);
-    if (iter == data_map.end()) {
+    int index = lines.findLine(addr);
+    if (index == StoreBufferIndex::NoEntry) {
         return nullptr;
     }
-    assert(data_vld[iter->second->index]);
-    return iter->second;
+    assert(data_vld[index]);
+    return data_vec[index];
 }
 
 void
 StoreBuffer::update(int index)
 {
-    assert(std::find(lru_index.begin(), lru_index.end(), index) != lru_index.end());
-    lru_index.erase(std::find(lru_index.begin(), lru_index.end(), index));
-    lru_index.push_front(index);
+    lines.lruRemove(index);
+    lines.lruPushFront(index);
 }
 
 StoreBufferEntry *
 StoreBuffer::getEvict()
 {
-    assert(lru_index.size() > 0);
-    uint64_t index = lru_index.back();
-    lru_index.pop_back();
+    assert(lines.lruSize() > 0);
+    uint64_t index = lines.lruTail();
+    lines.lruRemove(index);
     assert(data_vld[index]);
     return data_vec[index];
 }
@@ -235,16 +241,15 @@ StoreBuffer::release(StoreBufferEntry *entry)
     _size--;
     int index = entry->index;
     data_vld[index] = false;
-    data_map.erase(crossRef[index]);
+    lines.removeLine(index);
     assert(std::find(free_list.begin(), free_list.end(), index) == free_list.end());
     free_list.push_back(index);
     if (entry->vice) {
         // make vice regular
         auto vice = entry->vice;
         assert(data_vld[vice->index]);
-        auto [it, _] = data_map.insert({vice->blockPaddr, vice});
-        crossRef[vice->index] = it;
-        lru_index.push_front(vice->index);
+        lines.insertLine(vice->index, vice->blockPaddr);
+        lines.lruPushFront(vice->index);
     }
 }
 
@@ -443,6 +448,7 @@ LSQUnit::LSQUnit(uint32_t lqEntries, uint32_t sqEntries, uint32_t sbufferEntries
       sbufferEntries(sbufferEntries),
       storeBufferWritebackInactive(0),
       storeBufferInactiveThreshold(storeBufferInactiveThreshold),
+      storeFwdIndex(sqEntries),
       lsqID(-1),
       storeQueue(sqEntries),
       loadQueue(lqEntries),
@@ -550,6 +556,7 @@ LSQUnit::resetState()
     htmStarts = htmStops = 0;
 
     storeWBIt = storeQueue.begin();
+    storeFwdIndex.clear();
 
     retryPkt = NULL;
     memDepViolator = NULL;
@@ -2008,7 +2015,7 @@ LSQUnit::storeBufferEvictToCache()
         if (debug::StoreBuffer) {
             DPRINTFR(StoreBuffer, "Dumping sbuffer entry data\n");
             for (int i = 0; i < cacheLineSize(); i++) {
-                DPRINTFR(StoreBuffer, "%s%d ", entry->validMask[i] ? "" : "!", (uint32_t)entry->blockDatas[i]);
+                DPRINTFR(StoreBuffer, "%s%d ", bits(entry->validMask, i) ? "" : "!", (uint32_t)entry->blockDatas[i]);
             }
             DPRINTFR(StoreBuffer, "\n");
         }
@@ -2017,7 +2024,7 @@ LSQUnit::storeBufferEvictToCache()
         assert(entry->request == nullptr);
 
         entry->request = new LSQ::SbufferRequest(cpu, this, entry->blockPaddr, entry->blockDatas.data());
-        entry->request->addReq(entry->blockVaddr, entry->blockPaddr, entry->validMask);
+        entry->request->addReq(entry->blockVaddr, entry->blockPaddr, entry->byteEnable());
         entry->request->buildPackets();
         entry->request->sbuffer_entry = entry;
         bool success = entry->request->sendPacketToCache();
@@ -2161,6 +2168,7 @@ LSQUnit::squash(const InstSeqNum &squashed_num)
         // Must delete request now that it wasn't handed off to
         // memory.  This is quite ugly.  @todo: Figure out the proper
         // place to really handle request deletes.
+        storeFwdIndex.remove(storeQueue.tail());
         storeQueue.back().clear();
 
         storeQueue.pop_back();
@@ -2338,6 +2346,7 @@ LSQUnit::completeStore(typename StoreQueue::iterator store_idx, bool from_sbuffe
 
     if (store_idx == storeQueue.begin()) {
         do {
+            storeFwdIndex.remove(storeQueue.head());
             storeQueue.front().clear();
             storeQueue.pop_front();
         } while (storeQueue.front().completed() &&
@@ -2785,13 +2794,18 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
         return NoFault;
     }
 
-    // Check the SQ for any previous stores that might lead to forwarding
-    auto store_it = load_inst->sqIt;
-    assert (store_it >= storeWBIt);
-    // End once we've reached the top of the LSQ
-    while (store_it != storeWBIt && !load_inst->isDataPrefetch()) {
-        // Move the index to one younger
-        store_it--;
+    // Check the SQ for any previous stores that might lead to forwarding,
+    // only those writing the bytes of the load may
+    assert (load_inst->sqIt >= storeWBIt);
+    fwdCandidates.clear();
+    if (!load_inst->isDataPrefetch()) {
+        storeFwdIndex.find(request->mainReq()->getVaddr(),
+                           request->mainReq()->getSize(), storeWBIt.idx(),
+                           load_inst->sqIt.idx(), fwdCandidates);
+    }
+    // From the youngest to the oldest
+    for (size_t store_idx : fwdCandidates) {
+        auto store_it = storeQueue.getIterator(store_idx);
         assert(store_it->valid());
         assert(store_it->instruction()->seqNum < load_inst->seqNum);
         int store_size = store_it->size();
@@ -2811,11 +2825,6 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
             auto st_s = store_it->instruction()->effAddr;
             auto st_e = st_s + store_size;
 
-            bool store_has_lower_limit = req_s >= st_s;
-            bool store_has_upper_limit = req_e <= st_e;
-            bool lower_load_has_store_part = req_s < st_e;
-            bool upper_load_has_store_part = req_e > st_s;
-
             DPRINTF(LSQUnit, "req_s:%x,req_e:%x,st_s:%x,st_e:%x\n", req_s,
                     req_e, st_s, st_e);
             DPRINTF(LSQUnit, "store_size:%x,store_pc:%s,req_size:%x,req_pc:%s\n",
@@ -2823,47 +2832,12 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
                     request->mainReq()->getSize(),
                     request->instruction()->pcState());
 
-            auto coverage = AddrRangeCoverage::NoAddrRangeCoverage;
-
-            // If the store entry is not atomic (atomic does not have valid
-            // data), the store has all of the data needed, and
-            // the load is not LLSC, then
-            // we can forward data from the store to the load
-            if ((!store_it->instruction()->isAtomic() &&
-                 store_has_lower_limit && store_has_upper_limit &&
-                 !request->mainReq()->isLLSC()) &&
-                (!((req_s > req_e) || (st_s > st_e)))) {
-                const auto &store_req = store_it->request()->mainReq();
-                coverage = store_req->isMasked()
-                               ? AddrRangeCoverage::PartialAddrRangeCoverage
-                               : AddrRangeCoverage::FullAddrRangeCoverage;
-            } else if ((!((req_s > req_e) || (st_s > st_e))) &&
-                       (
-                           // This is the partial store-load forwarding case
-                           // where a store has only part of the load's data
-                           // and the load isn't LLSC
-                           (!request->mainReq()->isLLSC() &&
-                            ((store_has_lower_limit &&
-                              lower_load_has_store_part) ||
-                             (store_has_upper_limit &&
-                              upper_load_has_store_part) ||
-                             (lower_load_has_store_part &&
-                              upper_load_has_store_part))) ||
-                           // The load is LLSC, and the store has all or part
-                           // of the load's data
-                           (request->mainReq()->isLLSC() &&
-                            ((store_has_lower_limit ||
-                              upper_load_has_store_part) &&
-                             (store_has_upper_limit ||
-                              lower_load_has_store_part))) ||
-                           // The store entry is atomic and has all or part of
-                           // the load's data
-                           (store_it->instruction()->isAtomic() &&
-                            ((store_has_lower_limit ||
-                              upper_load_has_store_part) &&
-                             (store_has_upper_limit ||
-                              lower_load_has_store_part))))) {
-
+            // A masked store may not write all the bytes of its range
+            auto coverage = storeCoverage(
+                req_s, req_e, st_s, st_e, request->mainReq()->isLLSC(),
+                store_it->instruction()->isAtomic());
+            if (coverage == AddrRangeCoverage::FullAddrRangeCoverage &&
+                store_it->request()->mainReq()->isMasked()) {
                 coverage = AddrRangeCoverage::PartialAddrRangeCoverage;
             }
 
@@ -2961,7 +2935,7 @@ LSQUnit::read(LSQRequest *request, ssize_t load_idx)
                 return NoFault;
             }
             // if not fully forward, need to clear buffer
-            request->forwardPackets.clear();
+            request->clearForward();
         }
     }
 
@@ -3039,6 +3013,8 @@ LSQUnit::write(LSQRequest *request, uint8_t *data, ssize_t store_idx)
         request->mainReq()->getFlags() & Request::STORE_NO_DATA;
     storeQueue[store_idx].isAllZeros() = store_no_data;
     assert(size <= SQEntry::DataSize || store_no_data);
+    storeFwdIndex.insert(store_idx,
+                         storeQueue[store_idx].instruction()->effAddr, size);
 
     // copy data into the storeQueue only if the store request has valid data
     if (!(request->req()->getFlags() & Request::CACHE_BLOCK_ZERO) &&
@@ -43,6 +43,7 @@
 #define __CPU_O3_LSQ_UNIT_HH__
 
 #include <algorithm>
+#include <array>
 #include <bitset>
 #include <cstdint>
 #include <cstring>
@@ -52,7 +53,6 @@
 #include <vector>
 
 #include <base/logging.hh>
-#include <boost/circular_buffer.hpp>
 
 #include "arch/generic/debugfaults.hh"
 #include "arch/generic/vec_reg.hh"
@@ -65,6 +65,8 @@
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/limits.hh"
 #include "cpu/o3/lsq.hh"
+#include "cpu/o3/store_buffer_index.hh"
+#include "cpu/o3/store_fwd_index.hh"
 #include "cpu/timebuf.hh"
 #include "debug/HtmCpu.hh"
 #include "debug/LSQUnit.hh"
@@ -84,11 +86,16 @@ class IEW;
 class StoreBufferEntry
 {
   public:
+    /** Widest line whose valid bytes fit in validMask */
+    static constexpr unsigned MaxLineSize = 64;
+
     const int index;
+    const unsigned lineSize;
     Addr blockVaddr;
     Addr blockPaddr;
-    std::vector<uint8_t> blockDatas;
-    std::vector<bool> validMask;
+    std::array<uint8_t, MaxLineSize> blockDatas{};
+    // bit i is set if byte i of blockDatas has been written
+    uint64_t validMask = 0;
     bool sending;
     // the another same addr entry when sending
     // another cannot sending until self sending finished
@@ -96,9 +103,9 @@ class StoreBufferEntry
     // merged request
     LSQ::SbufferRequest* request = nullptr;
 
-    StoreBufferEntry(int size, int index) : index(index) {
-        blockDatas.resize(size, 0);
-        validMask.resize(size, false);
+    StoreBufferEntry(int size, int index) : index(index), lineSize(size) {
+        fatal_if(size > MaxLineSize,
+                 "Store buffer lines are at most %d bytes", MaxLineSize);
     }
 
     void reset(uint64_t blockVaddr, uint64_t blockPaddr, uint64_t offset, uint8_t* datas, uint64_t size);
@@ -106,18 +113,17 @@ class StoreBufferEntry
     void merge(uint64_t offset, uint8_t* datas, uint64_t size);
 
     bool recordForward(RequestPtr req, LSQ::LSQRequest* lsqreq);
+
+    /** Byte enable of the line for writing it to the cache */
+    std::vector<bool> byteEnable() const;
 };
 
 class StoreBuffer
 {
-    using mapIter = typename std::unordered_map<int, StoreBufferEntry*>::iterator;
-
-    // key = (paddr & cacheblockmask)
     uint64_t _size;
-    std::unordered_map<int, StoreBufferEntry*> data_map;
-    std::vector<mapIter> crossRef;
-    boost::circular_buffer<int> lru_index;
-    boost::circular_buffer<int> free_list;
+    // which entry holds a line, and the unsent entries in LRU order
+    StoreBufferIndex lines;
+    std::vector<int> free_list;
     std::vector<StoreBufferEntry*> data_vec;
     std::vector<bool> data_vld;
 
@@ -277,13 +283,11 @@ class LSQUnit
 
     StoreBufferEntry* blockedsbufferEntry = nullptr;
 
-    /** Coverage of one address range with another */
-    enum class AddrRangeCoverage
-    {
-        PartialAddrRangeCoverage, /* Two ranges partly overlap */
-        FullAddrRangeCoverage, /* One range fully covers another */
-        NoAddrRangeCoverage /* Two ranges are disjoint */
-    };
+    /** Stores of the store queue by the bytes they write */
+    StoreForwardIndex storeFwdIndex;
+
+    /** Store queue indices looked up by read(), kept to reuse the memory */
+    std::vector<size_t> fwdCandidates;
 
   public:
     using LoadQueue = CircularQueue<LQEntry>;
@@ -301,7 +305,7 @@ class LSQUnit
      * contructor is deleted explicitly. However, STL vector requires
      * a valid copy constructor for the base type at compile time.
      */
-    LSQUnit(const LSQUnit &l) : stats(nullptr)
+    LSQUnit(const LSQUnit &l) : storeFwdIndex(0), stats(nullptr)
     {
         panic("LSQUnit is not copy-able");
     }
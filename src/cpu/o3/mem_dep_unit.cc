@@ -28,8 +28,7 @@
 
 #include "cpu/o3/mem_dep_unit.hh"
 
-#include <map>
-#include <memory>
+#include <algorithm>
 #include <vector>
 
 #include "base/compiler.hh"
@@ -47,12 +46,6 @@ namespace gem5
 namespace o3
 {
 
-#ifdef DEBUG
-int MemDepUnit::MemDepEntry::memdep_count = 0;
-int MemDepUnit::MemDepEntry::memdep_insert = 0;
-int MemDepUnit::MemDepEntry::memdep_erase = 0;
-#endif
-
 MemDepUnit::MemDepUnit() : iqPtr(NULL), stats(nullptr) {}
 
 MemDepUnit::MemDepUnit(const BaseO3CPUParams &params)
@@ -65,30 +58,6 @@ MemDepUnit::MemDepUnit(const BaseO3CPUParams &params)
     DPRINTF(MemDepUnit, "Creating MemDepUnit object.\n");
 }
 
-MemDepUnit::~MemDepUnit()
-{
-    for (ThreadID tid = 0; tid < MaxThreads; tid++) {
-
-        ListIt inst_list_it = instList[tid].begin();
-
-        MemDepHashIt hash_it;
-
-        while (!instList[tid].empty()) {
-            hash_it = memDepHash.find((*inst_list_it)->seqNum);
-
-            assert(hash_it != memDepHash.end());
-
-            memDepHash.erase(hash_it);
-
-            instList[tid].erase(inst_list_it++);
-        }
-    }
-
-#ifdef DEBUG
-    assert(MemDepEntry::memdep_count == 0);
-#endif
-}
-
 void
 MemDepUnit::init(const BaseO3CPUParams &params, ThreadID tid, CPU *cpu)
 {
@@ -100,6 +69,9 @@ MemDepUnit::init(const BaseO3CPUParams &params, ThreadID tid, CPU *cpu)
     depPred.init(params.store_set_clear_period, params.store_set_clear_thres, params.SSITSize,
             params.LFSTSize, params.LFSTEntrySize);
 
+    // Grows past this only if the ROB is not the limit.
+    instList[tid].reserve(params.numROBEntries);
+
     std::string stats_group_name = csprintf("MemDepUnit__%i", tid);
     cpu->addStatGroup(stats_group_name.c_str(), &stats);
     this->cpu = cpu;
@@ -123,9 +95,7 @@ MemDepUnit::MemDepUnitStats::MemDepUnitStats(statistics::Group *parent)
 bool
 MemDepUnit::isDrained() const
 {
-    bool drained = instsToReplay.empty()
-                 && memDepHash.empty()
-                 && instsToReplay.empty();
+    bool drained = instsToReplay.empty();
     for (int i = 0; i < MaxThreads; ++i)
         drained = drained && instList[i].empty();
 
@@ -136,11 +106,8 @@ void
 MemDepUnit::drainSanityCheck() const
 {
     assert(instsToReplay.empty());
-    assert(memDepHash.empty());
     for (int i = 0; i < MaxThreads; ++i)
         assert(instList[i].empty());
-    assert(instsToReplay.empty());
-    assert(memDepHash.empty());
 }
 
 void
@@ -195,18 +162,7 @@ MemDepUnit::insert(const DynInstPtr &inst)
 {
     ThreadID tid = inst->threadNumber;
 
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(inst);
-
-    // Add the MemDepEntry to the hash.
-    memDepHash.insert(
-        std::pair<InstSeqNum, MemDepEntryPtr>(inst->seqNum, inst_entry));
-#ifdef DEBUG
-    MemDepEntry::memdep_insert++;
-#endif
-
-    instList[tid].push_back(inst);
-
-    inst_entry->listIt = --(instList[tid].end());
+    size_t inst_idx = pushEntry(inst);
 
     // Check any barriers and the dependence predictor for any
     // producing memrefs/stores.
@@ -235,27 +191,31 @@ MemDepUnit::insert(const DynInstPtr &inst)
         }
     }
 
-    std::vector<MemDepEntryPtr> store_entries;
+    std::vector<MemDepEntry *> store_entries;
 
     // If there is a producing store, try to find the entry.
     for (auto producing_store : producing_stores) {
         DPRINTF(MemDepUnit, "Searching for producer [sn:%lli]\n",
                             producing_store);
-        MemDepHashIt hash_it = memDepHash.find(producing_store);
-
-        if (hash_it != memDepHash.end()) {
-            store_entries.push_back((*hash_it).second);
-            DPRINTF(MemDepUnit, "Producer found\n");
+        for (ThreadID store_tid = 0; store_tid < MaxThreads; store_tid++) {
+            size_t store_idx = findEntry(store_tid, producing_store);
+            if (store_idx != NoEntry) {
+                store_entries.push_back(&instList[store_tid][store_idx]);
+                DPRINTF(MemDepUnit, "Producer found\n");
+                break;
+            }
         }
     }
 
+    MemDepEntry &inst_entry = instList[tid][inst_idx];
+
     // If no store entry, then instruction can issue as soon as the registers
     // are ready.
     if (store_entries.empty()) {
         DPRINTF(MemDepUnit, "No dependency for inst PC "
                 "%s [sn:%lli].\n", inst->pcState(), inst->seqNum);
 
-        assert(inst_entry->memDeps == 0);
+        assert(inst_entry.memDeps == 0);
 
         inst->issueQue->markMemDepDone(inst);
     } else {
@@ -267,9 +227,9 @@ MemDepUnit::insert(const DynInstPtr &inst)
 
         // Add this instruction to the list of dependents.
         for (auto store_entry : store_entries)
-            store_entry->dependInsts.push_back(inst_entry);
+            store_entry->dependInsts.push_back({tid, inst_idx, inst->seqNum});
 
-        inst_entry->memDeps = store_entries.size();
+        inst_entry.memDeps = store_entries.size();
 
         if (inst->isLoad()) {
             ++stats.conflictingLoads;
@@ -321,21 +281,7 @@ MemDepUnit::insertNonSpec(const DynInstPtr &inst)
 void
 MemDepUnit::insertBarrier(const DynInstPtr &barr_inst)
 {
-    ThreadID tid = barr_inst->threadNumber;
-
-    MemDepEntryPtr inst_entry = std::make_shared<MemDepEntry>(barr_inst);
-
-    // Add the MemDepEntry to the hash.
-    memDepHash.insert(
-        std::pair<InstSeqNum, MemDepEntryPtr>(barr_inst->seqNum, inst_entry));
-#ifdef DEBUG
-    MemDepEntry::memdep_insert++;
-#endif
-
-    // Add the instruction to the instruction list.
-    instList[tid].push_back(barr_inst);
-
-    inst_entry->listIt = --(instList[tid].end());
+    pushEntry(barr_inst);
 
     insertBarrierSN(barr_inst);
 }
@@ -367,12 +313,12 @@ MemDepUnit::replay()
     while (!instsToReplay.empty()) {
         temp_inst = instsToReplay.front();
 
-        MemDepEntryPtr inst_entry = findInHash(temp_inst);
+        MemDepEntry &inst_entry = getEntry(temp_inst);
 
         DPRINTF(MemDepUnit, "Replaying mem instruction PC %s [sn:%lli].\n",
                 temp_inst->pcState(), temp_inst->seqNum);
 
-        inst_entry->inst->issueQue->retryMem(inst_entry->inst);
+        inst_entry.inst->issueQue->retryMem(inst_entry.inst);
 
         instsToReplay.pop_front();
     }
@@ -386,19 +332,12 @@ MemDepUnit::completed(const DynInstPtr &inst)
 
     ThreadID tid = inst->threadNumber;
 
-    // Remove the instruction from the hash and the list.
-    MemDepHashIt hash_it = memDepHash.find(inst->seqNum);
-
-    assert(hash_it != memDepHash.end());
-
-    instList[tid].erase((*hash_it).second->listIt);
+    // Leave an empty entry behind, the older ones may still be in flight.
+    MemDepEntry &inst_entry = getEntry(inst);
+    inst_entry.inst = nullptr;
+    inst_entry.dependInsts.clear();
 
-    (*hash_it).second = NULL;
-
-    memDepHash.erase(hash_it);
-#ifdef DEBUG
-    MemDepEntry::memdep_erase++;
-#endif
+    trimEntries(tid);
 }
 
 void
@@ -441,14 +380,14 @@ MemDepUnit::wakeDependents(const DynInstPtr &inst)
         return;
     }
 
-    MemDepEntryPtr inst_entry = findInHash(inst);
-    stats.dependentLoads += inst_entry->dependInsts.size();
+    MemDepEntry &inst_entry = getEntry(inst);
+    stats.dependentLoads += inst_entry.dependInsts.size();
 
-    for (int i = 0; i < inst_entry->dependInsts.size(); ++i ) {
-        MemDepEntryPtr woken_inst = inst_entry->dependInsts[i];
+    for (const auto &dep : inst_entry.dependInsts) {
+        MemDepEntry *woken_inst = resolve(dep);
 
-        if (!woken_inst->inst) {
-            // Potentially removed mem dep entries could be on this list
+        if (!woken_inst) {
+            // Squashed dependents could be on this list
             continue;
         }
 
@@ -459,39 +398,12 @@ MemDepUnit::wakeDependents(const DynInstPtr &inst)
         assert(woken_inst->memDeps > 0);
         woken_inst->memDeps -= 1;
 
-        if ((woken_inst->memDeps == 0) &&
-            !woken_inst->squashed) {
+        if (woken_inst->memDeps == 0) {
             woken_inst->inst->issueQue->markMemDepDone(woken_inst->inst);
         }
     }
 
-    inst_entry->dependInsts.clear();
-}
-
-MemDepUnit::MemDepEntry::MemDepEntry(const DynInstPtr &new_inst) :
-    inst(new_inst)
-{
-#ifdef DEBUG
-    ++memdep_count;
-
-    DPRINTF(MemDepUnit,
-            "Memory dependency entry created. memdep_count=%i %s\n",
-            memdep_count, inst->pcState());
-#endif
-}
-
-MemDepUnit::MemDepEntry::~MemDepEntry()
-{
-    for (int i = 0; i < dependInsts.size(); ++i) {
-        dependInsts[i] = NULL;
-    }
-#ifdef DEBUG
-    --memdep_count;
-
-    DPRINTF(MemDepUnit,
-            "Memory dependency entry deleted. memdep_count=%i %s\n",
-            memdep_count, inst->pcState());
-#endif
+    inst_entry.dependInsts.clear();
 }
 
 void
@@ -509,37 +421,26 @@ MemDepUnit::squash(const InstSeqNum &squashed_num, ThreadID tid)
         }
     }
 
-    ListIt squash_it = instList[tid].end();
-    --squash_it;
-
-    MemDepHashIt hash_it;
+    auto &insts = instList[tid];
+    while (!insts.empty() && insts.back().seqNum > squashed_num) {
+        MemDepEntry &entry = insts.back();
 
-    while (!instList[tid].empty() &&
-           (*squash_it)->seqNum > squashed_num) {
+        if (entry.inst) {
+            DPRINTF(MemDepUnit, "Squashing inst [sn:%lli]\n", entry.seqNum);
 
-        DPRINTF(MemDepUnit, "Squashing inst [sn:%lli]\n",
-                (*squash_it)->seqNum);
+            loadBarrierSNs.erase(entry.seqNum);
 
-        loadBarrierSNs.erase((*squash_it)->seqNum);
-
-        storeBarrierSNs.erase((*squash_it)->seqNum);
-
-        hash_it = memDepHash.find((*squash_it)->seqNum);
-
-        assert(hash_it != memDepHash.end());
-
-        (*hash_it).second->squashed = true;
-
-        (*hash_it).second = NULL;
-
-        memDepHash.erase(hash_it);
-#ifdef DEBUG
-        MemDepEntry::memdep_erase++;
-#endif
+            storeBarrierSNs.erase(entry.seqNum);
+        }
 
-        instList[tid].erase(squash_it--);
+        // Slots are reused, drop the references now.
+        entry.inst = nullptr;
+        entry.dependInsts.clear();
+        insts.pop_back();
     }
 
+    trimEntries(tid);
+
     // Tell the dependency predictor to squash as well.
     depPred.squash(squashed_num, tid);
 }
@@ -565,14 +466,90 @@ MemDepUnit::issue(const DynInstPtr &inst)
     depPred.issued(inst->pcState().instAddr(), inst->seqNum, inst->isStore());
 }
 
-MemDepUnit::MemDepEntryPtr &
-MemDepUnit::findInHash(const DynInstConstPtr &inst)
+size_t
+MemDepUnit::pushEntry(const DynInstPtr &inst)
+{
+    auto &insts = instList[inst->threadNumber];
+    assert(insts.empty() || insts.back().seqNum < inst->seqNum);
+
+    if (insts.full()) {
+        insts.reserve(std::max<size_t>(2 * insts.capacity(), 16));
+    }
+    insts.advance_tail();
+
+    MemDepEntry &entry = insts.back();
+    entry.inst = inst;
+    entry.seqNum = inst->seqNum;
+    entry.dependInsts.clear();
+    entry.memDeps = 0;
+
+    return insts.tail();
+}
+
+size_t
+MemDepUnit::findEntry(ThreadID tid, InstSeqNum seq_num) const
 {
-    MemDepHashIt hash_it = memDepHash.find(inst->seqNum);
+    const auto &insts = instList[tid];
+    if (insts.empty() || seq_num < insts[insts.head()].seqNum ||
+        seq_num > insts[insts.tail()].seqNum) {
+        return NoEntry;
+    }
 
-    assert(hash_it != memDepHash.end());
+    // The entries are in program order.
+    size_t lo = insts.head();
+    size_t hi = insts.tail() + 1;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (insts[mid].seqNum < seq_num) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
 
-    return (*hash_it).second;
+    if (lo > insts.tail() || insts[lo].seqNum != seq_num ||
+        !insts[lo].inst) {
+        return NoEntry;
+    }
+    return lo;
+}
+
+MemDepUnit::MemDepEntry &
+MemDepUnit::getEntry(const DynInstConstPtr &inst)
+{
+    size_t idx = findEntry(inst->threadNumber, inst->seqNum);
+
+    assert(idx != NoEntry);
+
+    return instList[inst->threadNumber][idx];
+}
+
+MemDepUnit::MemDepEntry *
+MemDepUnit::resolve(const MemDepRef &ref)
+{
+    auto &insts = instList[ref.tid];
+    if (!insts.isValidIdx(ref.idx)) {
+        return nullptr;
+    }
+    MemDepEntry &entry = insts[ref.idx];
+    if (entry.seqNum != ref.seqNum || !entry.inst) {
+        return nullptr;
+    }
+    return &entry;
+}
+
+void
+MemDepUnit::trimEntries(ThreadID tid)
+{
+    auto &insts = instList[tid];
+    while (!insts.empty() && !insts.front().inst) {
+        insts.front().dependInsts.clear();
+        insts.pop_front();
+    }
+    while (!insts.empty() && !insts.back().inst) {
+        insts.back().dependInsts.clear();
+        insts.pop_back();
+    }
 }
 
 void
@@ -582,27 +559,22 @@ MemDepUnit::dumpLists()
         cprintf("Instruction list %i size: %i\n",
                 tid, instList[tid].size());
 
-        ListIt inst_list_it = instList[tid].begin();
         int num = 0;
 
-        while (inst_list_it != instList[tid].end()) {
+        for (const auto &entry : instList[tid]) {
+            if (!entry.inst) {
+                continue;
+            }
             cprintf("Instruction:%i\nPC: %s\n[sn:%llu]\n[tid:%i]\nIssued:%i\n"
                     "Squashed:%i\n\n",
-                    num, (*inst_list_it)->pcState(),
-                    (*inst_list_it)->seqNum,
-                    (*inst_list_it)->threadNumber,
-                    (*inst_list_it)->isIssued(),
-                    (*inst_list_it)->isSquashed());
-            inst_list_it++;
+                    num, entry.inst->pcState(),
+                    entry.inst->seqNum,
+                    entry.inst->threadNumber,
+                    entry.inst->isIssued(),
+                    entry.inst->isSquashed());
             ++num;
         }
     }
-
-    cprintf("Memory dependence hash size: %i\n", memDepHash.size());
-
-#ifdef DEBUG
-    cprintf("Memory dependence entries: %i\n", MemDepEntry::memdep_count);
-#endif
 }
 
 } // namespace o3
@@ -41,12 +41,12 @@
 #ifndef __CPU_O3_MEM_DEP_UNIT_HH__
 #define __CPU_O3_MEM_DEP_UNIT_HH__
 
+#include <limits>
 #include <list>
-#include <memory>
-#include <set>
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
@@ -57,17 +57,6 @@
 namespace gem5
 {
 
-struct SNHash
-{
-    size_t
-    operator()(const InstSeqNum &seq_num) const
-    {
-        unsigned a = (unsigned)seq_num;
-        unsigned hash = (((a >> 14) ^ ((a >> 2) & 0xffff))) & 0x7FFFFFFF;
-        return hash;
-    }
-};
-
 struct BaseO3CPUParams;
 
 namespace o3
@@ -99,9 +88,6 @@ class MemDepUnit
     /** Constructs a MemDepUnit with given parameters. */
     MemDepUnit(const BaseO3CPUParams &params);
 
-    /** Frees up any memory allocated. */
-    ~MemDepUnit();
-
     /** Returns the name of the memory dependence unit. */
     std::string name() const { return _name; }
 
@@ -171,9 +157,15 @@ class MemDepUnit
 
     typedef typename std::list<DynInstPtr>::iterator ListIt;
 
-    class MemDepEntry;
-
-    typedef std::shared_ptr<MemDepEntry> MemDepEntryPtr;
+    /** Reference to the entry of a dependent instruction, which only
+     *  resolves as long as that instruction is tracked.
+     */
+    struct MemDepRef
+    {
+        ThreadID tid;
+        size_t idx;
+        InstSeqNum seqNum;
+    };
 
     /** Memory dependence entries that track memory operations, marking
      *  when the instruction is ready to execute and what instructions depend
@@ -182,51 +174,44 @@ class MemDepUnit
     class MemDepEntry
     {
       public:
-        /** Constructs a memory dependence entry. */
-        MemDepEntry(const DynInstPtr &new_inst);
-
-        /** Frees any pointers. */
-        ~MemDepEntry();
-
-        /** Returns the name of the memory dependence entry. */
-        std::string name() const { return "memdepentry"; }
-
-        /** The instruction being tracked. */
+        /** The instruction being tracked, null once it is done. */
         DynInstPtr inst;
 
-        /** The iterator to the instruction's location inside the list. */
-        ListIt listIt;
+        /** Sequence number of the instruction, kept after it is done. */
+        InstSeqNum seqNum = 0;
 
         /** A vector of any dependent instructions. */
-        std::vector<MemDepEntryPtr> dependInsts;
+        std::vector<MemDepRef> dependInsts;
 
         /** Number of memory dependencies that need to be satisfied. */
         int memDeps = 0;
-        /** If the instruction is completed. */
-        bool completed = false;
-        /** If the instruction is squashed. */
-        bool squashed = false;
-
-        /** For debugging. */
-#ifdef DEBUG
-        static int memdep_count;
-        static int memdep_insert;
-        static int memdep_erase;
-#endif
     };
 
-    /** Finds the memory dependence entry in the hash map. */
-    MemDepEntryPtr &findInHash(const DynInstConstPtr& inst);
+    /** Index of no entry. */
+    static constexpr size_t NoEntry = std::numeric_limits<size_t>::max();
 
-    typedef std::unordered_map<InstSeqNum, MemDepEntryPtr, SNHash> MemDepHash;
+    /** Adds an entry for the instruction, returns its index. */
+    size_t pushEntry(const DynInstPtr &inst);
 
-    typedef typename MemDepHash::iterator MemDepHashIt;
+    /** Index of the entry of a tracked instruction, NoEntry if there is
+     *  none.
+     */
+    size_t findEntry(ThreadID tid, InstSeqNum seq_num) const;
+
+    /** The entry of a tracked instruction. */
+    MemDepEntry &getEntry(const DynInstConstPtr& inst);
 
-    /** A hash map of all memory dependence entries. */
-    MemDepHash memDepHash;
+    /** The entry of a dependent instruction, if it is still tracked. */
+    MemDepEntry *resolve(const MemDepRef &ref);
 
-    /** A list of all instructions in the memory dependence unit. */
-    std::list<DynInstPtr> instList[MaxThreads];
+    /** Drops the done entries at both ends of a thread's list. */
+    void trimEntries(ThreadID tid);
+
+    /** The entries of the memory instructions of each thread, in program
+     *  order. A completed instruction leaves an empty entry behind until
+     *  the older ones are done too.
+     */
+    CircularQueue<MemDepEntry> instList[MaxThreads];
 
     /** A list of all instructions that are going to be replayed. */
     std::list<DynInstPtr> instsToReplay;
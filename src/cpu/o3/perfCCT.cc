@@ -18,19 +18,22 @@ InstMeta::reset(const DynInstPtr inst)
 }
 
 
-PerfCCT::PerfCCT(bool enable, ArchDBer* db) : enableCCT(enable), archdb(db)
+PerfCCT::PerfCCT(bool enable, ArchDBer* db)
+    : enableCCT(enable), archdb(db), insertStmt(-1)
 {
+    static_assert((int)PerfRecord::Num_PerfRecord <= DBCommand::MaxValues);
     if (enableCCT) {
         metas.resize(MaxMetas);
 
-        ss << "INSERT INTO LifeTimeCommitTrace(";
-        ss << PerfRecordStrings[0];
+        std::string sql = "INSERT INTO LifeTimeCommitTrace(";
+        std::string values = ") VALUES(?";
+        sql += PerfRecordStrings[0];
         for (int i=1; i < (int)PerfRecord::Num_PerfRecord; i++) {
-            ss << "," << PerfRecordStrings[i];
+            sql += ",";
+            sql += PerfRecordStrings[i];
+            values += ",?";
         }
-        ss << ") VALUES(";
-        sql_insert_cmd = ss.str();
-        ss.str(std::string());
+        insertStmt = archdb->prepare(sql + values + ");");
     }
 }
 
@@ -69,18 +72,16 @@ PerfCCT::commitMeta(InstSeqNum sn)
         return;
     }
     auto meta = getMeta(sn);
-    ss << sql_insert_cmd;
+    DBCommand cmd;
+    cmd.stmt = insertStmt;
     // dump counter first
-    ss << meta->posTick[0];
-    for (auto it = meta->posTick.begin() + 1; it != meta->posTick.end(); it++) {
-        ss << "," << *it;
+    for (auto tick : meta->posTick) {
+        cmd.push(tick);
     }
     // dump string last
-    ss << ",\'" << meta->disasm << "\'";
-    ss << "," << meta->pc;
-    ss << ");";
-    archdb->execmd(ss.str());
-    ss.str(std::string());
+    cmd.push(meta->disasm);
+    cmd.push(meta->pc);
+    archdb->insert(std::move(cmd));
 }
 
 }
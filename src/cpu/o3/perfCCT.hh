@@ -32,12 +32,11 @@ class PerfCCT
     const int MaxMetas = 1500;  // same as MaxNum of DynInst
     bool enableCCT;
     ArchDBer* archdb;
-    std::string sql_insert_cmd;
+    // prepared insert into LifeTimeCommitTrace
+    int insertStmt;
 
     std::vector<InstMeta> metas;
 
-    std::stringstream ss;
-
     InstMeta* getMeta(InstSeqNum sn);
 
   public:
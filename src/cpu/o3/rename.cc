@@ -60,7 +60,9 @@ namespace o3
 {
 
 Rename::Rename(CPU *_cpu, const BaseO3CPUParams &params)
-    : cpu(_cpu),
+    : numCheckpoints(params.numRenameCheckpoints),
+      checkpointGap(params.renameCheckpointGap),
+      cpu(_cpu),
       iewToRenameDelay(params.iewToRenameDelay),
       decodeToRenameDelay(params.decodeToRenameDelay),
       commitToRenameDelay(params.commitToRenameDelay),
@@ -86,6 +88,8 @@ Rename::Rename(CPU *_cpu, const BaseO3CPUParams &params)
         stalls[tid] = {false, false};
         serializeInst[tid] = nullptr;
         serializeOnNextInst[tid] = false;
+        historyBuffer[tid].reserve(params.numROBEntries);
+        checkpoints[tid].reserve(numCheckpoints);
     }
 
     renameStalls.resize(renameWidth, StallReason::NoStall);
@@ -141,6 +145,8 @@ Rename::RenameStats::RenameStats(statistics::Group *parent)
                "Number of HB maps that are committed"),
       ADD_STAT(undoneMaps, statistics::units::Count::get(),
                "Number of HB maps that are undone due to squashing"),
+      ADD_STAT(checkpointRestores, statistics::units::Count::get(),
+               "Number of squashes recovered from a rename map checkpoint"),
       ADD_STAT(serializing, statistics::units::Count::get(),
                "count of serializing insts renamed"),
       ADD_STAT(tempSerializing, statistics::units::Count::get(),
@@ -175,6 +181,7 @@ Rename::RenameStats::RenameStats(statistics::Group *parent)
 
     committedMaps.prereq(committedMaps);
     undoneMaps.prereq(undoneMaps);
+    checkpointRestores.prereq(checkpointRestores);
     serializing.flags(statistics::total);
     tempSerializing.flags(statistics::total);
     skidInsts.flags(statistics::total);
@@ -290,6 +297,8 @@ Rename::resetStage()
         storesInProgress[tid] = 0;
 
         serializeOnNextInst[tid] = false;
+
+        checkpoints[tid].flush();
     }
 }
 
@@ -814,6 +823,8 @@ Rename::renameInsts(ThreadID tid)
 
         renameDestRegs(inst, inst->threadNumber);
 
+        takeCheckpoint(inst, inst->threadNumber);
+
         cpu->perfCCT->updateInstPos(inst->seqNum, PerfRecord::AtRename);
 
         if (inst->isAtomic() || inst->isStore()) {
@@ -1048,20 +1059,40 @@ Rename::tryFreePReg(PhysRegIdPtr preg)
 void
 Rename::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
 {
-    auto hb_it = historyBuffer[tid].begin();
+    auto &history = historyBuffer[tid];
+
+    // The checkpoints of squashed branches are gone.
+    auto &ckpts = checkpoints[tid];
+    while (!ckpts.empty() && ckpts.back().seqNum > squashed_seq_num) {
+        ckpts.pop_back();
+    }
 
     // After a syscall squashes everything, the history buffer may be empty
     // but the ROB may still be squashing instructions.
+    if (history.empty() || history.back().instSeqNum <= squashed_seq_num) {
+        return;
+    }
+
+    if (restoreCheckpoint(squashed_seq_num, tid)) {
+        return;
+    }
+
     // Go through the most recent instructions, undoing the mappings
-    // they did and freeing up the registers.
-    while (!historyBuffer[tid].empty() &&
-           hb_it->instSeqNum > squashed_seq_num) {
-        assert(hb_it != historyBuffer[tid].end());
+    // they did. The registers they allocated go back to the head of the
+    // free list at once afterwards. With SMT the other threads allocate
+    // from the same free list, so the registers are freed one by one.
+    const bool rewind = numThreads == 1;
+    UnifiedFreeList::Position free_list_pos;
+    freeList->position(free_list_pos);
+    size_t squash_idx = history.tail() + 1;
+    while (squash_idx > history.head() &&
+           history[squash_idx - 1].instSeqNum > squashed_seq_num) {
+        const RenameHistory &hb = history[--squash_idx];
 
         DPRINTF(Rename, "[tid:%i] Removing history entry with sequence "
                 "number %i (archReg: %d, newPhysReg: %d, prevPhysReg: %d).\n",
-                tid, hb_it->instSeqNum, hb_it->archReg.index(),
-                hb_it->newPhysReg->index(), hb_it->prevPhysReg->index());
+                tid, hb.instSeqNum, hb.archReg.index(),
+                hb.newPhysReg->index(), hb.prevPhysReg->index());
 
         // Undo the rename mapping only if it was really a change.
         // Special regs that are not really renamed (like misc regs
@@ -1069,40 +1100,168 @@ Rename::doSquash(const InstSeqNum &squashed_seq_num, ThreadID tid)
         // is the same as the old one.  While it would be merely a
         // waste of time to update the rename table, we definitely
         // don't want to put these on the free list.
-        if (hb_it->newPhysReg != hb_it->prevPhysReg) {
+        if (hb.newPhysReg != hb.prevPhysReg) {
             // Tell the rename map to set the architected register to the
             // previous physical register that it was renamed to.
-            renameMap[tid]->setEntry(hb_it->archReg, hb_it->prevPhysReg);
-            tryFreePReg(hb_it->newPhysReg);
+            renameMap[tid]->setEntry(hb.archReg, hb.prevPhysReg);
+            if (hb.allocated && rewind) {
+                free_list_pos[hb.newPhysReg->classValue()]--;
+            } else if (hb.allocated) {
+                tryFreePReg(hb.newPhysReg);
+            }
         }
 
         // Notify potential listeners that the register mapping needs to be
-        // removed because the instruction it was mapped to got squashed. Note
-        // that this is done before hb_it is incremented.
-        ppSquashInRename->notify(std::make_pair(hb_it->instSeqNum,
-                                                hb_it->newPhysReg));
+        // removed because the instruction it was mapped to got squashed.
+        ppSquashInRename->notify(std::make_pair(hb.instSeqNum,
+                                                hb.newPhysReg));
+    }
+
+    if (rewind) {
+        rewindFreeList(free_list_pos);
+    }
+    freeSquashedRegs(squash_idx, tid);
+}
+
+bool
+Rename::restoreCheckpoint(const InstSeqNum &squashed_seq_num, ThreadID tid)
+{
+    auto &history = historyBuffer[tid];
+    auto &ckpts = checkpoints[tid];
+    if (ckpts.empty()) {
+        return false;
+    }
+    const RenameCheckpoint &ckpt = ckpts.back();
+    assert(ckpt.seqNum <= squashed_seq_num);
+    assert(ckpt.historyIdx >= history.head());
+
+    // Find the oldest rename to squash, the history is in program order.
+    size_t squash_idx = ckpt.historyIdx;
+    size_t end_idx = history.tail() + 1;
+    for (size_t hi = end_idx; squash_idx < hi;) {
+        size_t mid = squash_idx + (hi - squash_idx) / 2;
+        if (history[mid].instSeqNum <= squashed_seq_num) {
+            squash_idx = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    // Undoing the squashed renames one by one is cheaper.
+    if (squash_idx - ckpt.historyIdx >= end_idx - squash_idx) {
+        return false;
+    }
+
+    DPRINTF(Rename, "[tid:%i] Restoring the checkpoint of [sn:%llu], "
+            "redoing %i and squashing %i renames.\n", tid, ckpt.seqNum,
+            squash_idx - ckpt.historyIdx, end_idx - squash_idx);
+
+    // Redo the renames of the instructions between the branch and the
+    // squashing one, they take the same registers from the free list.
+    renameMap[tid]->restoreSnapshot(ckpt.map);
+    UnifiedFreeList::Position free_list_pos = ckpt.freeListPos;
+    for (size_t idx = ckpt.historyIdx; idx < squash_idx; idx++) {
+        const RenameHistory &hb = history[idx];
+        if (hb.newPhysReg == hb.prevPhysReg) {
+            continue;
+        }
+        renameMap[tid]->setEntry(hb.archReg, hb.newPhysReg);
+        if (hb.allocated) {
+            [[maybe_unused]] PhysRegIdPtr reg = freeList->regAt(
+                hb.newPhysReg->classValue(),
+                free_list_pos[hb.newPhysReg->classValue()]++);
+            assert(reg == hb.newPhysReg);
+        }
+    }
+
+    if (ppSquashInRename->hasListeners()) {
+        for (size_t idx = end_idx; idx-- > squash_idx;) {
+            ppSquashInRename->notify(std::make_pair(history[idx].instSeqNum,
+                                                    history[idx].newPhysReg));
+        }
+    }
 
-        historyBuffer[tid].erase(hb_it++);
+    ++stats.checkpointRestores;
 
-        ++stats.undoneMaps;
+    rewindFreeList(free_list_pos);
+    freeSquashedRegs(squash_idx, tid);
+    return true;
+}
+
+void
+Rename::rewindFreeList(const UnifiedFreeList::Position &free_list_pos)
+{
+    // Another thread may have allocated registers since, which would be
+    // handed out twice.
+    panic_if(numThreads > 1, "Rewinding the free list shared by %i threads",
+             numThreads);
+    freeList->rewind(free_list_pos);
+}
+
+void
+Rename::freeSquashedRegs(size_t squash_idx, ThreadID tid)
+{
+    auto &history = historyBuffer[tid];
+
+    // The renames that shared an older register drop their reference.
+    auto &shared = sharedRenames[tid];
+    while (!shared.empty() && shared.back() >= squash_idx) {
+        tryFreePReg(history[shared.back()].newPhysReg);
+        shared.pop_back();
+    }
+
+    const size_t num_squashed = history.tail() + 1 - squash_idx;
+    history.pop_back(num_squashed);
+    stats.undoneMaps += num_squashed;
+}
+
+void
+Rename::takeCheckpoint(const DynInstPtr &inst, ThreadID tid)
+{
+    // The free list is shared by the threads, its head can only go
+    // back for one.
+    if (!inst->isControl() || numCheckpoints == 0 || numThreads > 1) {
+        return;
+    }
+
+    auto &ckpts = checkpoints[tid];
+    const size_t history_idx = historyBuffer[tid].tail() + 1;
+    if (ckpts.full() || (!ckpts.empty() &&
+                history_idx - ckpts.back().historyIdx < checkpointGap)) {
+        return;
     }
+
+    ckpts.advance_tail();
+    RenameCheckpoint &ckpt = ckpts.back();
+    ckpt.seqNum = inst->seqNum;
+    ckpt.historyIdx = history_idx;
+    renameMap[tid]->takeSnapshot(ckpt.map);
+    freeList->position(ckpt.freeListPos);
+
+    DPRINTF(Rename, "[tid:%i] [sn:%llu] Checkpointed the rename map (%i "
+            "checkpoints).\n", tid, inst->seqNum, ckpts.size());
 }
 
 void
 Rename::removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid)
 {
+    auto &history = historyBuffer[tid];
+
     DPRINTF(Rename, "[tid:%i] Removing a committed instruction from the "
             "history buffer %u (size=%i), until [sn:%llu].\n",
-            tid, tid, historyBuffer[tid].size(), inst_seq_num);
-
-    auto hb_it = historyBuffer[tid].end();
+            tid, tid, history.size(), inst_seq_num);
 
-    --hb_it;
+    // The checkpoints older than the committed instruction cannot be
+    // recovered from, the renames after them are partly gone.
+    auto &ckpts = checkpoints[tid];
+    while (!ckpts.empty() && ckpts.front().seqNum < inst_seq_num) {
+        ckpts.pop_front();
+    }
 
-    if (historyBuffer[tid].empty()) {
+    if (history.empty()) {
         DPRINTF(Rename, "[tid:%i] History buffer is empty.\n", tid);
         return;
-    } else if (hb_it->instSeqNum > inst_seq_num) {
+    } else if (history.front().instSeqNum > inst_seq_num) {
         DPRINTF(Rename, "[tid:%i] [sn:%llu] "
                 "Old sequence number encountered. "
                 "Ensure that a syscall happened recently.\n",
@@ -1114,27 +1273,32 @@ Rename::removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid)
     // number. Some or even all of the committed instructions may not have
     // rename histories if they did not have destination registers that were
     // renamed.
-    while (!historyBuffer[tid].empty() &&
-           hb_it != historyBuffer[tid].end() &&
-           hb_it->instSeqNum <= inst_seq_num) {
+    while (!history.empty() &&
+           history.front().instSeqNum <= inst_seq_num) {
+        const RenameHistory &hb = history.front();
 
         DPRINTF(Rename,
                 "[tid:%i] try to free up older rename of reg p%i (%s), "
                 "[sn:%llu].\n",
-                tid, hb_it->prevPhysReg->flatIndex(),
-                hb_it->prevPhysReg->className(), hb_it->instSeqNum);
+                tid, hb.prevPhysReg->flatIndex(),
+                hb.prevPhysReg->className(), hb.instSeqNum);
 
 
         // Don't free special phys regs like misc and zero regs, which
         // can be recognized because the new mapping is the same as
         // the old one.
-        if (hb_it->newPhysReg != hb_it->prevPhysReg) {
-            tryFreePReg(hb_it->prevPhysReg);
+        if (hb.newPhysReg != hb.prevPhysReg) {
+            tryFreePReg(hb.prevPhysReg);
         }
 
         ++stats.committedMaps;
 
-        historyBuffer[tid].erase(hb_it--);
+        history.pop_front();
+    }
+
+    auto &shared = sharedRenames[tid];
+    while (!shared.empty() && shared.front() < history.head()) {
+        shared.pop_front();
     }
 }
 
@@ -1249,16 +1413,24 @@ Rename::renameDestRegs(const DynInstPtr &inst, ThreadID tid)
                 rename_result.first->flatIndex());
 
         // Record the rename information so that a history can be kept.
+        bool changed = rename_result.first != rename_result.second;
         RenameHistory hb_entry(inst->seqNum, flat_dest_regid,
                                rename_result.first,
-                               rename_result.second);
+                               rename_result.second,
+                               changed && !mov_elim);
 
-        historyBuffer[tid].push_front(hb_entry);
+        auto &history = historyBuffer[tid];
+        if (history.full()) {
+            history.reserve(std::max<size_t>(2 * history.capacity(), 64));
+        }
+        history.push_back(hb_entry);
+        if (changed && mov_elim) {
+            sharedRenames[tid].push_back(history.tail());
+        }
 
         DPRINTF(Rename, "[tid:%i] [sn:%llu] "
                 "Adding instruction to history buffer (size=%i).\n",
-                tid,(*historyBuffer[tid].begin()).instSeqNum,
-                historyBuffer[tid].size());
+                tid, history.back().instSeqNum, history.size());
 
         // Tell the instruction to rename the appropriate destination
         // register (dest_idx) to the new physical register
@@ -1559,24 +1731,17 @@ Rename::incrFullStat(const FullSource &source)
 void
 Rename::dumpHistory()
 {
-    std::list<RenameHistory>::iterator buf_it;
-
     for (ThreadID tid = 0; tid < numThreads; tid++) {
-
-        buf_it = historyBuffer[tid].begin();
-
-        while (buf_it != historyBuffer[tid].end()) {
+        for (const auto &hb : historyBuffer[tid]) {
             cprintf("Seq num: %i\nArch reg[%s]: %i New phys reg:"
                     " %i[%s] Old phys reg: %i[%s]\n",
-                    (*buf_it).instSeqNum,
-                    (*buf_it).archReg.className(),
-                    (*buf_it).archReg.index(),
-                    (*buf_it).newPhysReg->index(),
-                    (*buf_it).newPhysReg->className(),
-                    (*buf_it).prevPhysReg->index(),
-                    (*buf_it).prevPhysReg->className());
-
-            buf_it++;
+                    hb.instSeqNum,
+                    hb.archReg.className(),
+                    hb.archReg.index(),
+                    hb.newPhysReg->index(),
+                    hb.newPhysReg->className(),
+                    hb.prevPhysReg->index(),
+                    hb.prevPhysReg->className());
         }
     }
 }
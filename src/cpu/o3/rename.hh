@@ -42,9 +42,11 @@
 #ifndef __CPU_O3_RENAME_HH__
 #define __CPU_O3_RENAME_HH__
 
+#include <deque>
 #include <list>
 #include <utility>
 
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "cpu/o3/comm.hh"
 #include "cpu/o3/commit.hh"
@@ -52,6 +54,7 @@
 #include "cpu/o3/free_list.hh"
 #include "cpu/o3/iew.hh"
 #include "cpu/o3/limits.hh"
+#include "cpu/o3/rename_map.hh"
 #include "cpu/timebuf.hh"
 #include "sim/probe/probe.hh"
 
@@ -258,6 +261,24 @@ class Rename
     /** Executes actual squash, removing squashed instructions. */
     void doSquash(const InstSeqNum &squash_seq_num, ThreadID tid);
 
+    /** Squashes the renames younger than a checkpoint at once, returns
+     *  false if there is no checkpoint to recover from.
+     */
+    bool restoreCheckpoint(const InstSeqNum &squash_seq_num, ThreadID tid);
+
+    /** Removes the renames from a history buffer index on, and drops
+     *  the references of those sharing an older register.
+     */
+    void freeSquashedRegs(size_t squash_idx, ThreadID tid);
+
+    /** Gives back the registers allocated from the free list positions
+     *  on, which only squashed renames of the only thread hold.
+     */
+    void rewindFreeList(const UnifiedFreeList::Position &free_list_pos);
+
+    /** Takes a checkpoint after renaming a branch if one is free. */
+    void takeCheckpoint(const DynInstPtr &inst, ThreadID tid);
+
     /** Removes a committed instruction's rename history. */
     void removeFromHistory(InstSeqNum inst_seq_num, ThreadID tid);
 
@@ -309,29 +330,67 @@ class Rename
      */
     struct RenameHistory
     {
+        RenameHistory() = default;
+
         RenameHistory(InstSeqNum _instSeqNum, const RegId& _archReg,
                       PhysRegIdPtr _newPhysReg,
-                      PhysRegIdPtr _prevPhysReg)
+                      PhysRegIdPtr _prevPhysReg, bool _allocated)
             : instSeqNum(_instSeqNum), archReg(_archReg),
-              newPhysReg(_newPhysReg), prevPhysReg(_prevPhysReg)
+              newPhysReg(_newPhysReg), prevPhysReg(_prevPhysReg),
+              allocated(_allocated)
         {
         }
 
         /** The sequence number of the instruction that renamed. */
-        InstSeqNum instSeqNum;
+        InstSeqNum instSeqNum = 0;
         /** The architectural register index that was renamed. */
         RegId archReg;
         /** The new physical register that the arch. register is renamed to. */
-        PhysRegIdPtr newPhysReg;
+        PhysRegIdPtr newPhysReg = nullptr;
         /** The old physical register that the arch. register was renamed to.
          */
-        PhysRegIdPtr prevPhysReg;
+        PhysRegIdPtr prevPhysReg = nullptr;
+        /** Whether the new physical register came from the free list. */
+        bool allocated = false;
     };
 
     /** A per-thread list of all destination register renames, used to either
-     * undo rename mappings or free old physical registers.
+     * undo rename mappings or free old physical registers. The youngest
+     * rename is at the back.
+     */
+    CircularQueue<RenameHistory> historyBuffer[MaxThreads];
+
+    /** History buffer indices of the renames to a physical register that
+     *  was not allocated for them, i.e. of eliminated moves.
      */
-    std::list<RenameHistory> historyBuffer[MaxThreads];
+    std::deque<size_t> sharedRenames[MaxThreads];
+
+    /**
+     * The rename map and the free list heads right after renaming a
+     * branch. A squash to or past the branch restores them and redoes
+     * the renames up to the squashing instruction, rather than undoing
+     * every squashed rename.
+     */
+    struct RenameCheckpoint
+    {
+        /** The sequence number of the branch. */
+        InstSeqNum seqNum = 0;
+        /** History buffer index right after the renames of the branch. */
+        size_t historyIdx = 0;
+        /** The mappings of all register classes. */
+        UnifiedRenameMap::Snapshot map;
+        /** The free list positions of all register classes. */
+        UnifiedFreeList::Position freeListPos;
+    };
+
+    /** The live checkpoints of each thread, oldest first. */
+    CircularQueue<RenameCheckpoint> checkpoints[MaxThreads];
+
+    /** Number of checkpoints per thread, none disables them. */
+    const unsigned numCheckpoints;
+
+    /** Minimum number of renames between two checkpoints. */
+    const unsigned checkpointGap;
 
     void tryFreePReg(PhysRegIdPtr phys_reg);
 
@@ -540,6 +599,8 @@ class Rename
         /** Stat for total number of mappings that were undone due to a
          *  squash. */
         statistics::Scalar undoneMaps;
+        /** Number of squashes recovered from a checkpoint. */
+        statistics::Scalar checkpointRestores;
         /** Number of serialize instructions handled. */
         statistics::Scalar serializing;
         /** Number of instructions marked as temporarily serializing. */
@@ -182,6 +182,9 @@ class UnifiedRenameMap
 
     typedef SimpleRenameMap::RenameInfo RenameInfo;
 
+    /** A copy of the mappings of all register classes. */
+    using Snapshot = std::array<std::vector<PhysRegIdPtr>, RMiscRegClass + 1>;
+
     /** Default constructor.  init() must be called prior to use. */
     UnifiedRenameMap() : regFile(nullptr) {};
 
@@ -260,6 +263,25 @@ class UnifiedRenameMap
         return renameMaps[arch_reg.classValue()].setEntry(arch_reg, phys_reg);
     }
 
+    /** Copies all mappings to a snapshot. */
+    void
+    takeSnapshot(Snapshot &snapshot) const
+    {
+        for (int i = 0; i < renameMaps.size(); i++)
+            snapshot[i].assign(renameMaps[i].begin(), renameMaps[i].end());
+    }
+
+    /** Sets all mappings back to a snapshot. */
+    void
+    restoreSnapshot(const Snapshot &snapshot)
+    {
+        for (int i = 0; i < renameMaps.size(); i++) {
+            assert(snapshot[i].size() == renameMaps[i].numArchRegs());
+            std::copy(snapshot[i].begin(), snapshot[i].end(),
+                      renameMaps[i].begin());
+        }
+    }
+
     /**
      * Return the minimum number of free entries across all of the
      * register classes.  The minimum is used so we guarantee that
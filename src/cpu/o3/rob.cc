@@ -107,6 +107,10 @@ ROB::ROB(CPU *_cpu, const BaseO3CPUParams &params)
         maxEntries[tid] = 0;
     }
 
+    for (ThreadID tid = 0; tid < MaxThreads; tid++) {
+        instList[tid].reserve(numEntries);
+    }
+
     resetState();
 }
 
@@ -115,7 +119,6 @@ ROB::resetState()
 {
     for (ThreadID tid = 0; tid  < MaxThreads; tid++) {
         threadEntries[tid] = 0;
-        squashIt[tid] = instList[tid].end();
         squashedSeqNum[tid] = 0;
         doneSquashing[tid] = true;
     }
@@ -247,11 +250,10 @@ ROB::retireHead(ThreadID tid)
 
     assert(numInstsInROB > 0);
 
-    // Get the head ROB instruction by copying it and remove it from the list
-    InstIt head_it = instList[tid].begin();
-
-    DynInstPtr head_inst = std::move(*head_it);
-    instList[tid].erase(head_it);
+    // Get the head ROB instruction by moving it out of its slot
+    DynInstPtr head_inst = std::move(instList[tid].front());
+    instList[tid].front() = nullptr;
+    instList[tid].pop_front();
 
     assert(head_inst->readyToCommit());
     assert(!head_inst->isSquashed());
@@ -323,19 +325,9 @@ ROB::doSquash(ThreadID tid)
     DPRINTF(ROB, "[tid:%i] Squashing instructions until [sn:%llu].\n",
             tid, squashedSeqNum[tid]);
 
-    assert(squashIt[tid] != instList[tid].end());
-
-    if ((*squashIt[tid])->seqNum < squashedSeqNum[tid]) {
-        DPRINTF(ROB, "[tid:%i] Done squashing instructions.\n",
-                tid);
-
-        squashIt[tid] = instList[tid].end();
-
-        doneSquashing[tid] = true;
-        return;
-    }
-
-    bool robTailUpdate = false;
+    // The squashed instructions are the youngest ones, so squashing
+    // just moves the tail of the thread back, a few entries per cycle.
+    assert(!instList[tid].empty());
 
     assert(dynSquashWidth);
     unsigned int num_insts_to_squash = dynSquashWidth;
@@ -348,65 +340,46 @@ ROB::doSquash(ThreadID tid)
         num_insts_to_squash = numEntries;
     }
 
+    bool robTailUpdate = false;
+
     for (int numSquashed = 0;
          numSquashed < num_insts_to_squash &&
-         squashIt[tid] != instList[tid].end() &&
-         (*squashIt[tid])->seqNum > squashedSeqNum[tid];
+         !instList[tid].empty() &&
+         instList[tid].back()->seqNum > squashedSeqNum[tid];
          ++numSquashed)
     {
+        DynInstPtr inst = std::move(instList[tid].back());
+        instList[tid].back() = nullptr;
+        instList[tid].pop_back();
+
         DPRINTF(ROB, "[tid:%i] Squashing instruction PC %s, seq num %i.\n",
-                (*squashIt[tid])->threadNumber,
-                (*squashIt[tid])->pcState(),
-                (*squashIt[tid])->seqNum);
+                inst->threadNumber,
+                inst->pcState(),
+                inst->seqNum);
 
         // Mark the instruction as squashed, and ready to commit so that
         // it can drain out of the pipeline.
-        (*squashIt[tid])->setSquashed();
+        inst->setSquashed();
 
-        (*squashIt[tid])->setCanCommit();
+        inst->setCanCommit();
 
-        // printf("[ROB] squash seqNum %ld\n", (*squashIt[tid])->seqNum);
-
-        auto prevIt = std::prev(squashIt[tid]);
         --numInstsInROB;
         --threadEntries[tid];
 
-        (*squashIt[tid])->clearInROB();
-        // head_inst->setCommitted();
-        cpu->removeFrontInst(*squashIt[tid]);
-
-        if (instList[tid].empty() || squashIt[tid] == instList[tid].begin()) {
-            DPRINTF(ROB, "Reached head of instruction list while "
-                    "squashing.\n");
-
-            instList[tid].erase(squashIt[tid]);
-
-            squashIt[tid] = instList[tid].end();
-
-            doneSquashing[tid] = true;
+        inst->clearInROB();
+        cpu->removeFrontInst(inst);
 
-            return;
-        }
-
-        InstIt tail_thread = instList[tid].end();
-        tail_thread--;
-
-        if ((*squashIt[tid]) == (*tail_thread))
-            robTailUpdate = true;
-
-        instList[tid].erase(squashIt[tid]);
-
-        squashIt[tid] = prevIt;
+        robTailUpdate = true;
     }
 
-
     // Check if ROB is done squashing.
-    if ((*squashIt[tid])->seqNum <= squashedSeqNum[tid]) {
+    if (instList[tid].empty()) {
+        DPRINTF(ROB, "Reached head of instruction list while "
+                "squashing.\n");
+        doneSquashing[tid] = true;
+    } else if (instList[tid].back()->seqNum <= squashedSeqNum[tid]) {
         DPRINTF(ROB, "[tid:%i] Done squashing instructions.\n",
                 tid);
-
-        squashIt[tid] = instList[tid].end();
-
         doneSquashing[tid] = true;
     }
 
@@ -513,26 +486,19 @@ ROB::squash(InstSeqNum squash_num, ThreadID tid)
 
     squashedSeqNum[tid] = squash_num;
 
-    // TODO: find the number of instructions to squash and
-    // the number of uncommited instructions
+    // find the number of instructions to squash, which are the youngest
+    // ones, and the number of uncommited instructions
     unsigned total_inst_to_squash = 0;
-    for (auto it = instList[tid].begin(); it != instList[tid].end(); ++it) {
-        if ((*it)->seqNum > squash_num) {
-            total_inst_to_squash++;
-        }
+    for (size_t idx = instList[tid].tail();
+         total_inst_to_squash < instList[tid].size() &&
+         instList[tid][idx]->seqNum > squash_num; idx--) {
+        total_inst_to_squash++;
     }
     unsigned num_uncommited_inst = instList[tid].size() - total_inst_to_squash;
 
     dynSquashWidth = computeDynSquashWidth(num_uncommited_inst, total_inst_to_squash);
 
-    if (!instList[tid].empty()) {
-        InstIt tail_thread = instList[tid].end();
-        tail_thread--;
-
-        squashIt[tid] = tail_thread;
-
-        doSquash(tid);
-    }
+    doSquash(tid);
 }
 
 unsigned
@@ -573,11 +539,9 @@ const DynInstPtr&
 ROB::readHeadInst(ThreadID tid)
 {
     if (threadEntries[tid] != 0) {
-        InstIt head_thread = instList[tid].begin();
+        assert(instList[tid].front()->isInROB());
 
-        assert((*head_thread)->isInROB());
-
-        return *head_thread;
+        return instList[tid].front();
     } else {
         return dummyInst;
     }
@@ -586,10 +550,7 @@ ROB::readHeadInst(ThreadID tid)
 DynInstPtr
 ROB::readTailInst(ThreadID tid)
 {
-    InstIt tail_thread = instList[tid].end();
-    tail_thread--;
-
-    return *tail_thread;
+    return instList[tid].back();
 }
 
 ROB::ROBStats::ROBStats(statistics::Group *parent)
@@ -41,10 +41,12 @@
 #ifndef __CPU_O3_ROB_HH__
 #define __CPU_O3_ROB_HH__
 
+#include <list>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "base/circular_queue.hh"
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "config/the_isa.hh"
@@ -74,7 +76,8 @@ class ROB
 {
   public:
     typedef std::pair<RegIndex, RegIndex> UnmapInfo;
-    typedef typename std::list<DynInstPtr>::iterator InstIt;
+    typedef CircularQueue<DynInstPtr> InstQueue;
+    typedef typename InstQueue::iterator InstIt;
 
     /** Possible ROB statuses. */
     enum Status
@@ -289,8 +292,8 @@ class ROB
     /** Max Insts a Thread Can Have in the ROB */
     unsigned maxEntries[MaxThreads];
 
-    /** ROB List of Instructions */
-    std::list<DynInstPtr> instList[MaxThreads];
+    /** ROB List of Instructions, one slot per ROB entry */
+    InstQueue instList[MaxThreads];
 
     /** Number of instructions that can be squashed in a single cycle. */
     unsigned rollbackWidth;
@@ -304,7 +307,7 @@ class ROB
     unsigned computeDynSquashWidth(unsigned uncommitted_insts, unsigned to_squash);
 
   public:
-    std::list<DynInstPtr>* getInstList(ThreadID tid){
+    InstQueue* getInstList(ThreadID tid){
         return &instList[tid];
     }
     /** Iterator pointing to the instruction which is the last instruction
@@ -317,16 +320,6 @@ class ROB
      *  in the ROB*/
     InstIt head;
 
-  private:
-    /** Iterator used for walking through the list of instructions when
-     *  squashing.  Used so that there is persistent state between cycles;
-     *  when squashing, the instructions are marked as squashed but not
-     *  immediately removed, meaning the tail iterator remains the same before
-     *  and after a squash.
-     *  This will always be set to cpu->instList.end() if it is invalid.
-     */
-    InstIt squashIt[MaxThreads];
-
   public:
     /** Number of instructions in the ROB. */
     int numInstsInROB;
@@ -0,0 +1,109 @@
+#include "cpu/o3/store_buffer_index.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+void
+StoreBufferIndex::init(size_t num_entries)
+{
+    lineIndexBits = std::max(ceilLog2(2 * num_entries), 1);
+    lineIndex.assign(size_t(1) << lineIndexBits, NoEntry);
+    lineAddr.assign(num_entries, 0);
+    lruPrev.assign(num_entries, NoEntry);
+    lruNext.assign(num_entries, NoEntry);
+    lruHead = _lruTail = NoEntry;
+    _lruSize = 0;
+}
+
+void
+StoreBufferIndex::insertLine(int index, Addr addr)
+{
+    const size_t slot_mask = lineIndex.size() - 1;
+    size_t slot = lineSlot(addr);
+    while (lineIndex[slot] != NoEntry) {
+        assert(lineAddr[lineIndex[slot]] != addr);
+        slot = (slot + 1) & slot_mask;
+    }
+    lineIndex[slot] = index;
+    lineAddr[index] = addr;
+}
+
+void
+StoreBufferIndex::removeLine(int index)
+{
+    const size_t slot_mask = lineIndex.size() - 1;
+    size_t hole = lineSlot(lineAddr[index]);
+    while (lineIndex[hole] != index) {
+        assert(lineIndex[hole] != NoEntry);
+        hole = (hole + 1) & slot_mask;
+    }
+
+    // Move back the lines probed past the hole, so that no lookup stops
+    // at it before reaching them
+    for (size_t slot = (hole + 1) & slot_mask; lineIndex[slot] != NoEntry;
+         slot = (slot + 1) & slot_mask) {
+        const size_t home = lineSlot(lineAddr[lineIndex[slot]]);
+        if (((slot - home) & slot_mask) >= ((slot - hole) & slot_mask)) {
+            lineIndex[hole] = lineIndex[slot];
+            hole = slot;
+        }
+    }
+    lineIndex[hole] = NoEntry;
+}
+
+int
+StoreBufferIndex::findLine(Addr addr) const
+{
+    const size_t slot_mask = lineIndex.size() - 1;
+    for (size_t slot = lineSlot(addr); lineIndex[slot] != NoEntry;
+         slot = (slot + 1) & slot_mask) {
+        if (lineAddr[lineIndex[slot]] == addr) {
+            return lineIndex[slot];
+        }
+    }
+    return NoEntry;
+}
+
+void
+StoreBufferIndex::lruPushFront(int index)
+{
+    lruPrev[index] = NoEntry;
+    lruNext[index] = lruHead;
+    if (lruHead != NoEntry) {
+        lruPrev[lruHead] = index;
+    } else {
+        _lruTail = index;
+    }
+    lruHead = index;
+    _lruSize++;
+}
+
+void
+StoreBufferIndex::lruRemove(int index)
+{
+    assert(_lruSize > 0);
+    if (lruPrev[index] != NoEntry) {
+        lruNext[lruPrev[index]] = lruNext[index];
+    } else {
+        assert(lruHead == index);
+        lruHead = lruNext[index];
+    }
+    if (lruNext[index] != NoEntry) {
+        lruPrev[lruNext[index]] = lruPrev[index];
+    } else {
+        assert(_lruTail == index);
+        _lruTail = lruPrev[index];
+    }
+    _lruSize--;
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,70 @@
+#ifndef __CPU_O3_STORE_BUFFER_INDEX_HH__
+#define __CPU_O3_STORE_BUFFER_INDEX_HH__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Bookkeeping of the store buffer entries, named by their index: which
+ * entry holds a line, and the order in which the unsent entries were
+ * last written.
+ *
+ * Lines are found in an open-addressed, linear-probing table keyed by
+ * the full line address, twice as large as the number of entries.
+ * Removal shifts the lines probed past the hole back, so no tombstones
+ * are left. The unsent entries are linked from the most to the least
+ * recently written one.
+ */
+class StoreBufferIndex
+{
+  public:
+    static constexpr int NoEntry = -1;
+
+    /** Forget everything and make room for num_entries entries */
+    void init(size_t num_entries);
+
+    /** Entry index holds the line at addr, no other entry may */
+    void insertLine(int index, Addr addr);
+    void removeLine(int index);
+    /** The entry holding the line at addr, NoEntry if there is none */
+    int findLine(Addr addr) const;
+
+    /** Make index the most recently written unsent entry */
+    void lruPushFront(int index);
+    void lruRemove(int index);
+    /** The least recently written unsent entry */
+    int lruTail() const { return _lruTail; }
+    size_t lruSize() const { return _lruSize; }
+
+  private:
+    // entries of the lines, NoEntry marks a free slot
+    std::vector<int> lineIndex;
+    unsigned lineIndexBits = 0;
+    // line held by each entry, valid while it is in lineIndex
+    std::vector<Addr> lineAddr;
+
+    std::vector<int> lruPrev;
+    std::vector<int> lruNext;
+    int lruHead = NoEntry;
+    int _lruTail = NoEntry;
+    size_t _lruSize = 0;
+
+    size_t
+    lineSlot(Addr addr) const
+    {
+        return (addr * 0x9e3779b97f4a7c15ULL) >> (64 - lineIndexBits);
+    }
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_STORE_BUFFER_INDEX_HH__
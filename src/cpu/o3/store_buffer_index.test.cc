@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "cpu/o3/store_buffer_index.hh"
+
+using namespace gem5;
+using namespace gem5::o3;
+
+/** Removing a line keeps the lines probed past it reachable */
+TEST(StoreBufferIndexTest, RemoveInProbeChain)
+{
+    StoreBufferIndex index;
+    index.init(4);
+
+    // few slots, so some of the lines collide
+    for (int i = 0; i < 4; i++) {
+        index.insertLine(i, 0x80000000 + 0x40 * i);
+    }
+    index.removeLine(1);
+    ASSERT_EQ(index.findLine(0x80000040), StoreBufferIndex::NoEntry);
+    for (int i : {0, 2, 3}) {
+        ASSERT_EQ(index.findLine(0x80000000 + 0x40 * i), i);
+    }
+
+    // lines above 4GiB are told apart from the ones below
+    index.insertLine(1, 0x180000040);
+    ASSERT_EQ(index.findLine(0x180000040), 1);
+    ASSERT_EQ(index.findLine(0x80000040), StoreBufferIndex::NoEntry);
+}
+
+/** The LRU gives back the least recently written entry */
+TEST(StoreBufferIndexTest, LruOrder)
+{
+    StoreBufferIndex index;
+    index.init(4);
+    ASSERT_EQ(index.lruSize(), 0);
+
+    index.lruPushFront(2);
+    index.lruPushFront(0);
+    index.lruPushFront(3);
+    ASSERT_EQ(index.lruTail(), 2);
+
+    // a merge into 2 makes it the most recent
+    index.lruRemove(2);
+    index.lruPushFront(2);
+    ASSERT_EQ(index.lruTail(), 0);
+    ASSERT_EQ(index.lruSize(), 3);
+
+    index.lruRemove(0);
+    index.lruRemove(3);
+    ASSERT_EQ(index.lruTail(), 2);
+    index.lruRemove(2);
+    ASSERT_EQ(index.lruSize(), 0);
+    ASSERT_EQ(index.lruTail(), StoreBufferIndex::NoEntry);
+}
+
+/**
+ * Insert, merge into, evict and release lines at random the way the
+ * store buffer does, and check every lookup and eviction against a
+ * std::map of the lines and a std::list in LRU order.
+ */
+TEST(StoreBufferIndexTest, RandomAgainstMapAndList)
+{
+    const int num_entries = 16;
+    std::mt19937_64 rng(0x5b1d);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+    // lines clustered in a few pages, some of them above 4GiB
+    auto rand_line = [&]() -> Addr {
+        Addr page = rand(4) * 0x100000000ULL + rand(4) * 0x1000;
+        return 0x80000000 + page + rand(64) * 0x40;
+    };
+
+    StoreBufferIndex index;
+    index.init(num_entries);
+    std::map<Addr, int> lines;
+    std::map<int, Addr> line_of;
+    // unsent entries, most recently written first
+    std::list<int> lru;
+    std::vector<int> free_list;
+    for (int i = 0; i < num_entries; i++) {
+        free_list.push_back(i);
+    }
+
+    for (int step = 0; step < 200000; step++) {
+        Addr addr = rand_line();
+        switch (rand(4)) {
+          case 0:
+            // a store to a new line, or a merge into the one holding it
+            if (lines.count(addr)) {
+                int entry = lines[addr];
+                auto it = std::find(lru.begin(), lru.end(), entry);
+                if (it != lru.end()) {
+                    lru.erase(it);
+                    lru.push_front(entry);
+                    index.lruRemove(entry);
+                    index.lruPushFront(entry);
+                }
+            } else if (!free_list.empty()) {
+                int entry = free_list.back();
+                free_list.pop_back();
+                lines[addr] = entry;
+                line_of[entry] = addr;
+                lru.push_front(entry);
+                index.insertLine(entry, addr);
+                index.lruPushFront(entry);
+            }
+            break;
+          case 1:
+            // send the least recently written line
+            ASSERT_EQ(index.lruSize(), lru.size());
+            if (!lru.empty()) {
+                ASSERT_EQ(index.lruTail(), lru.back());
+                index.lruRemove(lru.back());
+                lru.pop_back();
+            }
+            break;
+          case 2:
+            // a sent line is written back
+            if (line_of.size() > lru.size()) {
+                auto it = std::next(line_of.begin(), rand(line_of.size()));
+                if (std::find(lru.begin(), lru.end(), it->first) ==
+                    lru.end()) {
+                    index.removeLine(it->first);
+                    lines.erase(it->second);
+                    free_list.push_back(it->first);
+                    line_of.erase(it);
+                }
+            }
+            break;
+          default:
+            {
+                auto it = lines.find(addr);
+                ASSERT_EQ(index.findLine(addr),
+                          it == lines.end() ? StoreBufferIndex::NoEntry
+                                            : it->second)
+                    << "step " << step << " line " << addr;
+            }
+        }
+    }
+}
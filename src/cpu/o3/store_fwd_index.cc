@@ -0,0 +1,139 @@
+#include "cpu/o3/store_fwd_index.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+StoreForwardIndex::StoreForwardIndex(size_t num_stores)
+    : records(std::max<size_t>(num_stores, 1)),
+      bucketBits(std::max(ceilLog2(2 * records.size()), 1))
+{
+    buckets.resize(size_t(1) << bucketBits);
+}
+
+void
+StoreForwardIndex::insert(size_t sq_idx, Addr addr, unsigned size)
+{
+    Record &rec = record(sq_idx);
+    if (rec.valid) {
+        remove(rec.sqIdx);
+    }
+    // empty and wrapping stores never cover a load
+    if (size == 0 || addr + size < addr) {
+        return;
+    }
+
+    rec.valid = true;
+    rec.sqIdx = sq_idx;
+    rec.firstGranule = addr >> GranuleShift;
+    rec.lastGranule = (addr + size - 1) >> GranuleShift;
+    rec.wide = rec.lastGranule - rec.firstGranule >= MaxGranules;
+    if (rec.wide) {
+        wideStores.push_back(sq_idx);
+        return;
+    }
+    for (Addr g = rec.firstGranule; g <= rec.lastGranule; g++) {
+        buckets[bucket(g)].push_back(sq_idx);
+    }
+}
+
+void
+StoreForwardIndex::remove(size_t sq_idx)
+{
+    Record &rec = record(sq_idx);
+    if (!rec.valid || rec.sqIdx != sq_idx) {
+        return;
+    }
+    rec.valid = false;
+    if (rec.wide) {
+        erase(wideStores, sq_idx);
+        return;
+    }
+    for (Addr g = rec.firstGranule; g <= rec.lastGranule; g++) {
+        erase(buckets[bucket(g)], sq_idx);
+    }
+}
+
+void
+StoreForwardIndex::clear()
+{
+    for (auto &rec : records) {
+        rec.valid = false;
+    }
+    for (auto &stores : buckets) {
+        stores.clear();
+    }
+    wideStores.clear();
+}
+
+void
+StoreForwardIndex::erase(std::vector<size_t> &stores, size_t sq_idx)
+{
+    // the order of a bucket does not matter, find() sorts by age
+    auto it = std::find(stores.begin(), stores.end(), sq_idx);
+    assert(it != stores.end());
+    *it = stores.back();
+    stores.pop_back();
+}
+
+void
+StoreForwardIndex::find(Addr addr, unsigned size, size_t begin, size_t end,
+                        std::vector<size_t> &stores) const
+{
+    stores.clear();
+    // a wrapping load is not covered by any store
+    if (addr + size < addr) {
+        return;
+    }
+
+    // an empty load is covered by a store ending right at it too
+    const Addr first = size || !addr ? addr : addr - 1;
+    const Addr last = size ? addr + size - 1 : addr;
+    const Addr first_granule = first >> GranuleShift;
+    const Addr last_granule = last >> GranuleShift;
+
+    if (last_granule - first_granule >= records.size() * MaxGranules) {
+        // a load wider than all stores together, take all of them
+        for (const auto &rec : records) {
+            if (rec.valid) {
+                stores.push_back(rec.sqIdx);
+            }
+        }
+    } else {
+        for (Addr g = first_granule; g <= last_granule; g++) {
+            for (size_t sq_idx : buckets[bucket(g)]) {
+                const Record &rec = records[sq_idx % records.size()];
+                // skip the other granules hashed to this bucket
+                if (rec.firstGranule <= g && g <= rec.lastGranule) {
+                    stores.push_back(sq_idx);
+                }
+            }
+        }
+        for (size_t sq_idx : wideStores) {
+            const Record &rec = records[sq_idx % records.size()];
+            if (rec.firstGranule <= last_granule &&
+                first_granule <= rec.lastGranule) {
+                stores.push_back(sq_idx);
+            }
+        }
+    }
+
+    stores.erase(std::remove_if(stores.begin(), stores.end(),
+                                [begin, end](size_t sq_idx) {
+                                    return sq_idx < begin || sq_idx >= end;
+                                }),
+                 stores.end());
+    std::sort(stores.begin(), stores.end(), std::greater<size_t>());
+    stores.erase(std::unique(stores.begin(), stores.end()), stores.end());
+}
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,141 @@
+#ifndef __CPU_O3_STORE_FWD_INDEX_HH__
+#define __CPU_O3_STORE_FWD_INDEX_HH__
+
+#include <cstddef>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/** Coverage of one address range with another */
+enum class AddrRangeCoverage
+{
+    PartialAddrRangeCoverage, /* Two ranges partly overlap */
+    FullAddrRangeCoverage, /* One range fully covers another */
+    NoAddrRangeCoverage /* Two ranges are disjoint */
+};
+
+/**
+ * How much of the bytes [req_s, req_e) of a load the bytes [st_s, st_e)
+ * of an older store cover. An atomic store has no data to forward and
+ * an LL load must read memory, so they only ever cover partially, which
+ * makes the load wait for the store. A store with a byte mask may not
+ * write all the bytes of its range, the caller has to downgrade a full
+ * coverage of such a store.
+ */
+inline AddrRangeCoverage
+storeCoverage(Addr req_s, Addr req_e, Addr st_s, Addr st_e,
+              bool load_llsc, bool store_atomic)
+{
+    bool store_has_lower_limit = req_s >= st_s;
+    bool store_has_upper_limit = req_e <= st_e;
+    bool lower_load_has_store_part = req_s < st_e;
+    bool upper_load_has_store_part = req_e > st_s;
+    bool no_wrap = !((req_s > req_e) || (st_s > st_e));
+
+    if (!store_atomic && store_has_lower_limit && store_has_upper_limit &&
+        !load_llsc && no_wrap) {
+        return AddrRangeCoverage::FullAddrRangeCoverage;
+    }
+    if (no_wrap &&
+        (
+            // This is the partial store-load forwarding case where a
+            // store has only part of the load's data and the load isn't
+            // LLSC
+            (!load_llsc &&
+             ((store_has_lower_limit && lower_load_has_store_part) ||
+              (store_has_upper_limit && upper_load_has_store_part) ||
+              (lower_load_has_store_part && upper_load_has_store_part))) ||
+            // The load is LLSC, and the store has all or part of the
+            // load's data
+            (load_llsc &&
+             ((store_has_lower_limit || upper_load_has_store_part) &&
+              (store_has_upper_limit || lower_load_has_store_part))) ||
+            // The store entry is atomic and has all or part of the
+            // load's data
+            (store_atomic &&
+             ((store_has_lower_limit || upper_load_has_store_part) &&
+              (store_has_upper_limit || lower_load_has_store_part))))) {
+        return AddrRangeCoverage::PartialAddrRangeCoverage;
+    }
+    return AddrRangeCoverage::NoAddrRangeCoverage;
+}
+
+/**
+ * The stores of a store queue whose addresses are known, hashed by the
+ * 64-byte granules they write. A load looks up the stores writing its
+ * granules instead of walking every older store of the queue.
+ *
+ * Stores are named by their store queue index, which only grows, so
+ * it also gives their age. A store covering a load in any way writes a
+ * granule the load reads, or the one just before an empty load, so the
+ * lookup never misses a store the walk would have stopped at.
+ */
+class StoreForwardIndex
+{
+  public:
+    static constexpr unsigned GranuleShift = 6;
+
+    /** @param num_stores Number of stores in flight at most */
+    explicit StoreForwardIndex(size_t num_stores);
+
+    /**
+     * Index the store at sq_idx writing [addr, addr + size), in place
+     * of what was indexed for it before.
+     */
+    void insert(size_t sq_idx, Addr addr, unsigned size);
+
+    /** Forget the store at sq_idx, if it is indexed */
+    void remove(size_t sq_idx);
+
+    void clear();
+
+    /**
+     * The store queue indices in [begin, end) of the stores that may
+     * cover the load of [addr, addr + size), youngest first.
+     */
+    void find(Addr addr, unsigned size, size_t begin, size_t end,
+              std::vector<size_t> &stores) const;
+
+  private:
+    /** Stores wider than this many granules are not hashed */
+    static constexpr Addr MaxGranules = 4;
+
+    struct Record
+    {
+        bool valid = false;
+        bool wide = false;
+        size_t sqIdx = 0;
+        Addr firstGranule = 0;
+        Addr lastGranule = 0;
+    };
+
+    /** One record per store queue slot */
+    std::vector<Record> records;
+
+    std::vector<std::vector<size_t>> buckets;
+    unsigned bucketBits;
+
+    /** Stores writing too many granules to hash, checked every time */
+    std::vector<size_t> wideStores;
+
+    Record &record(size_t sq_idx) { return records[sq_idx % records.size()]; }
+
+    size_t
+    bucket(Addr granule) const
+    {
+        return (granule * 0x9e3779b97f4a7c15ULL) >> (64 - bucketBits);
+    }
+
+    static void erase(std::vector<size_t> &stores, size_t sq_idx);
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_STORE_FWD_INDEX_HH__
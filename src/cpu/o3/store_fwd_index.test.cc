@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include "cpu/o3/store_fwd_index.hh"
+
+using namespace gem5;
+using namespace gem5::o3;
+
+namespace
+{
+
+struct Store
+{
+    size_t idx;
+    Addr addr = 0;
+    unsigned size = 0;
+    bool atomic = false;
+    bool masked = false;
+};
+
+struct Decision
+{
+    size_t idx = 0;
+    AddrRangeCoverage coverage = AddrRangeCoverage::NoAddrRangeCoverage;
+};
+
+AddrRangeCoverage
+coverage(const Store &st, Addr addr, unsigned size, bool llsc)
+{
+    if (st.size == 0) {
+        return AddrRangeCoverage::NoAddrRangeCoverage;
+    }
+    auto cov = storeCoverage(addr, addr + size, st.addr, st.addr + st.size,
+                             llsc, st.atomic);
+    if (cov == AddrRangeCoverage::FullAddrRangeCoverage && st.masked) {
+        cov = AddrRangeCoverage::PartialAddrRangeCoverage;
+    }
+    return cov;
+}
+
+/** The store queue walk LSQUnit::read() did before the index */
+Decision
+linearScan(const std::deque<Store> &sq, size_t begin, size_t end,
+           Addr addr, unsigned size, bool llsc)
+{
+    Decision d;
+    for (size_t idx = end; idx-- > begin;) {
+        const Store &st = sq[idx - sq.front().idx];
+        d.coverage = coverage(st, addr, size, llsc);
+        if (d.coverage != AddrRangeCoverage::NoAddrRangeCoverage) {
+            d.idx = idx;
+            return d;
+        }
+    }
+    return d;
+}
+
+Decision
+indexedScan(const StoreForwardIndex &index, const std::deque<Store> &sq,
+            size_t begin, size_t end, Addr addr, unsigned size, bool llsc)
+{
+    std::vector<size_t> candidates;
+    index.find(addr, size, begin, end, candidates);
+    Decision d;
+    for (size_t idx : candidates) {
+        const Store &st = sq[idx - sq.front().idx];
+        d.coverage = coverage(st, addr, size, llsc);
+        if (d.coverage != AddrRangeCoverage::NoAddrRangeCoverage) {
+            d.idx = idx;
+            return d;
+        }
+    }
+    return d;
+}
+
+} // anonymous namespace
+
+/** A store is found by the loads reading the granules it writes */
+TEST(StoreForwardIndexTest, FindByGranule)
+{
+    StoreForwardIndex index(8);
+    std::vector<size_t> found;
+
+    index.insert(3, 0x1000, 8);
+    index.find(0x1004, 4, 0, 8, found);
+    ASSERT_EQ(found, std::vector<size_t>{3});
+
+    // the same granule only makes a candidate, coverage decides
+    index.find(0x1020, 8, 0, 8, found);
+    ASSERT_EQ(found, std::vector<size_t>{3});
+    index.find(0x1040, 8, 0, 8, found);
+    ASSERT_TRUE(found.empty());
+
+    // a store crossing into the next granule
+    index.insert(4, 0x103c, 8);
+    index.find(0x1040, 8, 0, 8, found);
+    ASSERT_EQ(found, std::vector<size_t>{4});
+
+    // an empty load right behind a store
+    index.find(0x10c0, 0, 0, 8, found);
+    ASSERT_TRUE(found.empty());
+    index.insert(5, 0x10b8, 8);
+    index.find(0x10c0, 0, 0, 8, found);
+    ASSERT_EQ(found, std::vector<size_t>{5});
+}
+
+/** Candidates are youngest first and limited to the window */
+TEST(StoreForwardIndexTest, WindowAndOrder)
+{
+    StoreForwardIndex index(8);
+    std::vector<size_t> found;
+
+    index.insert(2, 0x2000, 8);
+    index.insert(5, 0x2004, 4);
+    index.insert(7, 0x1ff8, 0x400);
+    index.find(0x2004, 4, 0, 8, found);
+    ASSERT_EQ(found, (std::vector<size_t>{7, 5, 2}));
+    index.find(0x2004, 4, 3, 7, found);
+    ASSERT_EQ(found, std::vector<size_t>{5});
+
+    index.remove(5);
+    index.find(0x2004, 4, 0, 8, found);
+    ASSERT_EQ(found, (std::vector<size_t>{7, 2}));
+
+    // reusing the slot of 2 replaces it
+    index.insert(10, 0x3000, 4);
+    index.find(0x2004, 4, 0, 16, found);
+    ASSERT_EQ(found, std::vector<size_t>{7});
+
+    index.clear();
+    index.find(0x2004, 4, 0, 16, found);
+    ASSERT_TRUE(found.empty());
+}
+
+/**
+ * Run a store queue through random pushes, address resolutions,
+ * commits and squashes, and check that every load picks the same store
+ * with the same coverage as the linear walk.
+ */
+TEST(StoreForwardIndexTest, RandomAgainstLinearScan)
+{
+    const size_t num_entries = 16;
+    const unsigned sizes[] = {0, 1, 2, 4, 8, 16, 32, 64, 100, 300};
+    std::mt19937_64 rng(0x5eed);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+    auto rand_addr = [&]() -> Addr {
+        switch (rand(8)) {
+          case 0: return rand(128);
+          case 1: return MaxAddr - rand(128);
+          case 2: case 3: return 0x8000 + rand(64) * 8;
+          default: return 0x8000 + rand(512);
+        }
+    };
+
+    StoreForwardIndex index(num_entries);
+    std::deque<Store> sq;
+    size_t next_idx = 0;
+    size_t wb_idx = 0;
+
+    for (int step = 0; step < 200000; step++) {
+        switch (rand(6)) {
+          case 0:
+            if (sq.size() < num_entries) {
+                sq.push_back(Store{next_idx++});
+            }
+            break;
+          case 1:
+            if (!sq.empty()) {
+                Store &st = sq[rand(sq.size())];
+                st.addr = rand_addr();
+                st.size = sizes[rand(std::size(sizes))];
+                st.atomic = rand(8) == 0;
+                st.masked = rand(8) == 0;
+                index.insert(st.idx, st.addr, st.size);
+            }
+            break;
+          case 2:
+            if (!sq.empty() && wb_idx > sq.front().idx) {
+                index.remove(sq.front().idx);
+                sq.pop_front();
+            }
+            break;
+          case 3:
+            if (!sq.empty() && sq.back().idx >= wb_idx) {
+                index.remove(sq.back().idx);
+                sq.pop_back();
+                next_idx--;
+            }
+            break;
+          case 4:
+            if (wb_idx < next_idx) {
+                wb_idx++;
+            }
+            break;
+          default:
+            {
+                if (sq.empty()) {
+                    break;
+                }
+                size_t begin = std::max(wb_idx, sq.front().idx);
+                size_t end = begin + rand(next_idx - begin + 1);
+                Addr addr = rand_addr();
+                unsigned size = sizes[rand(std::size(sizes))];
+                if (rand(4) == 0) {
+                    // load at the edges of a store
+                    const Store &st = sq[rand(sq.size())];
+                    addr = st.addr + (rand(2) ? st.size : 0);
+                }
+                bool llsc = rand(8) == 0;
+
+                Decision expected =
+                    linearScan(sq, begin, end, addr, size, llsc);
+                Decision actual =
+                    indexedScan(index, sq, begin, end, addr, size, llsc);
+                ASSERT_EQ(actual.coverage, expected.coverage)
+                    << "step " << step << " load " << addr << "+" << size;
+                ASSERT_EQ(actual.idx, expected.idx)
+                    << "step " << step << " load " << addr << "+" << size;
+            }
+        }
+    }
+}
@@ -195,6 +195,25 @@ class BPredUnit : public SimObject
         BTB.update(instPC, target, 0);
     }
 
+    /**
+     * Trains the predictor with an instruction retired by a functional
+     * warmup CPU, which has no fetch stage of its own to drive it.
+     * Predictors that are not trained this way ignore it.
+     * @param inst The retired instruction.
+     * @param pc The PC of the instruction, with its resolved next PC.
+     * @param next_pc The PC the warmup CPU goes on with.
+     */
+    virtual void
+    warmupCommit(ThreadID tid, const StaticInstPtr &inst,
+                 const PCStateBase &pc, const PCStateBase &next_pc)
+    {}
+
+    /**
+     * Ends a functional warmup, leaving nothing in flight so that a
+     * detailed CPU can start fetching from pc.
+     */
+    virtual void warmupHandOver(ThreadID tid, const PCStateBase &pc) {}
+
 
     void dump();
 
@@ -133,10 +133,12 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
 
     s0PC = 0x80000000;
 
-    s0History.resize(historyBits, 0);
+    fatal_if(historyBits > GlobalHistory::capacity(), "maxHistLen %u exceeds the history capacity %u\n",
+             historyBits, GlobalHistory::capacity());
+    s0History.resize(historyBits);
     fetchTargetQueue.setName(name());
 
-    commitHistory.resize(historyBits, 0);
+    commitHistory.resize(historyBits);
     squashing = true;
 
     lp = LoopPredictor(16, 4, enableLoopDB);
@@ -437,6 +439,16 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
     });
 }
 
+DecoupledBPUWithFTB::~DecoupledBPUWithFTB()
+{
+    // the streams hold PredMetaRefs into the pools of the components,
+    // release them while the components are still there
+    fetchStreamQueue.clear();
+    lastCommittedStream = FetchStream();
+    streamToEnqueue = FetchStream();
+    lb.streamBeforeLoop = FetchStream();
+}
+
 DecoupledBPUWithFTB::DBPFTBStats::DBPFTBStats(statistics::Group* parent, unsigned numStages, unsigned fsqSize):
     statistics::Group(parent),
     ADD_STAT(condNum, statistics::units::Count::get(), "the number of cond branches"),
@@ -1742,9 +1754,7 @@ void DecoupledBPUWithFTB::update(unsigned stream_id, ThreadID tid)
         }
 
         if (/* stream.startPC == ObservingPC &&  */stream.squashType == SQUASH_CTRL) {
-            auto hist(stream.history);
-            hist.resize(18);
-            uint64_t pattern = hist.to_ulong();
+            uint64_t pattern = stream.history.low(18);
             auto find_it = topMispredHist.find(pattern);
             if (find_it == topMispredHist.end()) {
                 topMispredHist[pattern] = 1;
@@ -2269,13 +2279,9 @@ DecoupledBPUWithFTB::tryEnqFetchTarget()
 }
 
 void
-DecoupledBPUWithFTB::histShiftIn(int shamt, bool taken, boost::dynamic_bitset<> &history)
+DecoupledBPUWithFTB::histShiftIn(int shamt, bool taken, GlobalHistory &history)
 {
-    if (shamt == 0) {
-        return;
-    }
-    history <<= shamt;
-    history[0] = taken;
+    history.shiftIn(shamt, taken);
 }
 
 void
@@ -2562,7 +2568,7 @@ DecoupledBPUWithFTB::enqueueFetchStream()
 }
 
 void
-DecoupledBPUWithFTB::checkHistory(const boost::dynamic_bitset<> &history)
+DecoupledBPUWithFTB::checkHistory(const GlobalHistory &history)
 {/*
     unsigned ideal_size = 0;
     boost::dynamic_bitset<> ideal_hash_hist(historyBits, 0);
@@ -2614,6 +2620,90 @@ DecoupledBPUWithFTB::resetPC(Addr new_pc)
     fetchTargetQueue.resetPC(new_pc);
 }
 
+void
+DecoupledBPUWithFTB::warmupCommit(ThreadID tid, const StaticInstPtr &inst,
+                                  const PCStateBase &pc,
+                                  const PCStateBase &next_pc)
+{
+    if (!warmup.nextPC) {
+        resetPC(pc.instAddr());
+    } else if (warmup.nextPC->instAddr() != pc.instAddr()) {
+        // a trap or an interrupt took the warmup CPU somewhere else
+        trapSquash(warmup.targetId, warmup.streamId, warmup.lastPC, pc, tid,
+                   warmup.loopIter);
+    }
+
+    bool in_loop = false;
+    int ticks = 0;
+    while (!trySupplyFetchWithTarget(pc.instAddr(), in_loop)) {
+        panic_if(++ticks > MaxWarmupTicks,
+                 "No fetch target for %#lx after %d ticks of warmup\n",
+                 pc.instAddr(), MaxWarmupTicks);
+        if (enableTwoTaken) {
+            ideal_tick();
+        } else {
+            tick();
+        }
+    }
+
+    const unsigned stream_id = getSupplyingStreamId();
+    const unsigned target_id = getSupplyingTargetId();
+    if (stream_id != warmup.streamId && stream_id > FirstStreamId) {
+        // all the streams before this one are committed, if there are any
+        update(stream_id - 1, tid);
+    }
+
+    // predict from the fall through, as fetch does before execution
+    const auto &rv_pc = pc.as<RiscvISA::PCState>();
+    RiscvISA::PCState pred_pc = rv_pc;
+    pred_pc.npc(rv_pc.getFallThruPC());
+    unsigned loop_iter = 0;
+    decoupledPredict(inst, ++warmup.seqNum, pred_pc, tid, loop_iter);
+
+    bool miss = pred_pc.instAddr() != next_pc.instAddr();
+    if (miss) {
+        // controls are redirected as by IEW, the others were predicted
+        // taken and are redirected as by decode
+        bool taken = next_pc.instAddr() != rv_pc.getFallThruPC();
+        controlSquash(target_id, stream_id, pc, next_pc, inst,
+                      rv_pc.compressed() ? 2 : 4, taken, warmup.seqNum,
+                      tid, loop_iter, inst->isControl());
+    }
+
+    if (inst->isControl() && !inst->isNonSpeculative()) {
+        Addr branch_addr = pc.instAddr();
+        Addr target_addr = rv_pc.npc();
+        if (target_addr < branch_addr ||
+            lp.findLoopBranchInStorage(branch_addr)) {
+            LoopTrace rec;
+            lp.commitLoopBranch(branch_addr, target_addr,
+                                rv_pc.getFallThruPC(), miss, rec);
+        }
+    }
+
+    set(warmup.nextPC, next_pc);
+    warmup.lastPC = pc.instAddr();
+    warmup.streamId = stream_id;
+    warmup.targetId = target_id;
+    warmup.loopIter = loop_iter;
+}
+
+void
+DecoupledBPUWithFTB::warmupHandOver(ThreadID tid, const PCStateBase &pc)
+{
+    if (!warmup.nextPC) {
+        return;
+    }
+    // drop what was predicted ahead and commit the last stream, which
+    // leaves the BPU empty for fetch to reset
+    trapSquash(warmup.targetId, warmup.streamId, warmup.lastPC, pc, tid,
+               warmup.loopIter);
+    update(warmup.streamId, tid);
+    warmup.nextPC.reset();
+    warmup.streamId = 0;
+    warmup.targetId = 0;
+}
+
 Cycles
 DecoupledBPUWithFTB::curCycle()
 {
@@ -188,6 +188,7 @@ class DecoupledBPUWithFTB : public BPredUnit
     typedef DecoupledBPUWithFTBParams Params;
 
     DecoupledBPUWithFTB(const Params &params);
+    ~DecoupledBPUWithFTB();
     LoopPredictor lp;
     LoopBuffer lb;
     bool enableLoopBuffer{false};
@@ -205,12 +206,33 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     std::map<FetchStreamId, FetchStream> fetchStreamQueue;
     unsigned fetchStreamQueueSize;
-    FetchStreamId fsqId{1};
+    /** Streams are numbered from 1, no stream comes before the first */
+    static constexpr FetchStreamId FirstStreamId = 1;
+    FetchStreamId fsqId{FirstStreamId};
     FetchStream lastCommittedStream;
     FetchStream streamToEnqueue;
 
     CPU *cpu;
 
+    /**
+     * State of a functional warmup, which plays the fetch of one
+     * instruction at a time and redirects the BPU like a squash from
+     * commit whenever it went another way than the warmup CPU.
+     */
+    struct WarmupState
+    {
+        /** Where the BPU expects the next instruction, null before */
+        std::unique_ptr<PCStateBase> nextPC;
+        Addr lastPC{0};
+        unsigned streamId{0};
+        unsigned targetId{0};
+        unsigned loopIter{0};
+        InstSeqNum seqNum{0};
+    } warmup;
+
+    /** Ticks to wait for a fetch target before giving up on the BPU */
+    static constexpr int MaxWarmupTicks = 1000;
+
     unsigned numBr;
 
     unsigned predictWidth;
@@ -270,10 +292,10 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     Addr s0PC;
     // Addr s0StreamStartPC;
-    boost::dynamic_bitset<> s0History;
+    GlobalHistory s0History;
     FullFTBPrediction finalPred;
 
-    boost::dynamic_bitset<> commitHistory;
+    GlobalHistory commitHistory;
 
     bool squashing{false};
 
@@ -308,7 +330,7 @@ class DecoupledBPUWithFTB : public BPredUnit
     Addr computePathHash(Addr br, Addr target);
 
     // TODO: compare phr and ghr
-    void histShiftIn(int shamt, bool taken, boost::dynamic_bitset<> &history);
+    void histShiftIn(int shamt, bool taken, GlobalHistory &history);
 
     void printStream(const FetchStream &e)
     {
@@ -645,7 +667,13 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     bool lookup(ThreadID tid, Addr instPC, void *&bp_history) override { return false; }
 
-    void checkHistory(const boost::dynamic_bitset<> &history);
+    void warmupCommit(ThreadID tid, const StaticInstPtr &inst,
+                      const PCStateBase &pc,
+                      const PCStateBase &next_pc) override;
+
+    void warmupHandOver(ThreadID tid, const PCStateBase &pc) override;
+
+    void checkHistory(const GlobalHistory &history);
 
     bool useStreamRAS(FetchStreamId sid);
 
@@ -1,39 +1,45 @@
 #include "cpu/pred/ftb/folded_hist.hh"
 
+#include <cassert>
+
 namespace gem5 {
 
 namespace branch_prediction {
 
 namespace ftb_pred {
 
+FoldedHist::FoldedHist(int histLen, int foldedLen, int maxShamt) :
+    histLen(histLen), foldedLen(foldedLen), maxShamt(maxShamt)
+{
+    assert(foldedLen > 0 && foldedLen < 64);
+    assert(maxShamt <= MaxShamt && maxShamt < foldedLen);
+    foldedMask = (uint64_t(1) << foldedLen) - 1;
+    for (int i = 0; i < maxShamt; i++) {
+        posHighestBitsInGhr[i] = histLen - 1 - i;
+        posHighestBitsInOldFoldedHist[i] = (histLen - 1 - i) % foldedLen;
+    }
+}
+
 void
-FoldedHist::update(const boost::dynamic_bitset<> &ghr, int shamt, bool taken)
+FoldedHist::update(const GlobalHistory &ghr, int shamt, bool taken)
 {
-    // Update the folded history
-    boost::dynamic_bitset<> temp(folded);
+    assert(shamt <= maxShamt);
     if (foldedLen >= histLen) {
-        temp <<= shamt;
-        for (int i = histLen; i < foldedLen; i++) {
-            temp[i] = 0;
-        }
-        temp[0] = taken;
-    } else {
-        temp.resize(foldedLen + shamt);
-        for (int i = 0; i < shamt; i++) {
-            temp[posHighestBitsInOldFoldedHist[i]] ^= ghr[posHighestBitsInGhr[i]];
-        }
-        temp <<= shamt;
-        for (int i = 0; i < shamt; i ++) {
-            temp[i] = temp[foldedLen + i];
-        }
-        temp[0] ^= taken;
-        temp.resize(foldedLen);
+        // nothing is folded, the history is kept as is
+        folded = ((folded << shamt) & ((uint64_t(1) << histLen) - 1)) | taken;
+        return;
+    }
+    // XOR out the bits leaving the window, they come back to the same
+    // position of the fold as the ones shifting in
+    for (int i = 0; i < shamt; i++) {
+        folded ^= uint64_t(ghr[posHighestBitsInGhr[i]]) << posHighestBitsInOldFoldedHist[i];
     }
-    folded = temp;
+    folded = ((folded << shamt) | (folded >> (foldedLen - shamt))) & foldedMask;
+    folded ^= taken;
 }
 
 void
-FoldedHist::recover(FoldedHist &other)
+FoldedHist::recover(const FoldedHist &other)
 {
     assert(foldedLen == other.foldedLen);
     assert(maxShamt == other.maxShamt);
@@ -42,18 +48,15 @@ FoldedHist::recover(FoldedHist &other)
 }
 
 void
-FoldedHist::check(const boost::dynamic_bitset<> &ghr)
+FoldedHist::check(const GlobalHistory &ghr)
 {
 #ifdef DEBUG
     // Check the folded history now, derive from ghr
-    boost::dynamic_bitset<> ideal(ghr);
-    boost::dynamic_bitset<> idealFolded;
-    ideal.resize(histLen);
-    idealFolded.resize(foldedLen);
+    uint64_t ideal = 0;
     for (int i = 0; i < histLen; i++) {
-        idealFolded[i % foldedLen] ^= ideal[i];
+        ideal ^= uint64_t(ghr[i]) << (i % foldedLen);
     }
-    assert(idealFolded == folded);
+    assert(ideal == folded);
 #endif
 }
 
@@ -61,4 +64,4 @@ FoldedHist::check(const boost::dynamic_bitset<> &ghr)
 
 }  // namespace branch_prediction
 
-}  // namespace gem5
\ No newline at end of file
+}  // namespace gem5
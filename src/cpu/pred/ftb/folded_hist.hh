@@ -1,11 +1,12 @@
 #ifndef __CPU_PRED_FTB_FOLDED_HIST_HH__
 #define __CPU_PRED_FTB_FOLDED_HIST_HH__
 
-#include <boost/dynamic_bitset.hpp>
+#include <array>
+#include <cstdint>
 
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
-#include "debug/FTBFoldedHist.hh"
+#include "cpu/pred/ftb/global_history.hh"
 
 namespace gem5 {
 
@@ -13,32 +14,31 @@ namespace branch_prediction {
 
 namespace ftb_pred {
 
+/**
+ * The newest histLen bits of the global history XOR-folded into
+ * foldedLen bits. Updates are incremental: the bits leaving the window
+ * are XORed out, the fold is rotated and the new bit XORed in.
+ */
 class FoldedHist {
     private:
+        static constexpr int MaxShamt = 8;
         int histLen;
         int foldedLen;
         int maxShamt;
-        boost::dynamic_bitset<> folded;
-        std::vector<int> posHighestBitsInGhr;
-        std::vector<int> posHighestBitsInOldFoldedHist;
+        uint64_t folded = 0;
+        uint64_t foldedMask;
+        std::array<int, MaxShamt> posHighestBitsInGhr;
+        std::array<int, MaxShamt> posHighestBitsInOldFoldedHist;
 
     public:
-        FoldedHist(int histLen, int foldedLen, int maxShamt) :
-            histLen(histLen), foldedLen(foldedLen), maxShamt(maxShamt)
-            {
-                folded.resize(foldedLen);
-                for (int i = 0; i < maxShamt; i++) {
-                    posHighestBitsInGhr.push_back(histLen - 1 - i);
-                    posHighestBitsInOldFoldedHist.push_back((histLen - 1 - i) % foldedLen);
-                }
-            }
-    
+        FoldedHist(int histLen, int foldedLen, int maxShamt);
+
     public:
-        boost::dynamic_bitset<> &get() { return folded; }
-        void update(const boost::dynamic_bitset<> &ghr, int shamt, bool taken);
-        void recover(FoldedHist &other);
-        void check(const boost::dynamic_bitset<> &ghr);
-    
+        uint64_t get() const { return folded; }
+        void update(const GlobalHistory &ghr, int shamt, bool taken);
+        void recover(const FoldedHist &other);
+        void check(const GlobalHistory &ghr);
+
 };
 
 }  // namespace ftb_pred
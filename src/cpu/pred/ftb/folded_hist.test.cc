@@ -0,0 +1,178 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <boost/dynamic_bitset.hpp>
+
+#include "cpu/pred/ftb/folded_hist.hh"
+#include "cpu/pred/ftb/global_history.hh"
+
+using namespace gem5::branch_prediction::ftb_pred;
+
+namespace
+{
+
+using Bits = boost::dynamic_bitset<>;
+
+/** The bitset history DecoupledBPUWithFTB::histShiftIn() shifted */
+void
+shiftIn(Bits &history, int shamt, bool taken)
+{
+    if (shamt == 0) {
+        return;
+    }
+    history <<= shamt;
+    history[0] = taken;
+}
+
+/** The bitset folding FoldedHist did before it kept a uint64_t */
+class BitsetFoldedHist
+{
+    int histLen;
+    int foldedLen;
+    Bits folded;
+    std::vector<int> posHighestBitsInGhr;
+    std::vector<int> posHighestBitsInOldFoldedHist;
+
+  public:
+    BitsetFoldedHist(int hist_len, int folded_len, int max_shamt)
+        : histLen(hist_len), foldedLen(folded_len), folded(folded_len)
+    {
+        for (int i = 0; i < max_shamt; i++) {
+            posHighestBitsInGhr.push_back(histLen - 1 - i);
+            posHighestBitsInOldFoldedHist.push_back(
+                (histLen - 1 - i) % foldedLen);
+        }
+    }
+
+    uint64_t get() const { return folded.to_ulong(); }
+
+    void
+    update(const Bits &ghr, int shamt, bool taken)
+    {
+        Bits temp(folded);
+        if (foldedLen >= histLen) {
+            temp <<= shamt;
+            for (int i = histLen; i < foldedLen; i++) {
+                temp[i] = 0;
+            }
+            temp[0] = taken;
+        } else {
+            temp.resize(foldedLen + shamt);
+            for (int i = 0; i < shamt; i++) {
+                temp[posHighestBitsInOldFoldedHist[i]] ^=
+                    ghr[posHighestBitsInGhr[i]];
+            }
+            temp <<= shamt;
+            for (int i = 0; i < shamt; i++) {
+                temp[i] = temp[foldedLen + i];
+            }
+            temp[0] ^= taken;
+            temp.resize(foldedLen);
+        }
+        folded = temp;
+    }
+};
+
+void
+expectSameHistory(const GlobalHistory &hist, const Bits &bits)
+{
+    ASSERT_EQ(hist.size(), bits.size());
+    for (unsigned i = 0; i < bits.size(); i++) {
+        ASSERT_EQ(hist[i], bits[i]) << "bit " << i;
+    }
+    for (unsigned n : {1u, 18u, 63u, 64u}) {
+        Bits low(bits);
+        low.resize(n);
+        ASSERT_EQ(hist.low(n), low.to_ulong()) << "newest " << n;
+    }
+}
+
+} // anonymous namespace
+
+/** Shifting in wraps around the words of the ring buffer */
+TEST(GlobalHistoryTest, ShiftInAgainstBitset)
+{
+    std::mt19937_64 rng(0x9117);
+    GlobalHistory hist(700);
+    Bits bits(700);
+
+    for (int step = 0; step < 20000; step++) {
+        int shamt = rng() % 9;
+        bool taken = rng() % 2;
+        hist.shiftIn(shamt, taken);
+        shiftIn(bits, shamt, taken);
+        if (step % 97 == 0) {
+            expectSameHistory(hist, bits);
+        }
+    }
+    expectSameHistory(hist, bits);
+
+    GlobalHistory copy = hist;
+    ASSERT_EQ(copy, hist);
+    copy.shiftIn(1, !copy[0]);
+    ASSERT_NE(copy, hist);
+}
+
+/**
+ * Fold the history of TAGE-like tables of several lengths, some not
+ * folded at all, and compare every update with the bitset folding and
+ * with the fold computed from scratch.
+ */
+TEST(FoldedHistTest, UpdateAgainstBitsetFolding)
+{
+    const int max_shamt = 8;
+    const std::vector<std::pair<int, int>> lens = {
+        {8, 11}, {11, 11}, {13, 9}, {32, 11}, {44, 12}, {64, 9},
+        {119, 9}, {130, 10}, {377, 12}, {640, 13},
+    };
+    const int hist_bits = 700;
+
+    std::mt19937_64 rng(0xf01d);
+    GlobalHistory hist(hist_bits);
+    Bits bits(hist_bits);
+    std::vector<FoldedHist> folded;
+    std::vector<BitsetFoldedHist> expected;
+    for (auto [hist_len, folded_len] : lens) {
+        folded.emplace_back(hist_len, folded_len, max_shamt);
+        expected.emplace_back(hist_len, folded_len, max_shamt);
+    }
+
+    for (int step = 0; step < 20000; step++) {
+        int shamt = 1 + rng() % max_shamt;
+        bool taken = rng() % 2;
+        // the tables fold the history from before the shift
+        for (size_t t = 0; t < lens.size(); t++) {
+            folded[t].update(hist, shamt, taken);
+            expected[t].update(bits, shamt, taken);
+        }
+        hist.shiftIn(shamt, taken);
+        shiftIn(bits, shamt, taken);
+
+        for (size_t t = 0; t < lens.size(); t++) {
+            auto [hist_len, folded_len] = lens[t];
+            ASSERT_EQ(folded[t].get(), expected[t].get())
+                << "step " << step << " hist " << hist_len << " folded "
+                << folded_len;
+            if (folded_len >= hist_len) {
+                continue;
+            }
+            uint64_t ideal = 0;
+            for (int i = 0; i < hist_len; i++) {
+                ideal ^= uint64_t(bits[i]) << (i % folded_len);
+            }
+            ASSERT_EQ(folded[t].get(), ideal)
+                << "step " << step << " hist " << hist_len << " folded "
+                << folded_len;
+        }
+    }
+
+    // a recovered fold goes on like the one it was taken from
+    FoldedHist recovered(lens[4].first, lens[4].second, max_shamt);
+    recovered.recover(folded[4]);
+    recovered.update(hist, 3, true);
+    folded[4].update(hist, 3, true);
+    ASSERT_EQ(recovered.get(), folded[4].get());
+}
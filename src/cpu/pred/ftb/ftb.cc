@@ -95,7 +95,7 @@ DefaultFTB::tick() {}
 
 void
 DefaultFTB::putPCHistory(Addr startAddr,
-                         const boost::dynamic_bitset<> &history,
+                         const GlobalHistory &history,
                          std::vector<FullFTBPrediction> &stagePreds)
 {
     TickedFTBEntry find_entry = lookup(startAddr);
@@ -151,15 +151,14 @@ DefaultFTB::putPCHistory(Addr startAddr,
     meta.entry = FTBEntry(find_entry);
 }
 
-std::shared_ptr<void>
+PredMetaRef
 DefaultFTB::getPredictionMeta()
 {
-    std::shared_ptr<void> meta_void_ptr = std::make_shared<FTBMeta>(meta);
-    return meta_void_ptr;
+    return metaPool.save(meta);
 }
 
 void
-DefaultFTB::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) {}
+DefaultFTB::specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) {}
 
 void
 DefaultFTB::reset()
@@ -363,7 +362,7 @@ DefaultFTB::getAndSetNewFTBEntry(FetchStream &stream)
 void
 DefaultFTB::update(const FetchStream &stream)
 {
-    auto meta = std::static_pointer_cast<FTBMeta>(stream.predMetas[getComponentIdx()]);
+    auto meta = metaPool.get(stream.predMetas[getComponentIdx()]);
     if (meta->hit) {
         ftbStats.updateHit++;
     } else {
@@ -471,7 +470,7 @@ DefaultFTB::update(const FetchStream &stream)
 void
 DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
 {
-    auto meta = std::static_pointer_cast<FTBMeta>(stream.predMetas[getComponentIdx()]);
+    auto meta = metaPool.get(stream.predMetas[getComponentIdx()]);
     auto &entry = meta->entry;
     auto pc = inst->getPC();
     auto npc = inst->getNPC();
@@ -84,12 +84,12 @@ class DefaultFTB : public TimedBaseFTBPredictor
     
     void tick() override;
 
-    void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+    void putPCHistory(Addr startAddr, const GlobalHistory &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
-    std::shared_ptr<void> getPredictionMeta() override;
+    PredMetaRef getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) override;
 
     /** Creates a FTB with the given number of entries, number of bits per
      *  tag, and instruction offset amount.
@@ -267,6 +267,8 @@ class DefaultFTB : public TimedBaseFTBPredictor
 
     FTBMeta meta;
 
+    PredMetaPool<FTBMeta> metaPool;
+
     struct FTBStats : public statistics::Group {
         statistics::Scalar newEntry;
         statistics::Scalar newEntryWithCond;
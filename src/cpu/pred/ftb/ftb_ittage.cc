@@ -4,6 +4,7 @@
 #include <cmath>
 #include <ctime>
 
+#include "base/bitfield.hh"
 #include "base/debug_helper.hh"
 #include "base/intmath.hh"
 #include "base/trace.hh"
@@ -43,12 +44,12 @@ FTBITTAGE::FTBITTAGE(const Params& p)
         tageTable[i].resize(tableSizes[i]);
 
         tableIndexBits[i] = ceilLog2(tableSizes[i]);
-        tableIndexMasks[i].resize(tableIndexBits[i], true);
+        tableIndexMasks[i] = mask(tableIndexBits[i]);
 
         assert(histLengths.size() >= numPredictors);
 
         assert(tableTagBits.size() >= numPredictors);
-        tableTagMasks[i].resize(tableTagBits[i], true);
+        tableTagMasks[i] = mask(tableTagBits[i]);
 
         assert(tablePcShifts.size() >= numPredictors);
 
@@ -136,7 +137,7 @@ FTBITTAGE::lookupHelper(Addr startAddr, TageEntry &main_entry, int &main_table,
 }
 
 void
-FTBITTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<FullFTBPrediction> &stagePreds) {
+FTBITTAGE::putPCHistory(Addr stream_start, const GlobalHistory &history, std::vector<FullFTBPrediction> &stagePreds) {
     // if (debugPC == stream_start) {
     //     debugFlag = true;
     // }
@@ -194,10 +195,9 @@ FTBITTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<Fu
     debugFlag = false;
 }
 
-std::shared_ptr<void>
+PredMetaRef
 FTBITTAGE::getPredictionMeta() {
-    std::shared_ptr<void> meta_void_ptr = std::make_shared<TageMeta>(meta);
-    return meta_void_ptr;
+    return metaPool.save(meta);
 }
 
 void
@@ -212,11 +212,11 @@ FTBITTAGE::update(const FetchStream &entry)
 
     // get tage predictions from meta
     // TODO: use component idx
-    auto meta = std::static_pointer_cast<TageMeta>(entry.predMetas[getComponentIdx()]);
+    auto meta = metaPool.get(entry.predMetas[getComponentIdx()]);
     auto pred = meta->pred;
-    auto updateTagFoldedHist = meta->tagFoldedHist;
-    auto updateAltTagFoldedHist = meta->altTagFoldedHist;
-    auto updateIndexFoldedHist = meta->indexFoldedHist;
+    const auto &updateTagFoldedHist = meta->tagFoldedHist;
+    const auto &updateAltTagFoldedHist = meta->altTagFoldedHist;
+    const auto &updateIndexFoldedHist = meta->indexFoldedHist;
     
     FTBSlot indirect_slot;
     for (auto slot : ftb_entry.slots) {
@@ -395,15 +395,10 @@ FTBITTAGE::updateCounter(bool taken, unsigned width, short &counter) {
 }
 
 Addr
-FTBITTAGE::getTageTag(Addr pc, int t, bitset &foldedHist, bitset &altFoldedHist)
+FTBITTAGE::getTageTag(Addr pc, int t, uint64_t foldedHist, uint64_t altFoldedHist)
 {
-    bitset buf(tableTagBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    bitset altTagBuf(altFoldedHist);
-    altTagBuf.resize(tableTagBits[t]);
-    altTagBuf <<= 1;
-    buf ^= foldedHist;
-    buf ^= altTagBuf;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist ^ (altFoldedHist << 1)) & tableTagMasks[t];
 }
 
 Addr
@@ -413,11 +408,10 @@ FTBITTAGE::getTageTag(Addr pc, int t)
 }
 
 Addr
-FTBITTAGE::getTageIndex(Addr pc, int t, bitset &foldedHist)
+FTBITTAGE::getTageIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & tableIndexMasks[t];
 }
 
 Addr
@@ -451,7 +445,7 @@ FTBITTAGE::satDecrement(int min, short &counter)
 }
 
 void
-FTBITTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool taken)
+FTBITTAGE::doUpdateHist(const GlobalHistory &history, int shamt, bool taken)
 {
     DPRINTF(FTBITTAGE || debugFlag, "in doUpdateHist, shamt %d, taken %d, history %s\n", shamt, taken, history);
     if (shamt == 0) {
@@ -470,7 +464,7 @@ FTBITTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool
 }
 
 void
-FTBITTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+FTBITTAGE::specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred)
 {
     int shamt;
     bool cond_taken;
@@ -479,11 +473,11 @@ FTBITTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPredict
 }
 
 void
-FTBITTAGE::recoverHist(const boost::dynamic_bitset<> &history,
+FTBITTAGE::recoverHist(const GlobalHistory &history,
     const FetchStream &entry, int shamt, bool cond_taken)
 {
     // TODO: need to get idx
-    std::shared_ptr<TageMeta> predMeta = std::static_pointer_cast<TageMeta>(entry.predMetas[getComponentIdx()]);
+    auto predMeta = metaPool.get(entry.predMetas[getComponentIdx()]);
     for (int i = 0; i < numPredictors; i++) {
         tagFoldedHist[i].recover(predMeta->tagFoldedHist[i]);
         altTagFoldedHist[i].recover(predMeta->altTagFoldedHist[i]);
@@ -493,7 +487,7 @@ FTBITTAGE::recoverHist(const boost::dynamic_bitset<> &history,
 }
 
 void
-FTBITTAGE::checkFoldedHist(const boost::dynamic_bitset<> &hist, const char * when)
+FTBITTAGE::checkFoldedHist(const GlobalHistory &hist, const char * when)
 {
     DPRINTF(FTBITTAGE || debugFlag, "checking folded history when %s\n", when);
     DPRINTF(FTBITTAGE || debugFlag, "history:\t%s\n", hist);
@@ -84,21 +84,21 @@ class FTBITTAGE : public TimedBaseFTBPredictor
     void tick() override;
     // make predictions, record in stage preds
     void putPCHistory(Addr startAddr,
-                      const boost::dynamic_bitset<> &history,
+                      const GlobalHistory &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
-    std::shared_ptr<void> getPredictionMeta() override;
+    PredMetaRef getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) override;
 
-    void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+    void recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
     void update(const FetchStream &entry) override;
 
     void commitBranch(const FetchStream &stream, const DynInstPtr &inst) override;
 
     // check folded hists after speculative update and recover
-    void checkFoldedHist(const bitset &history, const char *when);
+    void checkFoldedHist(const GlobalHistory &history, const char *when);
 
   private:
 
@@ -111,22 +111,22 @@ class FTBITTAGE : public TimedBaseFTBPredictor
 
     Addr getTageIndex(Addr pc, int table);
 
-    Addr getTageIndex(Addr pc, int table, bitset &foldedHist);
+    Addr getTageIndex(Addr pc, int table, uint64_t foldedHist);
 
     Addr getTageTag(Addr pc, int table);
 
-    Addr getTageTag(Addr pc, int table, bitset &foldedHist, bitset &altFoldedHist);
+    Addr getTageTag(Addr pc, int table, uint64_t foldedHist, uint64_t altFoldedHist);
 
-    void doUpdateHist(const bitset &history, int shamt, bool taken);
+    void doUpdateHist(const GlobalHistory &history, int shamt, bool taken);
 
     const unsigned numPredictors;
 
     std::vector<unsigned> tableSizes;
     std::vector<unsigned> tableIndexBits;
-    std::vector<bitset> tableIndexMasks;
+    std::vector<uint64_t> tableIndexMasks;
     // std::vector<uint64_t> tablePcMasks;
     std::vector<unsigned> tableTagBits;
-    std::vector<bitset> tableTagMasks;
+    std::vector<uint64_t> tableTagMasks;
     std::vector<unsigned> tablePcShifts;
     std::vector<unsigned> histLengths;
     std::vector<FoldedHist> tagFoldedHist;
@@ -178,6 +178,8 @@ class FTBITTAGE : public TimedBaseFTBPredictor
 
     TageMeta meta;
 
+    PredMetaPool<TageMeta> metaPool;
+
 public:
 
     Addr debugPC = 0;
@@ -55,12 +55,12 @@ FTBTAGE::FTBTAGE(const Params& p)
 
 
         tableIndexBits[i] = ceilLog2(tableSizes[i]);
-        tableIndexMasks[i].resize(tableIndexBits[i], true);
+        tableIndexMasks[i] = mask(tableIndexBits[i]);
 
         assert(histLengths.size() >= numPredictors);
 
         assert(tableTagBits.size() >= numPredictors);
-        tableTagMasks[i].resize(tableTagBits[i], true);
+        tableTagMasks[i] = mask(tableTagBits[i]);
 
         assert(tablePcShifts.size() >= numPredictors);
 
@@ -194,7 +194,7 @@ FTBTAGE::lookupHelper(Addr startAddr,
 }
 
 void
-FTBTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<FullFTBPrediction> &stagePreds) {
+FTBTAGE::putPCHistory(Addr stream_start, const GlobalHistory &history, std::vector<FullFTBPrediction> &stagePreds) {
     // DPRINTF(FTBTAGE, "putPCHistory startAddr: %#lx\n", stream_start);
     std::vector<TageEntry> entries;
     entries.resize(numBr);
@@ -262,10 +262,9 @@ FTBTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<Full
     // DPRINTF(FTBTAGE, "putPCHistory end\n");
 }
 
-std::shared_ptr<void>
+PredMetaRef
 FTBTAGE::getPredictionMeta() {
-    std::shared_ptr<void> meta_void_ptr = std::make_shared<TageMeta>(meta);
-    return meta_void_ptr;
+    return metaPool.save(meta);
 }
 
 void
@@ -304,15 +303,15 @@ FTBTAGE::update(const FetchStream &entry)
     // DPRINTF(FTBTAGE, "need to update size %d\n", need_to_update.size());
 
     // get tage predictions from meta
-    auto meta = std::static_pointer_cast<TageMeta>(entry.predMetas[getComponentIdx()]);
-    auto preds = meta->preds;
-    auto scMeta = meta->scMeta;
+    auto meta = metaPool.get(entry.predMetas[getComponentIdx()]);
+    const auto &preds = meta->preds;
+    const auto &scMeta = meta->scMeta;
     std::vector<bool> actualTakens;
     actualTakens.resize(numBr, false);
 
-    auto updateTagFoldedHist = meta->tagFoldedHist;
-    auto updateAltTagFoldedHist = meta->altTagFoldedHist;
-    auto updateIndexFoldedHist = meta->indexFoldedHist;
+    const auto &updateTagFoldedHist = meta->tagFoldedHist;
+    const auto &updateAltTagFoldedHist = meta->altTagFoldedHist;
+    const auto &updateIndexFoldedHist = meta->indexFoldedHist;
     for (int b = 0; b < numBr; b++) {
         DPRINTF(FTBTAGE, "try to update cond %d \n", b);
         if (!need_to_update[b]) {
@@ -535,15 +534,10 @@ FTBTAGE::updateCounter(bool taken, unsigned width, short &counter) {
 }
 
 Addr
-FTBTAGE::getTageTag(Addr pc, int t, bitset &foldedHist, bitset &altFoldedHist)
+FTBTAGE::getTageTag(Addr pc, int t, uint64_t foldedHist, uint64_t altFoldedHist)
 {
-    bitset buf(tableTagBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    bitset altTagBuf(altFoldedHist);
-    altTagBuf.resize(tableTagBits[t]);
-    altTagBuf <<= 1;
-    buf ^= foldedHist;
-    buf ^= altTagBuf;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist ^ (altFoldedHist << 1)) & tableTagMasks[t];
 }
 
 Addr
@@ -553,11 +547,10 @@ FTBTAGE::getTageTag(Addr pc, int t)
 }
 
 Addr
-FTBTAGE::getTageIndex(Addr pc, int t, bitset &foldedHist)
+FTBTAGE::getTageIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & tableIndexMasks[t];
 }
 
 Addr
@@ -614,7 +607,7 @@ FTBTAGE::getUseAltIdx(Addr pc) {
 }
 
 void
-FTBTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool taken)
+FTBTAGE::doUpdateHist(const GlobalHistory &history, int shamt, bool taken)
 {
     DPRINTF(FTBTAGE, "in doUpdateHist, shamt %d, taken %d, history %s\n", shamt, taken, history);
     if (shamt == 0) {
@@ -633,7 +626,7 @@ FTBTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool ta
 }
 
 void
-FTBTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+FTBTAGE::specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred)
 {
     int shamt;
     bool cond_taken;
@@ -645,10 +638,10 @@ FTBTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPredictio
 }
 
 void
-FTBTAGE::recoverHist(const boost::dynamic_bitset<> &history,
+FTBTAGE::recoverHist(const GlobalHistory &history,
     const FetchStream &entry, int shamt, bool cond_taken)
 {
-    std::shared_ptr<TageMeta> predMeta = std::static_pointer_cast<TageMeta>(entry.predMetas[getComponentIdx()]);
+    auto predMeta = metaPool.get(entry.predMetas[getComponentIdx()]);
     for (int i = 0; i < numPredictors; i++) {
         tagFoldedHist[i].recover(predMeta->tagFoldedHist[i]);
         altTagFoldedHist[i].recover(predMeta->altTagFoldedHist[i]);
@@ -662,7 +655,7 @@ FTBTAGE::recoverHist(const boost::dynamic_bitset<> &history,
 }
 
 void
-FTBTAGE::checkFoldedHist(const boost::dynamic_bitset<> &hist, const char * when)
+FTBTAGE::checkFoldedHist(const GlobalHistory &hist, const char * when)
 {
     for (int t = 0; t < numPredictors; t++) {
         for (int type = 0; type < 3; type++) {
@@ -747,11 +740,10 @@ FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t)
 }
 
 Addr
-FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t, bitset &foldedHist)
+FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & tableIndexMasks[t];
 }
 
 void
@@ -767,18 +759,18 @@ FTBTAGE::StatisticalCorrector::counterUpdate(int &ctr, int nbits, bool taken)
 }
 
 void
-FTBTAGE::StatisticalCorrector::update(Addr pc, SCMeta meta, std::vector<bool> needToUpdates,
+FTBTAGE::StatisticalCorrector::update(Addr pc, const SCMeta &meta, std::vector<bool> needToUpdates,
     std::vector<bool> actualTakens)
 {
-    auto predHist = meta.indexFoldedHist;
-    auto preds = meta.scPreds;
+    const auto &predHist = meta.indexFoldedHist;
+    const auto &preds = meta.scPreds;
 
     for (int b = 0; b < numBr; b++) {
         if (!needToUpdates[b]) {
             continue;
         }
         int phyBrIdx = tage->getShuffledBrIndex(pc, b);
-        auto &p = preds[b];
+        const auto &p = preds[b];
         bool scTaken = p.scPred;
         bool actualTaken = actualTakens[b];
         int tOrNt = p.tageTaken ? 1 : 0;
@@ -839,7 +831,7 @@ FTBTAGE::StatisticalCorrector::update(Addr pc, SCMeta meta, std::vector<bool> ne
 }
 
 void
-FTBTAGE::StatisticalCorrector::recoverHist(std::vector<FoldedHist> &fh)
+FTBTAGE::StatisticalCorrector::recoverHist(const std::vector<FoldedHist> &fh)
 {
     for (int i = 0; i < numPredictors; i++) {
         foldedHist[i].recover(fh[i]);
@@ -847,7 +839,7 @@ FTBTAGE::StatisticalCorrector::recoverHist(std::vector<FoldedHist> &fh)
 }
 
 void
-FTBTAGE::StatisticalCorrector::doUpdateHist(const boost::dynamic_bitset<> &history,
+FTBTAGE::StatisticalCorrector::doUpdateHist(const GlobalHistory &history,
     int shamt, bool cond_taken)
 {
     if (shamt == 0) {
@@ -6,6 +6,7 @@
 #include <vector>
 #include <utility>
 
+#include "base/bitfield.hh"
 #include "base/sat_counter.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
@@ -83,14 +84,14 @@ class FTBTAGE : public TimedBaseFTBPredictor
     void tick() override;
     // make predictions, record in stage preds
     void putPCHistory(Addr startAddr,
-                      const boost::dynamic_bitset<> &history,
+                      const GlobalHistory &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
-    std::shared_ptr<void> getPredictionMeta() override;
+    PredMetaRef getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) override;
 
-    void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+    void recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
     void update(const FetchStream &entry) override;
 
@@ -99,7 +100,7 @@ class FTBTAGE : public TimedBaseFTBPredictor
     void setTrace() override;
 
     // check folded hists after speculative update and recover
-    void checkFoldedHist(const bitset &history, const char *when);
+    void checkFoldedHist(const GlobalHistory &history, const char *when);
 
     // we hash between numBr br slots, depending on lower bits of pc
     // br slot 0 may be tage entry 0 or 1
@@ -119,15 +120,15 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
     Addr getTageIndex(Addr pc, int table);
 
-    Addr getTageIndex(Addr pc, int table, bitset &foldedHist);
+    Addr getTageIndex(Addr pc, int table, uint64_t foldedHist);
 
     Addr getTageTag(Addr pc, int table);
 
-    Addr getTageTag(Addr pc, int table, bitset &foldedHist, bitset &altFoldedHist);
+    Addr getTageTag(Addr pc, int table, uint64_t foldedHist, uint64_t altFoldedHist);
 
     unsigned getBaseTableIndex(Addr pc);
 
-    void doUpdateHist(const bitset &history, int shamt, bool taken);
+    void doUpdateHist(const GlobalHistory &history, int shamt, bool taken);
 
     const unsigned numPredictors;
 
@@ -135,10 +136,10 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
     std::vector<unsigned> tableSizes;
     std::vector<unsigned> tableIndexBits;
-    std::vector<bitset> tableIndexMasks;
+    std::vector<uint64_t> tableIndexMasks;
     // std::vector<uint64_t> tablePcMasks;
     std::vector<unsigned> tableTagBits;
-    std::vector<bitset> tableTagMasks;
+    std::vector<uint64_t> tableTagMasks;
     std::vector<unsigned> tablePcShifts;
     std::vector<unsigned> histLengths;
     std::vector<FoldedHist> tagFoldedHist;
@@ -286,6 +287,7 @@ public:
           for (int i = 0; i < numPredictors; i++) {
             tableIndexBits[i] = ceilLog2(tableSizes[i]);
             foldedHist.push_back(FoldedHist(histLens[i], tableIndexBits[i], numBr));
+            tableIndexMasks.push_back(mask(tableIndexBits[i]));
             scCntTable[i].resize(tableSizes[i]);
             for (auto &br_counters : scCntTable[i]) {
               br_counters.resize(numBr);
@@ -315,17 +317,17 @@ public:
       public:
         Addr getIndex(Addr pc, int t);
 
-        Addr getIndex(Addr pc, int t, bitset &foldedHist);
+        Addr getIndex(Addr pc, int t, uint64_t foldedHist);
 
         std::vector<FoldedHist> getFoldedHist();
 
         std::vector<SCPrediction> getPredictions(Addr pc, std::vector<TagePrediction> &tagePreds);
 
-        void update(Addr pc, SCMeta meta, std::vector<bool> needToUpdates, std::vector<bool> actualTakens);
+        void update(Addr pc, const SCMeta &meta, std::vector<bool> needToUpdates, std::vector<bool> actualTakens);
 
-        void recoverHist(std::vector<FoldedHist> &fh);
+        void recoverHist(const std::vector<FoldedHist> &fh);
 
-        void doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool cond_taken);
+        void doUpdateHist(const GlobalHistory &history, int shamt, bool cond_taken);
 
         void setStats(std::vector<TageBankStats *> stats) {
           this->stats = stats;
@@ -356,6 +358,8 @@ public:
 
         std::vector<int> tableIndexBits;
 
+        std::vector<uint64_t> tableIndexMasks;
+
         // std::vector<bool> tagVec;
 
         // table - table index - numBr - taken/not taken
@@ -402,6 +406,8 @@ private:
     } TageMeta;
 
     TageMeta meta;
+
+    PredMetaPool<TageMeta> metaPool;
 };
 }
 
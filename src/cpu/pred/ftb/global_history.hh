@@ -0,0 +1,137 @@
+#ifndef __CPU_PRED_FTB_GLOBAL_HISTORY_HH__
+#define __CPU_PRED_FTB_GLOBAL_HISTORY_HH__
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <ostream>
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Global branch history of at most MaxBits bits, packed into words that
+ * are used as a circular buffer. Shifting outcomes in moves the position
+ * of the newest bit and writes the new bits, instead of shifting the
+ * whole history, and a copy is a fixed-size memcpy.
+ *
+ * Bit i is the i-th newest bit, as in a bitset shifted left on every
+ * update. Only the lowest size() bits are meaningful.
+ */
+template <unsigned MaxBits>
+class GlobalHistoryBuffer
+{
+    static_assert(MaxBits >= 64 && (MaxBits & (MaxBits - 1)) == 0,
+                  "history capacity must be a power of two number of words");
+
+    static constexpr unsigned NumWords = MaxBits / 64;
+    static constexpr unsigned PosMask = MaxBits - 1;
+
+    std::array<uint64_t, NumWords> words{};
+    // position of bit 0 in words
+    unsigned head = 0;
+    unsigned len = 0;
+
+    bool
+    test(unsigned pos) const
+    {
+        return (words[pos / 64] >> (pos % 64)) & 1;
+    }
+
+    void
+    assign(unsigned pos, bool val)
+    {
+        uint64_t bit = uint64_t(1) << (pos % 64);
+        if (val) {
+            words[pos / 64] |= bit;
+        } else {
+            words[pos / 64] &= ~bit;
+        }
+    }
+
+  public:
+    static constexpr unsigned capacity() { return MaxBits; }
+
+    GlobalHistoryBuffer() = default;
+    explicit GlobalHistoryBuffer(unsigned size) { resize(size); }
+
+    /** Unlike a bitset, growing exposes bits shifted out earlier */
+    void
+    resize(unsigned size)
+    {
+        assert(size <= MaxBits);
+        len = size;
+    }
+
+    unsigned size() const { return len; }
+
+    bool operator[](unsigned i) const { return test((head + i) & PosMask); }
+
+    /** Same as history <<= shamt; history[0] = taken on a bitset */
+    void
+    shiftIn(unsigned shamt, bool taken)
+    {
+        if (shamt == 0) {
+            return;
+        }
+        assert(shamt <= 64);
+        head = (head - shamt) & PosMask;
+        assign(head, taken);
+        for (unsigned i = 1; i < shamt; i++) {
+            assign((head + i) & PosMask, false);
+        }
+    }
+
+    /** The newest n bits, n <= 64, bit 0 being the newest */
+    uint64_t
+    low(unsigned n) const
+    {
+        assert(n <= 64);
+        unsigned word = head / 64;
+        unsigned off = head % 64;
+        uint64_t val = words[word] >> off;
+        if (off != 0) {
+            val |= words[(word + 1) % NumWords] << (64 - off);
+        }
+        return n == 64 ? val : val & ((uint64_t(1) << n) - 1);
+    }
+
+    bool
+    operator==(const GlobalHistoryBuffer &other) const
+    {
+        if (len != other.len) {
+            return false;
+        }
+        for (unsigned i = 0; i < len; i++) {
+            if ((*this)[i] != other[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const GlobalHistoryBuffer &other) const { return !(*this == other); }
+
+    /** Oldest bit first, like a bitset */
+    friend std::ostream &
+    operator<<(std::ostream &os, const GlobalHistoryBuffer &hist)
+    {
+        for (unsigned i = hist.len; i > 0; i--) {
+            os << (hist[i - 1] ? '1' : '0');
+        }
+        return os;
+    }
+};
+
+using GlobalHistory = GlobalHistoryBuffer<1024>;
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_GLOBAL_HISTORY_HH__
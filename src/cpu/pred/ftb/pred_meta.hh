@@ -0,0 +1,143 @@
+#ifndef __CPU_PRED_FTB_PRED_META_HH__
+#define __CPU_PRED_FTB_PRED_META_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <deque>
+#include <utility>
+#include <vector>
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Reference counts and free list of the records of a PredMetaPool. A
+ * record is recycled once the last fetch stream referring to it is
+ * committed or squashed.
+ */
+class PredMetaPoolBase
+{
+  protected:
+    std::vector<unsigned> refCounts;
+    std::vector<unsigned> freeList;
+
+  public:
+    /**
+     * Every PredMetaRef must be gone by now, the owner of the fetch
+     * streams releases them before the components are destroyed.
+     */
+    ~PredMetaPoolBase() { assert(inUse() == 0); }
+
+    void ref(unsigned idx) { refCounts[idx]++; }
+
+    void
+    unref(unsigned idx)
+    {
+        assert(refCounts[idx] > 0);
+        if (--refCounts[idx] == 0) {
+            freeList.push_back(idx);
+        }
+    }
+
+    /** Number of records held by some fetch stream */
+    size_t inUse() const { return refCounts.size() - freeList.size(); }
+};
+
+/**
+ * A counted reference to a record of a PredMetaPool, which is what a
+ * fetch stream keeps for each component. Copying it, e.g. when the loop
+ * buffer replays a stream, shares the record instead of copying it.
+ */
+class PredMetaRef
+{
+    PredMetaPoolBase *pool = nullptr;
+    unsigned idx = 0;
+
+    template <class Meta>
+    friend class PredMetaPool;
+
+    PredMetaRef(PredMetaPoolBase *pool, unsigned idx) : pool(pool), idx(idx)
+    {
+        pool->ref(idx);
+    }
+
+  public:
+    PredMetaRef() = default;
+
+    PredMetaRef(const PredMetaRef &other) : pool(other.pool), idx(other.idx)
+    {
+        if (pool) {
+            pool->ref(idx);
+        }
+    }
+
+    PredMetaRef(PredMetaRef &&other) noexcept
+        : pool(std::exchange(other.pool, nullptr)), idx(other.idx)
+    {}
+
+    PredMetaRef &
+    operator=(PredMetaRef other) noexcept
+    {
+        std::swap(pool, other.pool);
+        std::swap(idx, other.idx);
+        return *this;
+    }
+
+    ~PredMetaRef()
+    {
+        if (pool) {
+            pool->unref(idx);
+        }
+    }
+
+    explicit operator bool() const { return pool != nullptr; }
+};
+
+/**
+ * Prediction metas of one component. Records are kept across uses, so
+ * saving a meta into a recycled record is a plain assignment which
+ * reuses the storage of its vectors, and no allocation is left on the
+ * prediction path once the pool has grown to the number of in-flight
+ * fetch streams.
+ */
+template <class Meta>
+class PredMetaPool : public PredMetaPoolBase
+{
+    // a deque keeps records in place when growing
+    std::deque<Meta> records;
+
+  public:
+    PredMetaRef
+    save(const Meta &meta)
+    {
+        unsigned idx;
+        if (freeList.empty()) {
+            idx = records.size();
+            records.push_back(meta);
+            refCounts.push_back(0);
+        } else {
+            idx = freeList.back();
+            freeList.pop_back();
+            records[idx] = meta;
+        }
+        return PredMetaRef(this, idx);
+    }
+
+    const Meta *
+    get(const PredMetaRef &ref) const
+    {
+        assert(ref.pool == this);
+        return &records[ref.idx];
+    }
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_PRED_META_HH__
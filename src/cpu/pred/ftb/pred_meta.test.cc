@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "cpu/pred/ftb/pred_meta.hh"
+
+using namespace gem5::branch_prediction::ftb_pred;
+
+namespace
+{
+
+struct Meta
+{
+    int id = 0;
+    std::vector<int> payload;
+};
+
+} // anonymous namespace
+
+/** Copies share a record, which is recycled after the last one goes */
+TEST(PredMetaPoolTest, RefCounting)
+{
+    PredMetaPool<Meta> pool;
+    {
+        PredMetaRef a = pool.save(Meta{1, {1, 2, 3}});
+        ASSERT_TRUE(a);
+        ASSERT_EQ(pool.inUse(), 1);
+
+        PredMetaRef b = a;
+        ASSERT_EQ(pool.get(b), pool.get(a));
+        ASSERT_EQ(pool.inUse(), 1);
+
+        PredMetaRef c = std::move(a);
+        ASSERT_FALSE(a);
+        ASSERT_EQ(pool.get(c)->id, 1);
+
+        b = PredMetaRef();
+        ASSERT_EQ(pool.inUse(), 1);
+    }
+    ASSERT_EQ(pool.inUse(), 0);
+
+    // the freed record is reused, keeping the storage of its vector
+    PredMetaRef d = pool.save(Meta{2, {4}});
+    ASSERT_EQ(pool.get(d)->id, 2);
+    ASSERT_EQ(pool.get(d)->payload, std::vector<int>{4});
+    PredMetaRef e = pool.save(Meta{3, {}});
+    ASSERT_NE(pool.get(d), pool.get(e));
+    ASSERT_EQ(pool.inUse(), 2);
+
+    // assigning a ref drops the record it held
+    d = e;
+    ASSERT_EQ(pool.inUse(), 1);
+    ASSERT_EQ(pool.get(d)->id, 3);
+}
+
+/**
+ * Save, copy, commit and squash streams at random, and check that each
+ * stream still reads the meta it saved, and that the pool holds exactly
+ * the records some stream refers to and never grows past the number of
+ * streams in flight.
+ */
+TEST(PredMetaPoolTest, RandomStreams)
+{
+    const size_t max_streams = 48;
+    std::mt19937_64 rng(0x3e7a);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    PredMetaPool<Meta> pool;
+    // stream id -> the ref it holds and the id of the meta it saved
+    std::map<int, std::pair<PredMetaRef, int>> streams;
+    std::vector<const Meta *> records;
+    int next_id = 0;
+
+    for (int step = 0; step < 100000; step++) {
+        switch (rand(4)) {
+          case 0:
+            if (streams.size() < max_streams) {
+                int id = next_id++;
+                PredMetaRef ref =
+                    pool.save(Meta{id, std::vector<int>(rand(8), id)});
+                streams[id] = {std::move(ref), id};
+            }
+            break;
+          case 1:
+            // a replayed stream shares the meta of an older one
+            if (!streams.empty() && streams.size() < max_streams) {
+                auto it = std::next(streams.begin(), rand(streams.size()));
+                streams[next_id++] = it->second;
+            }
+            break;
+          case 2:
+            if (!streams.empty()) {
+                streams.erase(streams.begin());
+            }
+            break;
+          default:
+            if (!streams.empty()) {
+                streams.erase(std::prev(streams.end()));
+            }
+        }
+
+        std::map<const Meta *, int> held;
+        for (const auto &[id, stream] : streams) {
+            const Meta *meta = pool.get(stream.first);
+            ASSERT_EQ(meta->id, stream.second) << "step " << step;
+            ASSERT_EQ(meta->payload,
+                      std::vector<int>(meta->payload.size(), stream.second));
+            held[meta]++;
+        }
+        ASSERT_EQ(pool.inUse(), held.size()) << "step " << step;
+        ASSERT_LE(pool.inUse(), max_streams);
+    }
+
+    streams.clear();
+    ASSERT_EQ(pool.inUse(), 0);
+}
@@ -55,7 +55,7 @@ RAS::checkCorrectness() {
 }
 
 void
-RAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+RAS::putPCHistory(Addr startAddr, const GlobalHistory &history,
                   std::vector<FullFTBPrediction> &stagePreds)
 {
     assert(getDelay() < stagePreds.size());
@@ -71,15 +71,14 @@ RAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
     */
 }
 
-std::shared_ptr<void>
+PredMetaRef
 RAS::getPredictionMeta()
 {
-    std::shared_ptr<void> meta_void_ptr = std::make_shared<RASMeta>(meta);
-    return meta_void_ptr;
+    return metaPool.save(meta);
 }
 
 void
-RAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+RAS::specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred)
 {
     // do push & pops on prediction
     // pred.returnTarget = stack[sp].retAddr;
@@ -107,7 +106,7 @@ RAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &p
 }
 
 void
-RAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken)
+RAS::recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken)
 {
     auto takenSlot = entry.exeBranchInfo;
     /*
@@ -115,7 +114,7 @@ RAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entr
         printStack("before recoverHist");
     }*/
     // recover sp and tos first
-    auto meta_ptr = std::static_pointer_cast<RASMeta>(entry.predMetas[getComponentIdx()]);
+    auto meta_ptr = metaPool.get(entry.predMetas[getComponentIdx()]);
     DPRINTF(FTBRAS, "recover called, meta TOSR %d TOSW %d ssp %d sctr %u entry PC %x end PC %x\n", meta_ptr->TOSR, meta_ptr->TOSW, meta_ptr->ssp, meta_ptr->sctr, entry.startPC, entry.predEndPC);
 
     TOSR = meta_ptr->TOSR;
@@ -149,7 +148,7 @@ RAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entr
 void
 RAS::update(const FetchStream &entry)
 {
-    auto meta_ptr = std::static_pointer_cast<RASMeta>(entry.predMetas[getComponentIdx()]);
+    auto meta_ptr = metaPool.get(entry.predMetas[getComponentIdx()]);
     auto takenSlot = entry.exeBranchInfo;
     if (entry.exeTaken) {
         if (meta_ptr->ssp != nsp || meta_ptr->sctr != stack[nsp].data.ctr) {
@@ -384,7 +383,7 @@ RAS::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
 Addr
 RAS::getTopAddrFromMetas(const FetchStream &stream)
 {
-    auto meta_ptr = std::static_pointer_cast<RASMeta>(stream.predMetas[getComponentIdx()]);
+    auto meta_ptr = metaPool.get(stream.predMetas[getComponentIdx()]);
     return meta_ptr->target;
 }
 
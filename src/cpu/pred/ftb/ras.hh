@@ -64,14 +64,14 @@ class RAS : public TimedBaseFTBPredictor
             // RASInflightEntry inflight; // inflight top of stack
         }RASMeta;
 
-        void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+        void putPCHistory(Addr startAddr, const GlobalHistory &history,
                           std::vector<FullFTBPrediction> &stagePreds) override;
         
-        std::shared_ptr<void> getPredictionMeta() override;
+        PredMetaRef getPredictionMeta() override;
 
-        void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+        void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) override;
 
-        void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+        void recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
         void update(const FetchStream &entry) override;
 
@@ -180,6 +180,8 @@ class RAS : public TimedBaseFTBPredictor
 
         RASMeta meta;
 
+        PredMetaPool<RASMeta> metaPool;
+
 
 };
 
@@ -7,6 +7,8 @@
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/pred/general_arch_db.hh"
+#include "cpu/pred/ftb/global_history.hh"
+#include "cpu/pred/ftb/pred_meta.hh"
 #include "cpu/pred/ftb/stream_common.hh"
 #include "cpu/static_inst.hh"
 #include "debug/DecoupleBP.hh"
@@ -204,8 +206,8 @@ typedef struct FTBEntry
         return reasonable;
     }
 
-    FTBSlot getSlot(Addr pc) {
-        for (auto &slot : this->slots) {
+    FTBSlot getSlot(Addr pc) const {
+        for (const auto &slot : this->slots) {
             if (slot.pc == pc) {
                 return slot;
             }
@@ -309,7 +311,7 @@ struct FetchStream
     int currentSentBlock;
 
     // prediction metas
-    std::vector<std::shared_ptr<void>> predMetas;
+    std::vector<PredMetaRef> predMetas;
 
     // for loop
     std::vector<LoopRedirectInfo> loopRedirectInfos;
@@ -318,7 +320,7 @@ struct FetchStream
 
     Tick predTick{};
     Cycles predCycle{};
-    boost::dynamic_bitset<> history;
+    GlobalHistory history;
 
     // for profiling
     int fetchInstNum;
@@ -423,7 +425,7 @@ typedef struct FullFTBPrediction
     unsigned predSource;
     Tick predTick;
     Cycles predCycle;
-    boost::dynamic_bitset<> history;
+    GlobalHistory history;
 
     bool isTaken() {
         auto &ftbEntry = this->ftbEntry;
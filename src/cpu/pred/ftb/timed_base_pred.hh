@@ -2,12 +2,11 @@
 #define __CPU_PRED_FTB_TIMED_BASE_PRED_HH__
 
 
-#include <boost/dynamic_bitset.hpp>
-
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/pred/ftb/global_history.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "sim/sim_object.hh"
 #include "params/TimedBaseFTBPredictor.hh"
@@ -35,13 +34,13 @@ class TimedBaseFTBPredictor: public SimObject
     virtual void tick() {}
     // make predictions, record in stage preds
     virtual void putPCHistory(Addr startAddr,
-                              const boost::dynamic_bitset<> &history,
+                              const GlobalHistory &history,
                               std::vector<FullFTBPrediction> &stagePreds) {}
 
-    virtual std::shared_ptr<void> getPredictionMeta() { return nullptr; }
+    virtual PredMetaRef getPredictionMeta() { return PredMetaRef(); }
 
-    virtual void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) {}
-    virtual void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) {}
+    virtual void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) {}
+    virtual void recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken) {}
     virtual void update(const FetchStream &entry) {}
     unsigned getDelay() { return numDelay; }
     // do some statistics on a per-branch and per-predictor basis
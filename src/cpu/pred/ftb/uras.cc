@@ -72,7 +72,7 @@ uRAS::setTrace()
 }
 
 void
-uRAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+uRAS::putPCHistory(Addr startAddr, const GlobalHistory &history,
                   std::vector<FullFTBPrediction> &stagePreds)
 {
     auto &stack = specStack;
@@ -86,15 +86,14 @@ uRAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
     printStack("putPCHistory", stack, sp);
 }
 
-std::shared_ptr<void>
+PredMetaRef
 uRAS::getPredictionMeta()
 {
-    std::shared_ptr<void> meta_void_ptr = std::make_shared<uRASMeta>(meta);
-    return meta_void_ptr;
+    return metaPool.save(meta);
 }
 
 void
-uRAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+uRAS::specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred)
 {
     auto &stack = specStack;
     auto &sp = specSp;
@@ -126,13 +125,13 @@ uRAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &
 }
 
 void
-uRAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken)
+uRAS::recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken)
 {
     auto &stack = specStack;
     auto &sp = specSp;
     printStack("before recoverHist", stack, sp);
     // recover sp and tos first
-    auto meta_ptr = std::static_pointer_cast<uRASMeta>(entry.predMetas[getComponentIdx()]);
+    auto meta_ptr = metaPool.get(entry.predMetas[getComponentIdx()]);
     auto takenSlot = entry.exeBranchInfo;
     if (enableDB) {
         SpecRASTrace rec(When::REDIRECT, RAS_OP::RECOVER, entry.startPC, takenSlot.pc, 0, sp, stack[sp].retAddr, stack[sp].ctr);
@@ -172,7 +171,7 @@ uRAS::update(const FetchStream &entry)
     printStack("before update", stack, sp);
     auto takenSlot = entry.exeBranchInfo;
     if (entry.exeTaken && (takenSlot.isReturn || takenSlot.isCall)) {
-        auto meta_ptr = std::static_pointer_cast<uRASMeta>(entry.predMetas[getComponentIdx()]);
+        auto meta_ptr = metaPool.get(entry.predMetas[getComponentIdx()]);
         auto pred_sp = meta_ptr->sp;
         auto pred_tos = meta_ptr->tos;
         auto miss = entry.squashType == SQUASH_CTRL && entry.squashPC == entry.exeBranchInfo.pc;
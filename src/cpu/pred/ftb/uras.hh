@@ -35,14 +35,14 @@ class uRAS : public TimedBaseFTBPredictor
             uRASEntry tos; // top of stack
         }uRASMeta;
 
-        void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+        void putPCHistory(Addr startAddr, const GlobalHistory &history,
                           std::vector<FullFTBPrediction> &stagePreds) override;
         
-        std::shared_ptr<void> getPredictionMeta() override;
+        PredMetaRef getPredictionMeta() override;
 
-        void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+        void specUpdateHist(const GlobalHistory &history, FullFTBPrediction &pred) override;
 
-        void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+        void recoverHist(const GlobalHistory &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
         void update(const FetchStream &entry) override;
 
@@ -108,6 +108,8 @@ class uRAS : public TimedBaseFTBPredictor
 
         uRASMeta meta;
 
+        PredMetaPool<uRASMeta> metaPool;
+
         TraceManager *specRasTrace;
         TraceManager *nonSpecRasTrace;
 
@@ -341,6 +341,7 @@ class PhysRegId : private RegId
 
     void decRef() { numRef = numRef == 0 ? 0 : numRef - 1; }
     void incRef() { ++numRef; }
+    void clearRef() { numRef = 0; }
 
     int getRef() const { return numRef; }
 
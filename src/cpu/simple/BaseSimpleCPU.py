@@ -38,3 +38,6 @@ class BaseSimpleCPU(BaseCPU):
     cxx_class = 'gem5::BaseSimpleCPU'
 
     branchPred = Param.BranchPredictor(NULL, "Branch Predictor")
+    warmup_branch_pred = Param.BranchPredictor(NULL,
+        "Branch predictor of a detailed CPU to train with the retired "
+        "instructions, for functional warmup")
@@ -87,6 +87,7 @@ BaseSimpleCPU::BaseSimpleCPU(const BaseSimpleCPUParams &p)
     : BaseCPU(p),
       curThread(0),
       branchPred(p.branchPred),
+      warmupBranchPred(p.warmup_branch_pred),
       traceData(NULL),
       _status(Idle)
 {
@@ -202,6 +203,19 @@ BaseSimpleCPU::haltContext(ThreadID thread_num)
     updateCycleCounters(BaseCPU::CPU_STATE_SLEEP);
 }
 
+void
+BaseSimpleCPU::switchOut()
+{
+    BaseCPU::switchOut();
+
+    if (warmupBranchPred) {
+        for (ThreadID tid = 0; tid < numThreads; tid++) {
+            warmupBranchPred->warmupHandOver(
+                tid, threadInfo[tid]->thread->pcState());
+        }
+    }
+}
+
 void
 BaseSimpleCPU::resetStats()
 {
@@ -475,6 +489,14 @@ BaseSimpleCPU::advancePC(const Fault &fault)
 
     const bool branching = thread->pcState().branching();
 
+    // the PC with its resolved next PC, for the predictor being warmed up
+    const bool warmup_commit = warmupBranchPred && fault == NoFault &&
+        curStaticInst &&
+        (!curStaticInst->isMicroop() || curStaticInst->isLastMicroop());
+    if (warmup_commit) {
+        warmupPC = thread->pcState().as<RiscvISA::PCState>();
+    }
+
     //Since we're moving to a new pc, zero out the offset
     t_info.fetchOffset = 0;
     if (fault != NoFault) {
@@ -489,6 +511,11 @@ BaseSimpleCPU::advancePC(const Fault &fault)
         }
     }
 
+    if (warmup_commit) {
+        warmupBranchPred->warmupCommit(curThread, curStaticInst, warmupPC,
+                                       thread->pcState());
+    }
+
     if (branchPred && curStaticInst && curStaticInst->isControl()) {
         // Use a fake sequence number since we only have one
         // instruction in flight at the same time.
@@ -45,6 +45,7 @@
 #include <memory>
 
 #include "arch/generic/pcstate.hh"
+#include "arch/riscv/pcstate.hh"
 #include "base/statistics.hh"
 #include "cpu/base.hh"
 #include "cpu/checker/cpu.hh"
@@ -87,6 +88,11 @@ class BaseSimpleCPU : public BaseCPU
     ThreadID curThread;
     branch_prediction::BPredUnit *branchPred;
 
+    /** Predictor of a detailed CPU this one warms up, if any */
+    branch_prediction::BPredUnit *warmupBranchPred;
+    /** PC of the instruction retired for warmupBranchPred, reused */
+    RiscvISA::PCState warmupPC;
+
     void checkPcEventQueue();
     void swapActiveThread();
 
@@ -147,6 +153,8 @@ class BaseSimpleCPU : public BaseCPU
 
     void haltContext(ThreadID thread_num) override;
 
+    void switchOut() override;
+
     // statistics
     void resetStats() override;
 
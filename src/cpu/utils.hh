@@ -38,7 +38,12 @@
 #ifndef __CPU_UTILS_HH__
 #define __CPU_UTILS_HH__
 
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
 #include "base/types.hh"
+#include "sim/byteswap.hh"
 
 namespace gem5
 {
@@ -94,6 +99,43 @@ isAnyActiveElement(const std::vector<bool>::const_iterator& it_start,
     return (it_tmp != it_end);
 }
 
+/**
+ * Copy the bytes of src whose bit is set in byte_mask to dst, and leave
+ * the others of dst alone. The bytes are blended eight at a time in a
+ * 64-bit word, which needs no host SIMD instructions. The select mask
+ * is built with byte i in bits 8i to 8i+7 and then put in host order,
+ * so that it lines up with the bytes loaded on either endianness.
+ * @param dst The bytes to write.
+ * @param src The bytes to copy.
+ * @param byte_mask Bit i set means byte i is copied.
+ * @param size Number of bytes, at most 64.
+ */
+inline void
+maskedCopy(uint8_t *dst, const uint8_t *src, uint64_t byte_mask,
+           unsigned size)
+{
+    assert(size <= 64);
+    constexpr uint64_t Lows = 0x0101010101010101ULL;
+    constexpr uint64_t Highs = 0x8080808080808080ULL;
+    unsigned i = 0;
+    for (; i + 8 <= size; i += 8, byte_mask >>= 8) {
+        // spread the eight mask bits to the low bit of each byte
+        uint64_t bits = ((byte_mask & 0xff) * Lows) & 0x8040201008040201ULL;
+        uint64_t set = (((bits & ~Highs) + ~Highs) | bits) & Highs;
+        uint64_t select = htole((set >> 7) * 0xff);
+        uint64_t d, s;
+        std::memcpy(&d, dst + i, 8);
+        std::memcpy(&s, src + i, 8);
+        d = (d & ~select) | (s & select);
+        std::memcpy(dst + i, &d, 8);
+    }
+    for (; i < size; i++, byte_mask >>= 1) {
+        if (byte_mask & 1) {
+            dst[i] = src[i];
+        }
+    }
+}
+
 inline std::string
 goldenDiffStr(uint8_t *dut_ptr, uint8_t* golden_ptr, size_t size) {
     assert(size <= 8);
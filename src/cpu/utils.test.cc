@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+
+#include "cpu/utils.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+void
+byteLoopCopy(uint8_t *dst, const uint8_t *src, uint64_t byte_mask,
+             unsigned size)
+{
+    for (unsigned i = 0; i < size; i++) {
+        if (byte_mask >> i & 1) {
+            dst[i] = src[i];
+        }
+    }
+}
+
+} // anonymous namespace
+
+/** Bytes are picked by their own mask bit, whatever the host order */
+TEST(MaskedCopyTest, SingleBytes)
+{
+    uint8_t dst[16] = {};
+    uint8_t src[16];
+    for (unsigned i = 0; i < 16; i++) {
+        src[i] = 0xa0 + i;
+    }
+    maskedCopy(dst, src, 0x8001, 16);
+    for (unsigned i = 0; i < 16; i++) {
+        ASSERT_EQ(dst[i], i == 0 || i == 15 ? src[i] : 0) << "byte " << i;
+    }
+}
+
+/**
+ * Copy random masks over random buffers of every size and alignment,
+ * and compare the result with a byte loop.
+ */
+TEST(MaskedCopyTest, RandomAgainstByteLoop)
+{
+    std::mt19937_64 rng(0xb1e4d);
+    uint8_t src[72], dst[72], expected[72];
+
+    for (int step = 0; step < 100000; step++) {
+        unsigned size = rng() % 65;
+        unsigned offset = rng() % 8;
+        uint64_t mask;
+        switch (rng() % 4) {
+          case 0: mask = ~uint64_t(0); break;
+          case 1: mask = 0; break;
+          default: mask = rng(); break;
+        }
+        for (unsigned i = 0; i < sizeof(src); i++) {
+            src[i] = rng();
+            dst[i] = expected[i] = rng();
+        }
+        maskedCopy(dst + offset, src + offset, mask, size);
+        byteLoopCopy(expected + offset, src + offset, mask, size);
+        for (unsigned i = 0; i < sizeof(dst); i++) {
+            ASSERT_EQ(dst[i], expected[i])
+                << "step " << step << " size " << size << " byte " << i;
+        }
+    }
+}
@@ -45,6 +45,7 @@
 #include "mem/packet.hh"
 #include "mem/packet_access.hh"
 #include "params/Plic.hh"
+#include "sim/eventq.hh"
 #include "sim/system.hh"
 
 namespace gem5
@@ -446,6 +447,9 @@ Plic::updateInt()
             ExceptionCode::INT_EXT_SUPER : ExceptionCode::INT_EXT_MACHINE;
 
         auto tc = system->threads[thread_id];
+        // the thread's state belongs to its CPU's event queue
+        EventQueue::ScopedMigration migrate(tc->getCpuPtr()->eventQueue(),
+                                            inParallelMode);
         uint32_t max_id = output.maxID[i];
         uint32_t priority = output.maxPriority[i];
         uint32_t threshold = registers.threshold[i].get();
@@ -48,6 +48,7 @@
 #include "debug/LLSC.hh"
 #include "debug/MemoryAccess.hh"
 #include "mem/packet_access.hh"
+#include "mem/physical.hh"
 #include "sim/system.hh"
 
 namespace gem5
@@ -116,6 +117,36 @@ AbstractMemory::setBackingStore(uint8_t* pmem_addr)
     DPRINTF(MemoryAccess, "Backing store set to %#lx\n", (uint64_t)pmemAddr);
 }
 
+void
+AbstractMemory::setLazyRestorer(LazyCptRestorer *restorer)
+{
+    // Requestors may have cached the backdoor before the restore.
+    if (backdoor.ptr())
+        backdoor.invalidate();
+
+    lazyRestorer = restorer;
+}
+
+void
+AbstractMemory::getBackdoor(MemBackdoorPtr &bd_ptr)
+{
+    if (lazyRestorer) {
+        if (!lazyRestorer->done())
+            return;
+        lazyRestorer = nullptr;
+    }
+
+    if (lockedAddrList.empty() && backdoor.ptr())
+        bd_ptr = &backdoor;
+}
+
+void
+AbstractMemory::populate(const uint8_t *host_addr, unsigned size)
+{
+    if (lazyRestorer && pmemAddr)
+        lazyRestorer->populate(host_addr, size);
+}
+
 AbstractMemory::MemStats::MemStats(AbstractMemory &_mem)
     : statistics::Group(&_mem), mem(_mem),
     ADD_STAT(bytesRead, statistics::units::Byte::get(),
@@ -397,6 +428,7 @@ AbstractMemory::access(PacketPtr pkt)
     uint8_t *host_addr = toHostAddr(pkt->getAddr());
     DPRINTF(MemoryAccess, "guest addr %#lx -> host_addr %#lx\n", pkt->getAddr(),
             (uint64_t) host_addr);
+    populate(host_addr, pkt->getSize());
 
     if (pkt->cmd == MemCmd::SwapReq) {
         if (pkt->isAtomicOp()) {
@@ -487,6 +519,7 @@ AbstractMemory::functionalAccess(PacketPtr pkt)
     assert(pkt->getAddrRange().isSubset(range));
 
     uint8_t *host_addr = toHostAddr(pkt->getAddr());
+    populate(host_addr, pkt->getSize());
 
     if (pkt->isRead()) {
         if (pmemAddr) {
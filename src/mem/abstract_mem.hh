@@ -60,6 +60,8 @@ class System;
 namespace memory
 {
 
+class LazyCptRestorer;
+
 /**
  * Locked address class that represents a physical address and a
  * context id.
@@ -120,6 +122,16 @@ class AbstractMemory : public ClockedObject
     // Backdoor to access this memory.
     MemBackdoor backdoor;
 
+    // Fills the backing store from a checkpoint on first touch, if the
+    // checkpoint is restored lazily
+    LazyCptRestorer *lazyRestorer = nullptr;
+
+    /**
+     * Make sure the checkpoint data of a region is in the backing store
+     * before the region is accessed.
+     */
+    void populate(const uint8_t *host_addr, unsigned size);
+
     // Enable specific memories to be reported to the configuration table
     const bool confTableReported;
 
@@ -234,12 +246,16 @@ class AbstractMemory : public ClockedObject
      */
     void setBackingStore(uint8_t* pmem_addr);
 
-    void
-    getBackdoor(MemBackdoorPtr &bd_ptr)
-    {
-        if (lockedAddrList.empty() && backdoor.ptr())
-            bd_ptr = &backdoor;
-    }
+    /**
+     * Populate the backing store lazily from a checkpoint. No backdoor
+     * is handed out until the checkpoint is fully materialized, so that
+     * every access passes through the restorer.
+     *
+     * @param restorer The restorer owning the checkpoint image
+     */
+    void setLazyRestorer(LazyCptRestorer *restorer);
+
+    void getBackdoor(MemBackdoorPtr &bd_ptr);
 
     /**
      * Get the list of locked addresses to allow checkpointing.
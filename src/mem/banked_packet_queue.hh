@@ -0,0 +1,296 @@
+#ifndef __MEM_BANKED_PACKET_QUEUE_HH__
+#define __MEM_BANKED_PACKET_QUEUE_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * A queue of memory packets in arrival order. Besides the plain deque,
+ * the queue keeps the packets of every bank sorted by row, so that a
+ * scheduler can find the oldest packet hitting or missing the open row
+ * of a bank without walking the whole queue. Packets are only ever
+ * added at the back, so the arrival number of a packet is also its
+ * position in the queue.
+ *
+ * @tparam Packet The queued packet type, MemPacket in the controllers.
+ */
+template <class Packet>
+class BankedPacketQueue
+{
+  public:
+    using iterator = typename std::deque<Packet*>::iterator;
+    using const_iterator = typename std::deque<Packet*>::const_iterator;
+
+    /** Arrival number of no packet, ordered after all of them */
+    static constexpr uint64_t NoSeq = std::numeric_limits<uint64_t>::max();
+
+    /** The queued packets of a single bank */
+    class BankQueue
+    {
+      public:
+        /** Oldest packet to the row, NoSeq if there is none */
+        uint64_t
+        firstIn(uint32_t row) const
+        {
+            auto it = rows.find(row);
+            return it == rows.end() ? NoSeq : *it->second.begin();
+        }
+
+        /** Oldest packet to any other row, NoSeq if there is none */
+        uint64_t
+        firstNotIn(uint32_t row) const
+        {
+            // only the head of the row itself can come before the others
+            auto it = rowHeads.begin();
+            if (it != rowHeads.end() && it->second == row) {
+                ++it;
+            }
+            return it == rowHeads.end() ? NoSeq : it->first;
+        }
+
+      private:
+        friend class BankedPacketQueue;
+
+        /** Arrival numbers of the packets, per row */
+        std::unordered_map<uint32_t, std::set<uint64_t>> rows;
+        /** The oldest packet of every row, oldest first */
+        std::set<std::pair<uint64_t, uint32_t>> rowHeads;
+    };
+
+    bool empty() const { return packets.empty(); }
+    size_t size() const { return packets.size(); }
+
+    iterator begin() { return packets.begin(); }
+    iterator end() { return packets.end(); }
+    const_iterator begin() const { return packets.begin(); }
+    const_iterator end() const { return packets.end(); }
+
+    Packet *front() const { return packets.front(); }
+    Packet *back() const { return packets.back(); }
+
+    void
+    push_back(Packet *pkt)
+    {
+        const uint64_t seq = nextSeq++;
+        packets.push_back(pkt);
+        seqs.push_back(seq);
+
+        BankQueue &bq = banks[bankKey(pkt->isDram(), pkt->pseudoChannel,
+                                      pkt->bankId)];
+        auto &row = bq.rows[pkt->row];
+        if (row.empty()) {
+            bq.rowHeads.emplace(seq, pkt->row);
+        }
+        row.insert(row.end(), seq);
+    }
+
+    iterator
+    erase(const_iterator it)
+    {
+        const auto pos = it - packets.cbegin();
+        const uint64_t seq = seqs[pos];
+        const Packet *pkt = *it;
+
+        auto bank_it = banks.find(bankKey(pkt->isDram(), pkt->pseudoChannel,
+                                          pkt->bankId));
+        assert(bank_it != banks.end());
+        BankQueue &bq = bank_it->second;
+        auto row_it = bq.rows.find(pkt->row);
+        assert(row_it != bq.rows.end());
+        auto &row = row_it->second;
+        if (*row.begin() == seq) {
+            bq.rowHeads.erase({seq, pkt->row});
+            row.erase(row.begin());
+            if (row.empty()) {
+                bq.rows.erase(row_it);
+            } else {
+                bq.rowHeads.emplace(*row.begin(), pkt->row);
+            }
+        } else {
+            row.erase(seq);
+        }
+
+        seqs.erase(seqs.begin() + pos);
+        return packets.erase(it);
+    }
+
+    void pop_front() { erase(packets.begin()); }
+
+    /** Arrival number of a queued packet */
+    uint64_t
+    seqOf(const_iterator it) const
+    {
+        return seqs[it - packets.begin()];
+    }
+
+    /** The queued packet with the given arrival number */
+    iterator
+    find(uint64_t seq)
+    {
+        auto it = std::lower_bound(seqs.begin(), seqs.end(), seq);
+        assert(it != seqs.end() && *it == seq);
+        return packets.begin() + (it - seqs.begin());
+    }
+
+    /** The packets queued for a bank, nullptr if there are none */
+    const BankQueue *
+    bank(bool is_dram, uint8_t pseudo_channel, uint16_t bank_id) const
+    {
+        auto it = banks.find(bankKey(is_dram, pseudo_channel, bank_id));
+        return it == banks.end() || it->second.rows.empty() ?
+            nullptr : &it->second;
+    }
+
+  private:
+    static uint32_t
+    bankKey(bool is_dram, uint8_t pseudo_channel, uint16_t bank_id)
+    {
+        return (uint32_t(is_dram) << 24) | (uint32_t(pseudo_channel) << 16) |
+               bank_id;
+    }
+
+    std::deque<Packet*> packets;
+    /** Arrival number of each packet, increasing from front to back */
+    std::deque<uint64_t> seqs;
+    uint64_t nextSeq = 0;
+
+    std::unordered_map<uint32_t, BankQueue> banks;
+};
+
+/**
+ * The FR-FCFS choice of a DRAM interface amongst the packets of a
+ * queue, made from the oldest packets of every bank.
+ *
+ * This makes the same choice as walking the queue in order: the oldest
+ * seamless row hit wins. Without one, the oldest packet to a bank
+ * amongst the first available ones wins if its bank can be prepped
+ * behind the scenes, and otherwise the oldest row hit that is prepped
+ * and ready, falling back to the former.
+ *
+ * @param bank_of bank_of(rank, bank) is the state of the bank, with its
+ *        openRow, rdAllowedAt and wrAllowedAt, or nullptr while its rank
+ *        is refreshing.
+ * @param min_bank_prep Gives the mask of the first available banks per
+ *        rank and whether their activate can be hidden, as
+ *        DRAMInterface::minBankPrep does. Only called when needed.
+ * @return The chosen packet and the tick of its column command, or the
+ *         end of the queue and MaxTick if no rank is available.
+ */
+template <class Packet, class BankOf, class MinBankPrep>
+std::pair<typename BankedPacketQueue<Packet>::iterator, Tick>
+chooseFRFCFS(BankedPacketQueue<Packet> &queue, uint8_t pseudo_channel,
+             unsigned ranks_per_channel, unsigned banks_per_rank,
+             Tick min_col_at, const BankOf &bank_of,
+             const MinBankPrep &min_bank_prep)
+{
+    const uint64_t no_seq = BankedPacketQueue<Packet>::NoSeq;
+
+    // seamless row hit, row hit that is prepped and ready, and packet to
+    // a bank amongst the first available ones
+    uint64_t seamless_seq = no_seq;
+    uint64_t prepped_seq = no_seq;
+    uint64_t earliest_seq = no_seq;
+    Tick seamless_col_at = MaxTick;
+    Tick prepped_col_at = MaxTick;
+    Tick earliest_col_at = MaxTick;
+
+    // is there a packet missing the open row of an available bank?
+    bool found_row_miss = false;
+
+    for (unsigned i = 0; i < ranks_per_channel; i++) {
+        for (unsigned j = 0; j < banks_per_rank; j++) {
+            const auto *bank = bank_of(i, j);
+            if (!bank) {
+                // the whole rank is refreshing
+                break;
+            }
+            const auto *bq =
+                queue.bank(true, pseudo_channel, i * banks_per_rank + j);
+            if (!bq) {
+                continue;
+            }
+
+            const uint64_t hit_seq = bq->firstIn(bank->openRow);
+            if (hit_seq != no_seq) {
+                const Packet *pkt = *queue.find(hit_seq);
+                const Tick col_allowed_at = pkt->isRead() ?
+                    bank->rdAllowedAt : bank->wrAllowedAt;
+                // no additional rank-to-rank or same bank-group delays
+                if (col_allowed_at <= min_col_at) {
+                    if (hit_seq < seamless_seq) {
+                        seamless_seq = hit_seq;
+                        seamless_col_at = col_allowed_at;
+                    }
+                } else if (hit_seq < prepped_seq) {
+                    prepped_seq = hit_seq;
+                    prepped_col_at = col_allowed_at;
+                }
+            }
+            found_row_miss |= bq->firstNotIn(bank->openRow) != no_seq;
+        }
+    }
+
+    if (seamless_seq != no_seq) {
+        return std::make_pair(queue.find(seamless_seq), seamless_col_at);
+    }
+
+    // can the PRE/ACT sequence be done without impacting utlization?
+    bool hidden_bank_prep = false;
+    if (found_row_miss) {
+        // determine the banks with the earliest bank delay
+        std::vector<uint32_t> earliest_banks;
+        std::tie(earliest_banks, hidden_bank_prep) = min_bank_prep();
+
+        for (unsigned i = 0; i < ranks_per_channel; i++) {
+            for (unsigned j = 0; j < banks_per_rank; j++) {
+                // only banks of available ranks with packets are picked
+                if (!bits(earliest_banks[i], j, j)) {
+                    continue;
+                }
+                const auto *bq =
+                    queue.bank(true, pseudo_channel, i * banks_per_rank + j);
+                const auto *bank = bank_of(i, j);
+                const uint64_t miss_seq = bq->firstNotIn(bank->openRow);
+                if (miss_seq < earliest_seq) {
+                    const Packet *pkt = *queue.find(miss_seq);
+                    earliest_seq = miss_seq;
+                    earliest_col_at = pkt->isRead() ?
+                        bank->rdAllowedAt : bank->wrAllowedAt;
+                }
+            }
+        }
+    }
+
+    // give priority to packets that can issue bank commands 'behind the
+    // scenes', any additional delay if any will be due to col-to-col
+    // command requirements
+    if (earliest_seq != no_seq &&
+        (hidden_bank_prep || prepped_seq == no_seq)) {
+        return std::make_pair(queue.find(earliest_seq), earliest_col_at);
+    }
+    if (prepped_seq != no_seq) {
+        return std::make_pair(queue.find(prepped_seq), prepped_col_at);
+    }
+    return std::make_pair(queue.end(), MaxTick);
+}
+
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_BANKED_PACKET_QUEUE_HH__
@@ -0,0 +1,276 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "mem/banked_packet_queue.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+namespace
+{
+
+/** The fields of a MemPacket the queue and the scheduler look at */
+struct TestPacket
+{
+    bool read;
+    bool dram;
+    uint8_t pseudoChannel;
+    uint8_t rank;
+    uint8_t bank;
+    uint32_t row;
+    uint16_t bankId;
+
+    bool isRead() const { return read; }
+    bool isDram() const { return dram; }
+};
+
+using TestQueue = BankedPacketQueue<TestPacket>;
+
+constexpr uint32_t NoRow = -1;
+
+struct TestBank
+{
+    uint32_t openRow = NoRow;
+    Tick rdAllowedAt = 0;
+    Tick wrAllowedAt = 0;
+    Tick actAllowedAt = 0;
+};
+
+/** Ranks of banks, a rank without banks is refreshing */
+class Channel
+{
+  public:
+    Channel(unsigned num_ranks, unsigned banks_per_rank)
+        : banksPerRank(banks_per_rank), ranks(num_ranks)
+    {}
+
+    const TestBank *
+    bank(unsigned rank, unsigned bank) const
+    {
+        return refreshing(rank) ? nullptr : &ranks[rank][bank];
+    }
+
+    bool refreshing(unsigned rank) const { return ranks[rank].empty(); }
+
+    /**
+     * The banks with waiting packets that can activate first, as
+     * DRAMInterface::minBankPrep does with simpler timings, and whether
+     * their activate can be hidden before min_col_at.
+     */
+    template <class HasPackets>
+    std::pair<std::vector<uint32_t>, bool>
+    minBankPrep(const HasPackets &has_packets, Tick min_col_at) const
+    {
+        const Tick tRCD = 7;
+        std::vector<uint32_t> mask(ranks.size(), 0);
+        Tick min_act_at = MaxTick;
+        for (unsigned i = 0; i < ranks.size(); i++) {
+            for (unsigned j = 0; j < banksPerRank; j++) {
+                if (refreshing(i) || !has_packets(i, j)) {
+                    continue;
+                }
+                const Tick act_at = ranks[i][j].actAllowedAt;
+                if (act_at < min_act_at) {
+                    std::fill(mask.begin(), mask.end(), 0);
+                    min_act_at = act_at;
+                }
+                if (act_at == min_act_at) {
+                    replaceBits(mask[i], j, j, 1);
+                }
+            }
+        }
+        return {mask, min_act_at + tRCD <= min_col_at};
+    }
+
+    const unsigned banksPerRank;
+    std::vector<std::vector<TestBank>> ranks;
+};
+
+/**
+ * The FR-FCFS choice of DRAMInterface::chooseNextFRFCFS as it was
+ * before the queue was indexed, walking every packet in order.
+ */
+std::pair<TestQueue::iterator, Tick>
+walkFRFCFS(TestQueue &queue, uint8_t pseudo_channel,
+           const Channel &channel, Tick min_col_at)
+{
+    std::vector<uint32_t> earliest_banks;
+    bool filled_earliest_banks = false;
+    bool hidden_bank_prep = false;
+    bool found_hidden_bank = false;
+    bool found_prepped_pkt = false;
+    bool found_earliest_pkt = false;
+
+    Tick selected_col_at = MaxTick;
+    auto selected_pkt_it = queue.end();
+
+    for (auto i = queue.begin(); i != queue.end(); ++i) {
+        const TestPacket *pkt = *i;
+        if (!pkt->isDram() || pkt->pseudoChannel != pseudo_channel ||
+            channel.refreshing(pkt->rank)) {
+            continue;
+        }
+        const TestBank &bank = *channel.bank(pkt->rank, pkt->bank);
+        const Tick col_allowed_at = pkt->isRead() ? bank.rdAllowedAt :
+                                                    bank.wrAllowedAt;
+        if (bank.openRow == pkt->row) {
+            if (col_allowed_at <= min_col_at) {
+                selected_pkt_it = i;
+                selected_col_at = col_allowed_at;
+                break;
+            } else if (!found_hidden_bank && !found_prepped_pkt) {
+                selected_pkt_it = i;
+                selected_col_at = col_allowed_at;
+                found_prepped_pkt = true;
+            }
+        } else if (!found_earliest_pkt) {
+            if (!filled_earliest_banks) {
+                // the banks with any waiting packet, found by a walk
+                auto has_packets = [&](unsigned rank, unsigned bank) {
+                    for (const TestPacket *p : queue) {
+                        if (p->isDram() &&
+                            p->pseudoChannel == pseudo_channel &&
+                            p->rank == rank && p->bank == bank) {
+                            return true;
+                        }
+                    }
+                    return false;
+                };
+                std::tie(earliest_banks, hidden_bank_prep) =
+                    channel.minBankPrep(has_packets, min_col_at);
+                filled_earliest_banks = true;
+            }
+            if (bits(earliest_banks[pkt->rank], pkt->bank, pkt->bank)) {
+                found_earliest_pkt = true;
+                found_hidden_bank = hidden_bank_prep;
+                if (hidden_bank_prep || !found_prepped_pkt) {
+                    selected_pkt_it = i;
+                    selected_col_at = col_allowed_at;
+                }
+            }
+        }
+    }
+    return std::make_pair(selected_pkt_it, selected_col_at);
+}
+
+} // anonymous namespace
+
+/** The bank queues give the oldest packets hitting and missing a row */
+TEST(BankedPacketQueueTest, OldestOfRow)
+{
+    TestQueue queue;
+    std::vector<TestPacket> pkts = {
+        {true, true, 0, 0, 1, 5, 1},
+        {true, true, 0, 0, 1, 7, 1},
+        {true, true, 0, 0, 1, 5, 1},
+        {true, false, 0, 0, 1, 5, 1},
+        {true, true, 1, 0, 1, 9, 1},
+    };
+    for (auto &pkt : pkts) {
+        queue.push_back(&pkt);
+    }
+
+    const TestQueue::BankQueue *bq = queue.bank(true, 0, 1);
+    ASSERT_NE(bq, nullptr);
+    ASSERT_EQ(bq->firstIn(5), 0);
+    ASSERT_EQ(bq->firstNotIn(5), 1);
+    ASSERT_EQ(bq->firstNotIn(7), 0);
+    ASSERT_EQ(bq->firstIn(9), TestQueue::NoSeq);
+    ASSERT_EQ(queue.bank(true, 0, 2), nullptr);
+
+    // the NVM and the other pseudo channel are kept apart
+    ASSERT_EQ(queue.bank(false, 0, 1)->firstNotIn(7), 3);
+    ASSERT_EQ(queue.bank(true, 1, 1)->firstIn(9), 4);
+
+    queue.pop_front();
+    ASSERT_EQ(bq->firstIn(5), 2);
+    ASSERT_EQ(bq->firstNotIn(5), 1);
+    ASSERT_EQ(bq->firstNotIn(7), 2);
+    ASSERT_EQ(*queue.find(2), &pkts[2]);
+    ASSERT_EQ(queue.seqOf(queue.begin()), 1);
+
+    queue.erase(queue.find(1));
+    ASSERT_EQ(bq->firstNotIn(5), TestQueue::NoSeq);
+    queue.erase(queue.find(2));
+    ASSERT_EQ(queue.bank(true, 0, 1), nullptr);
+}
+
+/**
+ * Queue and take packets at random, under random bank states, refreshes
+ * and column deadlines, and check the choice from the bank queues
+ * against the walk of the queue it replaced.
+ */
+TEST(BankedPacketQueueTest, RandomAgainstWalk)
+{
+    std::mt19937_64 rng(0xf7fc);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+    const uint8_t pseudo_channel = 0;
+
+    for (int trial = 0; trial < 1000; trial++) {
+        const unsigned num_ranks = 1 + rand(2);
+        const unsigned banks_per_rank = 1 + rand(8);
+        Channel channel(num_ranks, banks_per_rank);
+        TestQueue queue;
+        std::vector<std::unique_ptr<TestPacket>> pkts;
+        // queues hold either reads or writes
+        const bool read = rand(2);
+
+        for (int step = 0; step < 300; step++) {
+            const Tick now = 100 + rand(50);
+            for (auto &rank : channel.ranks) {
+                rank.assign(rand(5) ? banks_per_rank : 0, TestBank());
+                for (auto &bank : rank) {
+                    bank.openRow = rand(4) ? rand(3) : NoRow;
+                    bank.rdAllowedAt = bank.wrAllowedAt = now + rand(30);
+                    bank.actAllowedAt = now + rand(30) - 15;
+                }
+            }
+
+            if (rand(3) != 2 && queue.size() < 40) {
+                const uint8_t rank = rand(num_ranks);
+                const uint8_t bank = rand(banks_per_rank);
+                pkts.emplace_back(new TestPacket{
+                    read, rand(8) != 0, uint8_t(rand(6) == 0), rank, bank,
+                    uint32_t(rand(3)),
+                    uint16_t(rank * banks_per_rank + bank)});
+                queue.push_back(pkts.back().get());
+            } else if (!queue.empty()) {
+                queue.erase(queue.begin() + rand(queue.size()));
+            }
+
+            const Tick min_col_at = now + rand(30);
+            auto bank_of = [&channel](unsigned rank, unsigned bank) {
+                return channel.bank(rank, bank);
+            };
+            auto min_bank_prep = [&]() {
+                auto has_packets = [&](unsigned rank, unsigned bank) {
+                    return queue.bank(true, pseudo_channel,
+                                      rank * banks_per_rank + bank);
+                };
+                return channel.minBankPrep(has_packets, min_col_at);
+            };
+            auto walked = walkFRFCFS(queue, pseudo_channel, channel,
+                                     min_col_at);
+            auto chosen = chooseFRFCFS(queue, pseudo_channel, num_ranks,
+                                       banks_per_rank, min_col_at, bank_of,
+                                       min_bank_prep);
+            ASSERT_EQ(chosen.first - queue.begin(),
+                      walked.first - queue.begin())
+                << "trial " << trial << " step " << step;
+            if (walked.first != queue.end()) {
+                ASSERT_EQ(chosen.second, walked.second);
+                // the scheduler issues some of the choices
+                if (rand(2)) {
+                    queue.erase(walked.first);
+                }
+            }
+        }
+    }
+}
@@ -98,6 +98,9 @@ class BaseCache(ClockedObject):
     enable_wayprediction = Param.Bool(True, "enablewaypredction")
 
     prefetcher = Param.BasePrefetcher(NULL,"Prefetcher attached to cache")
+    prefetch_train_atomic = Param.Bool(False, "Train the prefetcher with "
+        "atomic accesses, dropping what it would prefetch (for functional "
+        "warmup)")
     tags = Param.BaseTags(BaseSetAssoc(), "Tag store")
     replacement_policy = Param.BaseReplacementPolicy(LRURP(),
         "Replacement policy")
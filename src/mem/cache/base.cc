@@ -176,7 +176,8 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
       system(p.system),
       stats(*this),
       cacheLevel(p.cache_level),
-      forceHit(p.force_hit)
+      forceHit(p.force_hit),
+      prefetchTrainAtomic(p.prefetch_train_atomic)
 {
     // the MSHR queue has no reserve entries as we check the MSHR
     // queue on every single allocation, whereas the write queue has
@@ -1026,6 +1027,12 @@ BaseCache::recvAtomic(PacketPtr pkt)
     PacketList writebacks;
     bool satisfied = access(pkt, blk, lat, writebacks);
 
+    const bool train_prefetcher = prefetcher && prefetchTrainAtomic;
+    if (satisfied && train_prefetcher) {
+        // as in timingAccess(), before the packet turns into a response
+        ppHit->notify(pkt);
+    }
+
     if (pkt->isClean() && blk && blk->isSet(CacheBlk::DirtyBit)) {
         // A cache clean opearation is looking for a dirty
         // block. If a dirty block is encountered a WriteClean
@@ -1045,18 +1052,19 @@ BaseCache::recvAtomic(PacketPtr pkt)
 
     if (!satisfied) {
         lat += handleAtomicReqMiss(pkt, blk, writebacks);
+        if (train_prefetcher) {
+            ppMiss->notify(pkt);
+        }
     }
 
-    // Note that we don't invoke the prefetcher at all in atomic mode.
+    // Note that we don't issue prefetches at all in atomic mode.
     // It's not clear how to do it properly, particularly for
     // prefetchers that aggressively generate prefetch candidates and
     // rely on bandwidth contention to throttle them; these will tend
     // to pollute the cache in atomic mode since there is no bandwidth
-    // contention.  If we ever do want to enable prefetching in atomic
-    // mode, though, this is the place to do it... see timingAccess()
-    // for an example (though we'd want to issue the prefetch(es)
-    // immediately rather than calling requestMemSideBus() as we do
-    // there).
+    // contention. With prefetch_train_atomic the prefetcher still sees
+    // the accesses and trains its tables, which is what a functional
+    // warmup wants, but whatever it would prefetch is dropped.
 
     // do any writebacks resulting from the response handling
     doWritebacksAtomic(writebacks);
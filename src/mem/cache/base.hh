@@ -1584,6 +1584,9 @@ class BaseCache : public ClockedObject, CacheAccessor
 
     const bool forceHit;
 
+    /** Whether atomic accesses train the prefetcher */
+    const bool prefetchTrainAtomic;
+
 public:
     // CacheAccessor overrided function
 
@@ -0,0 +1,204 @@
+#ifndef __MEM_CACHE_PREFETCH_DEFERRED_PACKET_QUEUE_HH__
+#define __MEM_CACHE_PREFETCH_DEFERRED_PACKET_QUEUE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <set>
+#include <unordered_map>
+
+#include "base/compiler.hh"
+#include "base/types.hh"
+
+namespace gem5
+{
+
+GEM5_DEPRECATED_NAMESPACE(Prefetcher, prefetch);
+namespace prefetch
+{
+
+/**
+ * A queue of deferred packets, highest priority first and oldest first
+ * within a priority. The packets are indexed by address, which finds a
+ * duplicate without walking the queue, and ordered in a balanced tree,
+ * so raising a priority or dropping the lowest packet takes logarithmic
+ * time. A queued packet never moves in memory, so a translation in
+ * flight can keep pointing at it.
+ *
+ * @tparam Packet The queued packet, Queued::DeferredPacket in the
+ *         prefetchers. It has a priority, a queueSeq owned by the queue
+ *         and a pfInfo giving its address and security.
+ */
+template <class Packet>
+class DeferredPacketQueue
+{
+  private:
+    using Storage = std::list<Packet>;
+
+    struct Key
+    {
+        int32_t priority;
+        uint64_t seq;
+        typename Storage::iterator entry;
+
+        bool
+        operator<(const Key &other) const
+        {
+            return priority != other.priority ?
+                priority > other.priority : seq < other.seq;
+        }
+    };
+    using Order = std::set<Key>;
+
+  public:
+    class iterator
+    {
+      public:
+        explicit iterator(typename Order::const_iterator _it) : it(_it) {}
+
+        Packet &operator*() const { return *it->entry; }
+        Packet *operator->() const { return &*it->entry; }
+        iterator &operator++() { ++it; return *this; }
+
+        bool operator==(const iterator &other) const
+        {
+            return it == other.it;
+        }
+        bool operator!=(const iterator &other) const
+        {
+            return it != other.it;
+        }
+
+      private:
+        friend class DeferredPacketQueue;
+        typename Order::const_iterator it;
+    };
+
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+    iterator begin() const { return iterator(order.begin()); }
+    iterator end() const { return iterator(order.end()); }
+    Packet &front() const { return *order.begin()->entry; }
+
+    /** Queue a copy of dpp behind the packets of its priority */
+    Packet &
+    push(const Packet &dpp)
+    {
+        auto entry = entries.insert(entries.end(), dpp);
+        entry->queueSeq = nextSeq++;
+        order.insert(Key{entry->priority, entry->queueSeq, entry});
+        byAddr.emplace(entry->pfInfo.getAddr(), entry);
+        return *entry;
+    }
+
+    /** The first queued packet for the address, or nullptr */
+    Packet *
+    find(Addr addr, bool is_secure) const
+    {
+        Packet *first = nullptr;
+        auto range = byAddr.equal_range(addr);
+        for (auto it = range.first; it != range.second; it++) {
+            Packet &dp = *it->second;
+            if (dp.pfInfo.isSecure() != is_secure) {
+                continue;
+            }
+            // the same address may be queued more than once
+            if (!first || Key{dp.priority, dp.queueSeq, {}} <
+                          Key{first->priority, first->queueSeq, {}}) {
+                first = &dp;
+            }
+        }
+        return first;
+    }
+
+    /** Whether the packet is in this queue */
+    bool
+    contains(const Packet *dp) const
+    {
+        auto it = orderOf(*dp);
+        return it != order.end() && &*it->entry == dp;
+    }
+
+    /**
+     * Change the priority of a queued packet, it goes behind the packets
+     * already queued with that priority
+     */
+    void
+    setPriority(Packet &dp, int32_t priority)
+    {
+        auto it = orderOf(dp);
+        assert(it != order.end() && &*it->entry == &dp);
+        typename Storage::iterator entry = it->entry;
+        order.erase(it);
+        dp.priority = priority;
+        dp.queueSeq = nextSeq++;
+        order.insert(Key{dp.priority, dp.queueSeq, entry});
+    }
+
+    /** The first queued of the packets with the lowest priority */
+    iterator
+    lowest() const
+    {
+        assert(!order.empty());
+        auto last = std::prev(order.end());
+        return iterator(order.lower_bound(Key{last->priority, 0, {}}));
+    }
+
+    iterator
+    erase(iterator it)
+    {
+        auto next = std::next(it.it);
+        entries.erase(unlink(it.it));
+        return iterator(next);
+    }
+
+    void
+    erase(Packet &dp)
+    {
+        auto it = orderOf(dp);
+        assert(it != order.end() && &*it->entry == &dp);
+        erase(iterator(it));
+    }
+
+    /** Move a packet to the back of a list, where it stays in place */
+    void
+    spliceTo(iterator it, std::list<Packet> &list)
+    {
+        list.splice(list.end(), entries, unlink(it.it));
+    }
+
+  private:
+    Storage entries;
+    Order order;
+    std::unordered_multimap<Addr, typename Storage::iterator> byAddr;
+    uint64_t nextSeq = 0;
+
+    typename Order::const_iterator
+    orderOf(const Packet &dp) const
+    {
+        return order.find(Key{dp.priority, dp.queueSeq, {}});
+    }
+
+    /** Drop a packet from the order and the index, not the storage */
+    typename Storage::iterator
+    unlink(typename Order::const_iterator it)
+    {
+        typename Storage::iterator entry = it->entry;
+        auto range = byAddr.equal_range(entry->pfInfo.getAddr());
+        for (auto addr_it = range.first; addr_it != range.second;
+             addr_it++) {
+            if (addr_it->second == entry) {
+                byAddr.erase(addr_it);
+                break;
+            }
+        }
+        order.erase(it);
+        return entry;
+    }
+};
+
+} // namespace prefetch
+} // namespace gem5
+
+#endif // __MEM_CACHE_PREFETCH_DEFERRED_PACKET_QUEUE_HH__
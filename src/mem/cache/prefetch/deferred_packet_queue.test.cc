@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <random>
+#include <vector>
+
+#include "mem/cache/prefetch/deferred_packet_queue.hh"
+
+using namespace gem5;
+using namespace gem5::prefetch;
+
+namespace
+{
+
+/** The address of a prefetch, as PrefetchInfo gives it */
+struct TestInfo
+{
+    Addr addr;
+    bool secure;
+
+    Addr getAddr() const { return addr; }
+    bool isSecure() const { return secure; }
+};
+
+/** The fields of a DeferredPacket the queue looks at */
+struct TestPacket
+{
+    int id;
+    int32_t priority;
+    TestInfo pfInfo;
+    uint64_t queueSeq = 0;
+
+    bool
+    operator>(const TestPacket &that) const
+    {
+        return priority > that.priority;
+    }
+};
+
+using TestQueue = DeferredPacketQueue<TestPacket>;
+
+/**
+ * The prefetch queue as it was before it was indexed: a list sorted by
+ * priority and walked for every lookup.
+ */
+class ListQueue
+{
+  public:
+    /** Insert behind the packets of the same or a higher priority */
+    void
+    push(const TestPacket &dpp)
+    {
+        auto it = queue.end();
+        while (it != queue.begin() && std::prev(it)->priority <
+                                      dpp.priority) {
+            --it;
+        }
+        queue.insert(it, dpp);
+    }
+
+    /** The first packet to the address */
+    TestPacket *
+    find(Addr addr, bool is_secure)
+    {
+        for (auto &dp : queue) {
+            if (dp.pfInfo.getAddr() == addr &&
+                dp.pfInfo.isSecure() == is_secure) {
+                return &dp;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Raise a priority and sort again, as alreadyInQueue did */
+    void
+    setPriority(TestPacket &dp, int32_t priority)
+    {
+        dp.priority = priority;
+        queue.sort(std::greater<TestPacket>());
+    }
+
+    /** The oldest packet of the lowest priority, walking from the back */
+    std::list<TestPacket>::iterator
+    lowest()
+    {
+        auto it = std::prev(queue.end());
+        while (it != queue.begin() &&
+               std::prev(it)->priority == it->priority) {
+            --it;
+        }
+        return it;
+    }
+
+    std::list<TestPacket> queue;
+};
+
+std::vector<int>
+ids(const TestQueue &queue)
+{
+    std::vector<int> result;
+    for (auto it = queue.begin(); it != queue.end(); ++it) {
+        result.push_back(it->id);
+    }
+    return result;
+}
+
+std::vector<int>
+ids(const ListQueue &queue)
+{
+    std::vector<int> result;
+    for (const auto &dp : queue.queue) {
+        result.push_back(dp.id);
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+/** Higher priorities come first, arrivals in order within a priority */
+TEST(DeferredPacketQueueTest, InsertionOrder)
+{
+    TestQueue queue;
+    queue.push({0, 1, {0x1000, false}});
+    queue.push({1, 3, {0x2000, false}});
+    queue.push({2, 1, {0x3000, false}});
+    queue.push({3, 2, {0x4000, false}});
+    queue.push({4, 3, {0x5000, false}});
+    ASSERT_EQ(ids(queue), (std::vector<int>{1, 4, 3, 0, 2}));
+    ASSERT_EQ(queue.front().id, 1);
+    ASSERT_EQ(queue.lowest()->id, 0);
+
+    queue.erase(queue.lowest());
+    ASSERT_EQ(queue.lowest()->id, 2);
+    ASSERT_EQ(queue.size(), 4);
+}
+
+/**
+ * A duplicate is the first queued packet to the same address and
+ * security, and a raised priority moves that packet itself behind the
+ * ones already queued with the new priority.
+ */
+TEST(DeferredPacketQueueTest, DuplicateAndPriority)
+{
+    TestQueue queue;
+    TestPacket &a = queue.push({0, 2, {0x1000, false}});
+    queue.push({1, 1, {0x2000, false}});
+    TestPacket &c = queue.push({2, 1, {0x1000, true}});
+    queue.push({3, 0, {0x1000, false}});
+
+    ASSERT_EQ(queue.find(0x1000, false), &a);
+    ASSERT_EQ(queue.find(0x1000, true), &c);
+    ASSERT_EQ(queue.find(0x3000, false), nullptr);
+
+    // the match is the last packet of the queue
+    TestPacket *last = queue.find(0x1000, true);
+    ASSERT_EQ(last->id, 2);
+    queue.setPriority(*last, 2);
+    ASSERT_EQ(ids(queue), (std::vector<int>{0, 2, 1, 3}));
+    ASSERT_EQ(queue.find(0x1000, true), &c);
+    ASSERT_TRUE(queue.contains(&c));
+
+    queue.erase(a);
+    ASSERT_EQ(queue.find(0x1000, false)->id, 3);
+
+    std::list<TestPacket> squashed;
+    queue.spliceTo(queue.lowest(), squashed);
+    ASSERT_EQ(squashed.back().id, 3);
+    ASSERT_FALSE(queue.contains(&squashed.back()));
+    ASSERT_EQ(queue.find(0x1000, false), nullptr);
+    ASSERT_EQ(ids(queue), (std::vector<int>{2, 1}));
+}
+
+/**
+ * Queue prefetches at random the way Queued::insert does, dropping
+ * duplicates after raising their priority and the lowest packet when
+ * full, and check the order and every duplicate found against the
+ * sorted list.
+ */
+TEST(DeferredPacketQueueTest, RandomAgainstList)
+{
+    const size_t queue_size = 16;
+    std::mt19937_64 rng(0xd3f3);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    TestQueue queue;
+    ListQueue list;
+    int next_id = 0;
+
+    for (int step = 0; step < 100000; step++) {
+        const Addr addr = 0x80000000 + rand(24) * 0x40;
+        const bool secure = rand(8) == 0;
+        const int32_t priority = rand(4);
+        switch (rand(4)) {
+          case 0:
+          case 1:
+            {
+                TestPacket *dp = queue.find(addr, secure);
+                TestPacket *lp = list.find(addr, secure);
+                ASSERT_EQ(dp ? dp->id : -1, lp ? lp->id : -1)
+                    << "step " << step;
+                if (dp) {
+                    if (dp->priority < priority) {
+                        queue.setPriority(*dp, priority);
+                        list.setPriority(*lp, priority);
+                    }
+                    break;
+                }
+                if (queue.size() == queue_size) {
+                    ASSERT_EQ(queue.lowest()->id, list.lowest()->id);
+                    queue.erase(queue.lowest());
+                    list.queue.erase(list.lowest());
+                }
+                TestPacket dpp{next_id++, priority, {addr, secure}};
+                queue.push(dpp);
+                list.push(dpp);
+            }
+            break;
+          case 2:
+            // the head is issued
+            if (!queue.empty()) {
+                queue.erase(queue.begin());
+                list.queue.pop_front();
+            }
+            break;
+          default:
+            // a demand access squashes a queued prefetch
+            if (TestPacket *dp = queue.find(addr, secure)) {
+                list.queue.remove_if([dp](const TestPacket &lp) {
+                    return lp.id == dp->id;
+                });
+                queue.erase(*dp);
+            }
+        }
+        ASSERT_EQ(ids(queue), ids(list)) << "step " << step;
+    }
+}
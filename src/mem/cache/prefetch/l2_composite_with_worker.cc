@@ -37,7 +37,7 @@ L2CompositeWithWorkerPrefetcher::prefetchUnused(Addr paddr, PrefetchSourceType p
 }
 
 void
-L2CompositeWithWorkerPrefetcher::addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp)
+L2CompositeWithWorkerPrefetcher::addToQueue(DeferredQueue &queue, DeferredPacket &dpp)
 {
     if (&queue == &pfq) {
         // Check whether the cdp prefetch request needs to be filtered out
@@ -28,7 +28,7 @@ class L2CompositeWithWorkerPrefetcher : public CompositeWithWorkerPrefetcher
 
     void prefetchUnused(Addr paddr, PrefetchSourceType pfSource) override;
 
-    void addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp) override;
+    void addToQueue(DeferredQueue &queue, DeferredPacket &dpp) override;
 
     void addHintDownStream(Base *down_stream) override
     {
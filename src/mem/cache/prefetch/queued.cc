@@ -48,6 +48,7 @@
 #include "mem/cache/base.hh"
 #include "mem/request.hh"
 #include "params/QueuedPrefetcher.hh"
+#include "sim/system.hh"
 
 namespace gem5
 {
@@ -138,7 +139,7 @@ Queued::~Queued()
 }
 
 void
-Queued::printQueue(const std::list<DeferredPacket> &queue) const
+Queued::printQueue(const DeferredQueue &queue) const
 {
     int pos = 0;
     std::string queue_name = "";
@@ -149,8 +150,7 @@ Queued::printQueue(const std::list<DeferredPacket> &queue) const
         queue_name = "PFTransQ";
     }
 
-    for (const_iterator it = queue.cbegin(); it != queue.cend();
-                                                            it++, pos++) {
+    for (auto it = queue.begin(); it != queue.end(); ++it, pos++) {
         Addr vaddr = it->pfInfo.getAddr();
         /* Set paddr to 0 if not yet translated */
         Addr paddr = it->pkt ? it->pkt->getAddr() : 0;
@@ -209,22 +209,16 @@ Queued::notify(const PacketPtr &pkt, const PrefetchInfo &pfi)
 
     // Squash queued prefetches if demand miss to same line
     if (queueSquash) {
-        auto itr = pfq.begin();
-        while (itr != pfq.end()) {
-            if (itr->pfInfo.getAddr() == blk_addr &&
-                itr->pfInfo.isSecure() == is_secure) {
-                DPRINTF(HWPrefetch, "Removing pf candidate addr: %#x "
-                        "(cl: %#x), demand request going to the same addr\n",
-                        itr->pfInfo.getAddr(),
-                        blockAddress(itr->pfInfo.getAddr()));
-                late_in_pfq = true;  // hit in pf queue
-                late_pfq_src = itr->pfInfo.getXsMetadata().prefetchSource;
-                delete itr->pkt;
-                itr = pfq.erase(itr);
-                statsQueued.pfRemovedDemand++;
-            } else {
-                ++itr;
-            }
+        while (DeferredPacket *dp = pfq.find(blk_addr, is_secure)) {
+            DPRINTF(HWPrefetch, "Removing pf candidate addr: %#x "
+                    "(cl: %#x), demand request going to the same addr\n",
+                    dp->pfInfo.getAddr(),
+                    blockAddress(dp->pfInfo.getAddr()));
+            late_in_pfq = true;  // hit in pf queue
+            late_pfq_src = dp->pfInfo.getXsMetadata().prefetchSource;
+            delete dp->pkt;
+            pfq.erase(*dp);
+            statsQueued.pfRemovedDemand++;
         }
     }
 
@@ -301,7 +295,7 @@ Queued::getPacket()
     if (pfq.front().pfahead) {
         prefetchStats.pfaheadProcess++;
     }
-    pfq.pop_front();
+    pfq.erase(pfq.begin());
 
     prefetchStats.pfIssued++;
     prefetchStats.pfIssued_srcs[pkt->req->getXsMetadata().prefetchSource]++;
@@ -337,12 +331,12 @@ void
 Queued::processMissingTranslations(unsigned max)
 {
     unsigned count = 0;
-    iterator it = pfqMissingTranslation.begin();
+    auto it = pfqMissingTranslation.begin();
     while (it != pfqMissingTranslation.end() && count < max) {
         DeferredPacket &dp = *it;
         // Increase the iterator first because dp.startTranslation can end up
         // calling finishTranslation, which will erase "it"
-        it++;
+        ++it;
         dp.startTranslation(tlb);
         count += 1;
     }
@@ -351,118 +345,74 @@ Queued::processMissingTranslations(unsigned max)
 void
 Queued::translationComplete(DeferredPacket *dp, bool failed)
 {
-    bool in_squash = false;
-    auto it = pfqMissingTranslation.begin();
-    while (it != pfqMissingTranslation.end()) {
-        if (&(*it) == dp) {
-            break;
-        }
-        it++;
-    }
     // If the dp is not in pfqMissingTranslation,
     // we will find it in pfqSquashed
-    if (it == pfqMissingTranslation.end()){
-        in_squash = true;
-        it = pfqSquashed.begin();
-        while (it != pfqSquashed.end()) {
-            if (&(*it) == dp) {
-                break;
-            }
+    if (!pfqMissingTranslation.contains(dp)) {
+        auto it = pfqSquashed.begin();
+        while (it != pfqSquashed.end() && &(*it) != dp) {
             it++;
         }
         assert(it != pfqSquashed.end());
+        pfqSquashed.erase(it);
+        return;
     }
-    if (!in_squash){
-        if (!failed) {
-            DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
-                    "paddr %#x \n", tlb->name(),
-                    it->translationRequest->getVaddr(),
-                    it->translationRequest->getPaddr());
-            Addr target_paddr = it->translationRequest->getPaddr();
-            // check if this prefetch is already redundant
-            if (cacheSnoop && (inCache(target_paddr, it->pfInfo.isSecure()) ||
-                        inMissQueue(target_paddr, it->pfInfo.isSecure()))) {
-                statsQueued.pfInCache++;
-                DPRINTF(HWPrefetch, "Dropping redundant in "
-                        "cache/MSHR prefetch addr:%#x\n", target_paddr);
-            } else if (!system->isMemAddr(target_paddr)) {
-                DPRINTF(HWPrefetch, "wrong paddr of prefetch:%#x\n", target_paddr);
-
-            } else {
-                Tick pf_time = curTick() + clockPeriod() * latency;
-                it->createPkt(target_paddr, blkSize, requestorId, tagPrefetch,
-                            pf_time, it->translationRequest->getPFSource(), it->translationRequest->getPFDepth());
-                addToQueue(pfq, *it);
-            }
+
+    if (!failed) {
+        DPRINTF(HWPrefetch, "%s Translation of vaddr %#x succeeded: "
+                "paddr %#x \n", tlb->name(),
+                dp->translationRequest->getVaddr(),
+                dp->translationRequest->getPaddr());
+        Addr target_paddr = dp->translationRequest->getPaddr();
+        // check if this prefetch is already redundant
+        if (cacheSnoop && (inCache(target_paddr, dp->pfInfo.isSecure()) ||
+                    inMissQueue(target_paddr, dp->pfInfo.isSecure()))) {
+            statsQueued.pfInCache++;
+            DPRINTF(HWPrefetch, "Dropping redundant in "
+                    "cache/MSHR prefetch addr:%#x\n", target_paddr);
+        } else if (!system->isMemAddr(target_paddr)) {
+            DPRINTF(HWPrefetch, "wrong paddr of prefetch:%#x\n", target_paddr);
+
         } else {
-            DPRINTF(HWPrefetch, "%s Translation of vaddr %#x failed, dropping "
-                    "prefetch request %#x \n", tlb->name(),
-                    it->translationRequest->getVaddr());
+            Tick pf_time = curTick() + clockPeriod() * latency;
+            dp->createPkt(target_paddr, blkSize, requestorId, tagPrefetch,
+                        pf_time, dp->translationRequest->getPFSource(), dp->translationRequest->getPFDepth());
+            addToQueue(pfq, *dp);
         }
-        pfqMissingTranslation.erase(it);
     } else {
-        pfqSquashed.erase(it);
+        DPRINTF(HWPrefetch, "%s Translation of vaddr %#x failed, dropping "
+                "prefetch request %#x \n", tlb->name(),
+                dp->translationRequest->getVaddr());
     }
+    pfqMissingTranslation.erase(*dp);
 }
 
 bool
-Queued::alreadyInQueue(std::list<DeferredPacket> &queue,
-                                 const PrefetchInfo &pfi, int32_t priority)
+Queued::alreadyInQueue(DeferredQueue &queue,
+                       const PrefetchInfo &pfi, int32_t priority)
 {
-    bool found = false;
-    iterator it;
-    for (it = queue.begin(); it != queue.end() && !found; it++) {
-        found = it->pfInfo.sameAddr(pfi);
-    }
-
-    /* If the address is already in the queue, update priority and leave */
-    if (it != queue.end()) {
-        statsQueued.pfBufferHit++;
-        if (it->priority < priority) {
-            /* Update priority value and position in the queue */
-            it->priority = priority;
-            /* Because swap() will cause the translationComplete
-             * run into wrong DeferredPacket, we use std::list::sort
-             * to update this queue */
-            queue.sort(std::greater<DeferredPacket>());
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue, priority updated\n");
-        } else {
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue\n");
-        }
-    }
-    return found;
+    return alreadyInQueue(queue, pfi.getAddr(), pfi.isSecure(), priority);
 }
-bool
 
-Queued::alreadyInQueue(std::list<DeferredPacket> &queue,
-                                 Addr addr, bool isSecure, int32_t priority)
+bool
+Queued::alreadyInQueue(DeferredQueue &queue,
+                       Addr addr, bool isSecure, int32_t priority)
 {
-    bool found = false;
-    iterator it;
-    for (it = queue.begin(); it != queue.end() && !found; it++) {
-        found = it->pfInfo.sameAddr(addr, isSecure);
+    DeferredPacket *dp = queue.find(addr, isSecure);
+    if (!dp) {
+        return false;
     }
 
-    /* If the address is already in the queue, update priority and leave */
-    if (it != queue.end()) {
-        statsQueued.pfBufferHit++;
-        if (it->priority < priority) {
-            /* Update priority value and position in the queue */
-            it->priority = priority;
-            /* Because swap() will cause the translationComplete
-             * run into wrong DeferredPacket, we use std::list::sort
-             * to update this queue */
-            queue.sort(std::greater<DeferredPacket>());
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue, priority updated\n");
-        } else {
-            DPRINTF(HWPrefetch, "Prefetch addr already in "
-                "prefetch queue\n");
-        }
+    /* The address is already in the queue, update priority and leave */
+    statsQueued.pfBufferHit++;
+    if (dp->priority < priority) {
+        queue.setPriority(*dp, priority);
+        DPRINTF(HWPrefetch, "Prefetch addr already in "
+            "prefetch queue, priority updated\n");
+    } else {
+        DPRINTF(HWPrefetch, "Prefetch addr already in "
+            "prefetch queue\n");
     }
-    return found;
+    return true;
 }
 
 
@@ -485,6 +435,14 @@ Queued::createPrefetchRequest(Addr addr, PrefetchInfo const &pfi, PacketPtr pkt,
 void
 Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi, const AddrPriority &addr_prio)
 {
+    // a cache trained in atomic mode (functional warmup) has no time to
+    // issue prefetches in, nor may it translate them
+    if (!system->isTimingMode()) {
+        DPRINTF(HWPrefetch, "Dropping pf candidate %#x in atomic mode\n",
+                new_pfi.getAddr());
+        return;
+    }
+
     int32_t priority = addr_prio.priority;
     if (queueFilter) {
         if (alreadyInQueue(pfq, new_pfi, priority)) {
@@ -592,8 +550,7 @@ Queued::insert(const PacketPtr &pkt, PrefetchInfo &new_pfi, const AddrPriority &
 }
 
 void
-Queued::addToQueue(std::list<DeferredPacket> &queue,
-                             DeferredPacket &dpp)
+Queued::addToQueue(DeferredQueue &queue, DeferredPacket &dpp)
 {
     /* Verify prefetch buffer space for request */
     unsigned queue_size;
@@ -625,25 +582,9 @@ Queued::addToQueue(std::list<DeferredPacket> &queue,
     }
     if (queue.size() == queue_size) {
         statsQueued.pfRemovedFull++;
-        /* Lowest priority packet */
-        iterator it = queue.end();
-        panic_if (it == queue.begin(),
-            "Prefetch queue is both full and empty!");
-        --it;
-        /* Look for oldest in that level of priority */
-        panic_if (it == queue.begin(),
-            "Prefetch queue is full with 1 element!");
-        iterator prev = it;
-        bool cont = true;
-        /* While not at the head of the queue */
-        while (cont && prev != queue.begin()) {
-            prev--;
-            /* While at the same level of priority */
-            cont = prev->priority == it->priority;
-            if (cont)
-                /* update pointer */
-                it = prev;
-        }
+        panic_if(queue.empty(), "Prefetch queue is both full and empty!");
+        /* Lowest priority packet, the oldest in that level of priority */
+        auto it = queue.lowest();
         DPRINTF(HWPrefetch, "%s full (sz=%lu), removing lowest priority oldest packet, addr: %#x\n", queue_name,
                 queue.size(), it->pfInfo.getAddr());
         if (&queue == &pfq || !it->ongoingTranslation){
@@ -656,34 +597,15 @@ Queued::addToQueue(std::list<DeferredPacket> &queue,
              * the pfqSquashed list and wait for
              * translationComplete to erase it */
             assert(&queue == &pfqMissingTranslation);
-            DeferredPacket * old_ptr = &(*it);
-            pfqSquashed.splice(pfqSquashed.end(),queue,it);
-            it = pfqSquashed.end();
-            it--;
-            assert(&(*it) == old_ptr);
+            queue.spliceTo(it, pfqSquashed);
             DPRINTF(HWPrefetch, "After moving pkt from transMissQueue to squashQueue, squashQueue sz=%lu\n",
                     pfqSquashed.size());
         }
     }
 
-    if ((queue.size() == 0) || (dpp <= queue.back())) {
-        queue.emplace_back(dpp);
-        if (&queue == &pfq && dpp.pfahead) {
-            DPRINTF(HWPrefetchOther, "insert one pfahead request host by self\n");
-        }
-    } else {
-        iterator it = queue.end();
-        do {
-            --it;
-        } while (it != queue.begin() && dpp > *it);
-        /* If we reach the head, we have to see if the new element is new head
-         * or not */
-        if (it == queue.begin() && dpp <= *it)
-            it++;
-        queue.insert(it, dpp);
-        if (&queue == &pfq && dpp.pfahead) {
-            DPRINTF(HWPrefetchOther, "insert one pfahead request host by self\n");
-        }
+    queue.push(dpp);
+    if (&queue == &pfq && dpp.pfahead) {
+        DPRINTF(HWPrefetchOther, "insert one pfahead request host by self\n");
     }
 
     if (debug::HWPrefetchQueue)
@@ -712,7 +634,7 @@ Queued::offloadToDownStream()
             hintDownStream->rxHint(&(*dpp_it));
             dpp_it = pfq.erase(dpp_it);
         } else {
-            dpp_it++;
+            ++dpp_it;
         }
     }
     DPRINTF(HWPrefetch, "Prefetch requests left in pfq: %lu, trans pfq: %lu\n", pfq.size(),
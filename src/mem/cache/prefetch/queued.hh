@@ -46,6 +46,7 @@
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/prefetch/base.hh"
+#include "mem/cache/prefetch/deferred_packet_queue.hh"
 #include "mem/packet.hh"
 
 namespace gem5
@@ -105,6 +106,8 @@ class Queued : public Base
         RequestPtr translationRequest;
         ThreadContext *tc;
         bool ongoingTranslation;
+        /** Order of this packet among those of its priority in a queue */
+        uint64_t queueSeq = 0;
 
         /**
          * Constructor
@@ -120,19 +123,6 @@ class Queued : public Base
             ongoingTranslation(false) {
         }
 
-        bool operator>(const DeferredPacket& that) const
-        {
-            return priority > that.priority;
-        }
-        bool operator<(const DeferredPacket& that) const
-        {
-            return priority < that.priority;
-        }
-        bool operator<=(const DeferredPacket& that) const
-        {
-            return !(*this > that);
-        }
-
         /**
          * Create the associated memory packet
          * @param paddr physical address of this packet
@@ -170,12 +160,12 @@ class Queued : public Base
         void startTranslation(BaseTLB *tlb);
     };
 
-    std::list<DeferredPacket> pfq;
-    std::list<DeferredPacket> pfqMissingTranslation;
-    std::list<DeferredPacket> pfqSquashed;
+    using DeferredQueue = DeferredPacketQueue<DeferredPacket>;
 
-    using const_iterator = std::list<DeferredPacket>::const_iterator;
-    using iterator = std::list<DeferredPacket>::iterator;
+    DeferredQueue pfq;
+    DeferredQueue pfqMissingTranslation;
+    /** Dropped packets waiting for their translation to finish */
+    std::list<DeferredPacket> pfqSquashed;
 
     // PARAMETERS
 
@@ -243,7 +233,7 @@ class Queued : public Base
         return pfq.empty() ? MaxTick : pfq.front().tick;
     }
 
-    void printQueue(const std::list<DeferredPacket> &queue) const;
+    void printQueue(const DeferredQueue &queue) const;
 
   protected:
 
@@ -252,7 +242,7 @@ class Queued : public Base
      * @param queue selected queue to use
      * @param dpp DeferredPacket to add
      */
-    virtual void addToQueue(std::list<DeferredPacket> &queue, DeferredPacket &dpp);
+    virtual void addToQueue(DeferredQueue &queue, DeferredPacket &dpp);
 
     /**
      * Starts the translations of the queued prefetches with a
@@ -280,10 +270,10 @@ class Queued : public Base
      * @param priority priority of the prefetch request to be added
      * @return True if the prefetch request was found in the queue
      */
-    bool alreadyInQueue(std::list<DeferredPacket> &queue,
+    bool alreadyInQueue(DeferredQueue &queue,
                         const PrefetchInfo &pfi, int32_t priority);
-    bool alreadyInQueue(std::list<DeferredPacket> &queue,
-                                    Addr addr, bool isSecure, int32_t priority);
+    bool alreadyInQueue(DeferredQueue &queue,
+                        Addr addr, bool isSecure, int32_t priority);
 
     /**
      * Returns the maxmimum number of prefetch requests that are allowed
@@ -45,10 +45,13 @@
 #ifndef __MEM_CACHE_QUEUE_HH__
 #define __MEM_CACHE_QUEUE_HH__
 
+#include <algorithm>
 #include <cassert>
 #include <string>
 #include <type_traits>
+#include <vector>
 
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/named.hh"
 #include "base/trace.hh"
@@ -101,6 +104,40 @@ class Queue : public Drainable, public Named
     /** Holds non allocated entries. */
     typename Entry::List freeList;
 
+    /**
+     * Allocated entries hashed by block address. A bucket keeps its
+     * entries in allocation order, which is the order of allocatedList,
+     * so matching an address only looks at the entries of its bucket.
+     */
+    std::vector<std::vector<Entry*>> addrIndex;
+
+    /** Number of bits of the hash used to pick a bucket */
+    const unsigned addrIndexBits;
+
+    size_t
+    addrBucket(Addr blk_addr) const
+    {
+        // Fibonacci hashing, the top bits depend on all address bits
+        return (blk_addr * 0x9e3779b97f4a7c15ULL) >> (64 - addrIndexBits);
+    }
+
+    /** Add a newly allocated entry to the address index */
+    void
+    indexEntry(Entry *entry)
+    {
+        addrIndex[addrBucket(entry->blkAddr)].push_back(entry);
+    }
+
+    /** Remove an entry from the address index, keeping the order */
+    void
+    unindexEntry(Entry *entry)
+    {
+        auto &bucket = addrIndex[addrBucket(entry->blkAddr)];
+        auto it = std::find(bucket.begin(), bucket.end(), entry);
+        assert(it != bucket.end());
+        bucket.erase(it);
+    }
+
     typename Entry::Iterator addToReadyList(Entry* entry)
     {
         if (readyList.empty() ||
@@ -135,8 +172,10 @@ class Queue : public Drainable, public Named
         Named(name),
         label(_label), numEntries(num_entries + reserve),
         numReserve(reserve), entries(numEntries, name + ".entry"),
+        addrIndexBits(std::max(ceilLog2(2 * numEntries), 1)),
         _numInService(0), allocated(0)
     {
+        addrIndex.resize(1ULL << addrIndexBits);
         for (int i = 0; i < numEntries; ++i) {
             freeList.push_back(&entries[i]);
         }
@@ -168,7 +207,7 @@ class Queue : public Drainable, public Named
     Entry* findMatch(Addr blk_addr, bool is_secure,
                      bool ignore_uncacheable = true) const
     {
-        for (const auto& entry : allocatedList) {
+        for (const auto& entry : addrIndex[addrBucket(blk_addr)]) {
             // we ignore any entries allocated for uncacheable
             // accesses and simply ignore them when matching, in the
             // cache we never check for matches when adding new
@@ -206,12 +245,19 @@ class Queue : public Drainable, public Named
      */
     Entry* findPending(const QueueEntry* entry) const
     {
-        for (const auto& ready_entry : readyList) {
-            if (ready_entry->conflictAddr(entry)) {
-                return ready_entry;
+        // The ready entries are the allocated ones not in service
+        Entry* pending = nullptr;
+        for (const auto& candidate :
+                 addrIndex[addrBucket(entry->blkAddr)]) {
+            if (!candidate->inService && candidate->conflictAddr(entry)) {
+                if (pending) {
+                    // Only the ready list knows which is the earliest
+                    return findPendingInReadyList(entry);
+                }
+                pending = candidate;
             }
         }
-        return nullptr;
+        return pending;
     }
 
     /**
@@ -241,6 +287,7 @@ class Queue : public Drainable, public Named
     deallocate(Entry *entry)
     {
         allocatedList.erase(entry->allocIter);
+        unindexEntry(entry);
         freeList.push_front(entry);
         allocated--;
         if (entry->inService) {
@@ -262,6 +309,17 @@ class Queue : public Drainable, public Named
     {
         return allocated == 0 ? DrainState::Drained : DrainState::Draining;
     }
+
+  private:
+    Entry* findPendingInReadyList(const QueueEntry* entry) const
+    {
+        for (const auto& ready_entry : readyList) {
+            if (ready_entry->conflictAddr(entry)) {
+                return ready_entry;
+            }
+        }
+        return nullptr;
+    }
 };
 
 } // namespace gem5
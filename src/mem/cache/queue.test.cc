@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include <list>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/cache/queue.hh"
+#include "mem/cache/queue_entry.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** A queue entry that only has an address and a ready time */
+class TestEntry : public QueueEntry
+{
+  public:
+    typedef std::list<TestEntry *> List;
+    typedef List::iterator Iterator;
+
+    Iterator readyIter;
+    Iterator allocIter;
+
+    TestEntry(const std::string &name) : QueueEntry(name) {}
+
+    void
+    allocate(Addr blk_addr, bool is_secure, bool uncacheable,
+             Tick ready_time)
+    {
+        blkAddr = blk_addr;
+        isSecure = is_secure;
+        _isUncacheable = uncacheable;
+        readyTime = ready_time;
+        inService = false;
+    }
+
+    void deallocate() {}
+
+    bool
+    matchBlockAddr(const Addr addr, const bool is_secure) const override
+    {
+        return (blkAddr == addr) && (isSecure == is_secure);
+    }
+
+    bool matchBlockAddr(const PacketPtr pkt) const override { return false; }
+
+    bool
+    conflictAddr(const QueueEntry *entry) const override
+    {
+        return entry->matchBlockAddr(blkAddr, isSecure);
+    }
+
+    bool sendPacket(BaseCache &cache) override { return false; }
+    Target *getTarget() override { return nullptr; }
+};
+
+/**
+ * A queue that allocates and services entries as the MSHR queue does,
+ * and finds them with the scans the address index replaced.
+ */
+class TestQueue : public Queue<TestEntry>
+{
+  public:
+    TestQueue(int num_entries)
+        : Queue<TestEntry>("test", num_entries, 0, "queue")
+    {}
+
+    TestEntry *
+    allocate(Addr blk_addr, bool is_secure, bool uncacheable = false,
+             Tick ready_time = 0)
+    {
+        TestEntry *entry = freeList.front();
+        freeList.pop_front();
+        entry->allocate(blk_addr, is_secure, uncacheable, ready_time);
+        entry->allocIter = allocatedList.insert(allocatedList.end(), entry);
+        indexEntry(entry);
+        entry->readyIter = addToReadyList(entry);
+        allocated += 1;
+        return entry;
+    }
+
+    void
+    markInService(TestEntry *entry)
+    {
+        entry->inService = true;
+        readyList.erase(entry->readyIter);
+        _numInService += 1;
+    }
+
+    void
+    markPending(TestEntry *entry)
+    {
+        entry->inService = false;
+        --_numInService;
+        entry->readyIter = addToReadyList(entry);
+    }
+
+    TestEntry *
+    scanMatch(Addr blk_addr, bool is_secure, bool ignore_uncacheable) const
+    {
+        for (const auto &entry : allocatedList) {
+            if (!(ignore_uncacheable && entry->isUncacheable()) &&
+                entry->matchBlockAddr(blk_addr, is_secure)) {
+                return entry;
+            }
+        }
+        return nullptr;
+    }
+
+    TestEntry *
+    scanPending(const QueueEntry *entry) const
+    {
+        for (const auto &ready_entry : readyList) {
+            if (ready_entry->conflictAddr(entry)) {
+                return ready_entry;
+            }
+        }
+        return nullptr;
+    }
+
+    /** Block addresses that share the bucket of blk_addr */
+    std::vector<Addr>
+    sameBucket(Addr blk_addr, size_t count) const
+    {
+        std::vector<Addr> addrs;
+        for (Addr addr = blk_addr; addrs.size() < count; addr += 64) {
+            if (addrBucket(addr) == addrBucket(blk_addr)) {
+                addrs.push_back(addr);
+            }
+        }
+        return addrs;
+    }
+
+    const TestEntry::List &allocatedEntries() const { return allocatedList; }
+};
+
+} // anonymous namespace
+
+/**
+ * Entries of a bucket are told apart by address, security and
+ * cacheability, and the first one allocated wins.
+ */
+TEST(QueueTest, FindMatchInBucket)
+{
+    TestQueue queue(6);
+    auto addrs = queue.sameBucket(0x80000000, 3);
+
+    TestEntry *a = queue.allocate(addrs[0], false);
+    TestEntry *b = queue.allocate(addrs[1], false, true);
+    TestEntry *b_secure = queue.allocate(addrs[1], true);
+    TestEntry *c = queue.allocate(addrs[2], false);
+
+    ASSERT_EQ(queue.findMatch(addrs[0], false), a);
+    ASSERT_EQ(queue.findMatch(addrs[0], true), nullptr);
+    ASSERT_EQ(queue.findMatch(addrs[1], false), nullptr);
+    ASSERT_EQ(queue.findMatch(addrs[1], false, false), b);
+    ASSERT_EQ(queue.findMatch(addrs[1], true), b_secure);
+    ASSERT_EQ(queue.findMatch(addrs[2], false), c);
+
+    queue.deallocate(a);
+    ASSERT_EQ(queue.findMatch(addrs[0], false), nullptr);
+    TestEntry *a2 = queue.allocate(addrs[0], false);
+    TestEntry *a3 = queue.allocate(addrs[0], false);
+    ASSERT_NE(a2, a3);
+    ASSERT_EQ(queue.findMatch(addrs[0], false), a2);
+    queue.deallocate(a2);
+    ASSERT_EQ(queue.findMatch(addrs[0], false), a3);
+}
+
+/**
+ * With more than one ready entry for a block, the earliest ready one is
+ * pending, whatever the order they were allocated in.
+ */
+TEST(QueueTest, FindPendingReadyOrder)
+{
+    TestQueue queue(4);
+    const Addr blk_addr = 0x80000040;
+    TestEntry probe("probe");
+    probe.allocate(blk_addr, false, false, 0);
+
+    TestEntry *late = queue.allocate(blk_addr, false, false, 200);
+    queue.allocate(blk_addr, true, false, 50);
+    ASSERT_EQ(queue.findPending(&probe), late);
+
+    TestEntry *early = queue.allocate(blk_addr, false, false, 100);
+    ASSERT_EQ(queue.findPending(&probe), early);
+
+    queue.markInService(early);
+    ASSERT_EQ(queue.findPending(&probe), late);
+    queue.markInService(late);
+    ASSERT_EQ(queue.findPending(&probe), nullptr);
+
+    queue.markPending(early);
+    ASSERT_EQ(queue.findPending(&probe), early);
+}
+
+/**
+ * Allocate, service, retry and free entries at random over few blocks,
+ * most of them in one bucket, and check every lookup against the scans
+ * of the allocated and ready lists.
+ */
+TEST(QueueTest, RandomAgainstScan)
+{
+    const int num_entries = 8;
+    std::mt19937_64 rng(0x9e37);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    TestQueue queue(num_entries);
+    auto addrs = queue.sameBucket(0x80000000, 4);
+    addrs.push_back(0x80001000);
+    addrs.push_back(0x80002040);
+    TestEntry probe("probe");
+    Tick now = 0;
+
+    for (int step = 0; step < 100000; step++) {
+        const auto &allocated = queue.allocatedEntries();
+        auto random_entry = [&]() {
+            return *std::next(allocated.begin(), rand(allocated.size()));
+        };
+        switch (rand(5)) {
+          case 0:
+          case 1:
+            if (allocated.size() < size_t(num_entries)) {
+                queue.allocate(addrs[rand(addrs.size())], rand(4) == 0,
+                               rand(8) == 0, now + rand(100));
+            }
+            break;
+          case 2:
+            if (!allocated.empty()) {
+                TestEntry *entry = random_entry();
+                if (entry->inService) {
+                    queue.markPending(entry);
+                } else {
+                    queue.markInService(entry);
+                }
+            }
+            break;
+          case 3:
+            if (!allocated.empty()) {
+                queue.deallocate(random_entry());
+            }
+            break;
+          default:
+            {
+                const Addr addr = addrs[rand(addrs.size())];
+                const bool is_secure = rand(4) == 0;
+                const bool ignore = rand(2);
+                ASSERT_EQ(queue.findMatch(addr, is_secure, ignore),
+                          queue.scanMatch(addr, is_secure, ignore))
+                    << "step " << step;
+                probe.allocate(addr, is_secure, false, 0);
+                ASSERT_EQ(queue.findPending(&probe),
+                          queue.scanPending(&probe))
+                    << "step " << step;
+            }
+        }
+        now += rand(10);
+    }
+}
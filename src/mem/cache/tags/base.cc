@@ -47,9 +47,11 @@
 
 #include <cassert>
 
+#include "base/bitfield.hh"
 #include "base/types.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/indexing_policies/set_associative.hh"
 #include "mem/request.hh"
 #include "sim/core.hh"
 #include "sim/sim_exit.hh"
@@ -76,12 +78,52 @@ BaseTags::findBlockBySetAndWay(int set, int way) const
     return indexingPolicy->getEntry(set, way);
 }
 
+void
+BaseTags::initTagStore()
+{
+    // Skewed sets have no contiguous ways to match
+    setAssocIndexing = dynamic_cast<SetAssociative*>(indexingPolicy);
+    const unsigned assoc = indexingPolicy->getAssoc();
+    if (!setAssocIndexing || assoc > TagStore::MaxAssoc) {
+        setAssocIndexing = nullptr;
+        return;
+    }
+
+    const uint32_t num_sets = indexingPolicy->getNumSets();
+    tagStore.init(num_sets, assoc);
+    for (uint32_t set = 0; set < num_sets; set++) {
+        for (uint32_t way = 0; way < assoc; way++) {
+            auto entry = static_cast<TaggedEntry*>(
+                indexingPolicy->getEntry(set, way));
+            entry->bindTagKey(tagStore.slot(set, way));
+        }
+    }
+}
+
 CacheBlk*
 BaseTags::findBlock(Addr addr, bool is_secure) const
 {
     // Extract block tag
     Addr tag = extractTag(addr);
 
+    if (setAssocIndexing) {
+        const uint32_t set = setAssocIndexing->getSet(addr);
+        uint64_t ways = tagStore.match(set, TagStore::key(tag, is_secure));
+        while (ways) {
+            const uint32_t way = ctz64(ways);
+            ways &= ways - 1;
+            CacheBlk* blk = static_cast<CacheBlk*>(
+                indexingPolicy->getEntry(set, way));
+            if (blk->matchTag(tag, is_secure)) {
+                if ((blk->getWay() != way) && (blk->getWay() != DEFAULTWAYPRE))
+                    panic("Unexpected way %d\n", blk->getWay());
+                blk->setHitWay(way);
+                return blk;
+            }
+        }
+        return nullptr;
+    }
+
     // Find possible entries that may contain the given address
     const std::vector<ReplaceableEntry*> entries =
         indexingPolicy->getPossibleEntries(addr);
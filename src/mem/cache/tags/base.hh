@@ -56,6 +56,7 @@
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "mem/cache/cache_blk.hh"
+#include "mem/cache/tags/tag_store.hh"
 #include "mem/packet.hh"
 #include "params/BaseTags.hh"
 #include "sim/clocked_object.hh"
@@ -66,6 +67,7 @@ namespace gem5
 class System;
 class IndexingPolicy;
 class ReplaceableEntry;
+class SetAssociative;
 
 /**
  * A common base class of Cache tagstore objects.
@@ -102,6 +104,15 @@ class BaseTags : public ClockedObject
     /** The data blocks, 1 per cache block. */
     std::unique_ptr<uint8_t[]> dataBlks;
 
+    /**
+     * Keys of the entries of a set associative indexing policy, empty
+     * if the tags are indexed otherwise. @sa initTagStore()
+     */
+    TagStore tagStore;
+
+    /** The indexing policy, if it is set associative */
+    const SetAssociative *setAssocIndexing = nullptr;
+
     /**
      * TODO: It would be good if these stats were acquired after warmup.
      */
@@ -173,6 +184,17 @@ class BaseTags : public ClockedObject
      */
     virtual void tagsInit() = 0;
 
+  protected:
+    /**
+     * Mirror the tags of all entries of the indexing policy in the tag
+     * store, so that findBlock() can match a set from its keys. To be
+     * called by tagsInit() once all entries are set. The entries must
+     * be TaggedEntries.
+     */
+    void initTagStore();
+
+  public:
+
     /**
      * Average in the reference count for valid blocks when the simulation
      * exits.
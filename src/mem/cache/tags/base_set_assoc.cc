@@ -83,6 +83,8 @@ BaseSetAssoc::tagsInit()
         // Associate a replacement data entry to the block
         blk->replacementData = replacementPolicy->instantiateEntry();
     }
+
+    initTagStore();
 }
 
 void
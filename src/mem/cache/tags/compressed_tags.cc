@@ -99,6 +99,8 @@ CompressedTags::tagsInit()
         // Link block to indexing policy
         indexingPolicy->setEntry(superblock, superblock_index);
     }
+
+    initTagStore();
 }
 
 CacheBlk*
@@ -130,6 +130,12 @@ class BaseIndexingPolicy : public SimObject
      */
     ReplaceableEntry* getEntry(const uint32_t set, const uint32_t way) const;
 
+    /** The associativity. */
+    unsigned getAssoc() const { return assoc; }
+
+    /** The number of sets. */
+    uint32_t getNumSets() const { return numSets; }
+
     /**
      * Generate the tag from the given address.
      *
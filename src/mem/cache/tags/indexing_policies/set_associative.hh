@@ -106,6 +106,14 @@ class SetAssociative : public BaseIndexingPolicy
      */
     ~SetAssociative() {};
 
+    /**
+     * Get the set an address maps to.
+     *
+     * @param addr The address.
+     * @return The set index.
+     */
+    uint32_t getSet(const Addr addr) const { return extractSet(addr); }
+
     /**
      * Find all possible entries for insertion and replacement of an address.
      * Should be called immediately before ReplacementPolicy's findVictim()
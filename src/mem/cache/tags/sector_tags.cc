@@ -37,6 +37,7 @@
 #include <memory>
 #include <string>
 
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/types.hh"
@@ -44,6 +45,7 @@
 #include "mem/cache/replacement_policies/base.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
 #include "mem/cache/tags/indexing_policies/base.hh"
+#include "mem/cache/tags/indexing_policies/set_associative.hh"
 
 namespace gem5
 {
@@ -113,6 +115,9 @@ SectorTags::tagsInit()
         // Link block to indexing policy
         indexingPolicy->setEntry(sec_blk, sec_blk_index);
     }
+
+    // Sectors are matched by their tags, sub-blocks share them
+    initTagStore();
 }
 
 void
@@ -256,6 +261,22 @@ SectorTags::findBlock(Addr addr, bool is_secure) const
     // due to sectors being composed of contiguous-address entries
     const Addr offset = extractSectorOffset(addr);
 
+    if (setAssocIndexing) {
+        // A valid sub-block has the tag and secure bit of its sector
+        const uint32_t set = setAssocIndexing->getSet(addr);
+        uint64_t ways = tagStore.match(set, TagStore::key(tag, is_secure));
+        while (ways) {
+            const uint32_t way = ctz64(ways);
+            ways &= ways - 1;
+            auto blk = static_cast<SectorBlk*>(
+                indexingPolicy->getEntry(set, way))->blks[offset];
+            if (blk->matchTag(tag, is_secure)) {
+                return blk;
+            }
+        }
+        return nullptr;
+    }
+
     // Find all possible sector entries that may contain the given address
     const std::vector<ReplaceableEntry*> entries =
         indexingPolicy->getPossibleEntries(addr);
@@ -0,0 +1,72 @@
+#ifndef __MEM_CACHE_TAGS_TAG_STORE_HH__
+#define __MEM_CACHE_TAGS_TAG_STORE_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+/**
+ * A copy of the tag, secure and valid bits of the entries of a set
+ * associative tag array, kept as one key per entry with the ways of a
+ * set next to each other. Matching an address against a set then reads
+ * a line or two of keys instead of every entry of the set, and the
+ * compare loop has no branches, so the compiler can vectorize it where
+ * the host has the instructions for it.
+ *
+ * The entries write their own keys through TaggedEntry::bindTagKey(),
+ * so the keys always follow the entries. A match is only a hint: the
+ * caller still checks the entry, which keeps entries with virtual
+ * validity, as sectors, exact.
+ */
+class TagStore
+{
+  public:
+    /** Key of entries that are not valid, no tag has it */
+    static constexpr Addr InvalidKey = MaxAddr;
+
+    /** Widest set a match bitmap can hold */
+    static constexpr unsigned MaxAssoc = 64;
+
+    /** Key of a valid entry */
+    static Addr key(Addr tag, bool is_secure) { return tag << 1 | is_secure; }
+
+    /** Make room for num_sets sets of assoc ways, all invalid */
+    void
+    init(uint32_t num_sets, unsigned _assoc)
+    {
+        assoc = _assoc;
+        keys.assign(size_t(num_sets) * assoc, InvalidKey);
+    }
+
+    bool enabled() const { return !keys.empty(); }
+
+    Addr *
+    slot(uint32_t set, uint32_t way)
+    {
+        return &keys[size_t(set) * assoc + way];
+    }
+
+    /** Bitmap of the ways of a set whose key is key */
+    uint64_t
+    match(uint32_t set, Addr key) const
+    {
+        const Addr *set_keys = &keys[size_t(set) * assoc];
+        uint64_t ways = 0;
+        for (uint64_t way = 0; way < assoc; way++) {
+            ways |= uint64_t(set_keys[way] == key) << way;
+        }
+        return ways;
+    }
+
+  private:
+    unsigned assoc = 0;
+    std::vector<Addr> keys;
+};
+
+} // namespace gem5
+
+#endif // __MEM_CACHE_TAGS_TAG_STORE_HH__
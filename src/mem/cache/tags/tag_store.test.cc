@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "mem/cache/tags/tag_store.hh"
+#include "mem/cache/tags/tagged_entry.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** The ways of a set whose entry matches, the way findBlock() checks */
+uint64_t
+matchEntries(const std::vector<TaggedEntry> &entries, unsigned assoc,
+             uint32_t set, Addr tag, bool is_secure)
+{
+    uint64_t ways = 0;
+    for (unsigned way = 0; way < assoc; way++) {
+        if (entries[set * assoc + way].matchTag(tag, is_secure)) {
+            ways |= uint64_t(1) << way;
+        }
+    }
+    return ways;
+}
+
+} // anonymous namespace
+
+/** The keys follow inserts and invalidations of the entries */
+TEST(TagStoreTest, KeysFollowEntries)
+{
+    TagStore store;
+    ASSERT_FALSE(store.enabled());
+    store.init(2, 4);
+    ASSERT_TRUE(store.enabled());
+
+    std::vector<TaggedEntry> entries(8);
+    for (uint32_t i = 0; i < entries.size(); i++) {
+        entries[i].bindTagKey(store.slot(i / 4, i % 4));
+    }
+    ASSERT_EQ(store.match(0, TagStore::key(0x10, false)), 0);
+
+    entries[1].insert(0x10, false);
+    entries[3].insert(0x10, true);
+    entries[6].insert(0x10, false);
+    ASSERT_EQ(store.match(0, TagStore::key(0x10, false)), 0b0010);
+    ASSERT_EQ(store.match(0, TagStore::key(0x10, true)), 0b1000);
+    ASSERT_EQ(store.match(1, TagStore::key(0x10, false)), 0b0100);
+
+    entries[1].invalidate();
+    ASSERT_EQ(store.match(0, TagStore::key(0x10, false)), 0);
+    // an invalid entry matches nothing, whatever its tag was
+    ASSERT_EQ(store.match(0, TagStore::key(MaxAddr, false)), 0);
+    ASSERT_EQ(store.match(0, TagStore::InvalidKey), 0b0111);
+
+    // binding an entry takes its current state
+    TaggedEntry late;
+    late.insert(0x20, true);
+    late.bindTagKey(store.slot(1, 3));
+    ASSERT_EQ(store.match(1, TagStore::key(0x20, true)), 0b1000);
+}
+
+/**
+ * Insert and invalidate entries of sets of several widths at random,
+ * with few distinct tags so that sets often hold the same tag in both
+ * security spaces, and check every lookup against matchTag().
+ */
+TEST(TagStoreTest, RandomAgainstMatchTag)
+{
+    std::mt19937_64 rng(0x7a65);
+    auto rand = [&rng](uint64_t n) { return rng() % n; };
+
+    for (unsigned assoc : {1, 2, 4, 8, 12, 16, 64}) {
+        const uint32_t num_sets = 16;
+        TagStore store;
+        store.init(num_sets, assoc);
+        std::vector<TaggedEntry> entries(num_sets * assoc);
+        for (uint32_t i = 0; i < entries.size(); i++) {
+            entries[i].bindTagKey(store.slot(i / assoc, i % assoc));
+        }
+
+        // tags as caches make them, the address above the set bits
+        auto rand_tag = [&]() -> Addr {
+            return rand(4) ? rand(8) : rng() >> 8;
+        };
+
+        for (int step = 0; step < 20000; step++) {
+            uint32_t set = rand(num_sets);
+            TaggedEntry &entry = entries[set * assoc + rand(assoc)];
+            switch (rand(3)) {
+              case 0:
+                if (entry.isValid()) {
+                    entry.invalidate();
+                }
+                entry.insert(rand_tag(), rand(2));
+                break;
+              case 1:
+                if (entry.isValid()) {
+                    entry.invalidate();
+                }
+                break;
+              default:
+                {
+                    Addr tag = rand_tag();
+                    bool is_secure = rand(2);
+                    ASSERT_EQ(store.match(set, TagStore::key(tag, is_secure)),
+                              matchEntries(entries, assoc, set, tag,
+                                           is_secure))
+                        << "assoc " << assoc << " step " << step;
+                }
+            }
+        }
+    }
+}
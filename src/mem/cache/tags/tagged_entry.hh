@@ -34,6 +34,7 @@
 #include "base/cprintf.hh"
 #include "base/types.hh"
 #include "mem/cache/replacement_policies/replaceable_entry.hh"
+#include "mem/cache/tags/tag_store.hh"
 
 namespace gem5
 {
@@ -107,6 +108,19 @@ class TaggedEntry : public ReplaceableEntry
         clearSecure();
     }
 
+    /**
+     * Keep the key of this entry in a tag store slot up to date, from
+     * its current state on.
+     *
+     * @param slot The slot of this entry in the tag store.
+     */
+    void
+    bindTagKey(Addr *slot)
+    {
+        _tagKey = slot;
+        updateTagKey();
+    }
+
     std::string
     print() const override
     {
@@ -120,10 +134,20 @@ class TaggedEntry : public ReplaceableEntry
      *
      * @param tag The tag value.
      */
-    virtual void setTag(Addr tag) { _tag = tag; }
+    virtual void
+    setTag(Addr tag)
+    {
+        _tag = tag;
+        updateTagKey();
+    }
 
     /** Set secure bit. */
-    virtual void setSecure() { _secure = true; }
+    virtual void
+    setSecure()
+    {
+        _secure = true;
+        updateTagKey();
+    }
 
     /** Set valid bit. The block must be invalid beforehand. */
     virtual void
@@ -131,6 +155,7 @@ class TaggedEntry : public ReplaceableEntry
     {
         assert(!isValid());
         _valid = true;
+        updateTagKey();
     }
 
   private:
@@ -150,8 +175,25 @@ class TaggedEntry : public ReplaceableEntry
     /** The entry's tag. */
     Addr _tag;
 
+    /** Slot of this entry in a tag store, if any. @sa bindTagKey() */
+    Addr *_tagKey = nullptr;
+
     /** Clear secure bit. Should be only used by the invalidation function. */
-    void clearSecure() { _secure = false; }
+    void
+    clearSecure()
+    {
+        _secure = false;
+        updateTagKey();
+    }
+
+    void
+    updateTagKey()
+    {
+        if (_tagKey) {
+            *_tagKey = _valid ? TagStore::key(_tag, _secure) :
+                TagStore::InvalidKey;
+        }
+    }
 };
 
 } // namespace gem5
@@ -45,11 +45,15 @@
 #include <zlib.h>
 #include <zstd.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 
 #include "base/intmath.hh"
 #include "base/logging.hh"
@@ -94,13 +98,17 @@ PhysicalMemory::PhysicalMemory(const std::string& _name,
                                bool auto_unlink_shared_backstore,
                                unsigned gcpt_restorer_size_limit,
                                mem_util::DedupMemory *dedup_mem_manager,
-                               bool enable_mem_dedup) :
+                               bool enable_mem_dedup,
+                               unsigned gcpt_restore_threads,
+                               bool gcpt_lazy_restore) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
     sharedBackstore(shared_backstore), sharedBackstoreSize(0),
     pageSize(sysconf(_SC_PAGE_SIZE)),
     restoreFromXiangshanCpt(restore_from_gcpt),
     gCptRestorerPath(gcpt_restorer_path),
     xsCptPath(gcpt_path), mapToRawCpt(map_to_raw_cpt), gcptRestorerSizeLimit(gcpt_restorer_size_limit),
+    gcptRestoreThreads(gcpt_restore_threads),
+    gcptLazyRestore(gcpt_lazy_restore && !enable_mem_dedup),
     enableDedup(enable_mem_dedup),
     dedupMemManager(dedup_mem_manager)
 {
@@ -112,6 +120,10 @@ PhysicalMemory::PhysicalMemory(const std::string& _name,
     if (mmap_using_noreserve)
         warn("Not reserving swap space. May cause SIGSEGV on actual usage\n");
 
+    if (gcpt_lazy_restore && enable_mem_dedup)
+        warn("Lazy checkpoint restore does not work with memory dedup, "
+             "restoring eagerly\n");
+
     // add the memories from the system to the address map as
     // appropriate
     for (const auto& m : _memories) {
@@ -403,6 +415,10 @@ PhysicalMemory::serialize(CheckpointOut &cp) const
     SERIALIZE_CONTAINER(lal_addr);
     SERIALIZE_CONTAINER(lal_cid);
 
+    // a lazily restored image has to be complete before it is saved
+    if (lazyRestorer)
+        lazyRestorer->populateAll();
+
     // serialize the backing stores
     unsigned int nbr_of_stores = backingStore.size();
     SERIALIZE_SCALAR(nbr_of_stores);
@@ -527,6 +543,52 @@ hasZSTDMagic(int fd)
     return memcmp(buf, zstd_magic, 4) == 0;
 }
 
+/** Granularity of the zero detection when restoring compressed images. */
+static constexpr size_t restoreBlockSize = 4096;
+
+/**
+ * Check whether a block is all zero. The OR reduction over whole words
+ * has no data dependent branch, so the compiler turns it into vector code.
+ */
+static bool
+isZeroBlock(const uint8_t *buf, size_t len)
+{
+    uint64_t acc = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf + i, sizeof(word));
+        acc |= word;
+    }
+    for (; i < len; i++)
+        acc |= buf[i];
+    return acc == 0;
+}
+
+/**
+ * Copy decompressed data into the backing store, leaving untouched the
+ * blocks that are zero in both the image and the backing store so that
+ * the host does not have to commit pages for them.
+ *
+ * @return The number of bytes that were written
+ */
+static uint64_t
+restoreNonZero(uint8_t *dst, const uint8_t *src, size_t len)
+{
+    uint64_t written = 0;
+    for (size_t off = 0; off < len; off += restoreBlockSize) {
+        size_t blk = std::min(restoreBlockSize, len - off);
+        if (!isZeroBlock(src + off, blk)) {
+            memcpy(dst + off, src + off, blk);
+            written += blk;
+        } else if (!isZeroBlock(dst + off, blk)) {
+            memset(dst + off, 0, blk);
+            written += blk;
+        }
+    }
+    return written;
+}
+
 void
 PhysicalMemory::unserializeStoreFrom(std::string filepath,
         unsigned store_id, long range_size)
@@ -665,31 +727,22 @@ PhysicalMemory::unserializeFromGz(std::string filepath, unsigned store_id, long
     }
 
     uint64_t curr_size = 0;
-    const uint32_t chunk_size = 16384;
-    long* temp_page = new long[chunk_size];
-    assert(temp_page);
-    long* pmem_current;
-    uint32_t bytes_read;
+    const uint32_t chunk_size = 1 << 20;
+    std::vector<uint8_t> temp_buf(chunk_size);
+    int bytes_read;
     while (curr_size < range.size()) {
-        bytes_read = gzread(compressed_mem, temp_page, chunk_size);
-        if (bytes_read == 0)
+        uint32_t to_read = std::min<uint64_t>(chunk_size,
+                                              range.size() - curr_size);
+        bytes_read = gzread(compressed_mem, temp_buf.data(), to_read);
+        if (bytes_read <= 0)
             break;
 
-        assert(bytes_read % sizeof(long) == 0);
-
-        for (uint32_t x = 0; x < bytes_read / sizeof(long); x++) {
-            // Only copy bytes that are non-zero, so we don't give
-            // the VM system hell
-            if (*(temp_page + x) != 0) {
-                pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
-                *pmem_current = *(temp_page + x);
-            }
-        }
+        // Only copy blocks that are non-zero, so we don't give
+        // the VM system hell
+        restoreNonZero(pmem + curr_size, temp_buf.data(), bytes_read);
         curr_size += bytes_read;
     }
 
-    delete[] temp_page;
-
     if (gzclose(compressed_mem))
         fatal("Close failed on physical memory checkpoint file '%s'\n",
               filepath.c_str());
@@ -725,6 +778,11 @@ PhysicalMemory::overrideGCptRestorer(unsigned store_id)
             restorer_size = gcptRestorerSizeLimit;
         }
 
+        // the restorer overrides the head of the image, which therefore
+        // has to be in place before
+        if (lazyRestorer)
+            lazyRestorer->populate(pmem, restorer_size);
+
         fseek(fp, 0, SEEK_SET);
         file_len = fread(pmem, 1, restorer_size, fp);
         if (file_len > 0) {
@@ -746,66 +804,110 @@ PhysicalMemory::unserializeFromZstd(std::string filepath, unsigned store_id, lon
     }
 
     auto file_size = lseek(fd, 0, SEEK_END);
-    if (file_size == 0) {
+    if (file_size <= 0) {
         fatal("File size is zero\n");
     }
-    lseek(fd, 0, SEEK_SET);
 
-    auto compress_file_buffer = malloc(file_size);
-    if (!compress_file_buffer) {
-        close(fd);
-        fatal("Compress file buffer create failed\n");
+    // map the compressed file instead of reading it into a private
+    // buffer, the page cache is shared by all the restoring threads
+    auto compress_file_buffer = (uint8_t *)mmap(NULL, file_size, PROT_READ,
+                                                MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (compress_file_buffer == MAP_FAILED) {
+        fatal("Compress file %s mmap failed\n", filepath.c_str());
+    }
+    madvise(compress_file_buffer, file_size, MADV_SEQUENTIAL);
+    warn("Read zstd file size %lu\n", file_size);
+
+    // walk the frame headers, a checkpoint made of several frames with
+    // known content sizes can be restored in parallel or lazily
+    std::vector<ZstdFrame> frames;
+    bool sizes_known = true;
+    uint64_t total_size = 0;
+    size_t frame_start = 0;
+    while (frame_start < (size_t)file_size) {
+        size_t frame_size = ZSTD_findFrameCompressedSize(
+            compress_file_buffer + frame_start, file_size - frame_start);
+        if (ZSTD_isError(frame_size)) {
+            munmap(compress_file_buffer, file_size);
+            fatal("Malformed zstd frame at offset %lu: %s\n", frame_start,
+                  ZSTD_getErrorName(frame_size));
+        }
+        unsigned long long content_size = ZSTD_getFrameContentSize(
+            compress_file_buffer + frame_start, frame_size);
+        if (content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+            content_size == ZSTD_CONTENTSIZE_ERROR) {
+            sizes_known = false;
+            content_size = 0;
+        }
+        frames.push_back({frame_start, frame_size, total_size, content_size});
+        total_size += content_size;
+        frame_start += frame_size;
     }
 
-    // read compressed file
-    ssize_t compressed_file_buffer_size = read(fd, compress_file_buffer, file_size);
-    warn("Read zstd file size %lu\n", compressed_file_buffer_size);
-    if (compressed_file_buffer_size != file_size) {
-        free(compress_file_buffer);
-        close(fd);
-        fatal("Compress file read failed\n");
+    if (frames.size() > 1 && !sizes_known) {
+        warn("zstd checkpoint has frames without content size, "
+             "restoring it serially\n");
+    } else if (frames.size() > 1) {
+        fatal_if(total_size > range.size(),
+                 "Decompress failed: Binary size %lu is larger than "
+                 "memory!\n", total_size);
+
+        if (gcptLazyRestore) {
+            inform("Restoring %lu zstd frames on first touch\n",
+                   frames.size());
+            madvise(compress_file_buffer, file_size, MADV_RANDOM);
+            lazyRestorer = std::make_unique<LazyCptRestorer>(
+                compress_file_buffer, file_size, std::move(frames), pmem,
+                range.size());
+            // only the memories backed by this store
+            for (const auto& m : memories) {
+                if (m->getAddrRange().isSubset(range))
+                    m->setLazyRestorer(lazyRestorer.get());
+            }
+            return;
+        }
+
+        unserializeZstdFrames(compress_file_buffer, frames, pmem);
+        munmap(compress_file_buffer, file_size);
+        return;
+    } else if (gcptLazyRestore) {
+        warn("Lazy restore needs a multi-frame zstd checkpoint, "
+             "restoring it eagerly\n");
     }
-    close(fd);
 
     // create decompress input buffer
-    ZSTD_inBuffer input = {compress_file_buffer, (size_t)compressed_file_buffer_size, 0};
+    ZSTD_inBuffer input = {compress_file_buffer, (size_t)file_size, 0};
 
     // alloc decompress buffer
-    const uint32_t decompress_file_buffer_size = 16384;
-    uint64_t* decompress_file_buffer = (uint64_t*)calloc(decompress_file_buffer_size, sizeof(long));
-    if (!decompress_file_buffer) {
-        free(compress_file_buffer);
-        fatal("Decompress file creating failed\n");
-    }
-
+    const size_t decompress_file_buffer_size = ZSTD_DStreamOutSize() * 8;
+    std::vector<uint8_t> decompress_file_buffer(decompress_file_buffer_size);
 
     // create and init decompress stream object
     ZSTD_DStream* dstream = ZSTD_createDStream();
     if (!dstream) {
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
+        munmap(compress_file_buffer, file_size);
         fatal("Cannot create zstd dstream object\n");
     }
 
     size_t init_result = ZSTD_initDStream(dstream);
     if (ZSTD_isError(init_result)) {
         ZSTD_freeDStream(dstream);
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
+        munmap(compress_file_buffer, file_size);
         fatal("Cannot init dstream object: %s\n", ZSTD_getErrorName(init_result));
     }
 
     // decompress and write in memory
-    uint64_t* pmem_current;
     uint64_t total_write_size = 0;
-    uint64_t non_zero_dword = 0;
+    uint64_t non_zero_bytes = 0;
     while (total_write_size < range.size()) {
-        ZSTD_outBuffer output = {decompress_file_buffer, decompress_file_buffer_size * sizeof(long), 0};
+        ZSTD_outBuffer output = {decompress_file_buffer.data(),
+            std::min<uint64_t>(decompress_file_buffer_size,
+                               range.size() - total_write_size), 0};
         size_t result = ZSTD_decompressStream(dstream, &output, &input);
         if (ZSTD_isError(result)) {
             ZSTD_freeDStream(dstream);
-            free(compress_file_buffer);
-            free(decompress_file_buffer);
+            munmap(compress_file_buffer, file_size);
             fatal("Decompress failed: %s\n", ZSTD_getErrorName(result));
         }
 
@@ -813,30 +915,152 @@ PhysicalMemory::unserializeFromZstd(std::string filepath, unsigned store_id, lon
             break;
         }
 
-        for (uint64_t x = 0; x < output.pos; x += sizeof(long)) {
-            pmem_current = (uint64_t*)(pmem + total_write_size + x);
-            uint64_t read_data = *(decompress_file_buffer + x / sizeof(long));
-            if (read_data != 0 || *pmem_current != 0) {
-                *pmem_current = read_data;
-                non_zero_dword++;
-            }
-        }
+        non_zero_bytes += restoreNonZero(pmem + total_write_size,
+                                         decompress_file_buffer.data(),
+                                         output.pos);
         total_write_size += output.pos;
     }
-    warn("Total write non-zero bytes: %lu\n", non_zero_dword * 8);
+    warn("Total write non-zero bytes: %lu\n", non_zero_bytes);
 
-    ZSTD_outBuffer output = {decompress_file_buffer, decompress_file_buffer_size * sizeof(long), 0};
+    ZSTD_outBuffer output = {decompress_file_buffer.data(),
+                             decompress_file_buffer_size, 0};
     size_t result = ZSTD_decompressStream(dstream, &output, &input);
+    ZSTD_freeDStream(dstream);
+    munmap(compress_file_buffer, file_size);
     if (ZSTD_isError(result) || output.pos != 0) {
-        ZSTD_freeDStream(dstream);
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
         fatal("Decompress failed: %s. Binary size is larger than memory!\n", ZSTD_getErrorName(result));
     }
+}
 
-    ZSTD_freeDStream(dstream);
-    free(compress_file_buffer);
-    free(decompress_file_buffer);
+void
+PhysicalMemory::unserializeZstdFrames(const uint8_t *src,
+        const std::vector<ZstdFrame> &frames, uint8_t *pmem)
+{
+    uint64_t max_frame = 0;
+    for (const auto &frame : frames)
+        max_frame = std::max(max_frame, frame.dstSize);
+
+    unsigned num_threads = gcptRestoreThreads;
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    num_threads = std::min<unsigned>(num_threads, frames.size());
+
+    inform("Restoring %lu zstd frames with %u threads\n", frames.size(),
+           num_threads);
+
+    std::atomic<size_t> next_frame{0};
+    std::atomic<uint64_t> non_zero_bytes{0};
+    std::atomic<bool> failed{false};
+
+    auto worker = [&]() {
+        ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        if (!dctx) {
+            failed = true;
+            return;
+        }
+        // Decompressing straight into pmem would fault in every zero
+        // page of the frame; go through a scratch buffer instead.
+        std::vector<uint8_t> buf(max_frame);
+        uint64_t written = 0;
+        for (size_t i = next_frame++; i < frames.size() && !failed;
+             i = next_frame++) {
+            const auto &frame = frames[i];
+            size_t out_size = ZSTD_decompressDCtx(dctx, buf.data(),
+                    buf.size(), src + frame.srcOffset, frame.srcSize);
+            if (ZSTD_isError(out_size)) {
+                warn("Decompress frame %lu failed: %s\n", i,
+                     ZSTD_getErrorName(out_size));
+                failed = true;
+                break;
+            }
+            written += restoreNonZero(pmem + frame.dstOffset, buf.data(),
+                                      out_size);
+        }
+        non_zero_bytes += written;
+        ZSTD_freeDCtx(dctx);
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < num_threads; t++)
+        workers.emplace_back(worker);
+    worker();
+    for (auto &t : workers)
+        t.join();
+
+    fatal_if(failed, "Parallel zstd checkpoint restore failed\n");
+    warn("Total write non-zero bytes: %lu\n", non_zero_bytes.load());
+}
+
+LazyCptRestorer::LazyCptRestorer(uint8_t *image, size_t image_size,
+                                 std::vector<ZstdFrame> frames,
+                                 uint8_t *pmem, uint64_t pmem_size)
+    : image(image), imageSize(image_size), frames(std::move(frames)),
+      populated(this->frames.size(), false),
+      pending(this->frames.size()), pmem(pmem), pmemSize(pmem_size)
+{
+    uint64_t max_frame = 0;
+    for (const auto &frame : this->frames)
+        max_frame = std::max(max_frame, frame.dstSize);
+    buffer.resize(max_frame);
+}
+
+LazyCptRestorer::~LazyCptRestorer()
+{
+    munmap(image, imageSize);
+}
+
+void
+LazyCptRestorer::populateRange(uint64_t offset, uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // find the last frame that starts at or before the offset
+    auto it = std::upper_bound(frames.begin(), frames.end(), offset,
+        [](uint64_t off, const ZstdFrame &f) { return off < f.dstOffset; });
+    if (it == frames.begin())
+        return;
+    size_t idx = std::distance(frames.begin(), it) - 1;
+
+    for (; idx < frames.size() && frames[idx].dstOffset < offset + size;
+         idx++) {
+        if (!populated[idx])
+            populateFrame(idx);
+    }
+}
+
+void
+LazyCptRestorer::populateAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t idx = 0; idx < frames.size(); idx++) {
+        if (!populated[idx])
+            populateFrame(idx);
+    }
+}
+
+void
+LazyCptRestorer::populateFrame(size_t idx)
+{
+    const auto &frame = frames[idx];
+    size_t out_size = ZSTD_decompress(buffer.data(), buffer.size(),
+                                      image + frame.srcOffset,
+                                      frame.srcSize);
+    fatal_if(ZSTD_isError(out_size), "Decompress frame %lu failed: %s\n",
+             idx, ZSTD_getErrorName(out_size));
+
+    restoreNonZero(pmem + frame.dstOffset, buffer.data(), out_size);
+    populated[idx] = true;
+    size_t left = pending.fetch_sub(1, std::memory_order_release) - 1;
+
+    DPRINTF(Checkpoint, "Materialized checkpoint frame %lu at %#lx, "
+            "%lu frames left\n", idx, frame.dstOffset, left);
+}
+
+void
+PhysicalMemory::materializeAll()
+{
+    if (lazyRestorer)
+        lazyRestorer->populateAll();
 }
 
 bool
@@ -38,7 +38,10 @@
 #ifndef __MEM_PHYSICAL_HH__
 #define __MEM_PHYSICAL_HH__
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -123,6 +126,88 @@ class BackingStoreEntry
      bool isDedupManaged;
 };
 
+/**
+ * One independently decompressible frame of a zstd checkpoint image.
+ */
+struct ZstdFrame
+{
+    /** Offset and size of the frame in the compressed image. */
+    size_t srcOffset;
+    size_t srcSize;
+
+    /** Offset and size of the decompressed data in the backing store. */
+    uint64_t dstOffset;
+    uint64_t dstSize;
+};
+
+/**
+ * Materializes a multi-frame zstd checkpoint lazily. The backing store
+ * starts out empty and a frame is decompressed into it the first time
+ * any byte it covers is accessed, so a simulation only pays for the
+ * part of the guest memory it touches.
+ */
+class LazyCptRestorer
+{
+  public:
+    /**
+     * @param image The mapped compressed image, owned by the restorer
+     * @param image_size Size of the mapping
+     * @param frames The frame table of the image, ordered by offset
+     * @param pmem The backing store to populate
+     * @param pmem_size Size of the backing store
+     */
+    LazyCptRestorer(uint8_t *image, size_t image_size,
+                    std::vector<ZstdFrame> frames, uint8_t *pmem,
+                    uint64_t pmem_size);
+
+    ~LazyCptRestorer();
+
+    /**
+     * Make sure a region of the backing store holds checkpoint data.
+     *
+     * @param host_addr Host address of the region in the backing store
+     * @param size Size of the region
+     */
+    void
+    populate(const uint8_t *host_addr, uint64_t size)
+    {
+        if (pending.load(std::memory_order_acquire) && host_addr >= pmem &&
+                host_addr < pmem + pmemSize) {
+            populateRange(host_addr - pmem, size);
+        }
+    }
+
+    /** Decompress every frame that has not been touched yet. */
+    void populateAll();
+
+    /** Whether the whole checkpoint has been materialized. */
+    bool
+    done() const
+    {
+        return pending.load(std::memory_order_acquire) == 0;
+    }
+
+  private:
+    void populateRange(uint64_t offset, uint64_t size);
+
+    void populateFrame(size_t idx);
+
+    uint8_t *image;
+    size_t imageSize;
+    std::vector<ZstdFrame> frames;
+    std::vector<bool> populated;
+    /** Frames left, read without the mutex on every access. */
+    std::atomic<size_t> pending;
+    uint8_t *pmem;
+    uint64_t pmemSize;
+
+    /** Decompression scratch buffer, as large as the largest frame. */
+    std::vector<uint8_t> buffer;
+
+    /** Accesses may come from several event queue threads. */
+    std::mutex mutex;
+};
+
 /**
  * The physical memory encapsulates all memories in the system and
  * provides basic functionality for accessing those memories without
@@ -185,6 +270,15 @@ class PhysicalMemory : public Serializable
 
     unsigned gcptRestorerSizeLimit{false};
 
+    // Number of host threads used to restore multi-frame zstd checkpoints,
+    // 0 lets the host concurrency decide
+    unsigned gcptRestoreThreads;
+
+    // Decompress multi-frame zstd checkpoints on first touch
+    bool gcptLazyRestore;
+
+    std::unique_ptr<LazyCptRestorer> lazyRestorer;
+
     bool enableDedup;
 
     mem_util::DedupMemory *dedupMemManager;
@@ -207,6 +301,23 @@ class PhysicalMemory : public Serializable
 
     void unserializeFromZstd(std::string filepath, unsigned store_id, long range_size);
 
+    /**
+     * Restore a zstd checkpoint that consists of several independent
+     * frames, each of which records its decompressed size. Frames are
+     * decompressed by a pool of host threads. Each thread decompresses
+     * into a private scratch buffer as large as the largest frame and
+     * copies only the non-zero 4 KiB blocks into the backing store, so
+     * untouched guest pages are never faulted in. The scratch buffers
+     * cost up to the largest frame size times the number of threads,
+     * e.g. 64 MiB frames on 16 threads need 1 GiB.
+     *
+     * @param src The mapped compressed image
+     * @param frames The frame table of the image
+     * @param pmem The backing store to restore into
+     */
+    void unserializeZstdFrames(const uint8_t *src,
+            const std::vector<ZstdFrame> &frames, uint8_t *pmem);
+
     void overrideGCptRestorer(unsigned store_id);
 
   public:
@@ -225,7 +336,9 @@ class PhysicalMemory : public Serializable
                    bool auto_unlink_shared_backstore,
                    unsigned gcpt_restorer_size_limit,
                    mem_util::DedupMemory *dedup_mem_manager,
-                   bool enable_mem_dedup);
+                   bool enable_mem_dedup,
+                   unsigned gcpt_restore_threads=0,
+                   bool gcpt_lazy_restore=false);
 
     /**
      * Unmap all the backing store we have used.
@@ -342,6 +455,12 @@ class PhysicalMemory : public Serializable
      */
     bool tryRestoreFromXSCpt();
 
+    /**
+     * Finish a lazy checkpoint restore, for users that read the backing
+     * store without going through the memories, e.g. difftest.
+     */
+    void materializeAll();
+
 };
 
 } // namespace memory
@@ -84,7 +84,13 @@ MessageBuffer::MessageBuffer(const Params &p)
              "Average stall ticks per message"),
     ADD_STAT(m_occupancy, statistics::units::Rate<
                 statistics::units::Ratio, statistics::units::Tick>::get(),
-             "Average occupancy of buffer capacity")
+             "Average occupancy of buffer capacity"),
+    ADD_STAT(m_held_msgs, statistics::units::Count::get(),
+             "Number of messages from another event queue held to a "
+             "quantum after they were sent"),
+    ADD_STAT(m_held_ticks, statistics::units::Tick::get(),
+             "Total number of ticks messages from another event queue "
+             "were held")
 {
     m_msg_counter = 0;
     m_consumer = NULL;
@@ -102,6 +108,7 @@ MessageBuffer::MessageBuffer(const Params &p)
     m_stall_time = 0;
 
     m_dequeue_callback = nullptr;
+    m_dequeue_callback_queue = nullptr;
 
     // stats
     m_not_avail_count
@@ -125,6 +132,12 @@ MessageBuffer::MessageBuffer(const Params &p)
     m_stall_time
         .flags(statistics::nozero);
 
+    m_held_msgs
+        .flags(statistics::nozero);
+
+    m_held_ticks
+        .flags(statistics::nozero);
+
     if (m_max_size > 0) {
         m_occupancy = m_buf_msgs / m_max_size;
     } else {
@@ -154,6 +167,9 @@ MessageBuffer::areNSlotsAvailable(unsigned int n, Tick current_time)
         return true;
     }
 
+    // the counters below are updated by the consumer
+    EventQueue::ScopedMigration migrate(consumerQueue(), inParallelMode);
+
     // determine the correct size for the current cycle
     // pop operations shouldn't effect the network's visible size
     // until schd cycle, but enqueue operations effect the visible
@@ -219,6 +235,15 @@ void
 MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
                        bool bypassStrictFIFO)
 {
+    assert(m_consumer != NULL);
+
+    // With parallel event queues the producer may run on another queue
+    // than the consumer. Take the consumer's queue for the insertion and
+    // the wakeup, so curTick() below is the consumer's time.
+    const bool cross_queue =
+        inParallelMode && consumerQueue() != curEventQueue();
+    EventQueue::ScopedMigration migrate(consumerQueue(), inParallelMode);
+
     // record current time incase we have a pop that also adjusts my size
     if (m_time_last_time_enqueue < current_time) {
         m_msgs_this_cycle = 0;  // first msg this cycle
@@ -255,6 +280,18 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
 
     // Check the arrival time
     assert(arrival_time >= current_time);
+
+    // The clocks of two event queues drift apart by up to a quantum, so
+    // the consumer may already be past a message due sooner. Hold such a
+    // message to a quantum after it was sent. The consumer can't have
+    // got that far, and the arrival time only depends on the producer,
+    // not on how far the consumer's thread happens to be.
+    if (cross_queue && arrival_time < current_time + simQuantum) {
+        m_held_msgs++;
+        m_held_ticks += current_time + simQuantum - arrival_time;
+        arrival_time = current_time + simQuantum;
+    }
+    assert(arrival_time >= curTick());
     if (m_strict_fifo &&
         !(bypassStrictFIFO || m_last_message_strict_fifo_bypassed)) {
         if (arrival_time < m_last_arrival_time) {
@@ -296,7 +333,6 @@ MessageBuffer::enqueue(MsgPtr message, Tick current_time, Tick delta,
             arrival_time, *(message.get()));
 
     // Schedule the wakeup
-    assert(m_consumer != NULL);
     m_consumer->scheduleEventAbsolute(arrival_time);
     m_consumer->storeEventInfo(m_vnet_id);
 }
@@ -338,6 +374,8 @@ MessageBuffer::dequeue(Tick current_time, bool decrement_messages)
 
     // if a dequeue callback was requested, call it now
     if (m_dequeue_callback) {
+        EventQueue::ScopedMigration migrate(m_dequeue_callback_queue,
+                                            inParallelMode);
         m_dequeue_callback();
     }
 
@@ -348,12 +386,14 @@ void
 MessageBuffer::registerDequeueCallback(std::function<void()> callback)
 {
     m_dequeue_callback = callback;
+    m_dequeue_callback_queue = curEventQueue();
 }
 
 void
 MessageBuffer::unregisterDequeueCallback()
 {
     m_dequeue_callback = nullptr;
+    m_dequeue_callback_queue = nullptr;
 }
 
 void
@@ -63,6 +63,7 @@
 #include "mem/ruby/network/dummy_port.hh"
 #include "mem/ruby/slicc_interface/Message.hh"
 #include "params/MessageBuffer.hh"
+#include "sim/eventq.hh"
 #include "sim/sim_object.hh"
 
 namespace gem5
@@ -202,6 +203,17 @@ class MessageBuffer : public SimObject
   private:
     void reanalyzeList(std::list<MsgPtr> &, Tick);
 
+    /**
+     * The event queue the consumer runs on. The buffer state belongs to
+     * it, so a producer on another queue migrates there to touch it.
+     */
+    EventQueue *
+    consumerQueue() const
+    {
+        return m_consumer ? m_consumer->getObject()->eventQueue()
+                          : curEventQueue();
+    }
+
     uint32_t functionalAccess(Packet *pkt, bool is_read, WriteMask *mask);
 
   private:
@@ -211,6 +223,8 @@ class MessageBuffer : public SimObject
     std::vector<MsgPtr> m_prio_heap;
 
     std::function<void()> m_dequeue_callback;
+    //! Event queue of the object that registered the dequeue callback
+    EventQueue *m_dequeue_callback_queue;
 
     // use a std::map for the stalled messages as this container is
     // sorted and ensures a well-defined iteration order
@@ -298,6 +312,10 @@ class MessageBuffer : public SimObject
     statistics::Scalar m_stall_count;
     statistics::Formula m_avg_stall_time;
     statistics::Formula m_occupancy;
+    // Messages from another event queue due within a quantum, held to a
+    // quantum after they were sent, and by how much
+    statistics::Scalar m_held_msgs;
+    statistics::Scalar m_held_ticks;
 };
 
 Tick random_time();
@@ -155,7 +155,10 @@ RubyPort::PioResponsePort::PioResponsePort(const std::string &_name,
 RubyPort::MemRequestPort::MemRequestPort(const std::string &_name,
                            RubyPort *_port)
     : QueuedRequestPort(_name, _port, reqQueue, snoopRespQueue),
-      reqQueue(*_port, *this), snoopRespQueue(*_port, *this)
+      // pio requests go to devices, which share the Ruby system's event
+      // queue rather than the sequencer's when cores run in parallel
+      reqQueue(*_port->m_ruby_system, *this),
+      snoopRespQueue(*_port->m_ruby_system, *this)
 {
     DPRINTF(RubyPort, "Created request memport on ruby sequencer %s\n", _name);
 }
@@ -204,6 +207,7 @@ bool RubyPort::MemRequestPort::recvTimingResp(PacketPtr pkt)
 
     // attempt to send the response in the next cycle
     RubyPort *rp = static_cast<RubyPort *>(&owner);
+    EventQueue::ScopedMigration migrate(rp->eventQueue(), inParallelMode);
     port->schedTimingResp(pkt, curTick() + rp->m_ruby_system->clockPeriod());
 
     return true;
@@ -283,6 +287,8 @@ RubyPort::MemResponsePort::recvTimingReq(PacketPtr pkt)
 
             // send next cycle
             RubySystem *rs = ruby_port->m_ruby_system;
+            EventQueue::ScopedMigration migrate(rs->eventQueue(),
+                                                inParallelMode);
             ruby_port->memRequestPort.schedTimingReq(pkt,
                 curTick() + rs->clockPeriod());
             return true;
@@ -324,7 +324,8 @@ def switchCpus(system, cpuList, verbose=True):
         _changeMemoryMode(system, memory_mode)
 
     # we only support single CPU for now
-    if not params.isNullPointer(system.l2.prefetcher):
+    if hasattr(system, 'l2') and \
+            not params.isNullPointer(system.l2.prefetcher):
         print("Register new dtb to l2 pref")
         system.l2.prefetcher.getCCObject().addTLB(cpuList[0][1].mmu.dtb.getCCObject())
 
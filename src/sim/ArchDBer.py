@@ -37,6 +37,9 @@ from m5.params import *
 from m5.proxy import *
 from m5.SimObject import *
 
+class ArchDBFormat(Enum):
+    vals = ['sqlite', 'columnar']
+
 class ArchDBer(SimObject):
     type = 'ArchDBer'
     cxx_header = "sim/arch_db.hh"
@@ -47,6 +50,11 @@ class ArchDBer(SimObject):
     ]
 
     arch_db_file = Param.String("", "Where to save arch db")
+    format = Param.ArchDBFormat('sqlite', "On-disk format of the arch db, "
+        "columnar traces are read with util/arch_db/columnar_trace.py")
+    columnar_block_rows = Param.Unsigned(65536, "Rows per compressed block "
+        "of the columnar format")
+    columnar_zstd_level = Param.Int(3, "zstd level of the columnar format")
     dump_from_start = Param.Bool(True, "Dump arch db from start")
     enable_rolling = Param.Bool(False, "Dump rolling perfcnt")
 
@@ -61,3 +69,9 @@ class ArchDBer(SimObject):
     dump_sms_train_trace = Param.Bool(False, "Dump sms train trace")
     dump_l1d_way_pre_trace = Param.Bool(False, "Dump l1d way predction trace")
     dump_lifetime = Param.Bool(False, "Dump inst lifetime")
+
+    async_writer = Param.Bool(True, "Write records from a separate host "
+        "thread")
+    writer_batch_size = Param.Unsigned(8192, "Records per transaction")
+    writer_queue_size = Param.Unsigned(16384, "Records buffered between the "
+        "simulation and the writer thread")
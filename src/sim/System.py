@@ -135,6 +135,10 @@ class System(SimObject):
     map_to_raw_cpt = Param.Bool(False, "Map physical memory to raw cpt with mmap")
     gcpt_restorer_file = Param.String("", "GCPT restorer image file")
     gcpt_restorer_size_limit = Param.Unsigned(0x700, "Enable riscv vector extension")
+    gcpt_restore_threads = Param.Unsigned(0, "Host threads used to restore "
+        "multi-frame zstd checkpoints (0: use all host cores)")
+    gcpt_lazy_restore = Param.Bool(False, "Decompress the frames of a "
+        "multi-frame zstd checkpoint when they are first accessed")
 
     xiangshan_system = Param.Bool(False, "Simulate Xiangshan system")
     arch_db = Param.ArchDBer(NULL,"arch db for this system")
@@ -1,6 +1,7 @@
-
 #include "sim/arch_db.hh"
 
+#include <chrono>
+
 #include "params/ArchDBer.hh"
 
 namespace gem5{
@@ -18,32 +19,62 @@ ArchDBer::ArchDBer(const Params &p)
     dumpSMSTrainTrace(p.dump_sms_train_trace),
     dumpL1WayPreTrace(p.dump_l1d_way_pre_trace),
     dumpLifetime(p.dump_lifetime),
-    mem_db(nullptr), zErrMsg(nullptr),rc(0),
-    db_path(p.arch_db_file)
+    disk_db(nullptr),
+    db_path(p.arch_db_file),
+    asyncWriter(p.async_writer),
+    batchSize(std::max(1u, p.writer_batch_size)),
+    queue(p.writer_queue_size),
+    closed(false),
+    numStmts(0),
+    rowsInBatch(0),
+    memTraceStmt(-1),
+    l1PFTraceStmt(-1),
+    bopTrainTraceStmt(-1),
+    smsTrainTraceStmt(-1),
+    l1MissTraceStmt(-1),
+    wayPreTraceStmt(-1),
+    evictTraceStmt(-1)
 {
-  int rc = sqlite3_open(":memory:", &mem_db);
-  if (rc) {
-    sqlite3_close(mem_db);
-    fatal("Can't open database: %s\n", sqlite3_errmsg(mem_db));
-  }
-
   fatal_if(db_path == "" || db_path == "None",
             "Arch db file path is not given!");
 
+  if (p.format == enums::ArchDBFormat::columnar) {
+    columnar = std::make_unique<ColumnarTraceWriter>(
+        db_path, p.columnar_block_rows, p.columnar_zstd_level);
+  } else {
+    openSQLite();
+  }
+
+  if (asyncWriter) {
+    writer = std::thread([this]() { writerLoop(); });
+  }
+
   for (const auto &s : p.table_cmds) {
     create_table(s);
   }
   registerExitCallback([this](){ save_db(); });
 }
 
-static int callback(void *NotUsed, int argc, char **argv, char **azColName){
-  return 0;
+void
+ArchDBer::openSQLite()
+{
+  // records are streamed into the file, start from an empty one like
+  // the backup of the in-memory db used to
+  unlink(db_path.c_str());
+  int rc = sqlite3_open(db_path.c_str(), &disk_db);
+  if (rc) {
+    sqlite3_close(disk_db);
+    fatal("Can't open database %s: %s\n", db_path, sqlite3_errmsg(disk_db));
+  }
+  // the file is only useful once the run finished, so trade durability
+  // for speed
+  sqlite3_exec(disk_db, "PRAGMA journal_mode=OFF;", nullptr, 0, nullptr);
+  sqlite3_exec(disk_db, "PRAGMA synchronous=OFF;", nullptr, 0, nullptr);
 }
 
 void ArchDBer::create_table(const std::string &sql) {
   // create table
-  rc = sqlite3_exec(mem_db, sql.c_str(), callback, 0, &zErrMsg);
-  fatal_if(rc != SQLITE_OK, "SQL error: %s\n", zErrMsg);
+  execmd(sql);
   inform("Table created: %s\n", sql.c_str());
 }
 
@@ -52,34 +83,162 @@ void ArchDBer::start_recording() {
 }
 
 void ArchDBer::save_db() {
-  warn("saving memdb to %s ...\n", db_path.c_str());
-  sqlite3 *disk_db;
-  sqlite3_backup *pBackup;
-  int rc = sqlite3_open(db_path.c_str(), &disk_db);
-  if (rc == SQLITE_OK){
-    pBackup = sqlite3_backup_init(disk_db, "main", mem_db, "main");
-    if (pBackup){
-      (void)sqlite3_backup_step(pBackup, -1);
-      (void)sqlite3_backup_finish(pBackup);
-    }
-    rc = sqlite3_errcode(disk_db);
+  // a fatal error in the writer itself must not wait for the writer
+  if (closed || std::this_thread::get_id() == writer.get_id())
+    return;
+  closed = true;
+
+  warn("flushing arch db to %s ...\n", db_path.c_str());
+  DBCommand stop;
+  stop.kind = DBCommand::Stop;
+  push(std::move(stop));
+  if (writer.joinable())
+    writer.join();
+
+  if (columnar) {
+    columnar->close();
+    return;
+  }
+
+  for (auto stmt : stmts) {
+    sqlite3_finalize(stmt);
   }
+  stmts.clear();
   sqlite3_close(disk_db);
+  disk_db = nullptr;
 }
 
 void
-ArchDBer::execmd(std::string cmd)
+ArchDBer::push(DBCommand &&cmd)
+{
+  if (!asyncWriter) {
+    process(cmd);
+    return;
+  }
+  // the writer fell behind, wait for it rather than dropping records
+  while (!queue.tryPush(std::move(cmd))) {
+    std::this_thread::yield();
+  }
+}
+
+void
+ArchDBer::writerLoop()
 {
-  rc = sqlite3_exec(mem_db, cmd.c_str(), callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
+  DBCommand cmd;
+  while (true) {
+    if (!queue.tryPop(cmd)) {
+      // nothing to do, make what we have so far durable and back off
+      commitBatch();
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      continue;
+    }
+    if (cmd.kind == DBCommand::Stop) {
+      break;
+    }
+    process(cmd);
+  }
+  commitBatch();
+}
+
+void
+ArchDBer::process(DBCommand &cmd)
+{
+  if (columnar) {
+    switch (cmd.kind) {
+      case DBCommand::Exec:
+        // tables are described by the columns of their inserts
+        break;
+      case DBCommand::Prepare:
+        columnar->prepare(cmd.stmt, cmd.sql);
+        break;
+      case DBCommand::Insert:
+        columnar->insert(cmd);
+        break;
+      case DBCommand::Stop:
+        break;
+    }
+    return;
+  }
+
+  int rc;
+  switch (cmd.kind) {
+    case DBCommand::Exec:
+      rc = sqlite3_exec(disk_db, cmd.sql.c_str(), nullptr, 0, nullptr);
+      fatal_if(rc != SQLITE_OK, "SQL error: %s in %s\n",
+               sqlite3_errmsg(disk_db), cmd.sql);
+      break;
+    case DBCommand::Prepare:
+      if (stmts.size() <= (size_t)cmd.stmt) {
+        stmts.resize(cmd.stmt + 1, nullptr);
+      }
+      rc = sqlite3_prepare_v2(disk_db, cmd.sql.c_str(), -1,
+                              &stmts[cmd.stmt], nullptr);
+      fatal_if(rc != SQLITE_OK, "SQL error: %s in %s\n",
+               sqlite3_errmsg(disk_db), cmd.sql);
+      break;
+    case DBCommand::Insert:
+    {
+      if (rowsInBatch == 0) {
+        sqlite3_exec(disk_db, "BEGIN;", nullptr, 0, nullptr);
+      }
+      sqlite3_stmt *stmt = stmts[cmd.stmt];
+      for (int i = 0; i < cmd.numValues; i++) {
+        const auto &v = cmd.values[i];
+        if (v.isText) {
+          sqlite3_bind_text(stmt, i + 1, v.text.data(), (int)v.text.size(),
+                            SQLITE_STATIC);
+        } else {
+          sqlite3_bind_int64(stmt, i + 1, v.integer);
+        }
+      }
+      rc = sqlite3_step(stmt);
+      fatal_if(rc != SQLITE_DONE, "SQL error: %s\n",
+               sqlite3_errmsg(disk_db));
+      sqlite3_reset(stmt);
+      if (++rowsInBatch >= batchSize) {
+        commitBatch();
+      }
+      break;
+    }
+    case DBCommand::Stop:
+      commitBatch();
+      break;
   }
 }
 
+void
+ArchDBer::commitBatch()
+{
+  if (rowsInBatch == 0)
+    return;
+  sqlite3_exec(disk_db, "COMMIT;", nullptr, 0, nullptr);
+  rowsInBatch = 0;
+}
+
+void
+ArchDBer::execmd(std::string cmd)
+{
+  DBCommand exec;
+  exec.kind = DBCommand::Exec;
+  exec.sql = std::move(cmd);
+  push(std::move(exec));
+}
+
+int
+ArchDBer::prepare(const std::string &sql)
+{
+  DBCommand prep;
+  prep.kind = DBCommand::Prepare;
+  prep.stmt = numStmts++;
+  prep.sql = sql;
+  push(std::move(prep));
+  return prep.stmt;
+}
+
 DBTraceManager *
 ArchDBer::addAndGetTrace(const char *name, std::vector<std::pair<std::string, DataType>> fields)
 {
-  _traces[name] = DBTraceManager(name, fields, mem_db);
+  _traces[name] = DBTraceManager(name, fields, this);
   return &_traces[name];
 }
 
@@ -90,15 +249,13 @@ ArchDBer::memTraceWrite(Tick tick, bool is_load, Addr pc, Addr vaddr, Addr paddr
   bool dump_me = dumpGlobal && dumpMemTrace;
   if (!dump_me) return;
 
-  sprintf(
-      memTraceSQLBuf,
+  if (memTraceStmt < 0) {
+    memTraceStmt = prepare(
       "INSERT INTO MemTrace(Tick,IsLoad,PC,VADDR,PADDR,Issued,Translated,Completed,Committed,Writenback,PFSrc,SITE) "
-      "VALUES(%ld,%d,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%d,'%s');",
-      tick, is_load, pc, vaddr, paddr, issued, translated, completed, committed, writenback, pf_src, "CommitMemTrace");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+      "VALUES(?,?,?,?,?,?,?,?,?,?,?,?);");
+  }
+  insert(memTraceStmt, tick, is_load, pc, vaddr, paddr, issued, translated, completed, committed, writenback, pf_src,
+         "CommitMemTrace");
 }
 
 void
@@ -107,14 +264,12 @@ ArchDBer::l1PFTraceWrite(Tick tick, Addr trigger_pc, Addr trigger_vaddr, Addr pf
   bool dump_me = dumpGlobal && dumpL1PfTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO L1PFTrace(Tick,TriggerPC,TriggerVAddr,PFVAddr,PFSrc,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,'%s');",
-          tick, trigger_pc, trigger_vaddr, pf_vaddr, pf_src, "L1PFTrace");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  if (l1PFTraceStmt < 0) {
+    l1PFTraceStmt = prepare(
+      "INSERT INTO L1PFTrace(Tick,TriggerPC,TriggerVAddr,PFVAddr,PFSrc,SITE) "
+      "VALUES(?,?,?,?,?,?);");
+  }
+  insert(l1PFTraceStmt, tick, trigger_pc, trigger_vaddr, pf_vaddr, pf_src, "L1PFTrace");
 }
 
 void
@@ -123,14 +278,12 @@ ArchDBer::bopTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr offse
   bool dump_me = dumpGlobal && dumpBopTrainTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO BOPTrainTrace(Tick,OldAddr,CurAddr,Offset,Score,Miss,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,%d,'%s');",
-          tick, old_addr, cur_addr, offset, score, miss, "BOPTrain");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  if (bopTrainTraceStmt < 0) {
+    bopTrainTraceStmt = prepare(
+      "INSERT INTO BOPTrainTrace(Tick,OldAddr,CurAddr,Offset,Score,Miss,SITE) "
+      "VALUES(?,?,?,?,?,?,?);");
+  }
+  insert(bopTrainTraceStmt, tick, old_addr, cur_addr, offset, score, miss, "BOPTrain");
 }
 
 void
@@ -139,14 +292,12 @@ ArchDBer::smsTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr trigg
   bool dump_me = dumpGlobal && dumpSMSTrainTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO SMSTrainTrace(Tick,OldAddr,CurAddr,TriggerOffset,Conf,Miss,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,%d,'%s');",
-          tick, old_addr, cur_addr, trigger_offset, conf, miss, "SMSTrain");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  if (smsTrainTraceStmt < 0) {
+    smsTrainTraceStmt = prepare(
+      "INSERT INTO SMSTrainTrace(Tick,OldAddr,CurAddr,TriggerOffset,Conf,Miss,SITE) "
+      "VALUES(?,?,?,?,?,?,?);");
+  }
+  insert(smsTrainTraceStmt, tick, old_addr, cur_addr, trigger_offset, conf, miss, "SMSTrain");
 }
 
 void ArchDBer::L1MissTrace_write(
@@ -159,16 +310,12 @@ void ArchDBer::L1MissTrace_write(
 ) {
   bool dump_me = dumpGlobal && dumpL1MissTrace;
   if (!dump_me) return;
-  char sql[512];
-  sprintf(sql,
-    "INSERT INTO L1MissTrace(PC,SOURCE,PADDR,VADDR, STAMP, SITE) " \
-    "VALUES(%ld, %ld, %ld, %ld, %ld, '%s');",
-    pc,source,paddr,vaddr, stamp, site
-  );
-  rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  if (l1MissTraceStmt < 0) {
+    l1MissTraceStmt = prepare(
+      "INSERT INTO L1MissTrace(PC,SOURCE,PADDR,VADDR, STAMP, SITE) " \
+      "VALUES(?, ?, ?, ?, ?, ?);");
+  }
+  insert(l1MissTraceStmt, pc, source, paddr, vaddr, stamp, site);
 }
 
 void
@@ -177,15 +324,12 @@ ArchDBer::dcacheWayPreTrace(Tick tick, uint64_t pc, uint64_t vaddr, int way, int
     bool dump_me = dumpGlobal && dumpL1WayPreTrace;
     if (!dump_me)
         return;
-    char sql[512];
-    sprintf(sql,
+    if (wayPreTraceStmt < 0) {
+        wayPreTraceStmt = prepare(
             "INSERT INTO dcacheWayPreTrace(PC,VADDR, WAY, Tick, IsWrite,SITE)"
-            "VALUES(%ld,%ld,%ld,%ld,%ld,'%s');",
-            pc, vaddr, (uint64_t)way, tick, (uint64_t)is_write, "dacheWayPre");
-    rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-    if (rc != SQLITE_OK) {
-        fatal("SQL error: %s\n", zErrMsg);
-    };
+            "VALUES(?,?,?,?,?,?);");
+    }
+    insert(wayPreTraceStmt, pc, vaddr, way, tick, is_write, "dacheWayPre");
 }
 
 void
@@ -194,61 +338,51 @@ ArchDBer::evictTraceWrite(int cache_level, Tick tick, uint64_t paddr, uint64_t s
   bool dump_me = dumpGlobal && ((dumpL1EvictTrace && cache_level == 1) || (dumpL2EvictTrace && cache_level == 2) ||
                                 (dumpL3EvictTrace && cache_level == 3));
   if (!dump_me) return;
-  char sql[512];
-  sprintf(sql,
-    "INSERT INTO CacheEvictTrace(Tick, PADDR, STAMP, Level, SITE) " \
-    "VALUES(%ld, %ld, %ld, %ld, '%s');",
-    tick, paddr, stamp, (int64_t) cache_level, site
-  );
-  rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  if (evictTraceStmt < 0) {
+    evictTraceStmt = prepare(
+      "INSERT INTO CacheEvictTrace(Tick, PADDR, STAMP, Level, SITE) " \
+      "VALUES(?, ?, ?, ?, ?);");
+  }
+  insert(evictTraceStmt, tick, paddr, stamp, cache_level, site);
 }
 
 void
 DBTraceManager::init_table() {
   // create table
-  char sql[1024];
-  int pos = 0;
-  pos = sprintf(sql,
-    "CREATE TABLE %s(" \
+  std::string sql = "CREATE TABLE " + _name + "(" \
     "ID INTEGER PRIMARY KEY AUTOINCREMENT, " \
-    "TICK INT NOT NULL", _name.c_str());
+    "TICK INT NOT NULL";
+  std::string insert_sql = "INSERT INTO " + _name + "(TICK";
+  std::string values = ") VALUES(?";
   for (auto it = _fields.begin(); it != _fields.end(); it++) {
     switch (it->second) {
       case UINT64:
-        pos += sprintf(sql+pos, ",%s INT NOT NULL", it->first.c_str());
+        sql += "," + it->first + " INT NOT NULL";
         break;
       case TEXT:
-        pos += sprintf(sql+pos, ",%s TEXT", it->first.c_str());
+        sql += "," + it->first + " TEXT";
         break;
       default:
         fatal("Unknown data type");
     }
+    insert_sql += "," + it->first;
+    values += ",?";
   }
-  pos += sprintf(sql+pos, ");");
-  assert(pos < 1024);
-  printf("%s\n", sql);
-  char *zErrMsg;
-  int rc = sqlite3_exec(_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  } else {
-    warn("Table created: %s\n", _name.c_str());
-  }
+  sql += ");";
+  fatal_if(_fields.size() + 1 > DBCommand::MaxValues,
+           "Too many fields in table %s\n", _name);
+  printf("%s\n", sql.c_str());
+  _db->execmd(sql);
+  _stmt = _db->prepare(insert_sql + values + ");");
+  warn("Table created: %s\n", _name.c_str());
 }
 
 void
 DBTraceManager::write_record(const Record &record)
 {
-  char sql[1024];
-  int pos = 0;
-  pos = sprintf(sql, "INSERT INTO %s(TICK", _name.c_str());
-  for (auto it = _fields.begin(); it != _fields.end(); it++) {
-    pos += sprintf(sql+pos, ",%s", it->first.c_str());
-  }
-  pos += sprintf(sql+pos, ") VALUES(%ld", record._tick);
+  DBCommand cmd;
+  cmd.stmt = _stmt;
+  cmd.push(record._tick);
   for (auto it = _fields.begin(); it != _fields.end(); it++) {
     switch (it->second) {
       case UINT64:
@@ -258,8 +392,7 @@ DBTraceManager::write_record(const Record &record)
         if (data == m.end()) {
           fatal("Can't find data for %s\n", it->first.c_str());
         }
-        assert(data != m.end());
-        pos += sprintf(sql+pos, ",%ld", data->second);
+        cmd.push(data->second);
         break;
       }
       case TEXT:
@@ -269,22 +402,14 @@ DBTraceManager::write_record(const Record &record)
         if (data == m.end()) {
           fatal("Can't find data for %s\n", it->first.c_str());
         }
-        assert(data != m.end());
-        pos += sprintf(sql+pos, ",'%s'", data->second.c_str());
+        cmd.push(data->second);
         break;
       }
       default:
         fatal("Unknown data type!\n");
     }
   }
-  pos += sprintf(sql+pos, ");");
-  assert(pos < 1024);
-  char *zErrMsg;
-  int rc = sqlite3_exec(_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  _db->insert(std::move(cmd));
 }
 
 } // namespace gem5
-
@@ -5,37 +5,98 @@
 #include <sqlite3.h>
 #include <unistd.h>
 
+#include <array>
 #include <cerrno>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 #include "base/logging.hh"
+#include "base/spsc_queue.hh"
 #include "base/types.hh"
 #include "cpu/pred/general_arch_db.hh"
+#include "enums/ArchDBFormat.hh"
 #include "params/ArchDBer.hh"
 #include "sim/sim_exit.hh"
+#include "sim/columnar_trace.hh"
 #include "sim/sim_object.hh"
 #include "sim/system.hh"
 
 namespace gem5{
 
 class BaseCache;
+class ArchDBer;
+
+/**
+ * A value bound to one column of a prepared statement.
+ */
+struct DBValue
+{
+    bool isText = false;
+    int64_t integer = 0;
+    std::string text;
+
+    DBValue() {}
+
+    template <typename T,
+              std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    DBValue(T v) : integer(static_cast<int64_t>(v)) {}
+
+    DBValue(const char *s) : isText(true), text(s) {}
+    DBValue(std::string s) : isText(true), text(std::move(s)) {}
+};
+
+/**
+ * A unit of work for the ArchDB writer. Rows are inserted through
+ * statements that are prepared once and referred to by index.
+ */
+struct DBCommand
+{
+    static constexpr int MaxValues = 16;
+
+    enum Kind
+    {
+        Insert,  // bind values to a prepared statement and step it
+        Prepare, // prepare sql as statement number stmt
+        Exec,    // run sql directly, e.g. to create a table
+        Stop     // flush everything and stop the writer
+    };
+
+    Kind kind = Insert;
+    int stmt = -1;
+    std::string sql;
+    int numValues = 0;
+    std::array<DBValue, MaxValues> values;
+
+    void
+    push(DBValue v)
+    {
+        assert(numValues < MaxValues);
+        values[numValues++] = std::move(v);
+    }
+};
 
 class DBTraceManager
 {
   std::string _name;
   std::map<std::string, DataType> _fields;
-  sqlite3 *_db;
+  ArchDBer *_db;
+  int _stmt;
 public:
-  DBTraceManager(const char *name, std::vector<std::pair<std::string, DataType>> fields, sqlite3 *db) {
+  DBTraceManager(const char *name, std::vector<std::pair<std::string, DataType>> fields, ArchDBer *db) {
     _name = name;
     for (auto it = fields.begin(); it != fields.end(); it++) {
       _fields[it->first] = it->second;
     }
     _db = db;
+    _stmt = -1;
   }
-  DBTraceManager() {}
+  DBTraceManager() : _db(nullptr), _stmt(-1) {}
   void init_table();
   void write_record(const Record &record);
 };
@@ -64,9 +125,10 @@ class ArchDBer : public SimObject
     bool dumpLifetime;
     bool dumpLifetimeMore;
 
-    sqlite3 *mem_db;
-    char * zErrMsg;
-    int rc;
+    // on-disk database, only touched by the writer
+    sqlite3 *disk_db;
+    // used instead of disk_db with the columnar format
+    std::unique_ptr<ColumnarTraceWriter> columnar;
     //path to save
     std::string db_path;
     // a trace corrsponds to a table
@@ -74,10 +136,64 @@ class ArchDBer : public SimObject
 
     void create_table(const std::string &sql);
 
+    // flush all pending records and close the database
     void save_db();
+
+  private:
+    // Records go from the simulation thread to a writer thread through
+    // a lock-free queue. The writer binds them to prepared statements
+    // and groups them into transactions of batchSize rows.
+    const bool asyncWriter;
+    const unsigned batchSize;
+    SPSCQueue<DBCommand> queue;
+    std::thread writer;
+    bool closed;
+
+    // statement numbers handed out to the producers
+    int numStmts;
+    // statements prepared by the writer, indexed by statement number
+    std::vector<sqlite3_stmt *> stmts;
+    unsigned rowsInBatch;
+
+    int memTraceStmt;
+    int l1PFTraceStmt;
+    int bopTrainTraceStmt;
+    int smsTrainTraceStmt;
+    int l1MissTraceStmt;
+    int wayPreTraceStmt;
+    int evictTraceStmt;
+
+    void openSQLite();
+    void push(DBCommand &&cmd);
+    void writerLoop();
+    void process(DBCommand &cmd);
+    void commitBatch();
+
   public:
     void execmd(std::string cmd);
 
+    /**
+     * Prepare an insert statement.
+     *
+     * @param sql The statement, with a ? placeholder per column
+     * @return The statement number to pass to insert()
+     */
+    int prepare(const std::string &sql);
+
+    /** Queue a row for a prepared statement. */
+    void insert(DBCommand &&cmd) { push(std::move(cmd)); }
+
+    template <typename... Args>
+    void
+    insert(int stmt, Args&&... args)
+    {
+        static_assert(sizeof...(Args) <= DBCommand::MaxValues);
+        DBCommand cmd;
+        cmd.stmt = stmt;
+        (cmd.push(DBValue(std::forward<Args>(args))), ...);
+        push(std::move(cmd));
+    }
+
     DBTraceManager *addAndGetTrace(const char *name, std::vector<std::pair<std::string, DataType>> fields);
 
     bool get_dump_rolling() { return dumpRolling; }
@@ -101,7 +217,6 @@ class ArchDBer : public SimObject
     void bopTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr offset, int score, bool miss);
     void smsTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr trigger_offset, int conf, bool miss);
     void dcacheWayPreTrace(Tick tick, uint64_t pc, uint64_t vaddr, int way, int is_write);
-    char memTraceSQLBuf[1024];
 };
 
 
@@ -0,0 +1,233 @@
+#include "sim/calendar_queue.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+CalendarQueue::CalendarQueue()
+    : buckets(MinBuckets, nullptr), bucketMask(MinBuckets - 1),
+      widthShift(DefaultWidthShift)
+{
+}
+
+void
+CalendarQueue::insert(Event *event)
+{
+    Event *&top = bucket(day(event));
+    Event *prev = nullptr;
+    Event *curr = top;
+    while (curr && *curr < *event) {
+        prev = curr;
+        curr = curr->nextBin;
+    }
+
+    if (!curr || *event < *curr) {
+        numBins++;
+    }
+    // same as the list event queue, event is the top of its bin now
+    Event *bin = Event::insertBefore(event, curr);
+    if (prev) {
+        prev->nextBin = bin;
+    } else {
+        top = bin;
+    }
+
+    if (!_head || *event <= *_head) {
+        _head = event;
+    }
+
+    if (numBins > 2 * buckets.size()) {
+        resize(2 * buckets.size());
+    }
+}
+
+void
+CalendarQueue::remove(Event *event)
+{
+    uint64_t event_day = day(event);
+    Event *&top = bucket(event_day);
+    Event *prev = nullptr;
+    Event *curr = top;
+    while (curr && *curr < *event) {
+        prev = curr;
+        curr = curr->nextBin;
+    }
+
+    if (!curr || *curr != *event)
+        panic("event not found!");
+
+    bool bin_empty = curr == event && !event->nextInBin;
+    Event *bin = Event::removeItem(event, curr);
+    if (prev) {
+        prev->nextBin = bin;
+    } else {
+        top = bin;
+    }
+
+    if (bin_empty) {
+        numBins--;
+    }
+
+    if (event == _head) {
+        // the head is the first bin of its bucket
+        _head = bin_empty ? findHead(event_day) : bin;
+        if (++headMoves == FarHeadWindow) {
+            headMoves = 0;
+            farHeads = 0;
+        }
+        if (_head && numBins > 1 && day(_head) - event_day >= buckets.size() &&
+            ++farHeads >= FarHeadsBeforeResize) {
+            // the next event keeps being more than a whole calendar
+            // away, the buckets are too narrow for the events pending
+            // now. A lone far event, e.g. a periodic one, is not worth
+            // rehashing every bin for.
+            resize(buckets.size());
+            return;
+        }
+    }
+
+    if (buckets.size() > MinBuckets && numBins < buckets.size() / 2) {
+        resize(buckets.size() / 2);
+    }
+}
+
+Event *
+CalendarQueue::findHead(uint64_t from) const
+{
+    if (numBins == 0) {
+        return nullptr;
+    }
+
+    // walk a year of the calendar from the day of the last head
+    for (uint64_t d = from; d != from + buckets.size(); d++) {
+        Event *top = buckets[d & bucketMask];
+        if (top && day(top) == d) {
+            return top;
+        }
+    }
+
+    // every bin is at least a year away, take the earliest one
+    Event *earliest = nullptr;
+    for (Event *top : buckets) {
+        if (top && (!earliest || *top < *earliest)) {
+            earliest = top;
+        }
+    }
+    return earliest;
+}
+
+void
+CalendarQueue::insertBin(Event *bin)
+{
+    Event *&top = bucket(day(bin));
+    Event *prev = nullptr;
+    Event *curr = top;
+    while (curr && *curr < *bin) {
+        prev = curr;
+        curr = curr->nextBin;
+    }
+    assert(!curr || *bin < *curr);
+
+    bin->nextBin = curr;
+    if (prev) {
+        prev->nextBin = bin;
+    } else {
+        top = bin;
+    }
+    numBins++;
+
+    if (!_head || *bin < *_head) {
+        _head = bin;
+    }
+}
+
+std::vector<Event *>
+CalendarQueue::bins() const
+{
+    std::vector<Event *> all;
+    all.reserve(numBins);
+    for (Event *top : buckets) {
+        for (Event *bin = top; bin; bin = bin->nextBin) {
+            all.push_back(bin);
+        }
+    }
+    std::sort(all.begin(), all.end(),
+              [](const Event *l, const Event *r) { return *l < *r; });
+    return all;
+}
+
+Event *
+CalendarQueue::takeAll()
+{
+    auto all = bins();
+    for (size_t i = 0; i < all.size(); i++) {
+        all[i]->nextBin = i + 1 < all.size() ? all[i + 1] : nullptr;
+    }
+
+    std::fill(buckets.begin(), buckets.end(), nullptr);
+    numBins = 0;
+    _head = nullptr;
+    return all.empty() ? nullptr : all.front();
+}
+
+void
+CalendarQueue::insertAll(Event *bins)
+{
+    while (bins) {
+        Event *next = bins->nextBin;
+        insertBin(bins);
+        bins = next;
+    }
+}
+
+void
+CalendarQueue::resize(size_t num_buckets)
+{
+    std::vector<Event *> all;
+    all.reserve(numBins);
+    for (Event *top : buckets) {
+        for (Event *bin = top; bin; bin = bin->nextBin) {
+            all.push_back(bin);
+        }
+    }
+
+    // Make a bucket two to four times the average spacing of the
+    // earliest bins, which are the ones that will be serviced next.
+    // Like Brown, leave out the spacings well above the average, so
+    // that a far away event does not make the buckets too wide.
+    size_t samples = std::min(all.size(), WidthSamples);
+    auto by_tick = [](const Event *l, const Event *r) { return *l < *r; };
+    std::partial_sort(all.begin(), all.begin() + samples, all.end(), by_tick);
+    if (samples > 1) {
+        Tick avg = (all[samples - 1]->when() - all[0]->when()) / (samples - 1);
+        Tick sum = 0;
+        size_t n = 0;
+        for (size_t i = 1; i < samples; i++) {
+            Tick gap = all[i]->when() - all[i - 1]->when();
+            if (gap / 2 <= avg) {
+                sum += gap;
+                n++;
+            }
+        }
+        if (sum > 0) {
+            widthShift = std::min(ceilLog2(std::max<Tick>(sum / n, 1)) + 1, 63);
+        }
+    }
+
+    buckets.assign(num_buckets, nullptr);
+    bucketMask = num_buckets - 1;
+    numBins = 0;
+    _head = nullptr;
+    headMoves = 0;
+    farHeads = 0;
+    for (Event *bin : all) {
+        insertBin(bin);
+    }
+}
+
+} // namespace gem5
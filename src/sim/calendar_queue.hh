@@ -0,0 +1,86 @@
+#ifndef __SIM_CALENDAR_QUEUE_HH__
+#define __SIM_CALENDAR_QUEUE_HH__
+
+#include <vector>
+
+#include "base/types.hh"
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+/**
+ * Bins of an EventQueue kept in a calendar queue (R. Brown, "Calendar
+ * queues: a fast O(1) priority queue implementation for the simulation
+ * event set problem", CACM 1988).
+ *
+ * A bin is the stack of events with the same when and priority, linked
+ * through nextInBin exactly as in the list event queue, so the order in
+ * which events are serviced does not change. The bins are hashed by
+ * their tick into a ring of buckets, each of which holds a short sorted
+ * list of bins linked through nextBin. The number of buckets follows
+ * the number of bins and the width of a bucket follows the spacing of
+ * the earliest bins, which keeps a few bins per bucket, so inserting,
+ * removing and finding the next head are O(1) on average.
+ */
+class CalendarQueue
+{
+  public:
+    CalendarQueue();
+
+    /** The next event to service, nullptr if there is none */
+    Event *head() const { return _head; }
+
+    void insert(Event *event);
+    void remove(Event *event);
+
+    /**
+     * Take all bins out of the calendar, linked through nextBin in
+     * service order like the list event queue.
+     */
+    Event *takeAll();
+
+    /** Insert all bins of a list taken by takeAll() */
+    void insertAll(Event *bins);
+
+    /** Tops of all bins in service order */
+    std::vector<Event *> bins() const;
+
+  private:
+    static constexpr size_t MinBuckets = 16;
+    // 512 ticks, roughly the cycle of a GHz clock domain
+    static constexpr unsigned DefaultWidthShift = 9;
+    // number of earliest bins sampled to pick the bucket width
+    static constexpr size_t WidthSamples = 32;
+    // resize once this many of the last FarHeadWindow heads were more
+    // than a year after the previous one
+    static constexpr unsigned FarHeadsBeforeResize = 8;
+    static constexpr unsigned FarHeadWindow = 64;
+
+    std::vector<Event *> buckets;
+    size_t bucketMask;
+    // a bucket covers 1 << widthShift ticks
+    unsigned widthShift;
+    size_t numBins = 0;
+    Event *_head = nullptr;
+    // heads taken since the window started, and far ones among them
+    unsigned headMoves = 0;
+    unsigned farHeads = 0;
+
+    /** Index of the bucket in the unbounded calendar */
+    uint64_t day(const Event *event) const { return event->when() >> widthShift; }
+    Event *&bucket(uint64_t day) { return buckets[day & bucketMask]; }
+
+    /** Link a whole bin into its bucket, there must be no such bin yet */
+    void insertBin(Event *bin);
+
+    /** The earliest bin at day or later, which no bin is before */
+    Event *findHead(uint64_t from) const;
+
+    /** Rehash the bins into num_buckets buckets and pick a new width */
+    void resize(size_t num_buckets);
+};
+
+} // namespace gem5
+
+#endif // __SIM_CALENDAR_QUEUE_HH__
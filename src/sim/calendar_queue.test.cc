@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "sim/eventq.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+class Workload;
+
+class TestEvent : public Event
+{
+  public:
+    TestEvent(Workload &workload, unsigned id, Priority prio)
+        : Event(prio), workload(workload), id(id)
+    {}
+
+    void process() override;
+
+    Workload &workload;
+    const unsigned id;
+};
+
+/**
+ * Events which reschedule themselves when they fire and now and then
+ * move or cancel another one. Most of them fire within a few hundred
+ * cycles, a few are far away, and at times a burst of events lands on
+ * the same tick, so the calendar grows, shrinks and resizes for far
+ * heads. The same seed gives the same decisions on both queues as long
+ * as they service the events in the same order.
+ */
+class Workload
+{
+  public:
+    Workload(EventQueue &eq, unsigned num_events) : eq(eq), rng(7)
+    {
+        static const Event::Priority prios[] = {
+            Event::Default_Pri, Event::CPU_Tick_Pri,
+            Event::Delayed_Writeback_Pri, Event::Stat_Event_Pri,
+            Event::Sim_Exit_Pri,
+        };
+        for (unsigned i = 0; i < num_events; i++) {
+            events.emplace_back(
+                new TestEvent(*this, i, prios[rng() % std::size(prios)]));
+        }
+        for (auto &event : events) {
+            eq.schedule(event.get(), delay());
+        }
+    }
+
+    ~Workload()
+    {
+        for (auto &event : events) {
+            if (event->scheduled()) {
+                eq.deschedule(event.get());
+            }
+        }
+    }
+
+    void
+    fire(TestEvent &event)
+    {
+        serviced.emplace_back(event.id, eq.getCurTick());
+
+        if (rng() % 8 != 0) {
+            eq.schedule(&event, eq.getCurTick() + delay());
+        }
+        auto &other = *events[rng() % events.size()];
+        switch (rng() % 8) {
+          case 0:
+            eq.reschedule(&other, eq.getCurTick() + delay(), true);
+            break;
+          case 1:
+            if (other.scheduled()) {
+                eq.deschedule(&other);
+            }
+            break;
+          case 2:
+            // several events in the same bin
+            if (!other.scheduled()) {
+                eq.schedule(&other, eq.getCurTick() + 1000);
+            }
+            break;
+          default:
+            break;
+        }
+    }
+
+    Tick
+    delay()
+    {
+        switch (rng() % 64) {
+          case 0:
+            return 1000000 + rng() % 10000000;
+          case 1:
+            return 0;
+          default:
+            return 333 * (1 + rng() % 300);
+        }
+    }
+
+    EventQueue &eq;
+    std::mt19937_64 rng;
+    std::vector<std::unique_ptr<TestEvent>> events;
+    std::vector<std::pair<unsigned, Tick>> serviced;
+};
+
+void
+TestEvent::process()
+{
+    workload.fire(*this);
+}
+
+std::vector<std::pair<unsigned, Tick>>
+run(bool use_calendar, unsigned pending, unsigned count)
+{
+    EventQueue eq(use_calendar ? "calendar" : "list", use_calendar);
+    Workload workload(eq, pending);
+    for (unsigned i = 0; i < count && !eq.empty(); i++) {
+        eq.serviceOne();
+    }
+    return std::move(workload.serviced);
+}
+
+} // anonymous namespace
+
+/** The calendar services events in the same order as the bin list */
+TEST(CalendarQueueTest, SameOrderAsList)
+{
+    for (unsigned pending : {1, 5, 40, 700}) {
+        auto list = run(false, pending, 100000);
+        auto calendar = run(true, pending, 100000);
+        ASSERT_EQ(list.size(), calendar.size()) << pending << " pending";
+        for (size_t i = 0; i < list.size(); i++) {
+            ASSERT_EQ(list[i], calendar[i])
+                << pending << " pending, event " << i;
+        }
+    }
+}
+
+/** Events of the same tick and priority fire as on the list queue */
+TEST(CalendarQueueTest, SameBinOrder)
+{
+    auto run_bin = [](bool use_calendar) {
+        EventQueue eq("eq", use_calendar);
+        std::vector<unsigned> order;
+        std::vector<std::unique_ptr<EventFunctionWrapper>> events;
+        for (unsigned i = 0; i < 6; i++) {
+            events.emplace_back(new EventFunctionWrapper(
+                [&order, i]() { order.push_back(i); }, "test", false,
+                i % 2 ? Event::Default_Pri : Event::CPU_Tick_Pri));
+            eq.schedule(events.back().get(), 500);
+        }
+        eq.deschedule(events[2].get());
+        eq.reschedule(events[3].get(), 500);
+        while (!eq.empty()) {
+            eq.serviceOne();
+        }
+        return order;
+    };
+
+    auto list = run_bin(false);
+    ASSERT_EQ(list.size(), 5);
+    ASSERT_EQ(run_bin(true), list);
+}
@@ -0,0 +1,208 @@
+#include "sim/columnar_trace.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include "base/logging.hh"
+#include "sim/arch_db.hh"
+
+namespace gem5
+{
+
+namespace
+{
+
+std::string
+trim(const std::string &s)
+{
+    size_t b = 0, e = s.size();
+    while (b < e && std::isspace((unsigned char)s[b]))
+        b++;
+    while (e > b && std::isspace((unsigned char)s[e - 1]))
+        e--;
+    return s.substr(b, e - b);
+}
+
+} // anonymous namespace
+
+ColumnarTraceWriter::ColumnarTraceWriter(const std::string &path,
+                                         unsigned block_rows, int level)
+    : blockRows(std::max(1u, block_rows)), level(level),
+      cctx(ZSTD_createCCtx())
+{
+    file = fopen(path.c_str(), "wb");
+    fatal_if(!file, "Can't open columnar trace %s: %s\n", path,
+             strerror(errno));
+    fatal_if(!cctx, "Can't create zstd context\n");
+    write(Magic, sizeof(Magic));
+    writeVal<uint32_t>(Version);
+}
+
+ColumnarTraceWriter::~ColumnarTraceWriter()
+{
+    close();
+    ZSTD_freeCCtx(cctx);
+}
+
+void
+ColumnarTraceWriter::prepare(int stmt, const std::string &sql)
+{
+    // INSERT INTO Table(col, ...) VALUES(...)
+    const std::string into = "INTO";
+    size_t pos = sql.find(into);
+    size_t open = sql.find('(', pos);
+    size_t close = sql.find(')', open);
+    fatal_if(pos == std::string::npos || open == std::string::npos ||
+             close == std::string::npos,
+             "Columnar trace can't parse statement: %s\n", sql);
+
+    std::string name = trim(sql.substr(pos + into.size(),
+                                       open - pos - into.size()));
+    std::vector<std::string> cols;
+    size_t start = open + 1;
+    while (start <= close) {
+        size_t end = sql.find(',', start);
+        if (end == std::string::npos || end > close)
+            end = close;
+        cols.push_back(trim(sql.substr(start, end - start)));
+        start = end + 1;
+    }
+
+    Table *table;
+    auto it = tableByName.find(name);
+    if (it != tableByName.end()) {
+        table = it->second;
+        fatal_if(table->columns.size() != cols.size(),
+                 "Columnar trace: table %s inserted with different "
+                 "columns\n", name);
+    } else {
+        tables.emplace_back(new Table);
+        table = tables.back().get();
+        table->id = tables.size() - 1;
+        table->name = name;
+        table->columns.resize(cols.size());
+        for (size_t i = 0; i < cols.size(); i++)
+            table->columns[i].name = cols[i];
+        tableByName[name] = table;
+    }
+
+    if (stmtTables.size() <= (size_t)stmt)
+        stmtTables.resize(stmt + 1, nullptr);
+    stmtTables[stmt] = table;
+}
+
+void
+ColumnarTraceWriter::insert(const DBCommand &cmd)
+{
+    Table &table = *stmtTables[cmd.stmt];
+    fatal_if((size_t)cmd.numValues != table.columns.size(),
+             "Columnar trace: %d values for %d columns of %s\n",
+             cmd.numValues, table.columns.size(), table.name);
+
+    for (int i = 0; i < cmd.numValues; i++) {
+        const DBValue &v = cmd.values[i];
+        Column &col = table.columns[i];
+        if (col.type == Unknown)
+            col.type = v.isText ? Text : Int;
+        fatal_if(v.isText != (col.type == Text),
+                 "Columnar trace: column %s.%s changed type\n",
+                 table.name, col.name);
+        if (v.isText) {
+            col.chars += v.text;
+            col.offsets.push_back(col.chars.size());
+        } else {
+            col.ints.push_back(v.integer);
+        }
+    }
+
+    if (++table.rows >= blockRows)
+        writeBlock(table);
+}
+
+void
+ColumnarTraceWriter::close()
+{
+    if (!file)
+        return;
+    for (auto &table : tables)
+        writeBlock(*table);
+    fclose(file);
+    file = nullptr;
+}
+
+void
+ColumnarTraceWriter::writeSchema(Table &table)
+{
+    writeVal<uint8_t>(1);
+    writeVal<uint32_t>(table.id);
+    writeStr(table.name);
+    writeVal<uint16_t>(table.columns.size());
+    for (const auto &col : table.columns) {
+        writeVal<uint8_t>(col.type);
+        writeStr(col.name);
+    }
+    table.schemaWritten = true;
+}
+
+void
+ColumnarTraceWriter::writeBlock(Table &table)
+{
+    if (table.rows == 0)
+        return;
+    if (!table.schemaWritten)
+        writeSchema(table);
+
+    writeVal<uint8_t>(2);
+    writeVal<uint32_t>(table.id);
+    writeVal<uint32_t>(table.rows);
+    for (auto &col : table.columns) {
+        if (col.type == Text) {
+            size_t off_bytes = col.offsets.size() * sizeof(uint32_t);
+            raw.resize(off_bytes + col.chars.size());
+            memcpy(raw.data(), col.offsets.data(), off_bytes);
+            memcpy(raw.data() + off_bytes, col.chars.data(),
+                   col.chars.size());
+            col.offsets.clear();
+            col.chars.clear();
+        } else {
+            raw.resize(col.ints.size() * sizeof(int64_t));
+            // deltas are taken modulo 2^64, a prefix sum restores them
+            uint64_t prev = 0;
+            for (size_t i = 0; i < col.ints.size(); i++) {
+                uint64_t cur = col.ints[i];
+                uint64_t delta = cur - prev;
+                memcpy(raw.data() + i * sizeof(delta), &delta,
+                       sizeof(delta));
+                prev = cur;
+            }
+            col.ints.clear();
+        }
+        writeChunk();
+    }
+    table.rows = 0;
+}
+
+void
+ColumnarTraceWriter::writeChunk()
+{
+    compressed.resize(ZSTD_compressBound(raw.size()));
+    size_t size = ZSTD_compressCCtx(cctx, compressed.data(),
+                                    compressed.size(), raw.data(),
+                                    raw.size(), level);
+    fatal_if(ZSTD_isError(size), "Columnar trace: zstd failed: %s\n",
+             ZSTD_getErrorName(size));
+    writeVal<uint64_t>(size);
+    writeVal<uint64_t>(raw.size());
+    write(compressed.data(), size);
+}
+
+void
+ColumnarTraceWriter::write(const void *data, size_t size)
+{
+    fatal_if(fwrite(data, 1, size, file) != size,
+             "Columnar trace: write failed: %s\n", strerror(errno));
+}
+
+} // namespace gem5
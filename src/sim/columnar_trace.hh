@@ -0,0 +1,119 @@
+#ifndef __SIM_COLUMNAR_TRACE_HH__
+#define __SIM_COLUMNAR_TRACE_HH__
+
+#include <zstd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gem5
+{
+
+struct DBCommand;
+
+/**
+ * Columnar, zstd compressed alternative to the SQLite backend of ArchDBer.
+ *
+ * Rows are buffered per table and column, and every blockRows rows the
+ * table is flushed as one block in which each column is compressed on
+ * its own. Integer columns are delta encoded first, which turns ticks,
+ * sequence numbers and strided addresses into long runs of small values.
+ *
+ * The file is a sequence of little-endian records after an 8 byte magic
+ * and a u32 version:
+ *
+ *   schema (u8 1): u32 table, u16 len, name,
+ *                  u16 ncols, ncols * (u8 type, u16 len, name)
+ *   block  (u8 2): u32 table, u32 nrows,
+ *                  ncols * (u64 compressed, u64 raw, bytes)
+ *
+ * A schema record precedes the first block of its table. Integer columns
+ * (type 0) hold nrows int64 deltas, text columns (type 1) hold nrows u32
+ * end offsets followed by the concatenated strings.
+ * util/arch_db/columnar_trace.py reads the format back.
+ */
+class ColumnarTraceWriter
+{
+  public:
+    static constexpr char Magic[8] = {'X', 'S', 'C', 'O', 'L', 'D', 'B', 0};
+    static constexpr uint32_t Version = 1;
+
+    ColumnarTraceWriter(const std::string &path, unsigned block_rows,
+                        int level);
+    ~ColumnarTraceWriter();
+
+    /**
+     * Bind a statement number to the table and columns named by an
+     * "INSERT INTO Table(col, ...) VALUES(...)" statement.
+     */
+    void prepare(int stmt, const std::string &sql);
+
+    /** Append the values of cmd as a row of its statement's table. */
+    void insert(const DBCommand &cmd);
+
+    /** Write out all buffered rows and close the file. */
+    void close();
+
+  private:
+    enum ColumnType : uint8_t
+    {
+        Int = 0,
+        Text = 1,
+        Unknown = 0xff
+    };
+
+    struct Column
+    {
+        std::string name;
+        // fixed by the first value, so that a block is homogeneous
+        ColumnType type = Unknown;
+        std::vector<int64_t> ints;
+        std::vector<uint32_t> offsets;
+        std::string chars;
+    };
+
+    struct Table
+    {
+        uint32_t id;
+        std::string name;
+        std::vector<Column> columns;
+        uint32_t rows = 0;
+        bool schemaWritten = false;
+    };
+
+    FILE *file;
+    const unsigned blockRows;
+    const int level;
+    ZSTD_CCtx *cctx;
+
+    std::vector<std::unique_ptr<Table>> tables;
+    std::map<std::string, Table *> tableByName;
+    /** Table of each prepared statement, indexed by statement number. */
+    std::vector<Table *> stmtTables;
+
+    std::vector<char> raw;
+    std::vector<char> compressed;
+
+    void writeSchema(Table &table);
+    void writeBlock(Table &table);
+    void writeChunk();
+    void write(const void *data, size_t size);
+
+    template <typename T>
+    void writeVal(T v) { write(&v, sizeof(v)); }
+
+    void
+    writeStr(const std::string &s)
+    {
+        writeVal<uint16_t>(s.size());
+        write(s.data(), s.size());
+    }
+};
+
+} // namespace gem5
+
+#endif // __SIM_COLUMNAR_TRACE_HH__
@@ -39,8 +39,10 @@
 
 #include "base/logging.hh"
 #include "base/trace.hh"
+#include "config/use_calendar_eventq.hh"
 #include "cpu/smt.hh"
 #include "debug/Checkpoint.hh"
+#include "sim/calendar_queue.hh"
 
 namespace gem5
 {
@@ -111,6 +113,12 @@ Event::insertBefore(Event *event, Event *curr)
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        calendar->insert(event);
+        head = calendar->head();
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
@@ -170,6 +178,12 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        calendar->remove(event);
+        head = calendar->head();
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -202,7 +216,10 @@ EventQueue::serviceOne()
     Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
-    if (next) {
+    if (calendar) {
+        calendar->remove(event);
+        head = calendar->head();
+    } else if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
 
@@ -295,15 +312,12 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
+        for (Event *nextBin : binTops()) {
             Event *nextInBin = nextBin;
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -318,8 +332,7 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
-    Event *nextBin = head;
-    while (nextBin) {
+    for (Event *nextBin : binTops()) {
         Event *nextInBin = nextBin;
         while (nextInBin) {
             if (nextInBin->when() < time) {
@@ -345,16 +358,34 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
 }
 
+std::vector<Event *>
+EventQueue::binTops() const
+{
+    if (calendar)
+        return calendar->bins();
+
+    std::vector<Event *> tops;
+    for (Event *bin = head; bin; bin = bin->nextBin)
+        tops.push_back(bin);
+    return tops;
+}
+
 Event*
 EventQueue::replaceHead(Event* s)
 {
+    if (calendar) {
+        // hand the events out as a bin list, as in the list queue
+        Event* t = calendar->takeAll();
+        calendar->insertAll(s);
+        head = calendar->head();
+        return t;
+    }
+
     Event* t = head;
     head = s;
     return t;
@@ -416,8 +447,20 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const std::string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : EventQueue(n, USE_CALENDAR_EVENTQ)
+{
+}
+
+EventQueue::EventQueue(const std::string &n, bool use_calendar)
+    : objName(n), head(NULL), _curTick(0),
+      calendar(use_calendar ? new CalendarQueue : nullptr)
+{
+}
+
+EventQueue::~EventQueue()
 {
+    while (!empty())
+        deschedule(getHead());
 }
 
 void
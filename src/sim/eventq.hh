@@ -43,6 +43,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/debug.hh"
 #include "base/flags.hh"
@@ -55,6 +56,7 @@
 namespace gem5
 {
 
+class CalendarQueue;
 class EventQueue;       // forward declaration
 class BaseGlobalEvent;
 
@@ -250,6 +252,7 @@ class EventBase
  */
 class Event : public EventBase, public Serializable
 {
+    friend class CalendarQueue;
     friend class EventQueue;
 
   private:
@@ -628,6 +631,12 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
+    /**
+     * When set, the bins are kept in this calendar queue instead of the
+     * sorted bin list, and head is its head.
+     */
+    std::unique_ptr<CalendarQueue> calendar;
+
     //! Mutex to protect async queue.
     UncontendedMutex async_queue_mutex;
 
@@ -668,6 +677,9 @@ class EventQueue
 
     EventQueue(const EventQueue &);
 
+    /** Tops of all bins in service order */
+    std::vector<Event *> binTops() const;
+
   public:
     class ScopedMigration
     {
@@ -747,6 +759,13 @@ class EventQueue
      */
     EventQueue(const std::string &n);
 
+    /**
+     * An event queue which keeps its events in a calendar queue rather
+     * than the sorted bin list, whatever the build default is. The
+     * order of the events is the same with both.
+     */
+    EventQueue(const std::string &n, bool use_calendar);
+
     /**
      * @ingroup api_eventq
      * @{
@@ -968,11 +987,7 @@ class EventQueue
      */
     void checkpointReschedule(Event *event);
 
-    virtual ~EventQueue()
-    {
-        while (!empty())
-            deschedule(getHead());
-    }
+    virtual ~EventQueue();
 };
 
 inline void
@@ -0,0 +1,148 @@
+/*
+ * Compare the host time spent by the list and the calendar event queue
+ * on a mix of events like the one of a detailed CPU model: clocked
+ * objects ticking with a few periods and priorities, and many one-shot
+ * responses scheduled a random latency ahead, some of which are
+ * rescheduled or descheduled before they fire.
+ *
+ * Usage: eventq_bench [pending events] [serviced events]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "base/cprintf.hh"
+#include "sim/eventq.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+class Workload;
+
+class BenchEvent : public Event
+{
+  public:
+    BenchEvent(Workload &workload, unsigned id, Priority prio)
+        : Event(prio), workload(workload), id(id)
+    {}
+
+    void process() override;
+
+    Workload &workload;
+    const unsigned id;
+};
+
+class Workload
+{
+  public:
+    Workload(EventQueue &eq, unsigned num_events)
+        : eq(eq), rng(1)
+    {
+        static const Event::Priority prios[] = {
+            Event::Default_Pri, Event::CPU_Tick_Pri, Event::Delayed_Writeback_Pri,
+            Event::Stat_Event_Pri, Event::Sim_Exit_Pri,
+        };
+        for (unsigned i = 0; i < num_events; i++) {
+            events.emplace_back(new BenchEvent(*this, i, prios[rng() % 5]));
+        }
+        for (auto &event : events) {
+            eq.schedule(event.get(), delay(*event));
+        }
+    }
+
+    ~Workload()
+    {
+        for (auto &event : events) {
+            if (event->scheduled()) {
+                eq.deschedule(event.get());
+            }
+        }
+    }
+
+    void
+    fire(BenchEvent &event)
+    {
+        checksum = checksum * 1000003 + event.id + eq.getCurTick();
+        eq.schedule(&event, eq.getCurTick() + delay(event));
+
+        // now and then, move or cancel some other pending event
+        auto &other = *events[rng() % events.size()];
+        switch (rng() % 16) {
+          case 0:
+            eq.reschedule(&other, eq.getCurTick() + delay(other), true);
+            break;
+          case 1:
+            if (other.scheduled()) {
+                eq.deschedule(&other);
+            }
+            break;
+          default:
+            break;
+        }
+    }
+
+    /** Ticks until the next firing, clocked events have fixed periods */
+    Tick
+    delay(const BenchEvent &event)
+    {
+        static const Tick periods[] = {333, 500, 1000, 1333};
+        if (event.id % 4 == 0) {
+            return periods[event.id / 4 % 4];
+        }
+        // a response within a few hundred cycles, on a cycle boundary
+        return 333 * (1 + rng() % 300);
+    }
+
+    EventQueue &eq;
+    std::mt19937_64 rng;
+    std::vector<std::unique_ptr<BenchEvent>> events;
+    uint64_t checksum = 0;
+};
+
+void
+BenchEvent::process()
+{
+    workload.fire(*this);
+}
+
+uint64_t
+run(const char *name, bool use_calendar, unsigned pending, uint64_t serviced)
+{
+    EventQueue eq(name, use_calendar);
+    Workload workload(eq, pending);
+
+    auto start = std::chrono::steady_clock::now();
+    uint64_t i = 0;
+    for (; i < serviced && !eq.empty(); i++) {
+        eq.serviceOne();
+    }
+    std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+
+    ccprintf(std::cout, "%s: %d events with %d pending in %.3fs, %.2f Mevents/s\n",
+             name, i, pending, secs.count(), i / secs.count() / 1e6);
+    return workload.checksum;
+}
+
+} // anonymous namespace
+
+int
+main(int argc, char *argv[])
+{
+    unsigned pending = argc > 1 ? std::atoi(argv[1]) : 512;
+    uint64_t serviced = argc > 2 ? std::atoll(argv[2]) : 10000000;
+
+    uint64_t list = run("list", false, pending, serviced);
+    uint64_t calendar = run("calendar", true, pending, serviced);
+
+    if (list != calendar) {
+        ccprintf(std::cerr, "the queues serviced the events in different orders\n");
+        return 1;
+    }
+    return 0;
+}
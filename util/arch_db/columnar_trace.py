@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Reader for arch db traces dumped with ArchDBer.format = 'columnar'.
+
+Needs numpy and zstandard (pip install numpy zstandard).
+
+The layout is documented in src/sim/columnar_trace.hh. Columns are
+returned as numpy arrays, integer columns as int64 and text columns as
+object arrays. Like the SQLite tables, every table gets an ID column
+numbering its rows from 1, so scripts written against the SQLite dump
+can run on either.
+
+Usage:
+    python3 columnar_trace.py trace.cdb                 # list tables
+    python3 columnar_trace.py trace.cdb -t MemTrace -n 10
+    python3 columnar_trace.py trace.cdb --to-sqlite trace.db
+"""
+
+import argparse
+import struct
+
+import numpy as np
+import zstandard
+
+MAGIC = b'XSCOLDB\0'
+VERSION = 1
+INT, TEXT = 0, 1
+
+
+class ColumnarTrace:
+    def __init__(self, path):
+        self.path = path
+        # name -> (table id, [(column type, column name)])
+        self.schemas = {}
+        # table id -> [(file offset of the column chunks, nrows)]
+        self.blocks = {}
+        self._index()
+
+    def _index(self):
+        with open(self.path, 'rb') as f:
+            if f.read(8) != MAGIC:
+                raise ValueError(f'{self.path} is not a columnar arch db')
+            version, = struct.unpack('<I', f.read(4))
+            if version != VERSION:
+                raise ValueError(f'unsupported version {version}')
+            ncols = {}
+            while True:
+                kind = f.read(1)
+                if not kind:
+                    break
+                if kind[0] == 1:
+                    tid, = struct.unpack('<I', f.read(4))
+                    name = self._read_str(f)
+                    n, = struct.unpack('<H', f.read(2))
+                    cols = []
+                    for _ in range(n):
+                        ctype = f.read(1)[0]
+                        cols.append((ctype, self._read_str(f)))
+                    self.schemas[name] = (tid, cols)
+                    self.blocks[tid] = []
+                    ncols[tid] = n
+                elif kind[0] == 2:
+                    tid, nrows = struct.unpack('<II', f.read(8))
+                    self.blocks[tid].append((f.tell(), nrows))
+                    for _ in range(ncols[tid]):
+                        size, _raw = struct.unpack('<QQ', f.read(16))
+                        f.seek(size, 1)
+                else:
+                    raise ValueError(f'bad record kind {kind[0]}')
+
+    @staticmethod
+    def _read_str(f):
+        n, = struct.unpack('<H', f.read(2))
+        return f.read(n).decode()
+
+    def tables(self):
+        return list(self.schemas)
+
+    def column_names(self, table):
+        return ['ID'] + [name for _, name in self.schemas[table][1]]
+
+    def columns(self, table):
+        """Decode a whole table into a dict of column name -> array."""
+        tid, cols = self.schemas[table]
+        parts = [[] for _ in cols]
+        dctx = zstandard.ZstdDecompressor()
+        with open(self.path, 'rb') as f:
+            for offset, nrows in self.blocks[tid]:
+                f.seek(offset)
+                for i, (ctype, _) in enumerate(cols):
+                    size, raw = struct.unpack('<QQ', f.read(16))
+                    data = dctx.decompress(f.read(size),
+                                           max_output_size=raw)
+                    if ctype == INT:
+                        deltas = np.frombuffer(data, dtype=np.int64)
+                        parts[i].append(np.cumsum(deltas, dtype=np.int64))
+                    else:
+                        ends = np.frombuffer(data[:nrows * 4],
+                                             dtype=np.uint32)
+                        chars = data[nrows * 4:]
+                        starts = np.concatenate(([0], ends[:-1]))
+                        parts[i].append(np.array(
+                            [chars[s:e].decode() for s, e in
+                             zip(starts, ends)], dtype=object))
+        nrows = sum(n for _, n in self.blocks[tid])
+        result = {'ID': np.arange(1, nrows + 1, dtype=np.int64)}
+        for (ctype, name), p in zip(cols, parts):
+            if p:
+                result[name] = np.concatenate(p)
+            else:
+                result[name] = np.empty(0, dtype=np.int64 if ctype == INT
+                                        else object)
+        return result
+
+    def to_pandas(self, table):
+        import pandas as pd
+        return pd.DataFrame(self.columns(table))
+
+    def rows(self, table):
+        """Rows as tuples, in the order SELECT * returns them."""
+        cols = self.columns(table)
+        values = [cols[c] for c in self.column_names(table)]
+        for row in zip(*values):
+            yield tuple(v.item() if isinstance(v, np.generic) else v
+                        for v in row)
+
+    def to_sqlite(self, db_path):
+        import sqlite3
+        con = sqlite3.connect(db_path)
+        for table in self.tables():
+            _, cols = self.schemas[table]
+            decl = ['ID INTEGER PRIMARY KEY'] + [
+                f'{name} {"INT" if ctype == INT else "TEXT"}'
+                for ctype, name in cols]
+            con.execute(f'CREATE TABLE {table}({", ".join(decl)})')
+            marks = ','.join('?' * (len(cols) + 1))
+            con.executemany(f'INSERT INTO {table} VALUES({marks})',
+                            self.rows(table))
+        con.commit()
+        con.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('trace', help='columnar arch db file')
+    parser.add_argument('-t', '--table', help='table to print')
+    parser.add_argument('-n', type=int, default=20,
+                        help='number of rows to print')
+    parser.add_argument('--to-sqlite', metavar='DB',
+                        help='convert the trace to a SQLite database')
+    args = parser.parse_args()
+
+    trace = ColumnarTrace(args.trace)
+    if args.to_sqlite:
+        trace.to_sqlite(args.to_sqlite)
+    elif args.table:
+        print(' '.join(trace.column_names(args.table)))
+        for i, row in enumerate(trace.rows(args.table)):
+            if i >= args.n:
+                break
+            print(' '.join(str(v) for v in row))
+    else:
+        for table in trace.tables():
+            tid, _ = trace.schemas[table]
+            nrows = sum(n for _, n in trace.blocks[tid])
+            print(f'{table}: {nrows} rows, '
+                  f'{" ".join(trace.column_names(table))}')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+
+# Re-compress a zstd/gz/raw RVGCpt memory image into independent zstd
+# frames, so that PhysicalMemory can restore it with several host threads
+# (see System.gcpt_restore_threads), or lazily, one frame at a time on first
+# access (--gcpt-lazy-restore). Lazy restores want small frames, e.g. 2 MiB.
+# The output is still a plain zstd file that the zstd tools and older gem5
+# builds can decompress.
+#
+# Usage: gcpt_to_multiframe.sh <input cpt> <output .zstd> [frame size MiB]
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 <input cpt> <output .zstd> [frame size MiB, default 64]"
+    exit 1
+fi
+
+input=$1
+output=$2
+frame_mb=${3:-64}
+
+tmp_dir=$(mktemp -d)
+trap 'rm -rf $tmp_dir' EXIT
+
+case $(head -c 4 "$input" | od -An -tx1 | tr -d ' \n') in
+    28b52ffd) zstd -q -d -c "$input" > $tmp_dir/image ;;
+    1f8b*) gzip -d -c "$input" > $tmp_dir/image ;;
+    *) cp "$input" $tmp_dir/image ;;
+esac
+
+# Compressing each chunk from a regular file records the frame content
+# size, which the parallel restorer needs to place the frame.
+split -b ${frame_mb}M -d -a 6 $tmp_dir/image $tmp_dir/chunk.
+rm $tmp_dir/image
+zstd -q --rm -T0 $tmp_dir/chunk.*
+cat $tmp_dir/chunk.*.zst > "$output"
+
+echo "Wrote $(ls $tmp_dir/chunk.*.zst | wc -l) frames to $output"
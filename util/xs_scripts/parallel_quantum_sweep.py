@@ -0,0 +1,154 @@
+#!/usr/bin/env python3
+"""
+Run a multi-core XS configuration once serially and once with
+--parallel-cores for each quantum, then report how far the timing of each
+parallel run is from the serial run and how much faster it finished.
+With --repeats, every run is repeated and the spread of simTicks between
+repeats shows whether the timing depends on how the host threads were
+scheduled.
+
+Everything after '--' is passed to configs/example/xiangshan.py, e.g.
+
+    parallel_quantum_sweep.py --quanta auto 2ns 10ns --repeats 3 -- \\
+        --ruby --num-cpus=2 --generic-rv-cpt=$cpt --mem-type=DDR4_2400_8x8
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+
+script_dir = os.path.dirname(os.path.realpath(__file__))
+gem5_home = os.path.dirname(os.path.dirname(script_dir))
+
+ipc_re = re.compile(r"^system\.cpu\d*\.ipc$")
+
+
+def read_stats(path):
+    """The last dump in a stats.txt, as a dict of scalar values"""
+    dumps = [{}]
+    with open(path) as f:
+        for line in f:
+            if line.startswith("---------- End"):
+                dumps.append({})
+                continue
+            fields = line.split()
+            if len(fields) < 2:
+                continue
+            try:
+                dumps[-1][fields[0]] = float(fields[1])
+            except ValueError:
+                pass
+    dumps = [d for d in dumps if d]
+    if not dumps:
+        sys.exit(f"No statistics in {path}")
+    return dumps[-1]
+
+
+def summarize(stats):
+    ipcs = {k: v for k, v in stats.items() if ipc_re.match(k)}
+    held_msgs = sum(v for k, v in stats.items()
+                    if k.endswith(".m_held_msgs"))
+    held_ticks = sum(v for k, v in stats.items()
+                     if k.endswith(".m_held_ticks"))
+    return {
+        "ticks": stats.get("simTicks", 0),
+        "host": stats.get("hostSeconds", 0),
+        "ipcs": ipcs,
+        "held_msgs": held_msgs,
+        "held_ticks": held_ticks,
+    }
+
+
+def combine(repeats):
+    """The mean of the repeats of a run, and the spread of its simTicks"""
+    n = len(repeats)
+    ticks = [r["ticks"] for r in repeats]
+    res = {k: sum(r[k] for r in repeats) / n
+           for k in ("ticks", "host", "held_msgs", "held_ticks")}
+    res["ipcs"] = {k: sum(r["ipcs"].get(k, 0) for r in repeats) / n
+                   for k in repeats[0]["ipcs"]}
+    res["spread"] = 100.0 * (max(ticks) - min(ticks)) / res["ticks"] \
+        if res["ticks"] else 0.0
+    return res
+
+
+def run(args, outdir, quantum):
+    cmd = [args.gem5, "-d", outdir,
+           os.path.join(gem5_home, "configs/example/xiangshan.py")]
+    cmd += args.config_args
+    if quantum:
+        cmd += ["--parallel-cores"]
+    if quantum and quantum != "auto":
+        cmd += [f"--sim-quantum={quantum}"]
+    print(" ".join(cmd), flush=True)
+    with open(os.path.join(outdir, "log.txt"), "w") as log:
+        subprocess.run(cmd, stdout=log, stderr=subprocess.STDOUT,
+                       check=True)
+
+
+def deviation(value, ref):
+    return 100.0 * (value - ref) / ref if ref else 0.0
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__,
+        formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--gem5", default=os.path.join(
+        gem5_home, "build/RISCV_CHI/gem5.opt"),
+        help="gem5 binary (default: %(default)s)")
+    parser.add_argument("--quanta", nargs="+",
+                        default=["auto", "1ns", "2ns", "5ns", "10ns",
+                                 "100ns"],
+                        help="quanta to try, 'auto' leaves the default of "
+                        "xiangshan.py, the smallest latency between a core "
+                        "and the network (default: %(default)s)")
+    parser.add_argument("--repeats", type=int, default=1,
+                        help="runs of each configuration (default: "
+                        "%(default)s)")
+    parser.add_argument("--outdir", default="quantum_sweep",
+                        help="one sub-directory per run is created here")
+    parser.add_argument("--report-only", action="store_true",
+                        help="read the stats of earlier runs in --outdir")
+    parser.add_argument("config_args", nargs=argparse.REMAINDER,
+                        help="arguments for xiangshan.py, after '--'")
+    args = parser.parse_args()
+    if args.config_args and args.config_args[0] == "--":
+        args.config_args = args.config_args[1:]
+
+    results = {}
+    for quantum in [None] + args.quanta:
+        repeats = []
+        for i in range(args.repeats):
+            outdir = os.path.join(args.outdir, quantum or "serial")
+            if args.repeats > 1:
+                outdir = os.path.join(outdir, str(i))
+            if not args.report_only:
+                os.makedirs(outdir, exist_ok=True)
+                run(args, outdir, quantum)
+            repeats.append(summarize(
+                read_stats(os.path.join(outdir, "stats.txt"))))
+        results[quantum] = combine(repeats)
+
+    ref = results.pop(None)
+    print(f"serial: {ref['ticks']:.0f} ticks, {ref['host']:.1f} s, "
+          f"spread {ref['spread']:.2f}%")
+    print(f"{'quantum':>8} {'ticks %':>8} {'spread %':>9} "
+          f"{'max IPC %':>10} {'held msgs':>10} {'mean held':>10} "
+          f"{'speedup':>8}")
+    for quantum, res in results.items():
+        ipc_dev = max((abs(deviation(v, ref["ipcs"].get(k, 0)))
+                       for k, v in res["ipcs"].items()), default=0.0)
+        mean_held = (res["held_ticks"] / res["held_msgs"]
+                     if res["held_msgs"] else 0.0)
+        speedup = ref["host"] / res["host"] if res["host"] else 0.0
+        print(f"{quantum:>8} {deviation(res['ticks'], ref['ticks']):>+8.2f} "
+              f"{res['spread']:>9.2f} {ipc_dev:>10.2f} "
+              f"{res['held_msgs']:>10.0f} {mean_held:>10.0f} "
+              f"{speedup:>7.2f}x")
+
+
+if __name__ == "__main__":
+    main()